@@ -80,6 +80,7 @@
 * without reference to its choice of law rules.
 */
 
+#include <time.h>
 #include <string>
 
 /*
@@ -105,11 +106,19 @@
 #define PBS_ACCT_DEL (int)'D' /* Job Deleted by request */
 #define PBS_ACCT_ABT (int)'A' /* Job Abort by server */
 
+/* values of the accounting_format server attribute */
+#define ACCT_FORMAT_TEXT "text" /* date;type;jobid;key=value ... */
+#define ACCT_FORMAT_JSON "json" /* one JSON object per line */
+
+#define ACCT_QUEUE_MAX   4096   /* records queued for the writer before account_record() waits */
+
 extern int  acct_open (char *filename, bool acct_mutex_locked);
 void        acct_close (bool acct_mutex_locked);
 extern void account_record (int acctype, job *pjob, const char *text);
 extern void account_jobstr (job *pjob);
 extern void account_jobend (job *pjob, std::string &acct_data);
+int         acct_writer_start (void);
+void        acct_record_to_json (std::string &out, time_t when, const char *stamp, int acctype, const char *jobid, const char *text);
 
 #endif
 
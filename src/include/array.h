@@ -2,6 +2,9 @@
 #define ARRAY_H
 
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 /* these are required if you include array.h */
 #include "pbs_ifl.h"
@@ -131,6 +134,34 @@ class array_info
   };
 
 
+/*
+ * Tracks the indices of the subjobs that haven't been created yet, one bit per index, so an
+ * array only pays for the subjobs that have been instantiated
+ */
+
+class subjob_index_set
+  {
+  std::vector<unsigned long long> words;
+  int                             count;
+  size_t                          first_word; // no index is set in a word below this one
+
+  public:
+  subjob_index_set() : words(), count(0), first_word(0) {}
+
+  void clear();
+  void add(int index);
+  void add_range(int start, int end);
+  bool contains(int index) const;
+  bool remove(int index);
+  int  remove_range(int start, int end);
+  int  first();
+  int  size() const;
+  int  from_range_string(const char *range_str);
+  void to_range_string(std::string &range_str) const;
+  };
+
+
+
 /* pbs_server will keep a list of these structs, with one struct per job array*/
 
 class job_array
@@ -146,8 +177,20 @@ class job_array
   // order to not lose sub-jobs
   bool               ai_ghost_recovered;
 
-  // Vector of array sub jobs indices that haven't been created
-  std::vector<int>   uncreated_ids;
+  // array sub job indices that haven't been created
+  subjob_index_set   uncreated_ids;
+
+  // true if uncreated_ids was read from the array file
+  bool               uncreated_ids_recovered;
+
+  // holds placed on ranges of uncreated sub jobs, keyed by hold type. They are applied to
+  // each sub job when it is created
+  std::map<long, subjob_index_set> uncreated_holds;
+
+  // while non-zero, bulk operations are updating the array and saving it is left to the last
+  // of them to finish
+  int                bulk_updates;
+  bool               save_deferred;
 
   pthread_mutex_t   *ai_mutex;
 
@@ -169,8 +212,16 @@ class job_array
   void update_array_values(int old_state, enum ArrayEventsEnum event, const char *job_id,
                             int job_exit_status);
   void create_job_if_needed();
-  int  get_next_index_to_create(int &internal_index);
+  int  create_subjob(int index);
+  int  get_next_index_to_create();
+  int  remove_uncreated_range(int start, int end, int exit_status);
   void initialize_uncreated_ids();
+  void hold_uncreated_range(int start, int end, long holds);
+  void release_uncreated_range(int start, int end, long holds);
+  long get_uncreated_holds(int index) const;
+  void begin_bulk_update();
+  void end_bulk_update();
+  void request_save();
 
   bool need_to_update_slot_limits() const;
   void mark_deleted();
@@ -179,6 +230,22 @@ class job_array
 
 
 
+/*
+ * Created sub jobs of one array that a task pool thread deletes together
+ */
+
+class subjob_batch
+  {
+  public:
+  std::string              array_id;
+  std::vector<std::string> job_ids;
+  bool                     purge;
+
+  subjob_batch(const char *id, bool purge_jobs) : array_id(id), job_ids(), purge(purge_jobs) {}
+  };
+
+
+
 typedef container::item_container<job_array *>                all_arrays;
 typedef container::item_container<job_array *>::item_iterator all_arrays_iterator;
 
@@ -207,6 +274,9 @@ typedef container::item_container<job_array *>::item_iterator all_arrays_iterato
 #define TOKENS_TAG               "tokens"
 #define TOKEN_TAG                "token"
 #define RANGE_TAG                "range"
+#define UNCREATED_TAG            "uncreated"
+#define UNCREATED_HOLD_TAG       "uncreated_hold"
+#define HOLD_TYPE_TAG            "type"
 
 int  is_array(char *id);
 int  array_delete(const char *array_id);
@@ -219,6 +289,7 @@ int array_recov(const char *path, job_array **pa);
 
 int delete_array_range(job_array *pa, char *range, bool purge);
 int delete_whole_array(job_array *pa, bool purge);
+void *delete_subjob_batch_work(void *vp);
 bool attempt_delete(void *);
 
 int hold_array_range(job_array *,char *,pbs_attribute *);
@@ -234,6 +305,7 @@ bool set_array_depend_holds(job_array *);
 
 int release_job(struct batch_request *,void *, job_array *pa);
 int release_array_range(job_array *,struct batch_request *,char *);
+int release_uncreated_holds(job_array *,struct batch_request *,int,int);
 
 int first_job_index(job_array *);
 
@@ -247,5 +319,9 @@ int        check_array_slot_limits(job *pjob, job_array *pa);
 job_array *next_array(all_arrays_iterator **);
 
 job_array *get_jobs_array(job **);
+job_array *get_uncreated_subjob_array(const char *job_id, int &index);
+int        authorize_uncreated_subjob_req(job_array *pa, struct batch_request *preq, const char *job_id);
+int        materialize_array_subjob(const char *job_id, struct batch_request *preq);
+int        delete_uncreated_subjob(const char *job_id, struct batch_request *preq);
 
 #endif
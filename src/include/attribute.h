@@ -365,6 +365,9 @@ struct array_strings
 
 void clear_attr(pbs_attribute *pattr, attribute_def *pdef);
 int  find_attr(attribute_def *attrdef, const char *name, int limit);
+int  index_attr_defs(attribute_def *attrdef, int limit);
+#define DEF_NOT_INDEXED -2
+int  find_indexed_def(const void *defs, const char *name, int limit);
 int  recov_attr(int fd, void *parent, attribute_def *padef,
                 pbs_attribute *pattr, int limit, int unknown, int do_actions);
 long attr_ifelse_long(pbs_attribute *, pbs_attribute *, long);
@@ -3,18 +3,73 @@
 #define __AUTHORIZED_HOSTS_HPP__
 #include <map>
 #include <string>
+#include <vector>
 
 #include "pbs_nodes.h"
 
 
+/*
+ * An open-addressed table of (address, port) keys and the hostname for each.
+ * Once published a table is only changed by setting a key's hostname or
+ * marking a key removed, so readers can search it without a lock.
+ */
+
+class auth_table
+  {
+  public:
+  unsigned int                    mask;    /* capacity - 1, the capacity is a power of 2 */
+  unsigned int                    used;    /* keys set */
+  unsigned int                    removed; /* keys marked removed, their slots aren't reused */
+  std::vector<unsigned long long> keys;
+  std::vector<const char *>       hosts;
+
+  auth_table(unsigned int capacity) : mask(capacity - 1), used(0), removed(0),
+                                      keys(capacity, 0), hosts(capacity, (const char *)NULL) {}
+  };
+
+
+/* an interned hostname and the number of live slots in the published table pointing at it */
+class auth_name
+  {
+  public:
+  char *name;
+  int   refs;
+
+  auth_name() : name(NULL), refs(0) {}
+  };
+
+
 class authorized_hosts
   {
+  // Serializes the writers. Readers only use auth_current.
   pthread_mutex_t                               auth_mutex;
   // Map key is the ip address, value is the host information
   std::map<unsigned long, std::map<unsigned short, std::string> > auth_map;
+  auth_table                                   *auth_current;
+  // Readers register in the current epoch, see enter_read() and reclaim()
+  mutable unsigned int                          auth_readers[2];
+  unsigned int                                  auth_epoch;
+  // Tables and hostnames taken out of use during each epoch. Readers may still hold them.
+  std::vector<auth_table *>                     auth_retired[2];
+  std::vector<char *>                           auth_retired_names[2];
+  // The hostnames live slots point at
+  std::map<std::string, auth_name>              auth_host_names;
+
+  unsigned int enter_read() const;
+  void         leave_read(unsigned int epoch) const;
+  bool         find_host(unsigned long long key, std::string *host) const;
+  const char  *hold_name(const std::string &host);
+  void         release_name(const char *host);
+  void         set_key(unsigned long long key, const char *host);
+  void         remove_key(unsigned long long key);
+  void         update_any_port(unsigned long addr);
+  void         publish_table(unsigned int capacity);
+  void         retire_table(auth_table *table);
+  void         reclaim();
 
   public:
     authorized_hosts();
+    ~authorized_hosts();
 
     void add_authorized_address(unsigned long addr, unsigned short port, const std::string &host);
     void clear();
@@ -25,6 +80,8 @@ class authorized_hosts
     pbsnode *get_authorized_node(unsigned long addr, unsigned short port);
     void     list_authorized_hosts(std::string &output);
     bool     remove_address(unsigned long addr, unsigned short port);
+    int      get_host_name_count();
+    int      get_retired_count();
   };
 
 extern authorized_hosts auth_hosts;
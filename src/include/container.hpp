@@ -8,13 +8,8 @@
 #ifndef CONTAINER_H
 #define CONTAINER_H
 
-/*
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/member.hpp>
-*/
 #include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 #include <string>
 #include <vector>
 #include <pthread.h>
@@ -29,6 +24,8 @@ extern bool exit_called;
 #define ALREADY_IN_LIST     9
 #define ALWAYS_EMPTY_INDEX  0
 
+#define CONTAINER_SHARDS   16 /* stripes of the id index, each with its own rwlock */
+
 
 //#define CHECK_LOCKING
 
@@ -41,26 +38,29 @@ extern bool exit_called;
 namespace container{ //Creating a scope to prevent my using from spilling past the include file.
 
 
-//using namespace ::boost::multi_index;
-//using namespace ::boost::multi_index::detail;
+/*
+ * One entry in an item_container's list.
+ *
+ * An item is referenced by the list while it is linked, by each iterator
+ * positioned on it and, once it has been removed, it references the
+ * neighbors it had so that an iterator sitting on it can still move on.
+ * The last reference to be released frees it.
+ */
 
 template <class T>
 class item
   {
   public:
 
-  item(std::string const &idString, T p): id(idString), ptr(p)
+  item(std::string const &idString, T p): id(idString), ptr(p), next(NULL), prev(NULL), refs(1), dead(false)
     {
     }
 
   bool operator == (
-      
+
     const std::string &rhs) const
 
     {
-    if (&rhs == NULL)
-      return false;
-
     return id == rhs;
     }
 
@@ -69,38 +69,87 @@ class item
     return ptr;
     }
 
+  void acquire()
+    {
+    __sync_add_and_fetch(&refs, 1);
+    }
+
+  /*
+   * drop a reference to it, freeing it (and then any removed neighbors only
+   * it was keeping) when none are left
+   */
+
+  static void release(
+
+    item<T> *it)
+
+    {
+    std::vector<item<T> *> to_release;
+
+    while (it != NULL)
+      {
+      if (__sync_sub_and_fetch(&it->refs, 1) == 0)
+        {
+        /* only removed items can lose their last reference */
+        if (it->next != NULL)
+          to_release.push_back(it->next);
+        if (it->prev != NULL)
+          to_release.push_back(it->prev);
+
+        delete it;
+        }
+
+      if (to_release.size() == 0)
+        break;
+
+      it = to_release.back();
+      to_release.pop_back();
+      }
+    }
+
   std::string id;
+  T           ptr;
+  item<T>    *next;
+  item<T>    *prev;
+  int         refs;
+  bool        dead;  /* removed from the list, next and prev are frozen */
+
   private:
   item(){}
-  T ptr;
   };
 
-template <class T> class slot
+
+
+template <class T>
+class index_shard
   {
   public:
-  item<T> *pItem;
-  int     next;
-  int     prev;
+  pthread_rwlock_t                               lock;
+  boost::unordered_map<std::string, item<T> *>   index;
   };
 
+
+
+/*
+ * item_container
+ *
+ * An ordered list of T, indexed by id.
+ *
+ * Changes to the list and iteration require lock(). The id index is split
+ * into CONTAINER_SHARDS stripes, each with its own rwlock, so find() doesn't
+ * need lock() and readers only contend with writers of the same stripe.
+ *
+ * Iterators hold a reference to the item they will return next. If that
+ * item is removed the iterator follows the neighbors it had when it was
+ * removed, so iterators stay valid across inserts and removals made between
+ * calls to get_next_item().
+ */
+
 template <class T>
 class item_container
   {
   public:
 
-#if 0
-  typedef multi_index_container<item<T>,
-      indexed_by<
-      sequenced<>,
-      hashed_unique<member<item<T>, std::string, &item<T>::id > > > > indexed_container;
-
-  typedef typename indexed_container::template nth_index<0>::type& sequenced_index;
-  typedef typename indexed_container::template nth_index<0>::type::iterator sequenced_iterator;
-  typedef typename indexed_container::template nth_index<0>::type::reverse_iterator sequenced_reverse_iterator;
-  typedef typename indexed_container::template nth_index<1>::type& hashed_index;
-  typedef typename indexed_container::template nth_index<1>::type::iterator hashed_iterator;
-#endif
-
   class item_iterator
     {
   public:
@@ -124,33 +173,30 @@ class item_container
       if (endHit)
         return(NULL);
 
-      if (iter == ALWAYS_EMPTY_INDEX)
-        {
-        endHit = true;
-        return(NULL);
-        }
-      item<T> *pItem;
-      if (reversed)
+      if (started == false)
         {
-        pItem = pContainer->next_thing_from_back(&iter);
-        
-        if (pItem == NULL)
-          {
-          endHit = true;
-          return(NULL);
-          }
-        return pItem->get();
+        cur = (reversed) ? pContainer->last : pContainer->first;
+        if (cur != NULL)
+          cur->acquire();
+        started = true;
         }
-      
-      pItem = pContainer->next_thing(&iter);
 
-      if (pItem == NULL)
+      /* skip anything removed since the last call */
+      while ((cur != NULL) &&
+             (cur->dead == true))
+        advance();
+
+      if (cur == NULL)
         {
         endHit = true;
         return(NULL);
         }
 
-      return(pItem->get());
+      T pT = cur->get();
+
+      advance();
+
+      return(pT);
       } // END get_next_item()
 
 
@@ -165,11 +211,17 @@ class item_container
       pLocked = locked;
 #endif
       pContainer = pCtner;
-      iter = -1;
-      pContainer->initialize_ra_iterator(&iter);
+      cur = NULL;
+      started = false;
       reversed = reverse;
       endHit = false;
       }
+
+    ~item_iterator()
+      {
+      item<T>::release(cur);
+      }
+
     void reset(void) //Reset the iterator;
       {
 #ifdef CHECK_LOCKING
@@ -182,13 +234,26 @@ class item_container
         }
       }
 #endif
-      iter = -1;
-      pContainer->initialize_ra_iterator(&iter);
+      item<T>::release(cur);
+      cur = NULL;
+      started = false;
       endHit = false;
       }
   private:
+    void advance()
+      {
+      item<T> *nxt = (reversed) ? cur->prev : cur->next;
+
+      if (nxt != NULL)
+        nxt->acquire();
+
+      item<T>::release(cur);
+      cur = nxt;
+      }
+
     item_container<T> *pContainer;
-    int iter;
+    item<T> *cur;
+    bool started;
     bool endHit;
     bool reversed;
 #ifdef CHECK_LOCKING
@@ -198,16 +263,15 @@ class item_container
 
   item_container():
 
-    updateCounter(0),
-    max(0),
-    num(0),
-    next_slot(1),
-    last(0)
+    first(NULL),
+    last(NULL),
+    num(0)
 
     {
     pthread_mutex_init(&mutex, NULL);
-    max = 10;
-    slots = (slot<T> *)calloc(max, sizeof(slot<T>));
+
+    for (int i = 0; i < CONTAINER_SHARDS; i++)
+      pthread_rwlock_init(&shards[i].lock, NULL);
 #ifdef CHECK_LOCKING
     locked = false;
 #endif
@@ -219,25 +283,20 @@ class item_container
     {
     if (exit_called)
       {
-      //If exit is called, don't free the slots.
-      lock();
-      map.clear();
-      unlock();
+      //If exit is called, don't free the items.
       return;
       }
 
-    if (slots != NULL)
-      {
-      clear();
-      free(slots);
-      slots = NULL;
-      }
+    clear();
+
+    for (int i = 0; i < CONTAINER_SHARDS; i++)
+      pthread_rwlock_destroy(&shards[i].lock);
     }
 
 
 
   bool insert(
-      
+
     T                  it,
     std::string const &id,
     bool               replace = false)
@@ -247,23 +306,21 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[id];
-    if (index != ALWAYS_EMPTY_INDEX)
+    item<T> *existing = lookup(id);
+    if (existing != NULL)
       {
       if (!replace) return false;
-      remove_thing_from_index(index);
+      remove_item(existing);
       }
 
-    item<T> *pItem = new item<T>(id,it);
-    if (insert_thing(pItem) < 0)
-      return false;
+    link_before(new item<T>(id,it), NULL);
     return true;
     }
 
 
 
   bool insert_after(
-      
+
     std::string const &location_id,
     T                  it,
     std::string const &id)
@@ -273,14 +330,12 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[location_id];
-    if (index == ALWAYS_EMPTY_INDEX)
+    item<T> *location = lookup(location_id);
+    if ((location == NULL) ||
+        (lookup(id) != NULL))
       return false;
-    
-    item<T> *pItem = new item<T>(id,it);
 
-    if (insert_thing_after(pItem,index) < 0)
-      return false;
+    link_before(new item<T>(id,it), location->next);
 
     return true;
     }
@@ -288,7 +343,7 @@ class item_container
 
 
   bool insert_at(
-      
+
     int                index,
     T                  it,
     std::string const &id)
@@ -298,19 +353,16 @@ class item_container
     if (exit_called)
       return false;
 
-    int iter = -1;
-    initialize_ra_iterator(&iter);
-    while(index--)
-      {
-      item<T> *pItem = next_thing(&iter);
-      if (pItem == NULL)
-        return false;
-      }
+    if ((index < 0) ||
+        (index > num) ||
+        (lookup(id) != NULL))
+      return false;
 
-    item<T> *pItem = new item<T>(id,it);
+    item<T> *location = first;
+    while (index--)
+      location = location->next;
 
-    if (insert_thing_before(pItem,iter) < 0)
-      return false;
+    link_before(new item<T>(id,it), location);
 
     return true;
     }
@@ -318,7 +370,7 @@ class item_container
 
 
   bool insert_first(
-      
+
     T                  it,
     std::string const &id)
 
@@ -333,7 +385,7 @@ class item_container
 
 
   bool insert_before(
-      
+
     std::string const &location_id,
     T                  it,
     std::string const &id)
@@ -343,13 +395,12 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[location_id];
-    if (index == ALWAYS_EMPTY_INDEX)
+    item<T> *location = lookup(location_id);
+    if ((location == NULL) ||
+        (lookup(id) != NULL))
       return false;
 
-    item<T> *pItem = new item<T>(id,it);
-    if (insert_thing_before(pItem,index) != PBSE_NONE)
-      return false;
+    link_before(new item<T>(id,it), location);
 
     return true;
     }
@@ -357,7 +408,7 @@ class item_container
 
 
   bool remove(
-      
+
     std::string const &id)
 
     {
@@ -365,39 +416,114 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[id];
-    if (index == ALWAYS_EMPTY_INDEX)
-      return false;
-    
-    if (remove_thing_from_index(index) != PBSE_NONE)
+    item<T> *pItem = lookup(id);
+    if (pItem == NULL)
       return false;
 
+    remove_item(pItem);
+
     return true;
     }
 
 
 
+  /*
+   * find() only takes the read lock of id's stripe, so it may be called
+   * with or without lock()
+   */
+
   T find(
-      
+
     std::string const &id)
 
     {
-    CHECK_LOCK
     if (exit_called)
       return  empty_val();
 
-    int index = map[id];
-    if (index == ALWAYS_EMPTY_INDEX)
-      {
-      return empty_val();
-      }
-    item<T> *pItem = slots[index].pItem;
-    if (pItem == NULL)
+    index_shard<T> &shard = shard_for(id);
+    T               pT = empty_val();
+
+    pthread_rwlock_rdlock(&shard.lock);
+
+    typename boost::unordered_map<std::string, item<T> *>::iterator it = shard.index.find(id);
+    if (it != shard.index.end())
+      pT = it->second->get();
+
+    pthread_rwlock_unlock(&shard.lock);
+
+    return pT;
+    }
+
+
+
+  /*
+   * pin() looks id up like find() and also takes a reference on its item, so
+   * the item outlives a removal until unpin(). The reference is taken under
+   * the stripe's read lock, and remove_item() drops the id from the index
+   * under the write lock before it looks at the reference count, so it
+   * always sees the pin. Like find(), lock() isn't needed.
+   *
+   * @param value - (O) id's payload when it was found
+   * @return the pinned item or NULL if id isn't in the container
+   */
+
+  item<T> *pin(
+
+    std::string const &id,
+    T                 &value)
+
+    {
+    index_shard<T> &shard = shard_for(id);
+    item<T>        *pItem = NULL;
+
+    value = empty_val();
+
+    if (exit_called)
+      return(NULL);
+
+    pthread_rwlock_rdlock(&shard.lock);
+
+    typename boost::unordered_map<std::string, item<T> *>::iterator it = shard.index.find(id);
+    if (it != shard.index.end())
       {
-      return empty_val();
+      pItem = it->second;
+      pItem->acquire();
+      value = pItem->get();
       }
-    return pItem->get();
-    }
+
+    pthread_rwlock_unlock(&shard.lock);
+
+    return(pItem);
+    } /* END pin() */
+
+
+
+  /*
+   * true if value was removed from the container since pin() returned it.
+   * A removed item can't be swapped any more, so its payload is final.
+   */
+
+  bool removed_while_pinned(
+
+    item<T> *pinned,
+    T        value)
+
+    {
+    __sync_synchronize();
+
+    return((pinned->dead == true) &&
+           (pinned->ptr == value));
+    } /* END removed_while_pinned() */
+
+
+
+  void unpin(
+
+    item<T> *pinned)
+
+    {
+    item<T>::release(pinned);
+    } /* END unpin() */
 
 
 
@@ -406,9 +532,13 @@ class item_container
     CHECK_LOCK
     if (exit_called)
       return  empty_val();
-    
-    T pT = pop_thing();
-    
+
+    if (first == NULL)
+      return empty_val();
+
+    T pT = first->get();
+    remove_item(first);
+
     if (pT == NULL)
       return empty_val();
 
@@ -423,7 +553,11 @@ class item_container
     if (exit_called)
       return  empty_val();
 
-    T pT = pop_back_thing();
+    if (last == NULL)
+      return empty_val();
+
+    T pT = last->get();
+    remove_item(last);
 
     if (pT == NULL)
       return empty_val();
@@ -433,8 +567,12 @@ class item_container
 
 
 
+  /*
+   * exchanges the positions of id1 and id2 in the list
+   */
+
   bool swap(
-      
+
     std::string const &id1,
     std::string const &id2)
 
@@ -443,21 +581,35 @@ class item_container
     if (exit_called)
       return false;
 
-    int ind1 = map[id1];
-    int ind2 = map[id2];
+    item<T> *item1 = lookup(id1);
+    item<T> *item2 = lookup(id2);
 
-    if ((ind1 == ALWAYS_EMPTY_INDEX)||
-        (ind2 == ALWAYS_EMPTY_INDEX)||
-        (ind1 == ind2))
+    if ((item1 == NULL) ||
+        (item2 == NULL) ||
+        (item1 == item2))
       {
       return false;
       }
 
-    item<T> *pTmp = slots[ind1].pItem;
-    slots[ind1].pItem = slots[ind2].pItem;
-    slots[ind2].pItem = pTmp;
-    map[id1] = ind2;
-    map[id2] = ind1;
+    /* the payloads trade places, so both stripes change at once */
+    int s1 = shard_number(id1);
+    int s2 = shard_number(id2);
+
+    pthread_rwlock_wrlock(&shards[(s1 < s2) ? s1 : s2].lock);
+    if (s1 != s2)
+      pthread_rwlock_wrlock(&shards[(s1 < s2) ? s2 : s1].lock);
+
+    T tmp_ptr = item1->ptr;
+    item1->ptr = item2->ptr;
+    item2->ptr = tmp_ptr;
+    item1->id.swap(item2->id);
+
+    shards[s1].index[id1] = item2;
+    shards[s2].index[id2] = item1;
+
+    if (s1 != s2)
+      pthread_rwlock_unlock(&shards[(s1 < s2) ? s2 : s1].lock);
+    pthread_rwlock_unlock(&shards[(s1 < s2) ? s1 : s2].lock);
 
     return true;
     }
@@ -465,7 +617,7 @@ class item_container
 
 
   item_iterator *get_iterator(
-      
+
     bool reverse = false)
 
     {
@@ -489,22 +641,8 @@ class item_container
     if (exit_called)
       return;
 
-    for (int i = 0; i < max; i++)
-      {
-      if (slots[i].pItem != NULL)
-        {
-        map.erase(slots[i].pItem->id);
-        delete slots[i].pItem;
-        slots[i].pItem = NULL;
-        }
-
-      slots[i].next = ALWAYS_EMPTY_INDEX;
-      slots[i].prev = ALWAYS_EMPTY_INDEX;
-      }
-
-    num = 0;
-    next_slot = 1;
-    last = 0;
+    while (first != NULL)
+      remove_item(first);
     }
 
 
@@ -562,550 +700,148 @@ class item_container
     }
 
 
-  int swap_things(
-      
-    item<T> *thing1,
-    item<T> *thing2)
-
-    {
-    int index1 = get_index(thing1);
-    int index2 = get_index(thing2);
-
-    if ((index1 == THING_NOT_FOUND) ||
-        (index2 == THING_NOT_FOUND))
-      {
-      return THING_NOT_FOUND;
-      }
-
-    slots[index1].item = thing2;
-    slots[index2].item = thing1;
-
-    return(PBSE_NONE);
-    } /* END swap_things() */
 
+  int shard_number(
 
-
-  int check_and_resize()
+    std::string const &id)
 
     {
-    slot<T>        *tmp;
-    size_t       remaining;
-    size_t       size;
-
-    if (max == num + 1)
-      {
-      /* double the size if we're out of space */
-      size = (max * 2) * sizeof(slot<T>);
-
-      if ((tmp = (slot<T> *)realloc(slots,size)) == NULL)
-        {
-        //log_err(ENOMEM,__func__,"No memory left to resize the array");
-        return(ENOMEM);
-        }
-
-      remaining = max * sizeof(slot<T>);
+    return(boost::hash<std::string>()(id) % CONTAINER_SHARDS);
+    } /* END shard_number() */
 
-      memset(tmp + max, 0, remaining);
 
-      slots = tmp;
-
-      max = max * 2;
-      }
-
-    return(PBSE_NONE);
-    } /* END check_and_resize() */
 
+  index_shard<T> &shard_for(
 
-
-  void update_next_slot() /* M */
+    std::string const &id)
 
     {
-    while ((next_slot < max) &&
-           (slots[next_slot].pItem != NULL))
-      next_slot++;
-    } /* END update_next_slot() */
+    return(shards[shard_number(id)]);
+    } /* END shard_for() */
 
 
 
   /*
-   * inserts an item, resizing the array if necessary
-   *
-   * @return the index in the array or -1 on failure
+   * returns id's item. Only valid while lock() is held since that keeps it
+   * from being removed.
    */
 
-  int insert_thing(
+  item<T> *lookup(
 
-    item<T>  *thing)
+    std::string const &id)
 
     {
-    int rc;
-
-    /* check if the array must be resized */
-    if ((rc = check_and_resize()) != PBSE_NONE)
-      {
-      return(-1);
-      }
-
-    slots[next_slot].pItem = thing;
-    map[thing->id] = next_slot;
+    index_shard<T> &shard = shard_for(id);
+    item<T>        *pItem = NULL;
 
-    /* save the insertion point */
-    rc = next_slot;
+    pthread_rwlock_rdlock(&shard.lock);
 
-    /* handle the backwards pointer, next pointer is left at zero */
-    slots[rc].prev = last;
+    typename boost::unordered_map<std::string, item<T> *>::iterator it = shard.index.find(id);
+    if (it != shard.index.end())
+      pItem = it->second;
 
-    /* make sure the empty slot points to the next occupied slot */
-    if (last == ALWAYS_EMPTY_INDEX)
-      {
-      slots[ALWAYS_EMPTY_INDEX].next = rc;
-      }
-
-    /* update the last index */
-    slots[last].next = rc;
-    last = rc;
-
-    /* update the new item's next index */
-    slots[rc].next = ALWAYS_EMPTY_INDEX;
-
-    /* increase the count */
-    num++;
+    pthread_rwlock_unlock(&shard.lock);
 
-    update_next_slot();
-
-    return(rc);
-    } /* END insert_thing() */
+    return(pItem);
+    } /* END lookup() */
 
 
 
   /*
-   * inserts a thing after the thing in index
-   * NOTE: index must represent a valid index
+   * links thing into the list in front of location, or at the end if
+   * location is NULL, and indexes it
    */
 
-  int insert_thing_after(
+  void link_before(
 
-    item<T>         *thing,
-    int              index)
+    item<T> *thing,
+    item<T> *location)
 
     {
-    int rc;
-    int next;
-
-    /* check if the array must be resized */
-    if ((rc = check_and_resize()) != PBSE_NONE)
-      {
-      return(-1);
-      }
-
-    /* insert this element */
-    slots[next_slot].pItem = thing;
-    map[thing->id] = next_slot;
-
-    /* save the insertion point */
-    rc = next_slot;
+    index_shard<T> &shard = shard_for(thing->id);
 
-    /* move pointers around */
-    slots[rc].prev = index;
-    next = slots[index].next;
-    slots[rc].next = next;
-    slots[index].next = rc;
+    thing->next = location;
 
-    if (next != 0)
+    if (location == NULL)
       {
-      slots[next].prev = rc;
+      thing->prev = last;
+      last = thing;
       }
-
-    /* update the last index if needed */
-    if (last == index)
-      last = rc;
-
-    /* increase the count */
-    num++;
-
-    update_next_slot();
-
-    return(rc);
-    } /* END insert_thing_after() */
-
-
-
-  /*
-   * inserts a thing before the thing in index
-   * NOTE: index must represent a valid index
-   */
-  int insert_thing_before(
-
-    item<T>         *thing,
-    int              index)
-
-    {
-    int rc;
-    int prev;
-
-    /* check if the array must be resized */
-    if ((rc = check_and_resize()) != PBSE_NONE)
+    else
       {
-      return(-1);
+      thing->prev = location->prev;
+      location->prev = thing;
       }
 
-    /* insert this element */
-    slots[next_slot].pItem = thing;
-    map[thing->id] = next_slot;
-
-    /* save the insertion point */
-    rc = next_slot;
+    if (thing->prev == NULL)
+      first = thing;
+    else
+      thing->prev->next = thing;
 
-    /* move pointers around */
-    prev = slots[index].prev;
-    slots[rc].next = index;
-    slots[rc].prev = prev;
-    slots[index].prev = rc;
-    slots[prev].next = rc;
+    pthread_rwlock_wrlock(&shard.lock);
+    shard.index[thing->id] = thing;
+    pthread_rwlock_unlock(&shard.lock);
 
-    /* increase the count */
     num++;
-
-    update_next_slot();
-
-    return(rc);
-    } /* END insert_thing_before() */
-
-
-  bool is_present(
-
-    item<T>      *thing)
-
-    {
-    int i = slots[ALWAYS_EMPTY_INDEX].next;
-
-    while (i != 0)
-      {
-      if (slots[i].pItem == thing)
-        return(true);
-
-      i = slots[i].next;
-      }
-
-    return(false);
-    } /* END is_present() */
-
-
-
-  /*
-   * fix the next pointer for the box pointing to this index
-   *
-   * @param ra - the array we're fixing
-   * @param index - index of the slot we're unlinking
-   */
-  void unlink_slot(
-
-    int              index)
-
-    {
-    int prev = slots[index].prev;
-    int next = slots[index].next;
-
-    map.erase(slots[index].pItem->id);
-    slots[index].prev = ALWAYS_EMPTY_INDEX;
-    slots[index].next = ALWAYS_EMPTY_INDEX;
-    delete slots[index].pItem;
-    slots[index].pItem = NULL;
-
-    slots[prev].next = next;
-
-    /* update last if necessary, otherwise update prev's next index */
-    if (last == index)
-      last = prev;
-    else
-      slots[next].prev = prev;
-    } /* END unlink_slot() */
+    } /* END link_before() */
 
 
 
   /*
-   * remove a thing from the array
-   *
-   * @param thing - the thing to remove
-   * @return PBSE_NONE if the thing is removed
+   * unlinks thing from the list and the index and releases the list's
+   * reference to it
    */
 
-  int remove_thing(
+  void remove_item(
 
-    item<T>            *thing)
+    item<T> *thing)
 
     {
-    int i = slots[ALWAYS_EMPTY_INDEX].next;
-    bool found = false;
+    index_shard<T> &shard = shard_for(thing->id);
 
-    /* find the thing */
-    while (i != ALWAYS_EMPTY_INDEX)
-      {
-      if (slots[i].pItem == thing)
-        {
-        found = true;
-        break;
-        }
+    pthread_rwlock_wrlock(&shard.lock);
+    shard.index.erase(thing->id);
+    pthread_rwlock_unlock(&shard.lock);
 
-      i = slots[i].next;
-      }
-
-    if (!found)
-      return(THING_NOT_FOUND);
+    if (thing->prev == NULL)
+      first = thing->next;
+    else
+      thing->prev->next = thing->next;
 
-    unlink_slot(i);
+    if (thing->next == NULL)
+      last = thing->prev;
+    else
+      thing->next->prev = thing->prev;
 
     num--;
 
-    /* reset the next_slot index if necessary */
-    if (i < next_slot)
+    /* references are only added while lock() is held or, by pin(), under
+     * the stripe lock taken above, so if the list's is the only one the item
+     * can go now. Otherwise an iterator or a pin is on it and it keeps its
+     * neighbors so an iterator can move past it. */
+    if (__sync_add_and_fetch(&thing->refs, 0) > 1)
       {
-      next_slot = i;
-      }
-
-    return(PBSE_NONE);
-    } /* END remove_thing() */
-
-
+      if (thing->next != NULL)
+        thing->next->acquire();
+      if (thing->prev != NULL)
+        thing->prev->acquire();
 
-  item<T> *remove_thing_memcmp(
-
-    item<T>           *thing,
-    unsigned int     size)
-
-    {
-    int   i = slots[ALWAYS_EMPTY_INDEX].next;
-    void *item = NULL;
-
-    while (i != ALWAYS_EMPTY_INDEX)
-      {
-      /* check if equal */
-      if (!memcmp(slots[i].pItem, thing, size))
-        {
-        item = slots[i].pItem;
-
-        unlink_slot(i);
-
-        num--;
-
-        if (i < next_slot)
-          next_slot = i;
-
-        break;
-        }
-
-      i = slots[i].next;
+      thing->dead = true;
       }
-
-    return(item);
-    } /* END remove_thing_memcmp() */
-
-  /*
-   * pop the first thing from the array
-   *
-   * @return the first thing in the array or NULL if empty
-   */
-
-  T pop_thing()
-
-    {
-    item<T> *thing = NULL;
-    int   i = slots[ALWAYS_EMPTY_INDEX].next;
-    T pT = NULL;
-
-    if (i != ALWAYS_EMPTY_INDEX)
-      {
-      /* get the thing we're returning */
-      thing = slots[i].pItem;
-      pT = thing->get();
-
-      /* handle the deletion and removal */
-      unlink_slot(i);
-
-      num--;
-
-      /* reset the next slot index if necessary */
-      if (i < next_slot)
-        {
-        next_slot = i;
-        }
-      }
-
-    return(pT);
-    } /* END pop_thing() */
-
-
-  T pop_back_thing()
-
-    {
-    item<T> *thing = NULL;
-    int   i = slots[ALWAYS_EMPTY_INDEX].prev;
-    T pT = NULL;
-
-    if (i != ALWAYS_EMPTY_INDEX)
-      {
-      /* get the thing we're returning */
-      thing = slots[i].pItem;
-      pT = thing->get();
-
-      /* handle the deletion and removal */
-      unlink_slot(i);
-
-      num--;
-
-      /* reset the next slot index if necessary */
-      if (i < next_slot)
-        {
-        next_slot = i;
-        }
-      }
-
-    return(pT);
-    } /* END pop_thing() */
-
-
-
-  int remove_thing_from_index(
-
-    int index)
-
-    {
-    int rc = PBSE_NONE;
-
-    if (slots[index].pItem == NULL)
-      rc = THING_NOT_FOUND;
     else
       {
-      /* FOUND */
-      unlink_slot(index);
-
-      num--;
-
-      if (index < next_slot)
-        next_slot = index;
+      thing->next = NULL;
+      thing->prev = NULL;
       }
 
-    return(rc);
-    } /* END remove_thing_from_index() */
-
-
-  int remove_last_thing()
-
-    {
-    return(remove_thing_from_index(last));
-    } /* END remove_last_thing() */
-
-
-
-  /*
-   * returns the next available item and increments *iter
-   */
-  item<T> *next_thing(
-
-    int             *iter)
-
-    {
-    item<T> *thing;
-    int   i = *iter;
-
-    if (i == -1)
-      {
-      /* initialize first */
-      i = slots[ALWAYS_EMPTY_INDEX].next;
-      }
-
-    thing = slots[i].pItem;
-    *iter = slots[i].next;
-
-    return(thing);
-    } /* END next_thing() */
-
-
-
-  /*
-   * returns the next available item from the back and decrements *iter
-   */
-  item<T> *next_thing_from_back(
-
-    int             *iter)
-
-    {
-    item<T> *thing;
-    int   i = *iter;
-
-    if (i == -1)
-      {
-      /* initialize first */
-      i = last;
-      }
-
-    thing = slots[i].pItem;
-    *iter = slots[i].prev;
-
-    return(thing);
-    } /* END next_thing_from_back() */
-
-  /*
-   * initialize the iterator for this array
-   */
-  void initialize_ra_iterator(
-
-    int *iter)
-
-    {
-    *iter = slots[ALWAYS_EMPTY_INDEX].next;
-    } /* END initialize_ra_iterator() */
-
-
-
-  /*
-   * searches the array for thing, finding the index
-   *
-   * @param ra - the array to be searched
-   * @param thing - the thing we're looking for
-   * @return index if present, THING_NOT_FOUND otherwise
-   */
-
-  int get_index(
-
-    item<T> *thing)
-
-    {
-    try
-    {
-      int i = map[thing->id];
-      return i;
-    }catch(...)
-      {
-      return(THING_NOT_FOUND);
-      }
-    } /* END get_index() */
-
-
-
-  item<T> *get_thing_from_index(
-
-    int index)
-
-    {
-    if (index == -1)
-      index = slots[ALWAYS_EMPTY_INDEX].next;
-
-    if (index >= max)
-      return(NULL);
-    else
-      return(slots[index].pItem);
-    } /* END get_thing_from_index() */
+    item<T>::release(thing);
+    } /* END remove_item() */
 
-  //indexed_container container;
   pthread_mutex_t mutex;
-  unsigned long updateCounter;
-  slot<T> *slots;
-  int max;
+  item<T> *first;
+  item<T> *last;
   int num;
-  int next_slot;
-  int last;
-  boost::unordered_map<std::string, int> map;
+  index_shard<T> shards[CONTAINER_SHARDS];
 #ifdef CHECK_LOCKING
   bool locked;
 #endif
@@ -82,10 +82,18 @@
 
 #include <vector>
 
+/* execution slots are tracked one bit per slot, a set bit is an occupied slot */
+typedef unsigned long long slot_word_t;
+
+#define SLOT_WORD_BITS ((int)(sizeof(slot_word_t) * 8))
+
 class execution_slot_tracker
   {
-  std::vector<bool> slots;
-  int               open_count;
+  std::vector<slot_word_t> slot_words;
+  int                      slot_count;
+  int                      open_count;
+
+  slot_word_t valid_bits(int word_index) const;
 
   public:
     execution_slot_tracker(const execution_slot_tracker& est);
@@ -0,0 +1,63 @@
+#ifndef FREE_NODE_INDEX_HPP
+#define FREE_NODE_INDEX_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+
+/*
+ * What the index last saw of a node. Only nodes that can take work right
+ * now (free or partially free) appear in the secondary indexes.
+ */
+
+class indexed_node
+  {
+  public:
+  bool                     in_available;
+  int                      in_free_slots;
+  int                      in_free_gpus;
+  std::vector<std::string> in_properties;
+
+  indexed_node();
+  };
+
+
+
+/*
+ * Secondary indexes over allnodes that let node selection visit only the
+ * nodes that could satisfy a request instead of locking every node. The
+ * index is a hint: callers must still check each candidate under its node
+ * lock, and a node that was missed is still found by a full scan.
+ */
+
+class free_node_index
+  {
+  std::map<int, indexed_node>           fni_nodes;
+  std::set<int>                         fni_available;
+  std::map<std::string, std::set<int> > fni_by_property;
+  std::map<int, std::set<int> >         fni_by_slots;
+  std::map<int, std::set<int> >         fni_by_gpus;
+  std::set<int>                         fni_unindexable; // numa and alps hosts
+  pthread_mutex_t                       fni_mutex;
+
+  void unlink_node(int node_id, const indexed_node &in);
+  void link_node(int node_id, const indexed_node &in);
+
+  public:
+  free_node_index();
+  ~free_node_index();
+
+  void update(int node_id, bool available, int free_slots, int free_gpus,
+              const std::vector<std::string> &properties);
+  void mark_unindexable(int node_id);
+  void remove(int node_id);
+  bool is_usable();
+  int  get_candidates(int min_slots, int min_gpus, const std::vector<std::string> &properties,
+                      std::set<int> &candidates);
+  int  count_available();
+  };
+
+#endif /* FREE_NODE_INDEX_HPP */
@@ -0,0 +1,81 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef JOB_IMAGE_H
+#define JOB_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The binary job image written by job_save() and read by job_recov().
+ *
+ *   job_image_header
+ *   struct jobfix (ji_qs)      jih_qs_size bytes at jih_qs_offset
+ *   job_image_attr records     jih_attr_count records, jih_attr_size bytes
+ *   job_image_mom              jih_mom_size bytes, pbs_mom only
+ *
+ * Every section and record starts on a JOB_IMAGE_ALIGN boundary so that
+ * ji_qs and the attribute records can be validated in place in an mmap()ed
+ * file. The checksum covers everything after the header.
+ */
+
+#define JOB_IMAGE_MAGIC   0x4a424954 /* "TIBJ" */
+#define JOB_IMAGE_VERSION 1
+#define JOB_IMAGE_ALIGN   8
+#define JOB_IMAGE_PAD(x)  (((x) + JOB_IMAGE_ALIGN - 1) & ~((size_t)JOB_IMAGE_ALIGN - 1))
+
+typedef struct job_image_header
+  {
+  uint32_t jih_magic;
+  uint32_t jih_version;
+  uint32_t jih_header_size;
+  uint32_t jih_qs_version;  /* PBS_QS_VERSION of the ji_qs section */
+  uint32_t jih_qs_offset;
+  uint32_t jih_qs_size;     /* must be sizeof(struct jobfix) */
+  uint32_t jih_attr_offset;
+  uint32_t jih_attr_size;
+  uint32_t jih_attr_count;
+  uint32_t jih_mom_offset;
+  uint32_t jih_mom_size;
+  uint32_t jih_checksum;
+  } job_image_header;
+
+/* one encoded attribute (or one resource of a resource list attribute) */
+typedef struct job_image_attr
+  {
+  uint32_t jia_size;       /* the whole record, including padding */
+  uint32_t jia_flags;      /* at_flags when the job was saved */
+  uint16_t jia_name_len;   /* lengths include the terminating '\0'. */
+  uint16_t jia_resc_len;   /* 0 when there is no resource name */
+  uint32_t jia_value_len;
+  /* followed by the name, resource and value strings */
+  } job_image_attr;
+
+typedef struct job_image_mom
+  {
+  int32_t jim_stdout;
+  int32_t jim_stderr;
+  int32_t jim_taskid;
+  int32_t jim_nodeid;
+  } job_image_mom;
+
+
+/* FNV-1a, shared with printjob so that it can check images without the server */
+static inline uint32_t job_image_checksum(
+
+  const char *buf,
+  size_t      len)
+
+  {
+  const unsigned char *bytes = (const unsigned char *)buf;
+  uint32_t             hash = 2166136261U;
+
+  for (size_t i = 0; i < len; i++)
+    {
+    hash ^= bytes[i];
+    hash *= 16777619U;
+    }
+
+  return(hash);
+  }
+
+#endif /* JOB_IMAGE_H */
@@ -0,0 +1,97 @@
+#ifndef JOB_JOURNAL_HPP
+#define JOB_JOURNAL_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <pthread.h>
+
+#include "pbs_ifl.h" /* PBS_MAXSVRJOBID */
+
+
+#define JOURNAL_MAGIC        0x4a524e4c /* "JRNL" */
+#define JOURNAL_DELTA        1          /* a quick save: the job's state changed */
+#define JOURNAL_SNAPSHOT     2          /* the job file on disk is newer than any earlier delta */
+
+#define JOURNAL_OLD_SUFFIX   ".old"     /* the generation that is being compacted */
+
+
+/*
+ * One fixed size journal record. Quick saves only change the job's state,
+ * substate, server flags and a few times, so that is all a delta carries.
+ * Records are fixed size so that a torn write at the end of the journal is
+ * easy to detect and discard on replay.
+ */
+
+typedef struct job_journal_record
+  {
+  unsigned int jr_magic;
+  unsigned int jr_type;
+  char         jr_jobid[PBS_MAXSVRJOBID + 1];
+  int          jr_state;
+  int          jr_substate;
+  int          jr_svrflags;
+  int          jr_etime_set;
+  long         jr_stime;
+  long         jr_mtime;
+  long         jr_etime;
+  unsigned int jr_checksum;
+  } job_journal_record;
+
+
+void init_journal_record(job_journal_record &rec, unsigned int type, const char *jobid);
+bool journal_record_is_valid(const job_journal_record &rec);
+
+
+/*
+ * job_journal
+ *
+ * An append-only log of job state changes. A quick job save appends one
+ * small record instead of rewriting the job's XML file, and concurrent
+ * savers share a single fdatasync() (group commit). Full saves still write
+ * the job file; if the job has deltas in the journal a snapshot record is
+ * appended afterward so that replay doesn't roll the job back.
+ *
+ * The journal is compacted by rotating it to <path>.old, re-saving every job
+ * that has deltas and then removing the old generation.
+ */
+
+class job_journal
+  {
+  std::string                               path;
+  std::string                               old_path;
+  int                                       fd;
+  unsigned long                             appended;  /* records written to fd */
+  unsigned long                             durable;   /* records known to be on disk */
+  unsigned long                             rotated_at; /* appended when the file was last rotated */
+  bool                                      syncing;
+  std::set<std::string>                     dirty;     /* jobs with deltas and no snapshot */
+  std::map<std::string, job_journal_record> replayed;  /* last delta per job found by replay() */
+  pthread_mutex_t                           jj_mutex;
+  pthread_cond_t                            jj_cond;
+
+  int  replay_file(const char *filename);
+  int  commit(unsigned long seq);
+
+  public:
+    job_journal();
+    ~job_journal();
+
+    void set_path(const char *path);
+    int  replay();
+    bool get_replayed(const char *jobid, job_journal_record &rec);
+    int  open();
+    void close();
+    bool is_open();
+    int  append(const job_journal_record &rec);
+    bool has_deltas(const char *jobid);
+    int  snapshot_taken(const char *jobid);
+    void forget(const char *jobid);
+    int  rotate(std::vector<std::string> &to_snapshot);
+    int  finish_compaction();
+    unsigned long get_appended();
+  };
+
+#endif /* JOB_JOURNAL_HPP */
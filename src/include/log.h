@@ -88,6 +88,11 @@
 #define LOG_BUF_SIZE        16384
 #define LOCAL_LOG_BUF_SIZE  5096
 
+/* log records queued for the writer thread, see log_async_start() */
+#define LOG_QUEUE_SIZE_DEFAULT 8192
+#define LOG_FULL_BLOCK         0 /* wait for room when the queue is full */
+#define LOG_FULL_DROP          1 /* drop the record when the queue is full */
+
 /* The following macro assist in sharing code between the Server and Mom */
 #define LOG_EVENT log_event
 
@@ -93,6 +93,8 @@
 #define CHECK_POLL_TIME             45
 #define MAX_JOIN_WAIT_TIME          600
 #define RESEND_WAIT_TIME            300
+#define DEFAULT_STAGE_COPY_THREADS  4
+#define MAX_STAGE_COPY_THREADS      64
 
 
 
@@ -151,6 +153,8 @@ extern char           **maskclient; /* wildcard connections */
 extern char             MOMConfigVersion[64];
 extern int              MOMConfigDownOnError;
 extern int              MOMConfigRestart;
+extern int              MOMCgroupSampling;  /* sample jobs from their cgroups instead of all of /proc */
+extern int              MOMPipelinedRadixLaunch; /* forward job_radix joins before setting the job up locally */
 extern double           wallfactor;
 extern std::vector<cphosts> pcphosts;
 extern long             pe_alarm_time;
@@ -172,6 +176,7 @@ extern short            memory_pressure_duration;
 extern int              max_join_job_wait_time;
 extern int              resend_join_job_wait_time;
 extern int              mom_hierarchy_retry_time;
+extern int              stage_copy_threads; /* staged files copied at once without /bin/cp, 0 to always use it */
 extern int              MOMJobDirStickySet;
 extern std::string      presetup_prologue;
 
@@ -0,0 +1,62 @@
+#ifndef MOM_CONNECTION_POOL_HPP
+#define MOM_CONNECTION_POOL_HPP
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <time.h>
+#include <pthread.h>
+
+#include "net_connect.h" /* pbs_net_t */
+
+
+/*
+ * An idle, authenticated connection handle parked in the pool along with
+ * the last time it carried a request.
+ */
+
+class pooled_connection
+  {
+  public:
+  int    handle;
+  time_t last_used;
+
+  pooled_connection(int h, time_t used) : handle(h), last_used(used) {}
+  };
+
+
+/* connections are keyed by the mom's address and port (host order) */
+typedef std::pair<pbs_net_t, unsigned int> mom_endpoint;
+
+
+/*
+ * mom_connection_pool
+ *
+ * Keeps a bounded number of idle connection handles per mom so that short
+ * request/reply exchanges don't pay for a new TCP connection and privileged
+ * port authentication every time. The pool only tracks handles: checking
+ * that a handle is still healthy and actually closing evicted handles is
+ * left to the caller so that no socket I/O happens under the pool's mutex.
+ */
+
+class mom_connection_pool
+  {
+  std::map<mom_endpoint, std::vector<pooled_connection> > idle;
+  unsigned int                                           max_per_node;
+  int                                                    idle_timeout;
+  pthread_mutex_t                                        mcp_mutex;
+
+  public:
+    mom_connection_pool(unsigned int max_per_node, int idle_timeout);
+    ~mom_connection_pool();
+
+    int          checkout(pbs_net_t addr, unsigned int port);
+    bool         checkin(pbs_net_t addr, unsigned int port, int handle, time_t now);
+    void         evict_idle(time_t now, std::vector<int> &evicted);
+    void         purge(pbs_net_t addr, unsigned int port, std::vector<int> &evicted);
+    unsigned int idle_count(pbs_net_t addr, unsigned int port);
+    unsigned int get_max_per_node() const;
+    int          get_idle_timeout() const;
+  };
+
+#endif /* MOM_CONNECTION_POOL_HPP */
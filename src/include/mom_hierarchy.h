@@ -138,6 +138,19 @@ typedef std::vector<node_comm_t> mom_nodes;
 typedef std::vector<mom_nodes> mom_levels;
 typedef std::vector<mom_levels> mom_paths;
 
+/* largest uncompressed status batch accepted from a mom */
+#define STATUS_BATCH_MAX_LEN    (64 * 1024 * 1024)
+
+/* one child node's status, forwarded to the server inside a status batch */
+class status_batch_entry
+  {
+  public:
+  unsigned long            age;      /* seconds the status waited at the forwarding mom */
+  std::vector<std::string> statuses; /* the first is always "node=<name>" */
+
+  status_batch_entry() : age(0), statuses() {}
+  };
+
 /* mom_hierarchy_t holder */
 typedef struct mom_hierarchy
   {
@@ -155,6 +168,10 @@ node_comm_t *update_current_path(mom_hierarchy_t *);
 int tcp_connect_sockaddr(struct sockaddr * addr_in, size_t size, bool log = true);
 int write_tcp_reply(struct tcp_chan *chan,int,int,int,int);
 int read_tcp_reply(struct tcp_chan *chan,int,int,int,int *);
+int pack_status_batch(const std::vector<status_batch_entry> &entries, std::string &packed, unsigned int &raw_len);
+int unpack_status_batch(const char *packed, size_t packed_len, unsigned int raw_len, std::vector<status_batch_entry> &entries);
+int write_status_batch(struct tcp_chan *chan, const std::vector<status_batch_entry> &entries);
+int read_status_batch(struct tcp_chan *chan, std::vector<status_batch_entry> &entries);
 void free_mom_hierarchy(mom_hierarchy_t *);
 int handle_level(char *level_iter, int path_index, int &level_index);
 int handle_path(char *path_iter, int &path_index);
@@ -82,10 +82,14 @@
 
 
 #include <netinet/in.h> /* sockaddr_in */
+#include <string>
+#include <vector>
 #include "mcom.h" /* MMAX_LINE */
 #include "pbs_ifl.h" /* PBS_MAXSERVERNAME */
 
 #define DEFAULT_SERVER_STAT_UPDATES 45
+#define STATUS_FULL_REFRESH_INTERVAL 300 /* send a full status at least this often */
+#define STATUS_DELTA_RETRY_INTERVAL  600 /* wait this long before retrying deltas with a server that didn't take one */
 
 
 typedef struct mom_server
@@ -102,6 +106,13 @@ typedef struct mom_server
   int                received_hello_count;
   int                received_cluster_address_count;
   char               MOMSendStatFailure[MMAX_LINE];
+  unsigned long            status_generation;  /* the last status the server acknowledged, 0 if none */
+  time_t                   last_full_status;
+  time_t                   status_delta_retry; /* don't send deltas before this time */
+  std::vector<std::string> acked_status;
+
+  mom_server() : status_generation(0), last_full_status(0), status_delta_retry(0),
+                 acked_status() {}
   } mom_server;
 
 extern mom_server    mom_servers[];
@@ -80,5 +80,7 @@
 #include <string>
 #include <vector>
 
+class pbsnode;
 
-int process_status_info(const char *nd_name, std::vector<std::string> &status_info);
+int process_status_info(const char *nd_name, std::vector<std::string> &status_info, const std::vector<bool> *changed);
+int process_node_status(pbsnode *current, const char *name, std::vector<std::string> &status_info, const std::vector<bool> *changed);
@@ -129,6 +129,12 @@ typedef unsigned long pbs_net_t;        /* for holding host addresses */
 #define IS_UPDATE         3
 #define IS_STATUS         4
 #define IS_GPU_STATUS     5
+#define IS_STATUS_DELTA   6
+
+/* IS_STATUS_DELTA carries only the status strings that changed since the
+ * update the server last acknowledged, see write_status_delta() */
+#define IS_STATUS_DELTA_VER      1
+#define IS_STATUS_BASE_UNKNOWN   -506 /* reply: the server needs a full status */
 
 
 /* tell pbs_mom the direction of the hello */
@@ -0,0 +1,36 @@
+#ifndef NODE_LIVENESS_HPP
+#define NODE_LIVENESS_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <pthread.h>
+
+
+/*
+ * When each node was last heard from, ordered by time, so that check_nodes
+ * only has to visit the nodes that have gone quiet instead of locking every
+ * node. Like free_node_index this is a hint: the caller decides under the
+ * node's lock whether the node really is stale.
+ */
+
+class node_liveness_tracker
+  {
+  typedef std::multimap<time_t, std::string> deadline_map;
+
+  deadline_map                                    nlt_by_time;
+  std::map<std::string, deadline_map::iterator>   nlt_nodes;
+  pthread_mutex_t                                 nlt_mutex;
+
+  public:
+  node_liveness_tracker();
+  ~node_liveness_tracker();
+
+  void   heard_from(const char *node_name, time_t when);
+  void   forget(const char *node_name);
+  int    pop_quiet_since(time_t cutoff, std::vector<std::string> &quiet);
+  size_t size();
+  };
+
+#endif /* NODE_LIVENESS_HPP */
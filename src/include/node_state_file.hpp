@@ -0,0 +1,43 @@
+#ifndef NODE_STATE_FILE_HPP
+#define NODE_STATE_FILE_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/* rewrite the file once it holds this many records and is mostly stale */
+#define NODE_STATE_COMPACT_MIN_RECORDS 1024
+
+
+/*
+ * The node state file (server_priv/node_status). Each change is appended as
+ * a "<node> <state>" line and the last line for a node wins; a state of 0
+ * means nothing is saved for the node. The file is rewritten with only the
+ * live records once the stale ones outnumber them.
+ */
+
+class node_state_file
+  {
+  std::string                               nsf_path;
+  std::map<std::string, int>                nsf_states;  /* what the file says, non-zero only */
+  std::vector<std::pair<std::string, int> > nsf_pending;
+  unsigned int                              nsf_records; /* lines in the file */
+  pthread_mutex_t                           nsf_pending_mutex;
+  pthread_mutex_t                           nsf_file_mutex;
+
+  int  compact_locked();
+
+  public:
+  node_state_file();
+  ~node_state_file();
+
+  void         set_path(const char *path);
+  int          load(std::map<std::string, int> &states);
+  void         record(const char *node_name, int state);
+  int          flush();
+  int          compact();
+  unsigned int get_record_count();
+  };
+
+#endif /* NODE_STATE_FILE_HPP */
@@ -398,6 +398,8 @@
 #define ATTR_tcpincomingtimeout        "tcp_incoming_timeout"
 #define ATTR_ghost_array_recovery      "ghost_array_recovery"
 #define ATTR_cgroup_per_task           "cgroup_per_task"
+#define ATTR_accounting_format         "accounting_format"
+#define ATTR_accounting_fsync          "accounting_fsync"
 
 /* notification email formating */
 #define ATTR_mailsubjectfmt "mail_subject_fmt"
@@ -127,6 +127,8 @@ struct job_array;
 
 #define JOB_REPORTED_POLL_TIMEOUT 300
 #define JOB_CONDENSED_TIMEOUT     45
+#define JOB_STATUS_CACHE_TTL      60  /* seconds a cached qstat encoding is trusted */
+#define JOB_STATUS_CACHE_VARIANTS 4   /* cached encodings kept per job */
 #define REQ_VERSION_1             1
 #define REQ_VERSION_2             2
 
@@ -692,6 +694,8 @@ typedef struct job
   char           ji_altid[PBS_MAXSVRJOBID + 1];
   tm_event_t     ji_obit; /* event for end-of-job */
   tm_event_t     ji_intermediate_join_event; /* event to write back from join job for intermediate moms */
+  struct timeval ji_radix_join_start; /* when IM_JOIN_JOB_RADIX went out to this mom's part of the radix */
+  int            ji_radix_join_errors; /* join errors reported from this mom's part of the radix */
   hnodent        *ji_hosts; /* ptr to job host management stuff */
   hnodent        *ji_sisters; /* ptr to job host management stuff for intermediate moms */
   vnodent        *ji_vnods; /* ptr to job vnode management stuff */
@@ -766,6 +770,23 @@ typedef struct job
   } job;
 
 #else
+
+/*
+ * the client encoding of all of a job's attributes, kept so that repeated
+ * full qstats can copy it instead of encoding the job again. There is one
+ * for each combination of read privilege, ownership and condensed output.
+ * See status_job().
+ */
+
+typedef struct job_status_cache
+  {
+  int               jsc_priv;
+  int               jsc_owner;
+  bool              jsc_condensed;
+  time_t            jsc_built;
+  std::vector<char> jsc_blob;     /* the svrattrl blocks, each preceded by its size */
+  } job_status_cache;
+
 // for the server
 class job
   {
@@ -806,6 +827,7 @@ class job
   unsigned          ji_queue_counted;
   bool              ji_being_deleted;
   int               ji_commit_done;   /* req_commit has completed. If in routing queue job can now be routed */
+  std::vector<job_status_cache> ji_status_cache; /* encoded qstat output, see status_job() */
 
   /*
    * fixed size internal data - maintained via "quick save"
@@ -842,6 +864,12 @@ class job
 
   void encode_plugin_resource_usage(tlist_head *phead) const;
   void add_plugin_resource_usage(std::string &acct_data) const;
+
+  // must be called, with the job locked, whenever attributes change
+  void invalidate_status_cache()
+    {
+    this->ji_status_cache.clear();
+    }
   };
 #endif
 
@@ -1145,6 +1173,8 @@ class send_job_request
 /*
  * Related defines
  */
+/* a quick save only journals state, substate, svrflags, stime, mtime and
+ * etime; set ji_modified first if any other attribute changed */
 #define SAVEJOB_QUICK 0
 #define SAVEJOB_FULL  1
 #define SAVEJOB_NEW   2
@@ -1317,6 +1347,11 @@ void         delete_staged_in_files(job *pjob, char *home_dir, char **bad_list);
 #endif
 extern job  *job_recov(const char *);
 extern int   job_save(job *, int, int);
+#ifndef PBS_MOM
+int          replay_job_journal(const char *path);
+int          open_job_journal();
+void         compact_job_journal();
+#endif
 extern int   modify_job_attr(job *, svrattrl *, int, int *);
 extern const char *prefix_std_file(job *, std::string& , int);
 extern const char *add_std_filename(job *, char *, int, std::string&);
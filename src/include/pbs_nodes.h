@@ -221,6 +221,7 @@ class received_node
   std::string              hostname;
   std::vector<std::string> statuses;
   int                      hellos_sent;
+  time_t                   received_time; /* when statuses was last received */
   };
 
 
@@ -330,6 +331,7 @@ public:
   // CONST methods
   int         get_error() const;
   const char *get_name() const;
+  const std::vector<std::string> &get_properties() const;
   bool        hasprop(std::vector<prop> *props) const;
   void        write_compute_node_properties(FILE *nin) const;
   void        write_to_nodes_file(FILE *nin) const;
@@ -646,6 +648,13 @@ node_iterator   *get_node_iterator();
 
 struct prop     *init_prop(const char *pname);
 void             update_node_state(struct pbsnode *np, int newstate);
+void             update_free_node_index(struct pbsnode *pnode);
+void             remove_from_free_node_index(struct pbsnode *pnode);
+void             update_node_liveness(struct pbsnode *pnode);
+void             record_node_state(struct pbsnode *pnode);
+void             forget_node_state(const char *node_name);
+void             forget_received_status(const char *node_name);
+int              read_node_states(std::map<std::string, int> &states);
 int              is_job_on_node(struct pbsnode *np, int internal_job_id);
 void            *sync_node_jobs(void *vp);
 
@@ -204,3 +204,5 @@ ATTR_ghost_array_recovery,
 ATTR_cgroup_per_task,
 ATTR_idle_slot_limit,
 ATTR_default_gpu_mode,
+ATTR_accounting_format,
+ATTR_accounting_fsync,
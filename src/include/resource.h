@@ -150,6 +150,7 @@ extern int         svr_resc_size;
 
 extern resource     *add_resource_entry(pbs_attribute *, resource_def *);
 extern resource_def *find_resc_def(resource_def *, const char *, int);
+extern int           index_resc_defs(resource_def *, int, const resource_def *previous = NULL);
 extern resource     *find_resc_entry(pbs_attribute *, resource_def *);
 
 /* END resource.h */
@@ -229,6 +229,8 @@ enum srv_atr
   SRV_ATR_CgroupPerTask,
   SRV_ATR_IdleSlotLimit,
   SRV_ATR_DefaultGpuMode,
+  SRV_ATR_AcctFormat,
+  SRV_ATR_AcctFsync,
 
   /* This must be last */
   SRV_ATR_LAST
@@ -111,6 +111,8 @@
 
 #define PBS_NET_RETRY_TIME     30 /* retry time between re-sending requests  */
 #define PBS_NET_RETRY_LIMIT 14400 /* max retry time */
+#define PBS_MOM_POOL_MAX_PER_NODE 4 /* idle connections kept open per mom, 0 disables pooling */
+#define PBS_MOM_POOL_IDLE_TIME   60 /* close pooled mom connections idle this long (< PBS_NET_MAXCONNECTIDLE) */
 #define PBS_SCHEDULE_CYCLE    600 /* re-schedule even if no change, 10 min   */
 #define PBS_RESTAT_JOB        300 /* ask mom for status only if we haven't received one for 5 minutes */
 #define PBS_STAGEFAIL_WAIT   1800 /* retry time after stage in failure */
@@ -120,6 +122,8 @@
 #define PBS_JOBSTAT_MIN         4 /* minimum time between job stats */
 #define PBS_LOG_CHECK_RATE    300 /* check log size (and log age) every 5 min
                                      if log_file_max_size is set */
+#define PBS_JOURNAL_COMPACT_TIME 300 /* fold job journal deltas back into the job files every 5 min */
+#define PBS_MAX_RECOVERY_THREADS 32  /* threads used to read job and array files at startup */
 #define PBS_ACCT_CHECK_RATE   60*60  /* check accounting files every hour
 																		 if accounting_keep_days is set */
 #define PBS_LOCKFILE_UPDATE_TIME 3   /* how often TORQUE updates HA lock file */
@@ -146,6 +150,7 @@
 #define PBS_SERVERDB        "serverdb"
 #define PBS_SVRACL          "acl_svr"
 #define PBS_TRACKING        "tracking"
+#define PBS_JOB_JOURNAL     "job_journal"
 #define NODE_DESCRIP        "nodes"
 #define NODE_USAGE          "node_usage"
 #define NODE_STATUS         "node_status"
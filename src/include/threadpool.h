@@ -87,22 +87,76 @@
 
 
 #include <pthread.h>
+#include <time.h>
 
 
 #define POOL_DESTROY 0x1
 
+/* most work items freed by workers are kept for re-use instead of free()d */
+#define TP_MAX_FREE_WORK       256
+
+/* after this many items in a row from higher lanes, a waiting lower lane gets a turn */
+#define TP_LANE_STARVE_LIMIT   8
+
+
+/*
+ * priority lanes. Workers take work from the highest lane that has any,
+ * with TP_LANE_STARVE_LIMIT keeping the lower lanes moving. All of a pool's
+ * workers share its lanes, so there is no per-worker queue to steal from.
+ *
+ * A MOM's own IS_STATUS is read and processed by the request_pool worker
+ * that reads her connection, so that the reply carries the outcome. That
+ * connection is queued before its command is known and stays on the normal
+ * lane. The status work queued from it - the statuses a MOM forwards for
+ * other nodes and the job syncs - goes on the high lane.
+ */
+
+enum tp_lane
+  {
+  TP_LANE_HIGH,    /* node status and other MOM driven work */
+  TP_LANE_NORMAL,  /* client requests and anything not otherwise classified */
+  TP_LANE_LOW,     /* housekeeping: recyclers, mail */
+  TP_LANES
+  };
+
 
 
 typedef struct tp_work tp_work_t;
 struct tp_work
   {
-  tp_work_t *next;
-  void      *(*work_func)(void *); /* function to call */
-  void      *work_arg; /* argument */
+  tp_work_t       *next;
+  void            *(*work_func)(void *); /* function to call */
+  void            *work_arg; /* argument */
+  struct timespec  enqueued; /* for the wait time counters */
   };
 
 
 
+typedef struct tp_queue
+  {
+  tp_work_t *first;
+  tp_work_t *last;
+  int        depth;
+  } tp_queue_t;
+
+
+
+/* counters kept for each pool, read with get_threadpool_stats() */
+typedef struct tp_stats
+  {
+  int                 queued;             /* items waiting now */
+  int                 lane_queued[TP_LANES];
+  int                 max_queued;         /* high water mark of queued */
+  int                 nthreads;
+  int                 idle_threads;
+  unsigned long       enqueued;           /* totals since the pool was created */
+  unsigned long       completed;
+  unsigned long long  wait_usecs;         /* time completed items spent queued */
+  unsigned long long  run_usecs;          /* time spent running completed items */
+  } tp_stats_t;
+
+
+
 
 typedef struct tp_working tp_working_t;
 struct tp_working
@@ -121,8 +175,12 @@ struct threadpool
   pthread_cond_t   tp_waiting_work; /* what waiting threads pend on */
   pthread_cond_t   tp_can_destroy; /* thread pool is ready to be deleted */
   tp_working_t    *tp_active;  /* list of currently working threads */
-  tp_work_t       *tp_first; /* first in queue */
-  tp_work_t       *tp_last;  /* last in queue */
+  tp_queue_t       tp_lanes[TP_LANES]; /* queued work, by priority */
+  int              tp_queued; /* total queued across the lanes */
+  int              tp_higher_picks; /* items taken in a row while a lower lane waited */
+  tp_work_t       *tp_free; /* work items available for re-use */
+  int              tp_nfree;
+  tp_stats_t       tp_stats;
   pthread_attr_t   tp_attr; /* attributes for workers */
   int              tp_nthreads; /* number of threads */
   int              tp_min_threads; /* minimum number of threads */
@@ -141,6 +199,10 @@ extern threadpool_t *task_pool;
 extern threadpool_t *async_pool;
 
 int  enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *tp);
+int  enqueue_threadpool_request_lane(void *(*func)(void *), void *arg, threadpool_t *tp, enum tp_lane lane);
+tp_work_t *next_work_item(threadpool_t *tp);
+void get_threadpool_stats(threadpool_t *tp, tp_stats_t *stats);
+void log_threadpool_stats(threadpool_t *tp, const char *name);
 int  initialize_threadpool(threadpool_t **,int,int,int);
 void destroy_request_pool(threadpool_t *tp);
 void start_request_pool(threadpool_t *tp);
@@ -127,12 +127,22 @@ int task_is_in_threadpool(struct work_task *ptask);
 
 
 
+/*
+ * an entry in task_list_timed, a 4-ary min-heap ordered by task_time and
+ * then by seq so that tasks due at the same time run in the order they
+ * were set.
+ */
+
 typedef struct timed_task
   {
-  work_task *wt;
-  long       task_time;
+  work_task     *wt;
+  long           task_time;
+  unsigned long  seq;
   } timed_task;
 
+#define TIMED_TASK_HEAP_ARITY 4
+#define TIMED_TASK_BATCH      64
+
 class all_tasks
   {
 public:
@@ -165,6 +175,7 @@ typedef struct work_task
   void (*wt_parmfunc)  (struct work_task *);
   /* used in reissue_to_svr to store wt_func */
   int                  wt_aux; /* optional info: e.g. child status */
+  unsigned int         wt_heap_slot; /* 1 + index in task_list_timed, 0 if not there */
   } work_task;
 
 int        insert_task(all_tasks *, work_task *);
@@ -172,7 +183,9 @@ int        remove_task(all_tasks *,work_task *);
 int        has_task(all_tasks *);
 int        dispatch_timed_task(work_task *);
 work_task *pop_timed_task(time_t time_now);
-int        insert_timed_task(all_tasks *, time_t task_time, work_task *);
+int        pop_timed_tasks(time_t time_now, std::vector<work_task *> &expired, unsigned int max_tasks);
+void       insert_timed_task(work_task *);
+bool       remove_timed_task(work_task *);
 
 
 struct batch_request;
@@ -644,6 +644,11 @@ resource_def *find_resc_def(
   int           limit) /* number of members in resource_def array */
 
   {
+  int index = find_indexed_def(rscdf, name, limit);
+
+  if (index != DEF_NOT_INDEXED)
+    return((index >= 0) ? rscdf + index : NULL);
+
   while (limit--)
     {
     if (!strcmp(rscdf->rs_name, name))
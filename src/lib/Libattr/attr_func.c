@@ -83,17 +83,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <algorithm>
+#include <vector>
 #include "pbs_ifl.h"
 #include "list_link.h"
 #include "attribute.h"
 #include "pbs_error.h"
 #include "pbs_helper.h"
+#include "resource.h"
 
 /*
  * This file contains general functions for manipulating attributes.
  * Included are:
  * clear_attr()
  * find_attr()
+ * index_attr_defs()
+ * find_indexed_def()
  * free_null()
  * attrlist_alloc()
  * attrlist_create()
@@ -164,11 +170,450 @@ static int str_nc_cmp(
 
 
 
+/*
+ * Definition arrays that are searched by name all the time (job, queue,
+ * server and node attributes, resources) get a perfect hash index when
+ * they are registered. The index uses hash and displace: a name's first
+ * hash picks a bucket, and the bucket's displacement, chosen when the index
+ * is built, sends every name in that bucket to its own slot. A lookup is
+ * two hashes and one string compare.
+ *
+ * Lookups don't lock, so there is no telling when one is done with an
+ * index. An index that is replaced is retired and kept until the process
+ * exits. Replacements only happen when extra_resc changes, so this is a
+ * handful at most; past MAX_RETIRED_DEF_INDEXES the array is no longer
+ * indexed and its lookups go back to scanning.
+ */
+
+#define MAX_DEF_INDEXES         32
+#define MAX_RETIRED_DEF_INDEXES 64
+#define DEF_INDEX_BUCKET_KEYS   4
+#define MAX_DEF_DISPLACEMENT    65536
+
+typedef struct def_index
+  {
+  const void    *di_defs;
+  int            di_limit;
+  bool           di_nocase;
+  unsigned int   di_buckets;
+  unsigned int   di_mask;       /* the number of slots - 1 */
+  unsigned int  *di_displace;   /* one per bucket */
+  int           *di_slots;      /* definition index or -1 */
+  const char   **di_names;      /* by definition index */
+  } def_index;
+
+static def_index       *def_indexes[MAX_DEF_INDEXES];
+static int              def_index_count = 0;
+static def_index       *retired_def_indexes[MAX_RETIRED_DEF_INDEXES];
+static int              retired_def_index_count = 0;
+static pthread_mutex_t  def_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+static void def_name_hashes(
+
+  const char   *name,
+  bool          nocase,
+  unsigned int *h1,
+  unsigned int *h2)
+
+  {
+  unsigned int a = 2166136261U;
+  unsigned int b = 0x9747b28cU;
+
+  for (; *name != '\0'; name++)
+    {
+    unsigned int c = (unsigned char)*name;
+
+    if (nocase)
+      c = tolower(c);
+
+    a = (a ^ c) * 16777619U;
+    b = (b ^ c) * 0x5bd1e995U;
+    b ^= b >> 15;
+    }
+
+  *h1 = a;
+  *h2 = b;
+  } /* END def_name_hashes() */
+
+
+
+static inline unsigned int def_index_slot(
+
+  unsigned int h2,
+  unsigned int displacement,
+  unsigned int mask)
+
+  {
+  unsigned int h = h2 + displacement * 0x9e3779b9U;
+
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+
+  return(h & mask);
+  } /* END def_index_slot() */
+
+
+
+static void free_def_index(
+
+  def_index *di)
+
+  {
+  free(di->di_displace);
+  free(di->di_slots);
+  free(di->di_names);
+  free(di);
+  } /* END free_def_index() */
+
+
+
+static bool bucket_is_larger(
+
+  const std::vector<int> &a,
+  const std::vector<int> &b)
+
+  {
+  return(a.size() > b.size());
+  } /* END bucket_is_larger() */
+
+
+
+/*
+ * build_def_index - build the perfect hash for names[0 .. limit - 1]
+ *
+ * NULL names are skipped, and only the first of any duplicate names is
+ * indexed, so lookups give the same answer as a scan from the start.
+ *
+ * @return the index, or NULL if no displacements could be found
+ */
+
+static def_index *build_def_index(
+
+  const void  *defs,
+  const char **names,
+  int          limit,
+  bool         nocase)
+
+  {
+  std::vector<int>               keys;
+  std::vector<unsigned int>      h1;
+  std::vector<unsigned int>      h2;
+  unsigned int                   slots = 8;
+  unsigned int                   buckets;
+
+  for (int i = 0; i < limit; i++)
+    {
+    bool duplicate = false;
+
+    if ((names[i] == NULL) ||
+        (names[i][0] == '\0'))
+      continue;
+
+    for (unsigned int k = 0; k < keys.size(); k++)
+      {
+      const char *other = names[keys[k]];
+
+      if ((nocase == true) ? (strcasecmp(other, names[i]) == 0) : (strcmp(other, names[i]) == 0))
+        {
+        duplicate = true;
+        break;
+        }
+      }
+
+    if (duplicate == false)
+      {
+      unsigned int a;
+      unsigned int b;
+
+      def_name_hashes(names[i], nocase, &a, &b);
+      keys.push_back(i);
+      h1.push_back(a);
+      h2.push_back(b);
+      }
+    }
+
+  while (slots < keys.size() * 2)
+    slots <<= 1;
+
+  buckets = keys.size() / DEF_INDEX_BUCKET_KEYS + 1;
+
+  /* if some bucket can't be placed, retry with a sparser table */
+  for (int attempt = 0; attempt < 4; attempt++, slots <<= 1)
+    {
+    std::vector<std::vector<int> > by_bucket(buckets);
+    def_index                     *di = (def_index *)calloc(1, sizeof(def_index));
+    bool                           placed = true;
+
+    if (di == NULL)
+      return(NULL);
+
+    di->di_defs = defs;
+    di->di_limit = limit;
+    di->di_nocase = nocase;
+    di->di_buckets = buckets;
+    di->di_mask = slots - 1;
+    di->di_displace = (unsigned int *)calloc(buckets, sizeof(unsigned int));
+    di->di_slots = (int *)malloc(slots * sizeof(int));
+    di->di_names = (const char **)calloc(limit, sizeof(char *));
+
+    if ((di->di_displace == NULL) ||
+        (di->di_slots == NULL) ||
+        (di->di_names == NULL))
+      {
+      free_def_index(di);
+      return(NULL);
+      }
+
+    memcpy(di->di_names, names, limit * sizeof(char *));
+    for (unsigned int i = 0; i < slots; i++)
+      di->di_slots[i] = -1;
+
+    for (unsigned int k = 0; k < keys.size(); k++)
+      by_bucket[h1[k] % buckets].push_back(k);
+
+    /* the fullest buckets are hardest to place, so they go first */
+    std::stable_sort(by_bucket.begin(), by_bucket.end(), bucket_is_larger);
+
+    for (unsigned int b = 0; (b < buckets) && (placed == true); b++)
+      {
+      std::vector<int> &bucket = by_bucket[b];
+      unsigned int      d;
+
+      if (bucket.empty())
+        break;
+
+      for (d = 0; d < MAX_DEF_DISPLACEMENT; d++)
+        {
+        std::vector<unsigned int> taken;
+        bool                      fits = true;
+
+        for (unsigned int j = 0; j < bucket.size(); j++)
+          {
+          unsigned int slot = def_index_slot(h2[bucket[j]], d, di->di_mask);
+
+          if ((di->di_slots[slot] != -1) ||
+              (std::find(taken.begin(), taken.end(), slot) != taken.end()))
+            {
+            fits = false;
+            break;
+            }
+
+          taken.push_back(slot);
+          }
+
+        if (fits == true)
+          {
+          for (unsigned int j = 0; j < bucket.size(); j++)
+            di->di_slots[taken[j]] = keys[bucket[j]];
+
+          di->di_displace[h1[bucket[0]] % buckets] = d;
+          break;
+          }
+        }
+
+      if (d == MAX_DEF_DISPLACEMENT)
+        placed = false;
+      }
+
+    if (placed == true)
+      return(di);
+
+    free_def_index(di);
+    }
+
+  return(NULL);
+  } /* END build_def_index() */
+
+
+
+/*
+ * register_def_index - build and publish an index for a definition array
+ *
+ * An index already registered for defs, or for replaces when the array has
+ * been reallocated, is replaced in its slot and the old one is retired.
+ * When no more can be retired the old index is only unhooked from its array
+ * (it stays allocated in its slot) and defs isn't indexed.
+ *
+ * @return PBSE_NONE, or -1 if the index couldn't be built or there's no room
+ */
+
+static int register_def_index(
+
+  const void  *defs,
+  const char **names,
+  int          limit,
+  bool         nocase,
+  const void  *replaces)
+
+  {
+  def_index *di;
+  int        rc = -1;
+  int        i;
+
+  if ((defs == NULL) ||
+      (limit <= 0))
+    return(-1);
+
+  if ((di = build_def_index(defs, names, limit, nocase)) == NULL)
+    return(-1);
+
+  pthread_mutex_lock(&def_index_mutex);
+
+  for (i = 0; i < def_index_count; i++)
+    {
+    if ((def_indexes[i]->di_defs == defs) ||
+        ((replaces != NULL) &&
+         (def_indexes[i]->di_defs == replaces)))
+      break;
+    }
+
+  if (i < MAX_DEF_INDEXES)
+    {
+    /* the index must be complete before readers can see it */
+    __sync_synchronize();
+
+    if (i == def_index_count)
+      {
+      def_indexes[i] = di;
+      def_index_count++;
+      rc = PBSE_NONE;
+      }
+    else if (retired_def_index_count < MAX_RETIRED_DEF_INDEXES)
+      {
+      retired_def_indexes[retired_def_index_count++] = def_indexes[i];
+      def_indexes[i] = di;
+      rc = PBSE_NONE;
+      }
+    else
+      {
+      /* the old array may be freed and its address reused, nothing may find its index */
+      __atomic_store_n(&def_indexes[i]->di_defs, (const void *)NULL, __ATOMIC_RELEASE);
+      }
+    }
+
+  pthread_mutex_unlock(&def_index_mutex);
+
+  if (rc != PBSE_NONE)
+    free_def_index(di);
+
+  return(rc);
+  } /* END register_def_index() */
+
+
+
+/*
+ * index_attr_defs - build the name index used by find_attr() for attr_def
+ *
+ * Only lookups passing the same limit use the index.
+ */
+
+int index_attr_defs(
+
+  attribute_def *attr_def, /* I */
+  int            limit)    /* I */
+
+  {
+  std::vector<const char *> names;
+
+  for (int i = 0; i < limit; i++)
+    names.push_back(attr_def[i].at_name);
+
+  return(register_def_index(attr_def, &names[0], limit, true, NULL));
+  } /* END index_attr_defs() */
+
+
+
+/*
+ * index_resc_defs - build the name index used by find_resc_def() for rscdf
+ *
+ * When rscdf was reallocated from previous (e.g. extra_resc changed), the
+ * index for previous is replaced instead of taking another slot.
+ */
+
+int index_resc_defs(
+
+  resource_def       *rscdf,    /* I */
+  int                 limit,    /* I */
+  const resource_def *previous) /* I (optional) */
+
+  {
+  std::vector<const char *> names;
+
+  for (int i = 0; i < limit; i++)
+    names.push_back(rscdf[i].rs_name);
+
+  return(register_def_index(rscdf, &names[0], limit, false, previous));
+  } /* END index_resc_defs() */
+
+
+
+/*
+ * find_indexed_def - look name up in the index registered for defs
+ *
+ * @return the definition's index, -1 if it isn't there, or
+ *         DEF_NOT_INDEXED if defs has no index for this limit
+ */
+
+int find_indexed_def(
+
+  const void *defs,  /* I */
+  const char *name,  /* I */
+  int         limit) /* I */
+
+  {
+  def_index    *di = NULL;
+  int           count = def_index_count;
+  unsigned int  h1;
+  unsigned int  h2;
+  int           index;
+
+  if (name == NULL)
+    return(DEF_NOT_INDEXED);
+
+  for (int i = 0; i < count; i++)
+    {
+    if ((def_indexes[i]->di_defs == defs) &&
+        (def_indexes[i]->di_limit == limit))
+      {
+      di = def_indexes[i];
+      break;
+      }
+    }
+
+  if (di == NULL)
+    return(DEF_NOT_INDEXED);
+
+  def_name_hashes(name, di->di_nocase, &h1, &h2);
+
+  index = di->di_slots[def_index_slot(h2, di->di_displace[h1 % di->di_buckets], di->di_mask)];
+
+  if (index < 0)
+    return(-1);
+
+  if (di->di_nocase == true)
+    {
+    if (str_nc_cmp(di->di_names[index], name) != 0)
+      return(-1);
+    }
+  else if (strcmp(di->di_names[index], name) != 0)
+    return(-1);
+
+  return(index);
+  } /* END find_indexed_def() */
+
+
+
 /*
  * find_attr - find pbs_attribute definition by name
  *
  * Searches array of pbs_attribute definition strutures to find one
- * whose name matches the requested name.
+ * whose name matches the requested name. Arrays registered with
+ * index_attr_defs() are searched through their index.
  *
  * Returns: >= 0 index into definition struture array
  *     -1 if didn't find matching name
@@ -185,6 +630,9 @@ int find_attr(
 
   if (attr_def != NULL)
     {
+    if ((index = find_indexed_def(attr_def, name, limit)) != DEF_NOT_INDEXED)
+      return(index);
+
     for (index = 0;index < limit;index++)
       {
       if (!str_nc_cmp(attr_def->at_name, name))
@@ -88,6 +88,9 @@
  * log_close()
  * log_roll()
  * log_size()
+ * log_async_start()
+ * log_async_stop()
+ * log_set_roll_limits()
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -112,6 +115,9 @@
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
+#include <sched.h>
+
+#include <string>
 
 #include "log.h"
 #if SYSLOG
@@ -147,6 +153,42 @@ static int      syslogopen = 0;
 
 pthread_mutex_t log_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 
+/* asynchronous log writer, see log_async_start() */
+#define LOG_WRITE_BATCH_SIZE 65536 /* bytes handed to a single write */
+#define LOG_WRITER_IDLE_WAIT 1     /* seconds the writer sleeps with nothing to write */
+
+typedef struct log_slot
+  {
+  unsigned long  sequence;
+  std::string   *record;
+  } log_slot;
+
+typedef struct log_time_cache
+  {
+  time_t second;
+  int    yday;
+  char   stamp[80]; /* room for six full width ints, though a real date needs 20 */
+  } log_time_cache;
+
+static log_slot        *log_queue = NULL;
+static unsigned long    log_queue_mask;
+static unsigned long    log_queue_head;   /* next position a producer claims */
+static unsigned long    log_queue_tail;   /* next position written, moved under log_mutex */
+static int              log_full_policy = LOG_FULL_BLOCK;
+static volatile int     log_async_running = 0;
+static unsigned long    log_records_dropped = 0;
+static long             log_roll_max_size = 0;
+static int              log_roll_depth = 1;
+static time_t           log_roll_checked = 0;
+static int              log_writer_sleeping = 0;
+static pthread_t        log_writer_thread;
+static pthread_mutex_t  log_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   log_writer_cond = PTHREAD_COND_INITIALIZER;
+
+static __thread int             on_log_writer = FALSE;
+static __thread pid_t           log_thread_id = -1;
+static __thread log_time_cache  log_time = { -1, 0, "" };
+
 /* variables for job logging */
 static int      job_log_auto_switch = 0;
 static int      joblog_open_day;
@@ -749,164 +791,163 @@ bool log_available(int eventtype)
 
 
 /*
- * log_record - log a message to the log file
- * The log file must have been opened by log_open().
+ * log_cached_timestamp()
  *
- * NOTE:  do not use in pbs_mom spawned children - does not write to syslog!!!
+ * Formats tv as mm/dd/yyyy hh:mm:ss. The text is cached per thread, so localtime_r()
+ * only runs once a second instead of once a record.
  *
- * The caller should ensure proper formating of the message if "text"
- * is to contain "continuation lines".
+ * @param tv - the time to format
+ * @param yday - O (optional) the day of the year of tv
  */
 
-void log_record(
+static const char *log_cached_timestamp(
 
-  int         eventtype,  /* I */
-  int         objclass,   /* I */
-  const char *objname,    /* I */
-  const char *text)       /* I */
+  const struct timeval *tv,
+  int                  *yday)
 
   {
-  int tryagain = 2;
-  time_t now;
-  pid_t  thr_id = -1;
-
-  struct tm *ptm;
-  struct tm  tmpPtm;
-  struct timeval mytime;
-  int    rc = 0;
-  FILE  *savlog;
-  char  *start = NULL, *end = NULL;
-  size_t nchars;
-  int eventclass = 0;
-  char time_formatted_str[64];
-
-  thr_id = syscall(SYS_gettid);
-  pthread_mutex_lock(&log_mutex);
-
-#if SYSLOG
-  if (eventtype & PBSEVENT_SYSLOG)
+  if (tv->tv_sec != log_time.second)
     {
-    if (syslogopen == 0)
-      {
-      openlog(msg_daemonname, LOG_NOWAIT, LOG_DAEMON);
+    struct tm  tm_now;
+    time_t     now = tv->tv_sec;
 
-      syslogopen = 1;
-      }
+    localtime_r(&now, &tm_now);
 
-    syslog(LOG_ERR | LOG_DAEMON,"%s",text);
-    }
-#endif /* SYSLOG */
+    snprintf(log_time.stamp, sizeof(log_time.stamp), "%02d/%02d/%04d %02d:%02d:%02d",
+      tm_now.tm_mon + 1,
+      tm_now.tm_mday,
+      tm_now.tm_year + 1900,
+      tm_now.tm_hour,
+      tm_now.tm_min,
+      tm_now.tm_sec);
 
-  if (log_opened < 1)
-    {
-    pthread_mutex_unlock(&log_mutex);
-    return;
+    log_time.yday = tm_now.tm_yday;
+    log_time.second = tv->tv_sec;
     }
 
-  now = time((time_t *)0); /* get time for message */
+  if (yday != NULL)
+    *yday = log_time.yday;
 
-  ptm = localtime_r(&now,&tmpPtm);
+  return(log_time.stamp);
+  } /* END log_cached_timestamp() */
 
-  /* mytime used to calculate milliseconds */
 
-  gettimeofday(&mytime, NULL);
 
-  int milliseconds = mytime.tv_usec/1000;
+/*
+ * log_format_record()
+ *
+ * Appends the log lines for one record to out. Each line of text becomes its own
+ * log line, and the sequence "\r\n" is mapped to a single newline.
+ */
 
-  /* Do we need to switch the log? */
+static void log_format_record(
 
-  if (log_auto_switch && (ptm->tm_yday != log_open_day))
-    {
-    log_close(1);
+  std::string          &out,
+  int                   eventtype,
+  int                   objclass,
+  const char           *objname,
+  const char           *text,
+  const struct timeval *tv)
 
-    log_open(NULL, log_directory);
+  {
+  char        prefix[256];
+  const char *start = text;
+  const char *end;
+  int         eventclass = 0;
 
-    if (log_opened < 1)
-      {
-      pthread_mutex_unlock(&log_mutex);
-      return;
-      }
-    }
+  if (log_thread_id == -1)
+    log_thread_id = syscall(SYS_gettid);
 
-  time_formatted_str[0] = 0;
   log_get_set_eventclass(&eventclass, GETV);
+
   if (eventclass == PBS_EVENTCLASS_TRQAUTHD)
     {
-    log_format_trq_timestamp(time_formatted_str, sizeof(time_formatted_str));
+    log_format_trq_timestamp(prefix, sizeof(prefix) - 1);
+    strcat(prefix, " ");
+    }
+  else
+    {
+    snprintf(prefix, sizeof(prefix), "%s.%03d;%02d;%10.10s.%d;%s;",
+      log_cached_timestamp(tv, NULL),
+      (int)(tv->tv_usec / 1000),
+      (eventtype & ~PBSEVENT_FORCE),
+      msg_daemonname,
+      log_thread_id,
+      class_names[objclass]);
     }
-
-  /*
-   * Looking for the newline characters and splitting the output message
-   * on them.  Sequence "\r\n" is mapped to the single newline.
-   */
-  start = (char *)text;
 
   while (1)
     {
     for (end = start; *end != '\n' && *end != '\r' && *end != '\0'; end++)
       ;
 
-    nchars = end - start;
+    out += prefix;
 
-    if (*end == '\r' && *(end + 1) == '\n')
-      end++;
-
-    while (tryagain)
+    if (eventclass != PBS_EVENTCLASS_TRQAUTHD)
       {
-      if (eventclass != PBS_EVENTCLASS_TRQAUTHD)
-        {
-        rc = fprintf(logfile,
-              "%02d/%02d/%04d %02d:%02d:%02d.%03d;%02d;%10.10s.%d;%s;%s;%s%.*s\n",
-              ptm->tm_mon + 1,
-              ptm->tm_mday,
-              ptm->tm_year + 1900,
-              ptm->tm_hour,
-              ptm->tm_min,
-              ptm->tm_sec,
-			        milliseconds,
-              (eventtype & ~PBSEVENT_FORCE),
-              msg_daemonname,
-              thr_id,
-              class_names[objclass],
-              objname,
-              (text == start ? "" : "[continued]"),
-              (int)nchars,
-              start);
-        }
-      else
-        {
-        rc = fprintf(logfile,
-              "%s %s%.*s\n",
-              time_formatted_str,
-              (text == start ? "" : "[continued]"),
-              (int)nchars,
-              start);
-        }
-      if ((rc < 0) &&
-          (errno == EPIPE) &&
-          (tryagain == 2))
-        {
-        /* the log file descriptor has been changed--it now points to a socket!
-         * reopen log and leave the previous file descriptor alone--do not close it */
-
-        log_opened = 0;
-        log_open(NULL, log_directory);
-        tryagain--;
-        }
-      else
-        {
-        tryagain = 0;
-        }
+      out += (objname != NULL) ? objname : "(null)";
+      out += ';';
       }
 
-    if (rc < 0)
-      break;
+    if (start != text)
+      out += "[continued]";
+
+    out.append(start, end - start);
+    out += '\n';
+
+    if (*end == '\r' && *(end + 1) == '\n')
+      end++;
 
     if (*end == '\0')
       break;
 
     start = end + 1;
-    }  /* END while (1) */
+    }
+  } /* END log_format_record() */
+
+
+
+/*
+ * log_write_locked()
+ *
+ * Writes formatted log lines to the log file. log_mutex must be held.
+ */
+
+static void log_write_locked(
+
+  const std::string &out)
+
+  {
+  int     tryagain = 2;
+  int     rc = 0;
+  FILE   *savlog;
+
+  while (tryagain)
+    {
+    if (fwrite(out.c_str(), 1, out.size(), logfile) < out.size())
+      rc = -1;
+
+    if ((rc < 0) &&
+        (errno == EPIPE) &&
+        (tryagain == 2))
+      {
+      /* the log file descriptor has been changed--it now points to a socket!
+       * reopen log and leave the previous file descriptor alone--do not close it */
+
+      log_opened = 0;
+      log_open(NULL, log_directory);
+
+      if (log_opened < 1)
+        return;
+
+      rc = 0;
+      tryagain--;
+      }
+    else
+      {
+      tryagain = 0;
+      }
+    }
 
   fflush(logfile);
 
@@ -928,6 +969,579 @@ void log_record(
 
     logfile = savlog;
     }
+  } /* END log_write_locked() */
+
+
+
+/*
+ * log_enqueue()
+ *
+ * Adds a record to the log queue without taking any lock. Each slot carries a
+ * sequence number: a producer claims a position by advancing log_queue_head, fills
+ * the slot and then publishes it by moving the slot's sequence past the position.
+ *
+ * @return true if the record was queued, false if the queue is full
+ */
+
+static bool log_enqueue(
+
+  std::string *record)
+
+  {
+  unsigned long pos = __atomic_load_n(&log_queue_head, __ATOMIC_RELAXED);
+
+  while (1)
+    {
+    log_slot      *slot = log_queue + (pos & log_queue_mask);
+    unsigned long  seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    long           diff = (long)seq - (long)pos;
+
+    if (diff == 0)
+      {
+      if (__atomic_compare_exchange_n(&log_queue_head, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+        slot->record = record;
+        __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+
+        return(true);
+        }
+      }
+    else if (diff < 0)
+      return(false);
+    else
+      pos = __atomic_load_n(&log_queue_head, __ATOMIC_RELAXED);
+    }
+  } /* END log_enqueue() */
+
+
+
+/*
+ * log_dequeue()
+ *
+ * Removes the oldest published record from the log queue. log_mutex must be held;
+ * whoever holds it is the queue's only consumer.
+ *
+ * @return the record or NULL if there is nothing to write
+ */
+
+static std::string *log_dequeue(void)
+
+  {
+  unsigned long  tail = __atomic_load_n(&log_queue_tail, __ATOMIC_RELAXED);
+  log_slot      *slot = log_queue + (tail & log_queue_mask);
+  std::string   *record;
+
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != tail + 1)
+    return(NULL);
+
+  record = slot->record;
+  slot->record = NULL;
+
+  __atomic_store_n(&slot->sequence, tail + log_queue_mask + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&log_queue_tail, tail + 1, __ATOMIC_RELAXED);
+
+  return(record);
+  } /* END log_dequeue() */
+
+
+
+static bool log_queue_empty(void)
+
+  {
+  unsigned long tail = __atomic_load_n(&log_queue_tail, __ATOMIC_RELAXED);
+
+  return(__atomic_load_n(&log_queue[tail & log_queue_mask].sequence, __ATOMIC_ACQUIRE) != tail + 1);
+  } /* END log_queue_empty() */
+
+
+
+/*
+ * log_drain_queue()
+ *
+ * Writes every queued record to the log file, LOG_WRITE_BATCH_SIZE bytes at a time,
+ * switching to a new daily log first if the day has changed.
+ *
+ * @return the number of records written
+ */
+
+static int log_drain_queue(void)
+
+  {
+  std::string    batch;
+  std::string   *record;
+  unsigned long  dropped;
+  struct timeval tv;
+  int            yday;
+  int            count = 0;
+
+  if (log_queue == NULL)
+    return(0);
+
+  pthread_mutex_lock(&log_mutex);
+
+  gettimeofday(&tv, NULL);
+
+  if ((log_auto_switch) &&
+      (log_opened > 0))
+    {
+    log_cached_timestamp(&tv, &yday);
+
+    if (yday != log_open_day)
+      {
+      log_close(1);
+
+      log_open(NULL, log_directory);
+      }
+    }
+
+  while ((record = log_dequeue()) != NULL)
+    {
+    batch += *record;
+    delete record;
+    count++;
+
+    if (batch.size() >= LOG_WRITE_BATCH_SIZE)
+      {
+      if (log_opened > 0)
+        log_write_locked(batch);
+
+      batch.clear();
+      }
+    }
+
+  if ((dropped = __atomic_exchange_n(&log_records_dropped, 0, __ATOMIC_RELAXED)) != 0)
+    {
+    char buf[128];
+
+    snprintf(buf, sizeof(buf), "%lu log records were dropped because the log queue was full",
+      dropped);
+
+    log_format_record(batch, PBSEVENT_ERROR | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+      msg_daemonname, buf, &tv);
+    }
+
+  if ((batch.size() > 0) &&
+      (log_opened > 0))
+    log_write_locked(batch);
+
+  pthread_mutex_unlock(&log_mutex);
+
+  return(count);
+  } /* END log_drain_queue() */
+
+
+
+static void log_wake_writer(void)
+
+  {
+  /* pairs with the store to log_writer_sleeping in log_writer_wait() */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&log_writer_sleeping, __ATOMIC_SEQ_CST))
+    {
+    pthread_mutex_lock(&log_writer_mutex);
+    pthread_cond_signal(&log_writer_cond);
+    pthread_mutex_unlock(&log_writer_mutex);
+    }
+  } /* END log_wake_writer() */
+
+
+
+static void log_writer_wait(void)
+
+  {
+  struct timespec ts;
+
+  pthread_mutex_lock(&log_writer_mutex);
+
+  __atomic_store_n(&log_writer_sleeping, 1, __ATOMIC_SEQ_CST);
+
+  if ((log_async_running) &&
+      (log_queue_empty()))
+    {
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += LOG_WRITER_IDLE_WAIT;
+
+    pthread_cond_timedwait(&log_writer_cond, &log_writer_mutex, &ts);
+    }
+
+  __atomic_store_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST);
+
+  pthread_mutex_unlock(&log_writer_mutex);
+  } /* END log_writer_wait() */
+
+
+
+/*
+ * log_queue_record()
+ *
+ * Hands a formatted record to the writer thread. When the queue is full the record
+ * is dropped or, with LOG_FULL_BLOCK, the caller drains the queue itself if
+ * log_mutex is free (or already its own) and waits for the writer otherwise.
+ */
+
+static void log_queue_record(
+
+  std::string *record)
+
+  {
+  while (log_enqueue(record) == false)
+    {
+    if (log_full_policy == LOG_FULL_DROP)
+      {
+      __atomic_add_fetch(&log_records_dropped, 1, __ATOMIC_RELAXED);
+      delete record;
+      log_wake_writer();
+
+      return;
+      }
+
+    if (pthread_mutex_trylock(&log_mutex) == 0)
+      {
+      log_drain_queue();
+      pthread_mutex_unlock(&log_mutex);
+      }
+    else
+      {
+      log_wake_writer();
+      sched_yield();
+      }
+    }
+
+  log_wake_writer();
+  } /* END log_queue_record() */
+
+
+
+/*
+ * log_check_roll()
+ *
+ * Rolls the log once it reaches the size set by log_set_roll_limits(). Checks
+ * at most once a second.
+ */
+
+static void log_check_roll(void)
+
+  {
+  long   max_size = __atomic_load_n(&log_roll_max_size, __ATOMIC_RELAXED);
+  time_t now = time(NULL);
+
+  if ((max_size <= 0) ||
+      (log_opened < 1) ||
+      (now == log_roll_checked))
+    return;
+
+  log_roll_checked = now;
+
+  if (log_size() >= max_size)
+    {
+    log_record(
+      PBSEVENT_SYSTEM | PBSEVENT_FORCE,
+      PBS_EVENTCLASS_SERVER,
+      msg_daemonname,
+      "Rolling log file");
+
+    log_roll(__atomic_load_n(&log_roll_depth, __ATOMIC_RELAXED));
+    }
+  } /* END log_check_roll() */
+
+
+
+static void *log_writer(
+
+  void *vp)
+
+  {
+  on_log_writer = TRUE;
+
+  while (log_async_running)
+    {
+    if (log_drain_queue() == 0)
+      log_writer_wait();
+
+    log_check_roll();
+    }
+
+  return(NULL);
+  } /* END log_writer() */
+
+
+
+static void log_atfork_prepare(void)
+
+  {
+  pthread_mutex_lock(&log_mutex);
+  }
+
+
+
+static void log_atfork_parent(void)
+
+  {
+  pthread_mutex_unlock(&log_mutex);
+  }
+
+
+
+/*
+ * log_atfork_child - the writer thread doesn't exist in a forked child, so the
+ * child logs synchronously. Records still queued belong to the parent.
+ */
+
+static void log_atfork_child(void)
+
+  {
+  log_async_running = 0;
+  log_queue = NULL;
+  log_thread_id = -1;
+
+  pthread_mutex_unlock(&log_mutex);
+  }
+
+
+
+/*
+ * log_async_start()
+ *
+ * Starts the writer thread. From then on log_record() formats each record in the
+ * calling thread and queues it, and the writer thread does the file I/O, daily
+ * log switching and size based rolling.
+ *
+ * @param queue_size - number of records that can be queued, rounded up to a power of 2
+ * @param full_policy - LOG_FULL_BLOCK or LOG_FULL_DROP, what to do when the queue is full
+ * @return PBSE_NONE on success
+ */
+
+int log_async_start(
+
+  int queue_size,
+  int full_policy)
+
+  {
+  static bool   atfork_registered = false;
+  unsigned long slots = 2;
+
+  if (log_async_running)
+    return(PBSE_NONE);
+
+  if (queue_size < 1)
+    return(PBSE_IVALREQ);
+
+  /* the queue outlives log_async_stop() so late records are never written to freed memory */
+  if (log_queue == NULL)
+    {
+    while (slots < (unsigned long)queue_size)
+      slots <<= 1;
+
+    if ((log_queue = (log_slot *)calloc(slots, sizeof(log_slot))) == NULL)
+      return(PBSE_MEM_MALLOC);
+
+    for (unsigned long i = 0; i < slots; i++)
+      log_queue[i].sequence = i;
+
+    log_queue_mask = slots - 1;
+    log_queue_head = 0;
+    log_queue_tail = 0;
+    }
+
+  log_full_policy = full_policy;
+
+  if (atfork_registered == false)
+    {
+    pthread_atfork(log_atfork_prepare, log_atfork_parent, log_atfork_child);
+    atfork_registered = true;
+    }
+
+  log_async_running = 1;
+
+  if (pthread_create(&log_writer_thread, NULL, log_writer, NULL) != 0)
+    {
+    log_async_running = 0;
+
+    return(PBSE_SYSTEM);
+    }
+
+  return(PBSE_NONE);
+  } /* END log_async_start() */
+
+
+
+/*
+ * log_async_init()
+ *
+ * Starts the writer thread as configured by the environment:
+ *   PBSLOGQUEUESIZE  - records that can be queued, 0 logs synchronously
+ *   PBSLOGFULLPOLICY - "drop" to drop records when the queue is full instead of waiting
+ */
+
+int log_async_init(void)
+
+  {
+  int   queue_size = LOG_QUEUE_SIZE_DEFAULT;
+  int   full_policy = LOG_FULL_BLOCK;
+  char *ptr;
+
+  if ((ptr = getenv("PBSLOGQUEUESIZE")) != NULL)
+    queue_size = (int)strtol(ptr, NULL, 10);
+
+  if (((ptr = getenv("PBSLOGFULLPOLICY")) != NULL) &&
+      (!strcasecmp(ptr, "drop")))
+    full_policy = LOG_FULL_DROP;
+
+  if (queue_size <= 0)
+    return(PBSE_NONE);
+
+  return(log_async_start(queue_size, full_policy));
+  } /* END log_async_init() */
+
+
+
+/*
+ * log_async_stop()
+ *
+ * Stops the writer thread and writes whatever is still queued. log_record()
+ * is synchronous again afterwards.
+ */
+
+void log_async_stop(void)
+
+  {
+  if (!log_async_running)
+    return;
+
+  log_async_running = 0;
+
+  pthread_mutex_lock(&log_writer_mutex);
+  pthread_cond_signal(&log_writer_cond);
+  pthread_mutex_unlock(&log_writer_mutex);
+
+  pthread_join(log_writer_thread, NULL);
+
+  log_drain_queue();
+  } /* END log_async_stop() */
+
+
+
+/*
+ * log_set_roll_limits()
+ *
+ * Sets the size, in kilobytes, at which the log is rolled and how many old logs
+ * are kept. The writer thread checks the size as it writes; without one the
+ * check happens here.
+ *
+ * @param max_size - size in kilobytes, 0 to never roll
+ * @param roll_depth - number of rolled logs to keep
+ */
+
+void log_set_roll_limits(
+
+  long max_size,
+  int  roll_depth)
+
+  {
+  __atomic_store_n(&log_roll_depth, roll_depth, __ATOMIC_RELAXED);
+  __atomic_store_n(&log_roll_max_size, max_size, __ATOMIC_RELAXED);
+
+  if (!log_async_running)
+    {
+    log_roll_checked = 0;
+    log_check_roll();
+    }
+  } /* END log_set_roll_limits() */
+
+
+
+/*
+ * log_record - log a message to the log file
+ * The log file must have been opened by log_open().
+ *
+ * Once log_async_start() has run, the record is formatted here and queued for
+ * the writer thread; otherwise it is written before returning.
+ *
+ * NOTE:  do not use in pbs_mom spawned children - does not write to syslog!!!
+ *
+ * The caller should ensure proper formating of the message if "text"
+ * is to contain "continuation lines".
+ */
+
+void log_record(
+
+  int         eventtype,  /* I */
+  int         objclass,   /* I */
+  const char *objname,    /* I */
+  const char *text)       /* I */
+
+  {
+  struct timeval  mytime;
+  int             yday;
+  std::string     out;
+
+#if SYSLOG
+  if (eventtype & PBSEVENT_SYSLOG)
+    {
+    pthread_mutex_lock(&log_mutex);
+
+    if (syslogopen == 0)
+      {
+      openlog(msg_daemonname, LOG_NOWAIT, LOG_DAEMON);
+
+      syslogopen = 1;
+      }
+
+    syslog(LOG_ERR | LOG_DAEMON,"%s",text);
+
+    pthread_mutex_unlock(&log_mutex);
+    }
+#endif /* SYSLOG */
+
+  if ((log_async_running) &&
+      (!on_log_writer))
+    {
+    if (log_opened < 1)
+      return;
+
+    std::string *record = new std::string();
+
+    gettimeofday(&mytime, NULL);
+
+    log_format_record(*record, eventtype, objclass, objname, text, &mytime);
+
+    log_queue_record(record);
+
+    return;
+    }
+
+  pthread_mutex_lock(&log_mutex);
+
+  if (log_opened < 1)
+    {
+    pthread_mutex_unlock(&log_mutex);
+    return;
+    }
+
+  gettimeofday(&mytime, NULL);
+
+  log_cached_timestamp(&mytime, &yday);
+
+  /* Do we need to switch the log? */
+
+  if (log_auto_switch && (yday != log_open_day))
+    {
+    log_close(1);
+
+    log_open(NULL, log_directory);
+
+    if (log_opened < 1)
+      {
+      pthread_mutex_unlock(&log_mutex);
+      return;
+      }
+    }
+
+  log_format_record(out, eventtype, objclass, objname, text, &mytime);
+
+  log_write_locked(out);
 
   pthread_mutex_unlock(&log_mutex);
 
@@ -967,6 +1581,9 @@ void log_close(
       pthread_mutex_lock(&log_mutex);
       }
 
+    /* queued records, including the close message, belong in this file */
+    log_drain_queue();
+
     fclose(logfile);
 
     log_opened = 0;
@@ -30,6 +30,14 @@ long log_size(void);
 
 long job_log_size(void);
 
+int log_async_start(int queue_size, int full_policy);
+
+int log_async_init(void);
+
+void log_async_stop(void);
+
+void log_set_roll_limits(long max_size, int roll_depth);
+
 void print_trace(int socknum);
 
 void log_get_set_eventclass(int *objclass, SGetter action);
@@ -109,8 +109,12 @@
 #include <arpa/inet.h>
 #endif
 #include <pthread.h>
-
-
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+#include <vector>
+#include <queue>
+#include <functional>
 
 #include "portability.h"
 #include "server_limits.h"
@@ -158,6 +162,18 @@ static u_long   *GlobalSocketAddrSet = NULL;
 static u_long   *GlobalSocketPortSet = NULL;
 pthread_mutex_t *global_sock_read_mutex = NULL;
 
+#ifdef HAVE_SYS_EPOLL_H
+/* epoll instance mirroring GlobalSocketReadSet, -1 means use select() */
+static int                 GlobalEpollFD = -1;
+static struct epoll_event *GlobalEpollEvents = NULL;
+#endif
+
+/* min-heap of (deadline, socket) used to expire idle client connections */
+typedef std::pair<time_t, int> idle_deadline;
+static std::priority_queue<idle_deadline, std::vector<idle_deadline>, std::greater<idle_deadline> > idle_timers;
+static bool            *idle_timer_armed = NULL;
+static pthread_mutex_t *idle_timer_mutex = NULL;
+
 void *(*read_func[2])(void *);
 
 pthread_mutex_t *nc_list_mutex  = NULL;
@@ -166,6 +182,24 @@ pbs_net_t        pbs_server_addr;
 
 /* Private function within this file */
 
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * epoll_atfork_child - forked children (prologs, job starts, ...) share the
+ * parent's epoll instance, so they must never deregister sockets from it
+ * when they net_close().  Detach the child and let it use select().
+ */
+
+static void epoll_atfork_child(void)
+
+  {
+  if (GlobalEpollFD >= 0)
+    {
+    close(GlobalEpollFD);
+    GlobalEpollFD = -1;
+    }
+  } /* END epoll_atfork_child() */
+#endif
+
 void *accept_conn(void *);
 
 
@@ -344,6 +378,29 @@ int init_network(
 
     num_connections_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
     pthread_mutex_init(num_connections_mutex,&t_attr);
+
+    idle_timer_armed = (bool *)calloc(PBS_NET_MAX_CONNECTIONS, sizeof(bool));
+    idle_timer_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+    pthread_mutex_init(idle_timer_mutex, NULL);
+
+#ifdef HAVE_SYS_EPOLL_H
+    /* fall back to select() if epoll isn't available at run time */
+    if ((GlobalEpollFD = epoll_create1(EPOLL_CLOEXEC)) >= 0)
+      {
+      GlobalEpollEvents = (struct epoll_event *)calloc(PBS_NET_MAX_CONNECTIONS, sizeof(struct epoll_event));
+
+      if (GlobalEpollEvents == NULL)
+        {
+        close(GlobalEpollFD);
+        GlobalEpollFD = -1;
+        }
+      }
+
+    if (GlobalEpollFD < 0)
+      log_err(errno, __func__, "epoll unavailable, falling back to select()");
+    else
+      pthread_atfork(NULL, NULL, epoll_atfork_child);
+#endif
     
     type = Primary;
     }
@@ -646,36 +703,148 @@ int check_network_port(
 
 
 /*
- * wait_request - wait for a request (socket with data to read)
- * This routine does a select on the readset of sockets,
- * when data is ready, the processing routine associated with
- * the socket is invoked.
+ * arm_idle_timer - make sure sock has an entry in the idle deadline heap
+ *
+ * Only one entry per socket is kept in the heap.  The deadline recorded is
+ * never later than the real one since cn_lasttime only moves forward, so
+ * expire_idle_connections() re-checks the connection and re-arms it when
+ * it turns out to have been active in the meantime.
  */
 
-int wait_request(
+static void arm_idle_timer(
 
-  time_t  waittime,   /* I (seconds) */
-  long   *SState)     /* I (optional) */
+  int    sock,     /* I */
+  time_t deadline) /* I */
+
+  {
+  if ((idle_timer_mutex == NULL) ||
+      (sock < 0) ||
+      (sock >= PBS_NET_MAX_CONNECTIONS))
+    return;
+
+  pthread_mutex_lock(idle_timer_mutex);
+
+  if (idle_timer_armed[sock] == false)
+    {
+    idle_timer_armed[sock] = true;
+    idle_timers.push(idle_deadline(deadline, sock));
+    }
+
+  pthread_mutex_unlock(idle_timer_mutex);
+  } /* END arm_idle_timer() */
+
+
+
+/*
+ * expire_idle_connections - close client connections that have been idle
+ * for more than PBS_NET_MAXCONNECTIDLE seconds
+ *
+ * Only the sockets whose deadline has passed are visited, rather than the
+ * whole connection table.
+ */
+
+static void expire_idle_connections(
+
+  time_t now) /* I */
+
+  {
+  std::vector<int> due;
+  char             tmpLine[1024];
+
+  pthread_mutex_lock(idle_timer_mutex);
+
+  while ((idle_timers.empty() == false) &&
+         (idle_timers.top().first < now))
+    {
+    int sock = idle_timers.top().second;
+
+    idle_timers.pop();
+    idle_timer_armed[sock] = false;
+    due.push_back(sock);
+    }
+
+  pthread_mutex_unlock(idle_timer_mutex);
+
+  for (unsigned int j = 0; j < due.size(); j++)
+    {
+    int                i = due[j];
+    struct connection *cp;
+
+    pthread_mutex_lock(svr_conn[i].cn_mutex);
+
+    cp = &svr_conn[i];
+
+    if (cp->cn_active != FromClientDIS)
+      {
+      pthread_mutex_unlock(svr_conn[i].cn_mutex);
+
+      continue;
+      }
+
+    if ((now - cp->cn_lasttime) <= PBS_NET_MAXCONNECTIDLE)
+      {
+      arm_idle_timer(i, cp->cn_lasttime + PBS_NET_MAXCONNECTIDLE);
+      pthread_mutex_unlock(svr_conn[i].cn_mutex);
+  
+      continue;
+      }
+
+    if (cp->cn_authen & PBS_NET_CONN_NOTIMEOUT)
+      {
+      /* do not time-out this connection, but look at it again later */
+      arm_idle_timer(i, now + PBS_NET_MAXCONNECTIDLE);
+      pthread_mutex_unlock(svr_conn[i].cn_mutex);
+  
+      continue;
+      }
+
+    /* NOTE:  add info about node associated with connection - NYI */
+
+    {
+    char buf[80];
+
+    snprintf(tmpLine, sizeof(tmpLine), "connection %d to host %s has timed out after %d seconds - closing stale connection\n",
+      i,
+      netaddr_long(cp->cn_addr, buf),
+      PBS_NET_MAXCONNECTIDLE);
+    }
+    
+    log_err(-1, __func__, tmpLine);
+
+    /* locate node associated with interface, mark node as down until node responds */
+
+    /* NYI */
+
+    close_conn(i, TRUE);
+
+    pthread_mutex_unlock(svr_conn[i].cn_mutex);
+    }  /* END for (j) */
+
+  } /* END expire_idle_connections() */
+
+
+
+/*
+ * select_ready_sockets - the select() backend for wait_request()
+ *
+ * Places the ready sockets and their address/port into the ready vectors.
+ * Returns the number of ready sockets or -1 on a select() failure.
+ */
+
+static int select_ready_sockets(
+
+  time_t                waittime,   /* I */
+  std::vector<int>     &ready,      /* O */
+  std::vector<u_long>  &ready_addr, /* O */
+  std::vector<u_long>  &ready_port) /* O */
 
   {
   int             i;
   int             n;
-  time_t          now;
-
-  fd_set          *SelectSet = NULL;
+  fd_set         *SelectSet = NULL;
   int             SelectSetSize = 0;
   int             MaxNumDescriptors = 0;
-  int             SetSize = 0;
-  u_long   		  *SocketAddrSet = NULL;
-  u_long          *SocketPortSet = NULL;
-
-
-  char            tmpLine[1024];
   struct timeval  timeout;
-  long            OrigState = 0;
-
-  if (SState != NULL)
-    OrigState = *SState;
 
   timeout.tv_usec = 0;
   timeout.tv_sec  = waittime;
@@ -687,28 +856,16 @@ int wait_request(
     {
     return(-1);
     }
+
   pthread_mutex_lock(global_sock_read_mutex);
   
   memcpy(SelectSet,GlobalSocketReadSet,SelectSetSize);
 
+  pthread_mutex_unlock(global_sock_read_mutex);
+
   /* selset = readset;*/  /* readset is global */
   MaxNumDescriptors = get_max_num_descriptors();
-  SetSize = MaxNumDescriptors*sizeof(u_long);
-
-  SocketAddrSet = (u_long *)malloc(SetSize);
-  SocketPortSet = (u_long *)malloc(SetSize);
-  if((SocketAddrSet == NULL) || (SocketPortSet == NULL))
-    {
-    free(SelectSet);
-    if(SocketAddrSet != NULL) free(SocketAddrSet);
-    if(SocketPortSet != NULL) free(SocketPortSet);
-    pthread_mutex_unlock(global_sock_read_mutex);
-    return (-1);
-    }
-  memcpy(SocketAddrSet,GlobalSocketAddrSet,SetSize);
-  memcpy(SocketPortSet,GlobalSocketPortSet,SetSize);
 
-  pthread_mutex_unlock(global_sock_read_mutex);
   n = select(MaxNumDescriptors, SelectSet, (fd_set *)0, (fd_set *)0, &timeout);
 
   if (n == -1)
@@ -719,8 +876,6 @@ int wait_request(
       }
     else
       {
-      int i;
-
       struct stat fbuf;
 
       /* check all file descriptors to verify they are valid */
@@ -741,8 +896,6 @@ int wait_request(
         } /* END for each socket in global read set */
 
       free(SelectSet);
-      free(SocketAddrSet);
-      free(SocketPortSet);
 
       log_err(errno, __func__, "Unable to select sockets to read requests");
 
@@ -750,122 +903,176 @@ int wait_request(
       }  /* END else (errno == EINTR) */
     }    /* END if (n == -1) */
 
+  pthread_mutex_lock(global_sock_read_mutex);
+
   for (i = 0; (i < max_connection) && (n > 0); i++)
     {
     if (FD_ISSET(i, SelectSet))
       {
-      pthread_mutex_lock(svr_conn[i].cn_mutex);
-      /* this socket has data */
       n--;
 
-      svr_conn[i].cn_lasttime = time(NULL);
+      ready.push_back(i);
+      ready_addr.push_back(GlobalSocketAddrSet[i]);
+      ready_port.push_back(GlobalSocketPortSet[i]);
+      }
+    }
 
-      if (svr_conn[i].cn_active != Idle)
-        {
-        void *(*func)(void *) = svr_conn[i].cn_func;
+  pthread_mutex_unlock(global_sock_read_mutex);
 
-        netcounter_incr();
+  free(SelectSet);
 
-        pthread_mutex_unlock(svr_conn[i].cn_mutex);
+  return(ready.size());
+  } /* END select_ready_sockets() */
 
-        if (func != NULL)
-          {
-          int args[3];
 
-          args[0] = i;
-          args[1] = (int)SocketAddrSet[i];
-          args[2] = (int)SocketPortSet[i];
-          func((void *)args);
-          }
 
-        /* NOTE:  breakout if state changed (probably received shutdown request) */
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * epoll_ready_sockets - the epoll backend for wait_request()
+ *
+ * Sockets stay registered with GlobalEpollFD from globalset_add_sock() until
+ * globalset_del_sock(), so only the sockets that are ready are visited.
+ * Returns the number of ready sockets or -1 on an epoll_wait() failure.
+ */
 
-        if ((SState != NULL) && 
-            (OrigState != *SState))
-          break;
-        }
-      else
-        {
-        pthread_mutex_unlock(svr_conn[i].cn_mutex);
+static int epoll_ready_sockets(
 
-        globalset_del_sock(i);
-        close_conn(i, FALSE);
+  time_t                waittime,   /* I */
+  std::vector<int>     &ready,      /* O */
+  std::vector<u_long>  &ready_addr, /* O */
+  std::vector<u_long>  &ready_port) /* O */
 
-        pthread_mutex_lock(num_connections_mutex);
+  {
+  int n;
 
-        sprintf(tmpLine, "closed connections to fd %d - num_connections=%d (select bad socket)",
-          i,
-          num_connections);
+  n = epoll_wait(GlobalEpollFD, GlobalEpollEvents, max_connection, waittime * 1000);
 
-        pthread_mutex_unlock(num_connections_mutex);
-        log_err(-1, __func__, tmpLine);
-        }
-      }
-    } /* END for i */
+  if (n == -1)
+    {
+    if (errno == EINTR)
+      return(0); /* interrupted, cycle around */
 
-  free(SelectSet);
-  free(SocketAddrSet);
-  free(SocketPortSet);
+    log_err(errno, __func__, "Unable to wait on sockets to read requests");
 
-  /* NOTE:  break out if shutdown request received */
+    return(-1);
+    }
 
-  if ((SState != NULL) && (OrigState != *SState))
-    return(0);
+  pthread_mutex_lock(global_sock_read_mutex);
 
-  /* have any connections timed out ?? */
+  for (int i = 0; i < n; i++)
+    {
+    int sock = GlobalEpollEvents[i].data.fd;
 
-  now = time((time_t *)0);
+    ready.push_back(sock);
+    ready_addr.push_back(GlobalSocketAddrSet[sock]);
+    ready_port.push_back(GlobalSocketPortSet[sock]);
+    }
 
-  for (i = 0;i < max_connection;i++)
+  pthread_mutex_unlock(global_sock_read_mutex);
+
+  return(n);
+  } /* END epoll_ready_sockets() */
+#endif /* HAVE_SYS_EPOLL_H */
+
+
+
+/*
+ * wait_request - wait for a request (socket with data to read)
+ * This routine waits (epoll, or select as a fallback) on the readset of
+ * sockets, when data is ready, the processing routine associated with
+ * the socket is invoked.
+ */
+
+int wait_request(
+
+  time_t  waittime,   /* I (seconds) */
+  long   *SState)     /* I (optional) */
+
+  {
+  int                 n;
+  time_t              now;
+  char                tmpLine[1024];
+  long                OrigState = 0;
+  std::vector<int>    ready;
+  std::vector<u_long> ready_addr;
+  std::vector<u_long> ready_port;
+
+  if (SState != NULL)
+    OrigState = *SState;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (GlobalEpollFD >= 0)
+    n = epoll_ready_sockets(waittime, ready, ready_addr, ready_port);
+  else
+#endif
+    n = select_ready_sockets(waittime, ready, ready_addr, ready_port);
+
+  if (n == -1)
+    return(-1);
+
+  for (unsigned int j = 0; j < ready.size(); j++)
     {
-    struct connection *cp;
+    int i = ready[j];
 
     pthread_mutex_lock(svr_conn[i].cn_mutex);
+    /* this socket has data */
 
-    cp = &svr_conn[i];
+    svr_conn[i].cn_lasttime = time(NULL);
 
-    if (cp->cn_active != FromClientDIS)
+    if (svr_conn[i].cn_active != Idle)
       {
-      pthread_mutex_unlock(svr_conn[i].cn_mutex);
+      void *(*func)(void *) = svr_conn[i].cn_func;
 
-      continue;
-      }
+      arm_idle_timer(i, svr_conn[i].cn_lasttime + PBS_NET_MAXCONNECTIDLE);
+
+      netcounter_incr();
 
-    if ((now - cp->cn_lasttime) <= PBS_NET_MAXCONNECTIDLE)
-      {
       pthread_mutex_unlock(svr_conn[i].cn_mutex);
-  
-      continue;
-      }
 
-    if (cp->cn_authen & PBS_NET_CONN_NOTIMEOUT)
+      if (func != NULL)
+        {
+        int args[3];
+
+        args[0] = i;
+        args[1] = (int)ready_addr[j];
+        args[2] = (int)ready_port[j];
+        func((void *)args);
+        }
+
+      /* NOTE:  breakout if state changed (probably received shutdown request) */
+
+      if ((SState != NULL) && 
+          (OrigState != *SState))
+        break;
+      }
+    else
       {
       pthread_mutex_unlock(svr_conn[i].cn_mutex);
-  
-      continue; /* do not time-out this connection */
-      }
 
-    /* NOTE:  add info about node associated with connection - NYI */
+      globalset_del_sock(i);
+      close_conn(i, FALSE);
 
-    {
-    char buf[80];
+      pthread_mutex_lock(num_connections_mutex);
 
-    snprintf(tmpLine, sizeof(tmpLine), "connection %d to host %s has timed out after %d seconds - closing stale connection\n",
-      i,
-      netaddr_long(cp->cn_addr, buf),
-      PBS_NET_MAXCONNECTIDLE);
-    }
-    
-    log_err(-1, __func__, tmpLine);
+      sprintf(tmpLine, "closed connections to fd %d - num_connections=%d (select bad socket)",
+        i,
+        num_connections);
 
-    /* locate node associated with interface, mark node as down until node responds */
+      pthread_mutex_unlock(num_connections_mutex);
+      log_err(-1, __func__, tmpLine);
+      }
+    } /* END for j */
 
-    /* NYI */
+  /* NOTE:  break out if shutdown request received */
 
-    close_conn(i, TRUE);
+  if ((SState != NULL) && (OrigState != *SState))
+    return(0);
 
-    pthread_mutex_unlock(svr_conn[i].cn_mutex);
-    }  /* END for (i) */
+  /* have any connections timed out ?? */
+
+  now = time((time_t *)0);
+
+  expire_idle_connections(now);
 
   return(PBSE_NONE);
   }  /* END wait_request() */
@@ -965,6 +1172,22 @@ void globalset_add_sock(
   FD_SET(sock, GlobalSocketReadSet);
   GlobalSocketAddrSet[sock] = addr;
   GlobalSocketPortSet[sock] = port;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (GlobalEpollFD >= 0)
+    {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = sock;
+
+    if ((epoll_ctl(GlobalEpollFD, EPOLL_CTL_ADD, sock, &ev) != 0) &&
+        (errno == EEXIST))
+      epoll_ctl(GlobalEpollFD, EPOLL_CTL_MOD, sock, &ev);
+    }
+#endif
+
   pthread_mutex_unlock(global_sock_read_mutex);
   } /* END globalset_add_sock() */
 
@@ -980,6 +1203,13 @@ void globalset_del_sock(
   FD_CLR(sock, GlobalSocketReadSet);
   GlobalSocketAddrSet[sock] = 0;
   GlobalSocketPortSet[sock] = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+  /* the socket may already be closed, in which case the kernel dropped it */
+  if (GlobalEpollFD >= 0)
+    epoll_ctl(GlobalEpollFD, EPOLL_CTL_DEL, sock, NULL);
+#endif
+
   pthread_mutex_unlock(global_sock_read_mutex);
   } /* END globalset_del_sock() */
 
@@ -1043,6 +1273,8 @@ int add_connection(
   svr_conn[sock].cn_oncl     = 0;
   svr_conn[sock].cn_socktype = socktype;
 
+  arm_idle_timer(sock, svr_conn[sock].cn_lasttime + PBS_NET_MAXCONNECTIDLE);
+
 #ifndef NOPRIVPORTS
 
   if ((socktype == PBS_SOCK_INET) && (port < IPPORT_RESERVED))
@@ -1,19 +1,440 @@
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
 
 #include "authorized_hosts.hpp"
 #include "log.h"
 
+#define AUTH_TABLE_MIN_CAPACITY 64
 
+/* past this many retired tables or hostnames a writer waits for old readers to finish */
+#define AUTH_MAX_RETIRED_TABLES 8
+#define AUTH_MAX_RETIRED_NAMES  1024
 
-authorized_hosts::authorized_hosts() : auth_map()
+/* table keys: the address above the port + 1, or above AUTH_ANY_PORT for the
+ * entry that answers lookups by address alone */
+#define AUTH_ANY_PORT    0x20000ULL
+#define AUTH_KEY_EMPTY   0ULL
+#define AUTH_KEY_REMOVED (~0ULL)
+
+static unsigned long long auth_key(
+
+  unsigned long  addr,
+  unsigned long long port_part)
+
+  {
+  return(((unsigned long long)(addr & 0xFFFFFFFF) << 20) | port_part);
+  }
+
+static unsigned int auth_hash(
+
+  unsigned long long key)
+
+  {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+
+  return((unsigned int)key);
+  }
+
+
+
+authorized_hosts::authorized_hosts() : auth_map(), auth_current(NULL), auth_epoch(0),
+                                       auth_host_names()
 
   {
   pthread_mutex_init(&this->auth_mutex, NULL);
+  this->auth_readers[0] = 0;
+  this->auth_readers[1] = 0;
+  this->auth_current = new auth_table(AUTH_TABLE_MIN_CAPACITY);
   } // END constructor
 
 
 
+authorized_hosts::~authorized_hosts()
+
+  {
+  for (int epoch = 0; epoch < 2; epoch++)
+    {
+    for (unsigned int i = 0; i < this->auth_retired[epoch].size(); i++)
+      delete this->auth_retired[epoch][i];
+
+    for (unsigned int i = 0; i < this->auth_retired_names[epoch].size(); i++)
+      free(this->auth_retired_names[epoch][i]);
+    }
+
+  for (std::map<std::string, auth_name>::iterator it = this->auth_host_names.begin();
+       it != this->auth_host_names.end();
+       it++)
+    free(it->second.name);
+
+  delete this->auth_current;
+  pthread_mutex_destroy(&this->auth_mutex);
+  } // END destructor
+
+
+
+/*
+ * enter_read()
+ *
+ * Registers a reader in the current epoch. Nothing taken out of use after
+ * this is freed until leave_read() is called. If the epoch moves on while
+ * registering, the reader registers again in the new one so that reclaim()
+ * never waits on a count that keeps being joined.
+ *
+ * @return the epoch to pass to leave_read()
+ */
+
+unsigned int authorized_hosts::enter_read() const
+
+  {
+  for (;;)
+    {
+    unsigned int epoch = __atomic_load_n(&this->auth_epoch, __ATOMIC_SEQ_CST);
+
+    __atomic_add_fetch(&this->auth_readers[epoch], 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&this->auth_epoch, __ATOMIC_SEQ_CST) == epoch)
+      return(epoch);
+
+    __atomic_sub_fetch(&this->auth_readers[epoch], 1, __ATOMIC_SEQ_CST);
+    }
+  } // END enter_read()
+
+
+
+void authorized_hosts::leave_read(
+
+  unsigned int epoch) const
+
+  {
+  __atomic_sub_fetch(&this->auth_readers[epoch], 1, __ATOMIC_RELEASE);
+  } // END leave_read()
+
+
+
+/*
+ * find_host()
+ *
+ * Searches the published table without locking. A writer never changes a
+ * slot's key once set except to mark it removed, and tables and hostnames
+ * taken out of use aren't freed while a reader that could see them is
+ * registered, see reclaim().
+ *
+ * The hostname is copied out before leaving, so callers can take locks with
+ * it without holding up reclaim().
+ *
+ * @param key - the key to look for
+ * @param host - set to the hostname for key if not NULL
+ * @return true if key is in the table
+ */
+
+bool authorized_hosts::find_host(
+
+  unsigned long long  key,
+  std::string        *host) const
+
+  {
+  unsigned int        epoch = this->enter_read();
+  auth_table         *table = __atomic_load_n(&this->auth_current, __ATOMIC_ACQUIRE);
+  unsigned int        index = auth_hash(key) & table->mask;
+  unsigned long long  slot_key;
+  bool                found = false;
+
+  while ((slot_key = __atomic_load_n(&table->keys[index], __ATOMIC_ACQUIRE)) != AUTH_KEY_EMPTY)
+    {
+    if (slot_key == key)
+      {
+      if (host != NULL)
+        *host = __atomic_load_n(&table->hosts[index], __ATOMIC_ACQUIRE);
+
+      found = true;
+      break;
+      }
+
+    index = (index + 1) & table->mask;
+    }
+
+  this->leave_read(epoch);
+
+  return(found);
+  } // END find_host()
+
+
+
+/*
+ * hold_name()
+ *
+ * Interns host and counts one more live slot pointing at it. auth_mutex must
+ * be held.
+ *
+ * @return the interned copy of host
+ */
+
+const char *authorized_hosts::hold_name(
+
+  const std::string &host)
+
+  {
+  auth_name &interned = this->auth_host_names[host];
+
+  if (interned.name == NULL)
+    interned.name = strdup(host.c_str());
+
+  interned.refs++;
+
+  return(interned.name);
+  } // END hold_name()
+
+
+
+/*
+ * release_name()
+ *
+ * Counts one less live slot pointing at host. Once none do, the name is
+ * retired: readers that found it may still be copying it. auth_mutex must be
+ * held.
+ */
+
+void authorized_hosts::release_name(
+
+  const char *host)
+
+  {
+  std::map<std::string, auth_name>::iterator it = this->auth_host_names.find(host);
+
+  if ((it == this->auth_host_names.end()) ||
+      (--it->second.refs > 0))
+    return;
+
+  this->auth_retired_names[this->auth_epoch].push_back(it->second.name);
+  this->auth_host_names.erase(it);
+  } // END release_name()
+
+
+
+/*
+ * retire_table()
+ *
+ * Takes an unpublished table out of use. auth_mutex must be held.
+ */
+
+void authorized_hosts::retire_table(
+
+  auth_table *table)
+
+  {
+  this->auth_retired[this->auth_epoch].push_back(table);
+  } // END retire_table()
+
+
+
+/*
+ * reclaim()
+ *
+ * Frees what was retired before the last epoch change once every reader
+ * registered before that change has left, then starts a new epoch.
+ *
+ * Something retired during an epoch can only be held by readers registered
+ * in that epoch or an earlier one, since it was unpublished first. When the
+ * other epoch has no readers, everything retired while it was current is
+ * free to go and the epoch can flip to it.
+ *
+ * Normally this doesn't wait. If readers keep the retired lists above their
+ * caps it yields until they drain; read sections never block, so this is
+ * short. auth_mutex must be held.
+ */
+
+void authorized_hosts::reclaim()
+
+  {
+  for (;;)
+    {
+    unsigned int other = this->auth_epoch ^ 1;
+
+    // the unpublishing stores have to be visible before the reader count is read
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&this->auth_readers[other], __ATOMIC_SEQ_CST) == 0)
+      {
+      for (unsigned int i = 0; i < this->auth_retired[other].size(); i++)
+        delete this->auth_retired[other][i];
+
+      for (unsigned int i = 0; i < this->auth_retired_names[other].size(); i++)
+        free(this->auth_retired_names[other][i]);
+
+      this->auth_retired[other].clear();
+      this->auth_retired_names[other].clear();
+
+      __atomic_store_n(&this->auth_epoch, other, __ATOMIC_SEQ_CST);
+      }
+
+    if ((this->auth_retired[0].size() + this->auth_retired[1].size() <= AUTH_MAX_RETIRED_TABLES) &&
+        (this->auth_retired_names[0].size() + this->auth_retired_names[1].size() <= AUTH_MAX_RETIRED_NAMES))
+      break;
+
+    sched_yield();
+    }
+  } // END reclaim()
+
+
+
+/*
+ * publish_table()
+ *
+ * Copies the keys in use into a new table of capacity slots and makes it the
+ * one readers search. auth_mutex must be held.
+ */
+
+void authorized_hosts::publish_table(
+
+  unsigned int capacity)
+
+  {
+  auth_table *old_table = this->auth_current;
+  auth_table *new_table = new auth_table(capacity);
+
+  for (unsigned int i = 0; i <= old_table->mask; i++)
+    {
+    unsigned long long key = old_table->keys[i];
+    unsigned int       index;
+
+    if ((key == AUTH_KEY_EMPTY) ||
+        (key == AUTH_KEY_REMOVED))
+      continue;
+
+    index = auth_hash(key) & new_table->mask;
+
+    while (new_table->keys[index] != AUTH_KEY_EMPTY)
+      index = (index + 1) & new_table->mask;
+
+    new_table->keys[index] = key;
+    new_table->hosts[index] = old_table->hosts[i];
+    new_table->used++;
+    }
+
+  __atomic_store_n(&this->auth_current, new_table, __ATOMIC_RELEASE);
+  this->retire_table(old_table);
+  } // END publish_table()
+
+
+
+/*
+ * set_key()
+ *
+ * Adds key to the published table or changes its hostname. host must come
+ * from hold_name(); the slot keeps that hold and drops the one on any
+ * hostname it replaces. Removed slots aren't reused: a reader could match
+ * the old key and then read the new key's hostname. Instead the table is
+ * rebuilt once set and removed keys fill half of it. auth_mutex must be held.
+ */
+
+void authorized_hosts::set_key(
+
+  unsigned long long  key,
+  const char         *host)
+
+  {
+  auth_table   *table = this->auth_current;
+  unsigned int  index = auth_hash(key) & table->mask;
+
+  while (table->keys[index] != AUTH_KEY_EMPTY)
+    {
+    if (table->keys[index] == key)
+      {
+      const char *old_host = table->hosts[index];
+
+      __atomic_store_n(&table->hosts[index], host, __ATOMIC_RELEASE);
+      this->release_name(old_host);
+      return;
+      }
+
+    index = (index + 1) & table->mask;
+    }
+
+  if ((table->used + table->removed + 1) * 2 > table->mask + 1)
+    {
+    unsigned int capacity = AUTH_TABLE_MIN_CAPACITY;
+
+    while ((table->used + 1) * 4 > capacity)
+      capacity *= 2;
+
+    this->publish_table(capacity);
+
+    table = this->auth_current;
+    index = auth_hash(key) & table->mask;
+
+    while (table->keys[index] != AUTH_KEY_EMPTY)
+      index = (index + 1) & table->mask;
+    }
+
+  // the hostname must be visible before the key is
+  __atomic_store_n(&table->hosts[index], host, __ATOMIC_RELEASE);
+  __atomic_store_n(&table->keys[index], key, __ATOMIC_RELEASE);
+  table->used++;
+  } // END set_key()
+
+
+
+/*
+ * remove_key()
+ *
+ * Marks key removed in the published table. auth_mutex must be held.
+ */
+
+void authorized_hosts::remove_key(
+
+  unsigned long long key)
+
+  {
+  auth_table   *table = this->auth_current;
+  unsigned int  index = auth_hash(key) & table->mask;
+
+  while (table->keys[index] != AUTH_KEY_EMPTY)
+    {
+    if (table->keys[index] == key)
+      {
+      __atomic_store_n(&table->keys[index], AUTH_KEY_REMOVED, __ATOMIC_RELEASE);
+      table->used--;
+      table->removed++;
+      this->release_name(table->hosts[index]);
+      return;
+      }
+
+    index = (index + 1) & table->mask;
+    }
+  } // END remove_key()
+
+
+
+/*
+ * update_any_port()
+ *
+ * Points the address-only entry for addr at the host on its lowest port,
+ * the one auth_map lists first. auth_mutex must be held.
+ */
+
+void authorized_hosts::update_any_port(
+
+  unsigned long addr)
+
+  {
+  std::map<unsigned long, std::map<unsigned short, std::string> >::iterator it = this->auth_map.find(addr);
+
+  if ((it == this->auth_map.end()) ||
+      (it->second.size() == 0))
+    this->remove_key(auth_key(addr, AUTH_ANY_PORT));
+  else
+    {
+    this->set_key(auth_key(addr, AUTH_ANY_PORT), this->hold_name(it->second.begin()->second));
+    }
+  } // END update_any_port()
+
+
+
 /*
  * add_authorized_address()
  *
@@ -40,6 +461,11 @@ void authorized_hosts::add_authorized_address(
     }
   else
     this->auth_map[addr][port] = host;
+
+  this->set_key(auth_key(addr, port + 1), this->hold_name(host));
+  this->update_any_port(addr);
+  this->reclaim();
+
   pthread_mutex_unlock(&this->auth_mutex);
   } // END add_authorized_address()
 
@@ -54,8 +480,23 @@ void authorized_hosts::add_authorized_address(
 void authorized_hosts::clear()
 
   {
+  auth_table *old_table;
+
   pthread_mutex_lock(&this->auth_mutex);
   this->auth_map.clear();
+
+  old_table = this->auth_current;
+  __atomic_store_n(&this->auth_current, new auth_table(AUTH_TABLE_MIN_CAPACITY), __ATOMIC_RELEASE);
+
+  for (unsigned int i = 0; i <= old_table->mask; i++)
+    {
+    if ((old_table->keys[i] != AUTH_KEY_EMPTY) &&
+        (old_table->keys[i] != AUTH_KEY_REMOVED))
+      this->release_name(old_table->hosts[i]);
+    }
+
+  this->retire_table(old_table);
+  this->reclaim();
   pthread_mutex_unlock(&this->auth_mutex);
   }
 
@@ -73,14 +514,7 @@ bool authorized_hosts::is_authorized(
   unsigned long addr)
 
   {
-  bool legit = false;
-
-  pthread_mutex_lock(&this->auth_mutex);
-  if (this->auth_map.find(addr) != this->auth_map.end())
-    legit = true;
-  pthread_mutex_unlock(&this->auth_mutex);
-
-  return(legit);
+  return(this->find_host(auth_key(addr, AUTH_ANY_PORT), NULL));
   } // END is_authorized()
 
 
@@ -99,17 +533,7 @@ bool authorized_hosts::is_authorized(
   unsigned short port)
 
   {
-  bool legit = false;
-
-  pthread_mutex_lock(&this->auth_mutex);
-  if (this->auth_map.find(addr) != this->auth_map.end())
-    {
-    if (this->auth_map[addr].find(port) != this->auth_map[addr].end())
-      legit = true;
-    }
-  pthread_mutex_unlock(&this->auth_mutex);
-
-  return(legit);
+  return(this->find_host(auth_key(addr, port + 1), NULL));
   } // END is_authorized()
 
 
@@ -132,12 +556,8 @@ pbsnode *authorized_hosts::get_authorized_node(
   std::string  hostname;
   pbsnode     *pnode = NULL;
 
-  pthread_mutex_lock(&this->auth_mutex);
-  if (this->auth_map.find(addr) != this->auth_map.end())
-    hostname = this->auth_map[addr].begin()->second;
-  pthread_mutex_unlock(&this->auth_mutex);
-
-  if (hostname.size() != 0)
+  if ((this->find_host(auth_key(addr, AUTH_ANY_PORT), &hostname) == true) &&
+      (hostname.size() != 0))
     pnode = find_nodebyname(hostname.c_str());
 
   return(pnode);
@@ -165,15 +585,8 @@ pbsnode *authorized_hosts::get_authorized_node(
   std::string  hostname;
   pbsnode     *pnode = NULL;
 
-  pthread_mutex_lock(&this->auth_mutex);
-  if (this->auth_map.find(addr) != this->auth_map.end())
-    {
-    if (this->auth_map[addr].find(port) != this->auth_map[addr].end())
-      hostname = this->auth_map[addr][port];
-    }
-  pthread_mutex_unlock(&this->auth_mutex);
-
-  if (hostname.size() != 0)
+  if ((this->find_host(auth_key(addr, port + 1), &hostname) == true) &&
+      (hostname.size() != 0))
     pnode = find_nodebyname(hostname.c_str());
 
   return(pnode);
@@ -257,6 +670,10 @@ bool authorized_hosts::remove_address(
         {
         this->auth_map.erase(it);
         }
+
+      this->remove_key(auth_key(addr, port + 1));
+      this->update_any_port(addr);
+      this->reclaim();
       }
     }
   
@@ -265,3 +682,45 @@ bool authorized_hosts::remove_address(
   return(removed);
   } // END remove_address()
 
+
+
+/*
+ * get_host_name_count()
+ *
+ * @return the number of distinct hostnames the published table points at
+ */
+
+int authorized_hosts::get_host_name_count()
+
+  {
+  int count;
+
+  pthread_mutex_lock(&this->auth_mutex);
+  count = this->auth_host_names.size();
+  pthread_mutex_unlock(&this->auth_mutex);
+
+  return(count);
+  } // END get_host_name_count()
+
+
+
+/*
+ * get_retired_count()
+ *
+ * @return the number of retired tables and hostnames not yet freed
+ */
+
+int authorized_hosts::get_retired_count()
+
+  {
+  int count = 0;
+
+  pthread_mutex_lock(&this->auth_mutex);
+
+  for (int epoch = 0; epoch < 2; epoch++)
+    count += this->auth_retired[epoch].size() + this->auth_retired_names[epoch].size();
+
+  pthread_mutex_unlock(&this->auth_mutex);
+
+  return(count);
+  } // END get_retired_count()
@@ -49,7 +49,7 @@ struct group * getgrgid_ext(char **user_buf, gid_t grp_id );
 /* u_mom_hierarchy.c */
 mom_hierarchy_t *initialize_mom_hierarchy(void);
 
-int add_network_entry(mom_hierarchy_t *nt, char *name, struct addrinfo *ai, unsigned short rm_port, int path, int level);
+int add_network_entry(mom_hierarchy_t *nt, const char *name, struct addrinfo *ai, unsigned short rm_port, int path, int level);
 
 int rm_establish_connection(node_comm_t *nc);
 
@@ -61,6 +61,18 @@ int write_tcp_reply(struct tcp_chan *chan, int protocol, int version, int comman
 
 int read_tcp_reply(struct tcp_chan *chan, int protocol, int version, int command, int *exit_status);
 
+void get_status_delta(const std::vector<std::string> &base, const std::vector<std::string> &current, std::vector<unsigned int> &changed);
+
+int apply_status_delta(std::vector<std::string> &status, unsigned int count, const std::vector<unsigned int> &indexes, const std::vector<std::string> &values, std::vector<bool> &changed);
+
+int pack_status_batch(const std::vector<status_batch_entry> &entries, std::string &packed, unsigned int &raw_len);
+
+int unpack_status_batch(const char *packed, size_t packed_len, unsigned int raw_len, std::vector<status_batch_entry> &entries);
+
+int write_status_batch(struct tcp_chan *chan, const std::vector<status_batch_entry> &entries);
+
+int read_status_batch(struct tcp_chan *chan, std::vector<status_batch_entry> &entries);
+
 /* u_mu.c */
 int is_whitespace(char c);
  
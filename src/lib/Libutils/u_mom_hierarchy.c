@@ -87,6 +87,7 @@
 #include <netinet/in.h> /* sockaddr_in */
 #include <arpa/inet.h> /* inet_ntoa */
 #include <unistd.h>
+#include <zlib.h>
 
 #include "net_cache.h"
 #include "pbs_ifl.h"
@@ -544,6 +545,306 @@ int read_tcp_reply(
 
 
 
+
+/*
+ * get_status_delta()
+ *
+ * Compares a MOM status with the status the server last acknowledged.
+ * Status strings are compared by position: a MOM generates its status
+ * items in the same order every time, so between two updates usually only
+ * a few values (loadave, availmem, rectime...) differ.
+ *
+ * @param base - the status the server holds
+ * @param current - the status about to be sent
+ * @param changed - (O) the positions in current that the server must be sent
+ */
+
+void get_status_delta(
+
+  const std::vector<std::string> &base,
+  const std::vector<std::string> &current,
+  std::vector<unsigned int>      &changed)
+
+  {
+  changed.clear();
+
+  for (unsigned int i = 0; i < current.size(); i++)
+    {
+    if ((i >= base.size()) ||
+        (base[i] != current[i]))
+      changed.push_back(i);
+    }
+  } /* END get_status_delta() */
+
+
+
+/*
+ * apply_status_delta()
+ *
+ * Updates a stored MOM status in place with the values from a delta.
+ *
+ * @param status - (M) the stored status
+ * @param count - the number of strings in the new status
+ * @param indexes - the positions that changed
+ * @param values - the new strings for those positions
+ * @param changed - (O) true for each position of status that was updated
+ * @return PBSE_NONE or PBSE_PROTOCOL if the delta doesn't fit the status, in
+ * which case status must be thrown away
+ */
+
+int apply_status_delta(
+
+  std::vector<std::string>        &status,
+  unsigned int                     count,
+  const std::vector<unsigned int> &indexes,
+  const std::vector<std::string>  &values,
+  std::vector<bool>               &changed)
+
+  {
+  if (indexes.size() != values.size())
+    return(PBSE_PROTOCOL);
+
+  for (unsigned int i = 0; i < indexes.size(); i++)
+    {
+    if (indexes[i] >= count)
+      return(PBSE_PROTOCOL);
+    }
+
+  unsigned int old_count = status.size();
+
+  status.resize(count);
+  changed.assign(count, false);
+
+  for (unsigned int i = 0; i < indexes.size(); i++)
+    {
+    status[indexes[i]] = values[i];
+    changed[indexes[i]] = true;
+    }
+
+  // positions the old status didn't have must all be in the delta
+  for (unsigned int i = old_count; i < count; i++)
+    {
+    if (changed[i] == false)
+      return(PBSE_PROTOCOL);
+    }
+
+  return(PBSE_NONE);
+  } /* END apply_status_delta() */
+
+
+
+/*
+ * pack_status_batch()
+ *
+ * Packs the statuses a mom has cached from its children into one compressed
+ * buffer. Before compression each entry is its age in decimal followed by
+ * its status strings, each terminated by a NUL, and ends with an empty
+ * string.
+ *
+ * @param entries - the cached statuses
+ * @param packed - (O) the compressed batch
+ * @param raw_len - (O) the length of the batch before compression
+ * @return PBSE_NONE or PBSE_SYSTEM if the batch couldn't be compressed
+ */
+
+int pack_status_batch(
+
+  const std::vector<status_batch_entry> &entries,
+  std::string                           &packed,
+  unsigned int                          &raw_len)
+
+  {
+  std::string raw;
+  char        buf[MAXLINE];
+
+  for (unsigned int i = 0; i < entries.size(); i++)
+    {
+    snprintf(buf, sizeof(buf), "%lu", entries[i].age);
+    raw.append(buf);
+    raw.push_back('\0');
+
+    for (unsigned int j = 0; j < entries[i].statuses.size(); j++)
+      {
+      if (entries[i].statuses[j].size() == 0)
+        continue;
+
+      raw.append(entries[i].statuses[j]);
+      raw.push_back('\0');
+      }
+
+    raw.push_back('\0');
+    }
+
+  uLongf dest_len = compressBound(raw.size());
+
+  packed.resize(dest_len);
+
+  if (compress2((Bytef *)&packed[0], &dest_len, (const Bytef *)raw.data(), raw.size(), Z_BEST_SPEED) != Z_OK)
+    {
+    packed.clear();
+    return(PBSE_SYSTEM);
+    }
+
+  packed.resize(dest_len);
+  raw_len = raw.size();
+
+  return(PBSE_NONE);
+  } /* END pack_status_batch() */
+
+
+
+/*
+ * unpack_status_batch()
+ *
+ * Reverses pack_status_batch(). Entries that don't start with "node=" are
+ * dropped.
+ *
+ * @param entries - (O) the statuses in the batch
+ * @return PBSE_NONE or PBSE_PROTOCOL if the batch is corrupt
+ */
+
+int unpack_status_batch(
+
+  const char                      *packed,
+  size_t                           packed_len,
+  unsigned int                     raw_len,
+  std::vector<status_batch_entry> &entries)
+
+  {
+  std::string raw;
+  uLongf      dest_len = raw_len;
+
+  entries.clear();
+
+  if ((raw_len == 0) ||
+      (raw_len > STATUS_BATCH_MAX_LEN))
+    return(PBSE_PROTOCOL);
+
+  raw.resize(raw_len);
+
+  if ((uncompress((Bytef *)&raw[0], &dest_len, (const Bytef *)packed, packed_len) != Z_OK) ||
+      (dest_len != raw_len) ||
+      (raw[raw_len - 1] != '\0'))
+    return(PBSE_PROTOCOL);
+
+  const char *ptr = raw.c_str();
+  const char *end = ptr + raw_len;
+
+  while (ptr < end)
+    {
+    status_batch_entry entry;
+
+    entry.age = strtoul(ptr, NULL, 10);
+    ptr += strlen(ptr) + 1;
+
+    while ((ptr < end) &&
+           (*ptr != '\0'))
+      {
+      entry.statuses.push_back(ptr);
+      ptr += strlen(ptr) + 1;
+      }
+
+    if (ptr >= end)
+      {
+      /* the entry wasn't terminated */
+      entries.clear();
+      return(PBSE_PROTOCOL);
+      }
+
+    ptr++;
+
+    if ((entry.statuses.size() > 0) &&
+        (!strncmp(entry.statuses[0].c_str(), "node=", strlen("node="))))
+      entries.push_back(entry);
+    }
+
+  return(PBSE_NONE);
+  } /* END unpack_status_batch() */
+
+
+
+/*
+ * write_status_batch()
+ *
+ *   Format
+ *
+ *   entry count | (if count > 0) uncompressed length | compressed batch
+ */
+
+int write_status_batch(
+
+  struct tcp_chan                       *chan,
+  const std::vector<status_batch_entry> &entries)
+
+  {
+  std::string  packed;
+  unsigned int raw_len = 0;
+  int          ret;
+
+  if (entries.size() == 0)
+    return(diswui(chan, 0));
+
+  if (pack_status_batch(entries, packed, raw_len) != PBSE_NONE)
+    return(DIS_PROTO);
+
+  if ((ret = diswui(chan, entries.size())) == DIS_SUCCESS)
+    {
+    if ((ret = diswui(chan, raw_len)) == DIS_SUCCESS)
+      ret = diswcs(chan, packed.data(), packed.size());
+    }
+
+  return(ret);
+  } /* END write_status_batch() */
+
+
+
+/*
+ * read_status_batch()
+ *
+ * Reads a batch written by write_status_batch().
+ *
+ * @return DIS_SUCCESS, a DIS error, or DIS_PROTO if the batch is corrupt
+ */
+
+int read_status_batch(
+
+  struct tcp_chan                 *chan,
+  std::vector<status_batch_entry> &entries)
+
+  {
+  unsigned int  count;
+  unsigned int  raw_len;
+  size_t        packed_len = 0;
+  char         *packed;
+  int           rc;
+
+  entries.clear();
+
+  count = disrui(chan, &rc);
+
+  if ((rc != DIS_SUCCESS) ||
+      (count == 0))
+    return(rc);
+
+  raw_len = disrui(chan, &rc);
+
+  if (rc != DIS_SUCCESS)
+    return(rc);
+
+  if ((packed = disrcs(chan, &packed_len, &rc)) == NULL)
+    return((rc == DIS_SUCCESS) ? DIS_PROTO : rc);
+
+  if ((rc == DIS_SUCCESS) &&
+      (unpack_status_batch(packed, packed_len, raw_len, entries) != PBSE_NONE))
+    rc = DIS_PROTO;
+
+  free(packed);
+
+  return(rc);
+  } /* END read_status_batch() */
+
+
+
 int handle_level(
     
   char           *level_iter,
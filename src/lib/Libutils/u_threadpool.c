@@ -98,6 +98,109 @@ threadpool_t *async_pool;
 static void *work_thread(void *);
 
 
+
+static unsigned long long elapsed_usecs(
+
+  const struct timespec *start,
+  const struct timespec *end)
+
+  {
+  long long usecs = (end->tv_sec - start->tv_sec) * 1000000LL +
+                    (end->tv_nsec - start->tv_nsec) / 1000;
+
+  if (usecs < 0)
+    return(0);
+
+  return(usecs);
+  } /* END elapsed_usecs() */
+
+
+
+/*
+ * put_work_item()
+ *
+ * returns a work item to the pool's free list, or frees it if the list is full
+ * NOTE: tp's lock must be held
+ */
+
+static void put_work_item(
+
+  threadpool_t *tp,
+  tp_work_t    *work)
+
+  {
+  if (tp->tp_nfree < TP_MAX_FREE_WORK)
+    {
+    work->next = tp->tp_free;
+    tp->tp_free = work;
+    tp->tp_nfree++;
+    }
+  else
+    free(work);
+  } /* END put_work_item() */
+
+
+
+/*
+ * next_work_item()
+ *
+ * removes the next work item from the pool's lanes. This is the first item
+ * of the highest non-empty lane unless lower lanes have waited for more
+ * than TP_LANE_STARVE_LIMIT items in a row; then the lane with the oldest
+ * item goes.
+ * NOTE: tp's lock must be held
+ * @return the work item or NULL if nothing is queued
+ */
+
+tp_work_t *next_work_item(
+
+  threadpool_t *tp)
+
+  {
+  tp_queue_t *queue = NULL;
+  tp_work_t  *work;
+  int         lane;
+
+  for (lane = 0; lane < TP_LANES; lane++)
+    {
+    if (tp->tp_lanes[lane].depth > 0)
+      {
+      queue = tp->tp_lanes + lane;
+      break;
+      }
+    }
+
+  if (queue == NULL)
+    return(NULL);
+
+  if (tp->tp_queued == queue->depth)
+    tp->tp_higher_picks = 0;
+  else if (++tp->tp_higher_picks > TP_LANE_STARVE_LIMIT)
+    {
+    for (lane++; lane < TP_LANES; lane++)
+      {
+      tp_queue_t *lower = tp->tp_lanes + lane;
+
+      if ((lower->depth > 0) &&
+          (elapsed_usecs(&lower->first->enqueued, &queue->first->enqueued) > 0))
+        queue = lower;
+      }
+
+    tp->tp_higher_picks = 0;
+    }
+
+  work = queue->first;
+  queue->first = work->next;
+  if (queue->last == work)
+    queue->last = NULL;
+
+  queue->depth--;
+  tp->tp_queued--;
+
+  return(work);
+  } /* END next_work_item() */
+
+
 /*
  * create_work_thread()
  *
@@ -157,7 +260,7 @@ static void work_thread_cleanup(
     if (create_work_thread(tp) == 0)
       tp->tp_nthreads++;
     }
-  else if ((tp->tp_first != NULL) &&
+  else if ((tp->tp_queued > 0) &&
            (tp->tp_nthreads < tp->tp_min_threads) &&
            (create_work_thread(tp) == 0))
     {
@@ -229,6 +332,8 @@ static void *work_thread(
   tp_working_t      working;
 
   struct timespec   ts;
+  struct timespec   started;
+  struct timespec   finished;
 
   if (tp == NULL)
     {
@@ -262,7 +367,7 @@ static void *work_thread(
       }
 
 
-    while ((tp->tp_first == NULL) &&
+    while ((tp->tp_queued == 0) &&
            (!(tp->tp_flags & POOL_DESTROY)))
       {
       if ((tp->tp_nthreads <= tp->tp_min_threads) ||
@@ -298,27 +403,31 @@ static void *work_thread(
     if (tp->tp_flags & POOL_DESTROY)
       break;
 
-    if ((mywork = tp->tp_first) != NULL)
+    if ((mywork = next_work_item(tp)) != NULL)
       {
       func = mywork->work_func;
       arg  = mywork->work_arg;
 
-      tp->tp_first = mywork->next;
-      if (tp->tp_last == mywork)
-        tp->tp_last = NULL;
+      clock_gettime(CLOCK_MONOTONIC, &started);
+      tp->tp_stats.wait_usecs += elapsed_usecs(&mywork->enqueued, &started);
+      put_work_item(tp, mywork);
 
       working.next = tp->tp_active;
       tp->tp_active = &working;
 
       pthread_mutex_unlock(&tp->tp_mutex);
       pthread_cleanup_push(work_cleanup,tp);
-      free(mywork);
 
       /* do the work */
       func(arg);
 
+      clock_gettime(CLOCK_MONOTONIC, &finished);
+
       /* cleanup the work */
       pthread_cleanup_pop(1); /* calls work_cleanup(NULL) */
+
+      tp->tp_stats.completed++;
+      tp->tp_stats.run_usecs += elapsed_usecs(&started, &finished);
       }
     }
 
@@ -410,33 +519,66 @@ int initialize_threadpool(
 
 
 
-int enqueue_threadpool_request(
+/*
+ * enqueue_threadpool_request_lane()
+ *
+ * queues func(arg) to be run by tp at the priority of lane
+ * @return 0 or ENOMEM
+ */
+
+int enqueue_threadpool_request_lane(
 
   void         *(*func)(void *),
   void         *arg,
-  threadpool_t *tp)
+  threadpool_t *tp,
+  enum tp_lane  lane)
 
   {
-  tp_work_t *work = NULL;
-/*  char              log_buf[LOCAL_LOG_BUF_SIZE];*/
+  tp_work_t  *work = NULL;
+  tp_queue_t *queue;
+
+  if ((lane < 0) ||
+      (lane >= TP_LANES))
+    lane = TP_LANE_NORMAL;
+
+  queue = tp->tp_lanes + lane;
+
+  pthread_mutex_lock(&tp->tp_mutex);
 
-  if ((work = (tp_work_t *)calloc(1, sizeof(tp_work_t))) == NULL)
+  if ((work = tp->tp_free) != NULL)
     {
-    return(ENOMEM);
+    tp->tp_free = work->next;
+    tp->tp_nfree--;
+    }
+  else
+    {
+    pthread_mutex_unlock(&tp->tp_mutex);
+
+    if ((work = (tp_work_t *)calloc(1, sizeof(tp_work_t))) == NULL)
+      {
+      return(ENOMEM);
+      }
+
+    pthread_mutex_lock(&tp->tp_mutex);
     }
 
   work->next = NULL;
   work->work_func = func;
   work->work_arg  = arg;
+  clock_gettime(CLOCK_MONOTONIC, &work->enqueued);
 
-  pthread_mutex_lock(&tp->tp_mutex);
-
-  if (tp->tp_first == NULL)
-    tp->tp_first = work;
+  if (queue->first == NULL)
+    queue->first = work;
   else
-    tp->tp_last->next = work;
+    queue->last->next = work;
   
-  tp->tp_last = work;
+  queue->last = work;
+  queue->depth++;
+
+  tp->tp_queued++;
+  tp->tp_stats.enqueued++;
+  if (tp->tp_queued > tp->tp_stats.max_queued)
+    tp->tp_stats.max_queued = tp->tp_queued;
 
   if (tp->tp_idle_threads > 0)
     pthread_cond_signal(&tp->tp_waiting_work);
@@ -447,10 +589,94 @@ int enqueue_threadpool_request(
   pthread_mutex_unlock(&tp->tp_mutex);
 
   return(0);
+  } /* END enqueue_threadpool_request_lane() */
+
+
+
+int enqueue_threadpool_request(
+
+  void         *(*func)(void *),
+  void         *arg,
+  threadpool_t *tp)
+
+  {
+  return(enqueue_threadpool_request_lane(func, arg, tp, TP_LANE_NORMAL));
   } /* END enqueue_threadpool_request() */
 
 
 
+/*
+ * get_threadpool_stats()
+ *
+ * copies tp's queue and timing counters into stats
+ */
+
+void get_threadpool_stats(
+
+  threadpool_t *tp,    /* I */
+  tp_stats_t   *stats) /* O */
+
+  {
+  pthread_mutex_lock(&tp->tp_mutex);
+
+  *stats = tp->tp_stats;
+  stats->queued = tp->tp_queued;
+  for (int lane = 0; lane < TP_LANES; lane++)
+    stats->lane_queued[lane] = tp->tp_lanes[lane].depth;
+  stats->nthreads = tp->tp_nthreads;
+  stats->idle_threads = tp->tp_idle_threads;
+
+  pthread_mutex_unlock(&tp->tp_mutex);
+  } /* END get_threadpool_stats() */
+
+
+
+/*
+ * log_threadpool_stats()
+ *
+ * logs tp's counters under name. Wait and run times are averages over the
+ * items completed since the pool was created.
+ */
+
+void log_threadpool_stats(
+
+  threadpool_t *tp,
+  const char   *name)
+
+  {
+  tp_stats_t          stats;
+  char                log_buf[LOCAL_LOG_BUF_SIZE];
+  unsigned long long  avg_wait = 0;
+  unsigned long long  avg_run = 0;
+
+  get_threadpool_stats(tp, &stats);
+
+  if (stats.completed > 0)
+    {
+    avg_wait = stats.wait_usecs / stats.completed;
+    avg_run = stats.run_usecs / stats.completed;
+    }
+
+  snprintf(log_buf, sizeof(log_buf),
+    "%s: threads %d (%d idle), queued %d (high %d normal %d low %d, max %d), enqueued %lu, completed %lu, avg wait %llu us, avg run %llu us",
+    name,
+    stats.nthreads,
+    stats.idle_threads,
+    stats.queued,
+    stats.lane_queued[TP_LANE_HIGH],
+    stats.lane_queued[TP_LANE_NORMAL],
+    stats.lane_queued[TP_LANE_LOW],
+    stats.max_queued,
+    stats.enqueued,
+    stats.completed,
+    avg_wait,
+    avg_run);
+
+  log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+  } /* END log_threadpool_stats() */
+
+
+
 bool threadpool_is_too_busy(
 
   threadpool_t *tp,
@@ -518,11 +744,16 @@ void destroy_request_pool(
   pthread_mutex_unlock(&tp->tp_mutex);
 
   /* free pending work */
-  while ((work = tp->tp_first) != NULL)
+  while ((work = next_work_item(tp)) != NULL)
+    free(work);
+
+  while ((work = tp->tp_free) != NULL)
     {
-    tp->tp_first = work->next;
+    tp->tp_free = work->next;
     free(work);
     }
+
+  tp->tp_nfree = 0;
   } /* END destroy_request_pool() */
 
 
@@ -66,6 +66,7 @@
 #endif
 #include "mom_config.h"
 #include "timer.hpp"
+#include "proc_connector.h"
 
 #ifdef PENABLE_LINUX_CGROUPS
 #include "machine.hpp"
@@ -135,6 +136,8 @@ extern char    mom_alias[];
 proc_stat_t   *proc_array = NULL;
 static int            nproc = 0;
 static int            max_proc = 0;
+/* proc_array holds every process (not only job processes), see mom_get_node_sample() */
+static bool           proc_array_node_wide = false;
 
 extern pid2jobsid_map_t pid2jobsid_map; 
 
@@ -1209,11 +1212,9 @@ unsigned long cput_sum(
     job *pjob)
 
   {
-  ulong        cputime = 0; 
-  std::string  full_cgroup_path;
-  int          fd;
-  int          rc;
-  char         buf[LOCAL_BUF_SIZE];
+  ulong               cputime = 0; 
+  unsigned long long  nano_seconds;
+  char                buf[LOCAL_BUF_SIZE];
 
   pbs_attribute *pattr;
   pattr = &pjob->ji_wattr[JOB_ATR_req_information];
@@ -1258,44 +1259,22 @@ unsigned long cput_sum(
 
     /* This is not a -L request */
 
-    full_cgroup_path = cg_cpuacct_path + pjob->ji_qs.ji_jobid + "/cpuacct.usage";
-
-    fd = open(full_cgroup_path.c_str(), O_RDONLY);
-    if (fd <= 0)
+    if (trq_cg_get_job_cput_stats(pjob->ji_qs.ji_jobid, nano_seconds) != PBSE_NONE)
       {
       if (pjob->ji_cgroups_created == true)
         {
-        sprintf(buf, "failed to open %s: %s", full_cgroup_path.c_str(), strerror(errno));
+        snprintf(buf, sizeof(buf), "failed to read %s%s/cpuacct.usage: %s",
+          cg_cpuacct_path.c_str(), pjob->ji_qs.ji_jobid, strerror(errno));
         log_err(-1, __func__, buf);
         }
       return(0);
       }
 
-    rc = read(fd, buf, LOCAL_BUF_SIZE);
-    if (rc == -1)
-      {
-      sprintf(buf, "failed to read %s: %s", full_cgroup_path.c_str(), strerror(errno));
-      log_err(-1, __func__, buf);
-      close(fd);
-      return(0);
-      }
-    else if (rc != 0) /* if rc is 0 something is not right but it is not a critical error. Don't do anything */
-    {
-    ulong nano_seconds;
-    /* successful read. Should be a number in nano-seconds */
-
-    nano_seconds = atol(buf);
-    cputime += nano_seconds;
-    }
-
     /* convert the nano seconds to seconds */
-    cputime = cputime/NANO_SECONDS;
+    cputime = nano_seconds/NANO_SECONDS;
 
     pjob->ji_flags &= ~MOM_NO_PROC;
 
-    close(fd);
-    
-
   return(cputime);
   
   }
@@ -1556,10 +1535,8 @@ unsigned long long resi_sum(
 
   {
   unsigned long long resisize = 0;
-  std::string  full_cgroup_path;
-  char         buf[LOCAL_BUF_SIZE];
-  int          fd;
-  int          rc;
+  unsigned long long mem_read;
+  char               buf[LOCAL_BUF_SIZE];
 
   pbs_attribute *pattr;
   pattr = &pjob->ji_wattr[JOB_ATR_req_information];
@@ -1600,44 +1577,23 @@ unsigned long long resi_sum(
       }
     }
 
-  full_cgroup_path = cg_memory_path + pjob->ji_qs.ji_jobid + "/memory.max_usage_in_bytes";
-
-  fd = open(full_cgroup_path.c_str(), O_RDONLY);
-  if (fd <= 0)
+  if (trq_cg_get_job_memory_stats(pjob->ji_qs.ji_jobid, mem_read) != PBSE_NONE)
     {
     if (pjob->ji_cgroups_created == true)
       {
-      sprintf(buf, "failed to open %s: %s", full_cgroup_path.c_str(), strerror(errno));
+      snprintf(buf, sizeof(buf), "failed to read %s%s/memory.max_usage_in_bytes: %s",
+        cg_memory_path.c_str(), pjob->ji_qs.ji_jobid, strerror(errno));
       log_err(-1, __func__, buf);
       }
 
     return(0);
     }
 
-  rc = read(fd, buf, LOCAL_BUF_SIZE);
-  if (rc == -1)
-    {
-    sprintf(buf, "failed to read %s: %s", full_cgroup_path.c_str(), strerror(errno));
-    log_err(-1, __func__, buf);
-    close(fd);
-    return(0);
-    }
-  else if (rc != 0) 
-    {
-    int hardwareStyle;
-    unsigned long long mem_read;
-
-    mem_read = strtoull(buf, NULL, 10);
-
-    hardwareStyle = this_node.getHardwareStyle();
-
-    if (hardwareStyle == AMD) /* AMD adds everything up in the parent cgroup hierarchy and Intel does not */
-      resisize = mem_read;
-    else
-      resisize += mem_read;
-    }
-
-  close(fd);
+  /* AMD adds everything up in the parent cgroup hierarchy and Intel does not */
+  if (this_node.getHardwareStyle() == AMD)
+    resisize = mem_read;
+  else
+    resisize += mem_read;
 
   return(resisize);
   }
@@ -2316,6 +2272,9 @@ int mom_open_poll(void)
 
   max_proc = TBL_INC;
 
+  /* falls back to walking /proc if the kernel won't tell us about processes */
+  proc_connector_start();
+
   return(PBSE_NONE);
   }  /* END mom_open_poll() */
 
@@ -2367,39 +2326,84 @@ int get_job_sid_from_pid(pid_t pid)
 
 
 /*
- * Declare start of polling loop.
+ * sample_process()
  *
- * This function caches information about all of processes
- * on the compute node (pbs_mom calls this function). Each process
- * in /proc/ is queried by looking at the 'stat' file. Statistics like
- * CPU usage time, memory consumption, etc. are gathered in the proc_array
- * list. This list is then used throughout the pbs_mom to get information
- * about tasks it is monitoring.
+ * Reads /proc/<pid>/stat and appends it to proc_array, growing the array
+ * as needed.
  *
- * This function is called from the main MOM loop once every "check_poll_interval"
- * seconds.
- *
- * @see get_proc_stat() - child
- * @see mom_set_use() - Aggregates data collected here
- *
- * NOTE:  populates global 'proc_array[]' variable.
- * NOTE:  reallocs proc_array[] as needed to accomodate processes.
- * NOTE:  populates global 'pid2jobsid_map' map (pid to owning job session id mapping for all pids).
- * NOTE:  populates global 'pid2procarrayindex_map' map (pid to index in proc_array map).
+ * @return PBSE_NONE, or PBSE_SYSTEM if proc_array couldn't be grown
+ */
+
+static int sample_process(
+
+  pid_t pid)
+
+  {
+  proc_stat_t *ps;
+
+  if ((ps = get_proc_stat(pid)) == NULL)
+    {
+    if (errno != ENOENT)
+      {
+      sprintf(log_buffer, "%d: get_proc_stat", pid);
+
+      log_err(errno, __func__, log_buffer);
+      }
+
+    return(PBSE_NONE);
+    }
+
+  /* nproc++; -- we need to increment AFTER assigning this ps to
+     the proc_array--otherwise we could skip it in for loops */
+
+  if ((nproc + 1) >= max_proc)
+    {
+    proc_stat_t *hold;
+
+    if (LOGLEVEL >= 9)
+      {
+      log_record(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, __func__, "alloc more proc_array");
+      }
+
+    max_proc *= 2;
+
+    hold = (proc_stat_t *)calloc(1, max_proc * sizeof(proc_stat_t));
+
+    if (hold == NULL)
+      {
+      log_err(errno, __func__, "unable to realloc space for proc_array sample");
+
+      return(PBSE_SYSTEM);
+      }
+
+    memcpy(hold, proc_array, sizeof(proc_stat_t) * max_proc / 2);
+    free(proc_array);
+
+    proc_array = hold;
+    }  /* END if ((nproc+1) == max_proc) */
+
+  /* map pid to proc_array index */
+  pid2procarrayindex_map[pid] = nproc;
+
+  memcpy(&proc_array[nproc++], ps, sizeof(proc_stat_t));
+
+  return(PBSE_NONE);
+  }  /* END sample_process() */
+
+
+
+/*
+ * get_proc_sample()
  *
- * @see mom_open_poll() - allocs proc_array table.
- * @see mom_close_poll() - frees procs_array.
- * @see setup_program_environment() - parent - called at pbs_mom start
- * @see main_loop() - parent - called once per iteration
- * @see mom_set_use() - populate job structure with usage data for local use or to send to mother superior
+ * Loads proc_array with every process on the node (or every process in
+ * the Torque cpuset when cpusets are enabled).
  */
 
-int mom_get_sample(void)
+static int get_proc_sample(void)
 
   {
-  proc_stat_t           *pi;
-  proc_stat_t           *ps;
   pid_t                  pid;
+  int                    rc = PBSE_NONE;
 #ifdef PENABLE_LINUX26_CPUSETS
   struct pidl           *pids = NULL;
   struct pidl           *pp;
@@ -2407,22 +2411,6 @@ int mom_get_sample(void)
   struct dirent         *dent;
 #endif
 
-  if (proc_array == NULL)
-    mom_open_poll();
-
-  nproc = 0;
-
-  /* clear the maps */
-  pid2jobsid_map.clear();
-  pid2procarrayindex_map.clear();
-
-  pi = proc_array;
-
-  if (LOGLEVEL >= 6)
-    {
-    log_record(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, __func__, "proc_array load started");
-    }
-
 #ifdef PENABLE_LINUX26_CPUSETS
 
   /* Instead of collect stats of all processes running on a large SMP system,
@@ -2456,70 +2444,125 @@ int mom_get_sample(void)
 
     pid = atoi(dent->d_name);
 #endif
-    if ((ps = get_proc_stat(pid)) == NULL)
-      {
-      if (errno != ENOENT)
-        {
-        sprintf(log_buffer, "%d: get_proc_stat", pid);
+    if ((rc = sample_process(pid)) != PBSE_NONE)
+      break;
+    }  /* END while (...) != NULL) */
 
-        log_err(errno, __func__, log_buffer);
-        }
+#ifdef PENABLE_LINUX26_CPUSETS
+  free_pidlist(pids);
+#endif
+
+  return(rc);
+  }  /* END get_proc_sample() */
+
+
+
+#ifdef PENABLE_LINUX_CGROUPS
+/*
+ * get_cgroup_sample()
+ *
+ * Loads proc_array with only the processes in the cgroups of this node's
+ * jobs, which saves reading the stat file of every process on a large
+ * node. A running job whose cgroups weren't created by this mom (or can
+ * no longer be read) can only be found by walking /proc, as can anything
+ * at all when there are no jobs. The rm queries about the whole node reload
+ * from /proc, see mom_get_node_sample().
+ *
+ * @return PBSE_NONE, PBSE_SYSTEM if proc_array couldn't be grown, or -1
+ * if the caller must fall back to get_proc_sample()
+ */
+
+static int get_cgroup_sample(void)
+
+  {
+  std::vector<pid_t> pids;
+
+  if (alljobs_list.size() == 0)
+    return(-1);
+
+  for (std::list<job *>::iterator iter = alljobs_list.begin(); iter != alljobs_list.end(); iter++)
+    {
+    job  *pjob = *iter;
+    bool  task_cgroups;
+
+    if (pjob->ji_cgroups_created == false)
+      {
+      if (pjob->ji_qs.ji_state == JOB_STATE_RUNNING)
+        return(-1);
 
       continue;
       }
 
-    /* nproc++; -- we need to increment AFTER assigning this ps to
-       the proc_array--otherwise we could skip it in for loops */
+    task_cgroups = (pjob->ji_wattr[JOB_ATR_req_information].at_flags & ATR_VFLAG_SET) != 0;
 
-    if ((nproc + 1) >= max_proc)
+    if (trq_cg_get_job_pids(pjob->ji_qs.ji_jobid, task_cgroups, pids) != PBSE_NONE)
       {
-      proc_stat_t *hold;
-
-      if (LOGLEVEL >= 9)
+      if (LOGLEVEL >= 7)
         {
-        log_record(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, __func__, "alloc more proc_array");
+        snprintf(log_buffer, sizeof(log_buffer),
+          "unable to list the processes in job %s's cgroup, sampling from %s",
+          pjob->ji_qs.ji_jobid, procfs);
+        log_record(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, __func__, log_buffer);
         }
 
-      max_proc *= 2;
-
-      hold = (proc_stat_t *)calloc(1, max_proc * sizeof(proc_stat_t));
+      return(-1);
+      }
+    }
 
-      if (hold == NULL)
-        {
-        log_err(errno, __func__, "unable to realloc space for proc_array sample");
+  for (unsigned int i = 0; i < pids.size(); i++)
+    {
+    if (sample_process(pids[i]) != PBSE_NONE)
+      return(PBSE_SYSTEM);
+    }
 
-        return(PBSE_SYSTEM);
-        }
+  return(PBSE_NONE);
+  }  /* END get_cgroup_sample() */
+#endif
 
-      memcpy(hold, proc_array, sizeof(proc_stat_t) * max_proc / 2);
-      free(proc_array);
 
-      proc_array = hold;
-      }  /* END if ((nproc+1) == max_proc) */
 
-    /* map pid to proc_array index */
-    pid2procarrayindex_map[pid] = nproc;
+/*
+ * get_connector_sample()
+ *
+ * Loads proc_array with only the job processes that the proc connector
+ * has seen fork from (or join) a job session. With no jobs that is nothing
+ * at all, so the rm queries about the whole node reload from /proc, see
+ * mom_get_node_sample().
+ *
+ * @return PBSE_NONE, PBSE_SYSTEM if proc_array couldn't be grown, or -1
+ * if the connector isn't tracking processes
+ */
 
-    pi = &proc_array[nproc++];
+static int get_connector_sample(void)
 
-    memcpy(pi, ps, sizeof(proc_stat_t));
-    }  /* END while (...) != NULL) */
+  {
+  pid2jobsid_map_t job_pids;
 
-#ifdef PENABLE_LINUX26_CPUSETS
-  free_pidlist(pids);
-#endif
+  if (proc_connector_get_job_pids(global_job_sid_set, job_pids) != PBSE_NONE)
+    return(-1);
 
-  if (LOGLEVEL >= 6)
+  for (pid2jobsid_map_t::iterator iter = job_pids.begin(); iter != job_pids.end(); iter++)
     {
-    sprintf(log_buffer, "proc_array loaded - nproc=%d",
-            nproc);
-
-    log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
+    if (sample_process(iter->first) != PBSE_NONE)
+      return(PBSE_SYSTEM);
     }
 
-  /* We have filled the proc_array table. Now find all of the processes that actually belong to a job and
-     add them to the pid2jobsid_map associating the process id with the session id of the job to which it belongs */
+  return(PBSE_NONE);
+  }  /* END get_connector_sample() */
+
+
+
+/*
+ * map_job_pids()
+ *
+ * Finds the processes in proc_array that actually belong to a job and adds
+ * them to pid2jobsid_map, associating the process id with the session id of
+ * the job to which it belongs.
+ */
+
+static void map_job_pids(void)
 
+  {
   for ( int i = 0; i < nproc; i++)
     {
     int  job_sid;
@@ -2549,12 +2592,144 @@ int mom_get_sample(void)
 
     /* If we get to here the proc_array entry does not belong to a current job */
     }
+  }  /* END map_job_pids() */
+
+
+
+/*
+ * Declare start of polling loop.
+ *
+ * This function caches information about all of processes
+ * on the compute node (pbs_mom calls this function). Each process
+ * in /proc/ is queried by looking at the 'stat' file. Statistics like
+ * CPU usage time, memory consumption, etc. are gathered in the proc_array
+ * list. This list is then used throughout the pbs_mom to get information
+ * about tasks it is monitoring.
+ *
+ * When cgroups are enabled (and $cgroup_sampling isn't turned off) only the
+ * processes listed in the jobs' cgroups are queried. Otherwise, if the proc
+ * connector is tracking processes, only the processes it has attributed to
+ * a job are queried. /proc is walked only when neither is possible, or when
+ * an rm query needs the whole node (see mom_get_node_sample()).
+ *
+ * This function is called from the main MOM loop once every "check_poll_interval"
+ * seconds.
+ *
+ * @see get_proc_stat() - child
+ * @see mom_set_use() - Aggregates data collected here
+ *
+ * NOTE:  populates global 'proc_array[]' variable.
+ * NOTE:  reallocs proc_array[] as needed to accomodate processes.
+ * NOTE:  populates global 'pid2jobsid_map' map (pid to owning job session id mapping for all pids).
+ * NOTE:  populates global 'pid2procarrayindex_map' map (pid to index in proc_array map).
+ *
+ * @see mom_open_poll() - allocs proc_array table.
+ * @see mom_close_poll() - frees procs_array.
+ * @see setup_program_environment() - parent - called at pbs_mom start
+ * @see main_loop() - parent - called once per iteration
+ * @see mom_set_use() - populate job structure with usage data for local use or to send to mother superior
+ */
+
+int mom_get_sample(void)
+
+  {
+  int rc = -1;
+
+  if (proc_array == NULL)
+    mom_open_poll();
+
+  nproc = 0;
+  proc_array_node_wide = false;
+
+  /* clear the maps */
+  pid2jobsid_map.clear();
+  pid2procarrayindex_map.clear();
+
+  if (LOGLEVEL >= 6)
+    {
+    log_record(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, __func__, "proc_array load started");
+    }
+
+#ifdef PENABLE_LINUX_CGROUPS
+  if (MOMCgroupSampling)
+    {
+    if ((rc = get_cgroup_sample()) == -1)
+      {
+      /* at least one job can't be sampled from its cgroups, start over from /proc */
+      nproc = 0;
+      pid2procarrayindex_map.clear();
+      }
+    }
+#endif
+
+  if (rc == -1)
+    rc = get_connector_sample();
+
+  if (rc == -1)
+    {
+    rc = get_proc_sample();
+    proc_array_node_wide = (rc == PBSE_NONE);
+    }
+
+  if (rc != PBSE_NONE)
+    return(rc);
+
+  if (LOGLEVEL >= 6)
+    {
+    sprintf(log_buffer, "proc_array loaded - nproc=%d",
+            nproc);
+
+    log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
+    }
+
+  map_job_pids();
 
   return(PBSE_NONE);
   }  /* END mom_get_sample() */
 
 
 
+/*
+ * mom_get_node_sample()
+ *
+ * The cgroup and proc connector samples only hold job processes, but the rm
+ * queries about the node as a whole (sessions, nsessions, nusers) or about
+ * any session or pid need every process. The first such query after one of
+ * those samples reloads proc_array from /proc; the queries after it reuse
+ * that until the next mom_get_sample(). So /proc is walked at most once per
+ * sample, and only when the status or a client asks for these.
+ *
+ * @return PBSE_NONE or PBSE_SYSTEM if /proc couldn't be sampled
+ */
+
+static int mom_get_node_sample(void)
+
+  {
+  int rc;
+
+  if (proc_array_node_wide == true)
+    return(PBSE_NONE);
+
+  if (proc_array == NULL)
+    mom_open_poll();
+
+  nproc = 0;
+
+  pid2jobsid_map.clear();
+  pid2procarrayindex_map.clear();
+
+  if ((rc = get_proc_sample()) != PBSE_NONE)
+    return(rc);
+
+  map_job_pids();
+
+  proc_array_node_wide = true;
+
+  return(PBSE_NONE);
+  }  /* END mom_get_node_sample() */
+
+
+
 /*
  * Measure job resource usage and compare with its limits.
  *
@@ -3000,6 +3175,82 @@ int mom_set_use(
 
 
 
+/*
+ * list_session_pids()
+ *
+ * Lists the processes that might be in session sid. When the proc connector
+ * is tracking processes that is exactly the session's members; otherwise it
+ * is every process in cpuset (with cpusets) or every process in /proc, and
+ * the caller has to check each one's session itself.
+ *
+ * @param sid    - the session of interest
+ * @param cpuset - the cpuset to look in when cpusets are enabled, NULL for
+ *                 the whole Torque cpuset
+ * @param pids   - (O) the candidate pids
+ * @return PBSE_NONE, or PBSE_SYSTEM if /proc can't be read
+ */
+
+static int list_session_pids(
+
+  pid_t               sid,
+  const char         *cpuset,
+  std::vector<pid_t> &pids)
+
+  {
+#ifdef PENABLE_LINUX26_CPUSETS
+  struct pidl   *cpuset_pids = NULL;
+  struct pidl   *pp;
+#else
+  DIR           *dir;  /* local so callers may nest inside a walk of the global pdir */
+  struct dirent *dent;
+#endif
+
+  pids.clear();
+
+  if (proc_connector_get_session_pids(sid, pids) == PBSE_NONE)
+    return(PBSE_NONE);
+
+#ifdef PENABLE_LINUX26_CPUSETS
+
+  /* Instead of collecting stats of all processes running on a large SMP system,
+   * collect stats of processes running in and below the Torque cpuset, only
+   * This relies on reliable process starters for MPI, which bind their tasks
+   * to the cpuset of the job. */
+
+  if (cpuset == NULL)
+#ifdef USELIBCPUSET
+    cpuset = TTORQUECPUSET_BASE;
+#else
+    cpuset = TTORQUECPUSET_PATH;
+#endif /* USELIBCPUSET */
+
+  cpuset_pids = get_cpuset_pidlist(cpuset, cpuset_pids);
+
+  for (pp = cpuset_pids; pp != NULL; pp = pp->next)
+    pids.push_back(pp->pid);
+
+  free_pidlist(cpuset_pids);
+#else
+  if ((dir = opendir(procfs)) == NULL)
+    return(PBSE_SYSTEM);
+
+  while ((dent = readdir(dir)) != NULL)
+    {
+    if (!isdigit(dent->d_name[0]))
+      continue;
+
+    pids.push_back(atoi(dent->d_name));
+    }
+
+  closedir(dir);
+#endif /* PENABLE_LINUX26_CPUSETS */
+
+  return(PBSE_NONE);
+  }  /* END list_session_pids() */
+
+
+
+
 /**
  * Kill a task session.
  * Call with the task pointer and a signal number.
@@ -3025,12 +3276,7 @@ int kill_task(
   int            ctCleanIterations = 0;
   int            loopCt = 0;
   int            NumProcessesFound = 0; /* number of processes found with session ID */
-#ifdef PENABLE_LINUX26_CPUSETS
-  struct pidl   *pids = NULL;
-  struct pidl   *pp;
-#else
-   struct dirent *dent;
-#endif
+  std::vector<pid_t> pids;
   pid_t          pid;
 
   proc_stat_t   *ps;
@@ -3071,40 +3317,13 @@ int kill_task(
     ctThisIteration = 0;
 
     /* NOTE:  do not use cached proc-buffer since we need up-to-date info */
-#ifdef PENABLE_LINUX26_CPUSETS
-
-    /* Instead of collecting stats of all processes running on a large SMP system,
-     * collect stats of processes running in and below the Torque cpuset, only
-     * This relies on reliable process starters for MPI, which bind their tasks
-     * to the cpuset of the job. */
-
-#ifdef USELIBCPUSET
-    pids = get_cpuset_pidlist(TTORQUECPUSET_BASE, pids);
-#else
-    pids = get_cpuset_pidlist(TTORQUECPUSET_PATH, pids);
-#endif /* USELIBCPUSET */
-    pp = pids;
-    while (pp != NULL)
-      {
-      pid = pp->pid;
-      pp  = pp->next;
-#else
-    if (pdir == NULL)
-      {
-      if ((pdir = opendir(procfs)) == NULL)
-        return(PBSE_SYSTEM);
-      }
-
-    /* pdir is global */
-    rewinddir(pdir);
+    if (list_session_pids(sesid, NULL, pids) != PBSE_NONE)
+      return(PBSE_SYSTEM);
 
-    while ((dent = readdir(pdir)) != NULL)
+    for (unsigned int pid_index = 0; pid_index < pids.size(); pid_index++)
       {
-      if (!isdigit(dent->d_name[0]))
-        continue;
+      pid = pids[pid_index];
 
-      pid = atoi(dent->d_name);
-#endif /* PENABLE_LINUX26_CPUSETS */
       if ((ps = get_proc_stat(pid)) == NULL)
         {
         if (errno != ENOENT)
@@ -3295,12 +3514,8 @@ int kill_task(
           ++ct;
           }  /* END else ((ps->state == 'Z') || (ps->pid == 0)) */
         }    /* END if (sesid == ps->session) */
-      }      /* END while (...) != NULL) */
+      }      /* END for (pid_index) */
 
-#ifdef PENABLE_LINUX26_CPUSETS
-    free_pidlist(pids);
-    pids = NULL;
-#endif
     if (ctThisIteration == 0)
       {
       ctCleanIterations++;
@@ -3390,6 +3605,8 @@ int mom_close_poll(void)
     log_record(PBSEVENT_SYSTEM, 0, __func__, "entered");
     }
 
+  proc_connector_stop();
+
   if (pdir != NULL)
     {
     if (closedir(pdir) != 0)
@@ -3408,6 +3625,7 @@ int mom_close_poll(void)
     proc_array = NULL;
     nproc = 0;
     max_proc = TBL_INC;
+    proc_array_node_wide = false;
     }
 
   return(PBSE_NONE);
@@ -3489,6 +3707,13 @@ char *cput_job(
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   for (i = 0;i < nproc;i++)
     {
     ps = &proc_array[i];
@@ -3646,6 +3871,13 @@ char *mem_job(
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   for (i = 0;i < nproc;i++)
     {
     ps = &proc_array[i];
@@ -3786,6 +4018,13 @@ static char *resi_job(
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   for (i = 0;i < nproc;i++)
     {
     ps = &proc_array[i];
@@ -4021,6 +4260,13 @@ const char *sessions(
 
 #else
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   /* Walk through proc_array, store unique session IDs in the pids list */
 
   for (i = 0;i < nproc;i++)
@@ -4194,6 +4440,13 @@ const char *pids(
     return(NULL);
     }
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   /* Search for members of session */
 
   fmt = ret_string;
@@ -4310,6 +4563,14 @@ const char *nusers(
 
 #else
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    free(uids);
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   for (i = 0;i < nproc;i++)
     {
     ps = &proc_array[i];
@@ -4858,9 +5119,6 @@ void scan_non_child_tasks(void)
   static int first_time = TRUE;
   int log_drift_event = 0;
 
-  DIR *pdir;  /* use local pdir to prevent race conditions associated w/global pdir (VPAC) */
-
-  pdir = opendir(procfs);
   std::list<job *>::iterator iter;
 
   // get a list of jobs in start time order, first to last
@@ -4891,12 +5149,7 @@ void scan_non_child_tasks(void)
       {
       task *pTask = pJob->ji_tasks->at(i);
 
-#ifdef PENABLE_LINUX26_CPUSETS
-      struct pidl   *pids = NULL;
-      struct pidl   *pp;
-#else
-      struct dirent *dent;
-#endif
+      std::vector<pid_t> pids;
       pid_t          pid;
       int            found;
 
@@ -4959,29 +5212,13 @@ void scan_non_child_tasks(void)
       if(!found)
         {
         /* session master cannot be found, look for other pid in session */
-#ifdef PENABLE_LINUX26_CPUSETS
-        pids = get_cpuset_pidlist(pJob->ji_qs.ji_jobid, pids);
-        pp   = pids;
-        while (pp != NULL)
-          {
-          pid = pp->pid;
-          pp  = pp->next;
-#else
-        if (pdir == NULL)
-          {
-          if ((pdir = opendir(procfs)) == NULL)
-            return;
-          }
-
-        rewinddir(pdir);
+        if (list_session_pids(pTask->ti_qs.ti_sid, pJob->ji_qs.ji_jobid, pids) != PBSE_NONE)
+          return;
 
-        while ((dent = readdir(pdir)) != NULL)
+        for (unsigned int pid_index = 0; pid_index < pids.size(); pid_index++)
           {
-          if (!isdigit(dent->d_name[0]))
-            continue;
+          pid = pids[pid_index];
 
-          pid = atoi(dent->d_name);
-#endif /* PENABLE_LINUX26_CPUSETS */
           if ((ps = get_proc_stat(pid)) == NULL)
             continue;
 
@@ -5006,10 +5243,7 @@ void scan_non_child_tasks(void)
               break;
               }
             }
-          }    /* END while ((dent) != NULL) */
-#ifdef PENABLE_LINUX26_CPUSETS
-        free_pidlist(pids);
-#endif
+          }    /* END for (pid_index) */
         }
 
       if (!found)
@@ -5062,9 +5296,6 @@ void scan_non_child_tasks(void)
         }
     } /* END for each job */
 
-  if (pdir != NULL)
-    closedir(pdir);
-
   first_time = FALSE;
 
   return;
@@ -5223,6 +5454,13 @@ static const char *walltime(
     return(NULL);
     }
 
+  if (mom_get_node_sample() != PBSE_NONE)
+    {
+    rm_errno = RM_ERR_SYSTEM;
+
+    return(NULL);
+    }
+
   start = now;
 
   for (i = 0;i < nproc;i++)
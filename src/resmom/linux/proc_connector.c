@@ -0,0 +1,779 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <map>
+#include <vector>
+
+#include "pbs_error.h"
+#include "log.h"
+#include "proc_connector.h"
+
+/*
+ * The proc connector is a netlink multicast group on which the kernel
+ * announces every fork, exec, setsid and exit on the host. Listening to
+ * it lets the mom keep an up to date table of processes, and which job
+ * session each belongs to, without walking /proc to find them. Only
+ * processes (thread group leaders) are tracked, not threads.
+ *
+ * The table is seeded with one walk of /proc after subscribing, and is
+ * rebuilt the same way if the kernel reports that events were dropped.
+ * If the connector can't be used at all (no CONFIG_PROC_EVENTS, no
+ * CAP_NET_ADMIN) proc_connector_active() stays false and callers keep
+ * scanning /proc.
+ */
+
+#define PROC_CONNECTOR_RCVBUF     (4 * 1024 * 1024)
+#define PROC_CONNECTOR_POLL_MS    1000
+#define MAX_LINEAGE_DEPTH         1024
+
+typedef struct tracked_proc
+  {
+  pid_t        ppid;
+  pid_t        session;
+  pid_t        job_sid;      /* session of the job this process belongs to, -1 if none */
+  unsigned int resolved_gen;
+  } tracked_proc;
+
+typedef std::map<pid_t, tracked_proc> proc_table_t;
+
+proc_table_t    proc_table;
+job_pid_set_t   tracked_job_sids;
+pthread_mutex_t proc_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int   resolve_gen = 0;
+static int            cn_sock = -1;
+static pthread_t      listener_thread;
+static volatile bool  listener_running = false;
+static bool           atfork_registered = false;
+static bool           subscription_acked = false;
+
+
+
+/*
+ * parse_proc_ids()
+ *
+ * Reads the ppid and session out of a buffer in /proc/<pid>/stat format.
+ * The command name may contain spaces and parentheses, so parsing starts
+ * after the last ')'.
+ *
+ * @return PBSE_NONE on success, -1 if the buffer isn't in stat format
+ */
+
+int parse_proc_ids(
+
+  const char *buf,
+  pid_t      &ppid,
+  pid_t      &session)
+
+  {
+  const char *ptr = strrchr(buf, ')');
+
+  /* ") <state> <ppid> <pgrp> <session>" */
+  if ((ptr == NULL) ||
+      (sscanf(ptr + 1, " %*c %d %*d %d", &ppid, &session) != 2))
+    return(-1);
+
+  return(PBSE_NONE);
+  }  /* END parse_proc_ids() */
+
+
+
+/*
+ * read_proc_ids()
+ *
+ * Looks up a process' ppid and session. This can't use get_proc_stat()
+ * because that returns static storage shared with the main thread.
+ */
+
+int read_proc_ids(
+
+  pid_t  pid,
+  pid_t &ppid,
+  pid_t &session)
+
+  {
+  char  path[64];
+  char  buf[1024];
+  int   fd;
+  int   len;
+
+  snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+  if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+    return(-1);
+
+  len = read(fd, buf, sizeof(buf) - 1);
+
+  close(fd);
+
+  if (len <= 0)
+    return(-1);
+
+  buf[len] = '\0';
+
+  return(parse_proc_ids(buf, ppid, session));
+  }  /* END read_proc_ids() */
+
+
+
+/*
+ * resolve_job_sid()
+ *
+ * Works out which job session a process belongs to: its own session if
+ * that is a job's, otherwise whatever its parent belongs to. A process
+ * whose parent has exited stays with the job it was forked into.
+ *
+ * NOTE: call with proc_table_mutex held.
+ */
+
+static pid_t resolve_job_sid(
+
+  pid_t pid,
+  int   depth)
+
+  {
+  proc_table_t::iterator  it = proc_table.find(pid);
+  tracked_proc           *tp;
+  pid_t                   job_sid = -1;
+
+  if (it == proc_table.end())
+    return(-1);
+
+  tp = &it->second;
+
+  if (tp->resolved_gen == resolve_gen)
+    return(tp->job_sid);
+
+  if (tracked_job_sids.find(tp->session) != tracked_job_sids.end())
+    job_sid = tp->session;
+  else if ((tp->ppid > 1) &&
+           (depth < MAX_LINEAGE_DEPTH) &&
+           (proc_table.find(tp->ppid) != proc_table.end()))
+    job_sid = resolve_job_sid(tp->ppid, depth + 1);
+  else if (tracked_job_sids.find(tp->job_sid) != tracked_job_sids.end())
+    job_sid = tp->job_sid;
+
+  tp->job_sid = job_sid;
+  tp->resolved_gen = resolve_gen;
+
+  return(job_sid);
+  }  /* END resolve_job_sid() */
+
+
+
+/*
+ * resolve_all_job_sids()
+ *
+ * Recomputes the job of every tracked process. Called when the set of job
+ * sessions changes or the table has been reloaded.
+ *
+ * NOTE: call with proc_table_mutex held.
+ */
+
+static void resolve_all_job_sids(void)
+
+  {
+  resolve_gen++;
+
+  for (proc_table_t::iterator it = proc_table.begin(); it != proc_table.end(); it++)
+    resolve_job_sid(it->first, 0);
+  }  /* END resolve_all_job_sids() */
+
+
+
+/*
+ * proc_connector_track()
+ *
+ * Adds (or replaces) a process in the table and works out its job.
+ *
+ * NOTE: call with proc_table_mutex held.
+ */
+
+void proc_connector_track(
+
+  pid_t pid,
+  pid_t ppid,
+  pid_t session)
+
+  {
+  tracked_proc &tp = proc_table[pid];
+
+  tp.ppid = ppid;
+  tp.session = session;
+  tp.job_sid = -1;
+  tp.resolved_gen = resolve_gen - 1;
+
+  resolve_job_sid(pid, 0);
+  }  /* END proc_connector_track() */
+
+
+
+/*
+ * load_proc_table()
+ *
+ * (Re)builds the table from /proc.
+ */
+
+static int load_proc_table(void)
+
+  {
+  DIR           *pdir;
+  struct dirent *dent;
+  proc_table_t   loaded;
+
+  if ((pdir = opendir("/proc")) == NULL)
+    return(PBSE_SYSTEM);
+
+  while ((dent = readdir(pdir)) != NULL)
+    {
+    pid_t pid;
+    pid_t ppid;
+    pid_t session;
+
+    if (!isdigit(dent->d_name[0]))
+      continue;
+
+    pid = atoi(dent->d_name);
+
+    if (read_proc_ids(pid, ppid, session) == PBSE_NONE)
+      {
+      tracked_proc &tp = loaded[pid];
+
+      tp.ppid = ppid;
+      tp.session = session;
+      tp.job_sid = -1;
+      tp.resolved_gen = 0;
+      }
+    }
+
+  closedir(pdir);
+
+  pthread_mutex_lock(&proc_table_mutex);
+
+  /* keep what we knew about processes whose parents are already gone */
+  for (proc_table_t::iterator it = loaded.begin(); it != loaded.end(); it++)
+    {
+    proc_table_t::iterator old = proc_table.find(it->first);
+
+    if (old != proc_table.end())
+      it->second.job_sid = old->second.job_sid;
+    }
+
+  proc_table.swap(loaded);
+  resolve_all_job_sids();
+
+  pthread_mutex_unlock(&proc_table_mutex);
+
+  return(PBSE_NONE);
+  }  /* END load_proc_table() */
+
+
+
+/*
+ * handle_proc_event()
+ *
+ * Applies one proc connector event to the table.
+ */
+
+void handle_proc_event(
+
+  struct proc_event *ev)
+
+  {
+  pid_t ppid;
+  pid_t session;
+
+  pthread_mutex_lock(&proc_table_mutex);
+
+  switch (ev->what)
+    {
+    case proc_event::PROC_EVENT_FORK:
+
+      {
+      pid_t                  child = ev->event_data.fork.child_tgid;
+      pid_t                  forker = ev->event_data.fork.parent_tgid;
+      proc_table_t::iterator parent;
+
+      /* a new thread, not a new process */
+      if (ev->event_data.fork.child_pid != child)
+        break;
+
+      parent = proc_table.find(forker);
+
+      if (parent != proc_table.end())
+        {
+        tracked_proc &tp = proc_table[child];
+
+        tp = parent->second;
+        tp.ppid = forker;
+        }
+      else if (read_proc_ids(child, ppid, session) == PBSE_NONE)
+        proc_connector_track(child, ppid, session);
+      }
+
+      break;
+
+    case proc_event::PROC_EVENT_EXEC:
+
+      if (proc_table.find(ev->event_data.exec.process_tgid) == proc_table.end())
+        {
+        if (read_proc_ids(ev->event_data.exec.process_tgid, ppid, session) == PBSE_NONE)
+          proc_connector_track(ev->event_data.exec.process_tgid, ppid, session);
+        }
+
+      break;
+
+    case proc_event::PROC_EVENT_SID:
+
+      {
+      pid_t                  pid = ev->event_data.sid.process_tgid;
+      proc_table_t::iterator it = proc_table.find(pid);
+
+      if (it != proc_table.end())
+        {
+        /* setsid() makes the caller the leader of a new session */
+        it->second.session = pid;
+
+        if (tracked_job_sids.find(pid) != tracked_job_sids.end())
+          it->second.job_sid = pid;
+        }
+      else if (read_proc_ids(pid, ppid, session) == PBSE_NONE)
+        proc_connector_track(pid, ppid, session);
+      }
+
+      break;
+
+    case proc_event::PROC_EVENT_EXIT:
+
+      if (ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid)
+        proc_table.erase(ev->event_data.exit.process_tgid);
+
+      break;
+
+    default:
+
+      break;
+    }
+
+  pthread_mutex_unlock(&proc_table_mutex);
+  }  /* END handle_proc_event() */
+
+
+
+/*
+ * receive_proc_events()
+ *
+ * Reads one datagram from the connector socket and hands each proc event
+ * in it to handler.
+ *
+ * @return the number of events read, or -1 with errno set
+ */
+
+static int receive_proc_events(
+
+  void (*handler)(struct proc_event *))
+
+  {
+  char                buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+  struct sockaddr_nl  from;
+  socklen_t           from_len = sizeof(from);
+  struct nlmsghdr    *nlh;
+  ssize_t             len;
+  int                 count = 0;
+
+  len = recvfrom(cn_sock, buf, sizeof(buf), 0, (struct sockaddr *)&from, &from_len);
+
+  if (len < 0)
+    return(-1);
+
+  /* only the kernel speaks for the proc connector */
+  if (from.nl_pid != 0)
+    return(0);
+
+  for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len))
+    {
+    struct cn_msg *msg;
+
+    if ((nlh->nlmsg_type == NLMSG_ERROR) ||
+        (nlh->nlmsg_type == NLMSG_OVERRUN))
+      break;
+
+    if (nlh->nlmsg_type == NLMSG_NOOP)
+      continue;
+
+    msg = (struct cn_msg *)NLMSG_DATA(nlh);
+
+    if ((msg->id.idx != CN_IDX_PROC) ||
+        (msg->id.val != CN_VAL_PROC))
+      continue;
+
+    handler((struct proc_event *)msg->data);
+    count++;
+    }
+
+  return(count);
+  }  /* END receive_proc_events() */
+
+
+
+/*
+ * proc_connector_listen()
+ *
+ * The listener thread. Polls with a timeout so that proc_connector_stop()
+ * can end it.
+ */
+
+static void *proc_connector_listen(
+
+  void *vp)
+
+  {
+  while (listener_running == true)
+    {
+    struct pollfd pfd;
+
+    pfd.fd = cn_sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, PROC_CONNECTOR_POLL_MS) <= 0)
+      continue;
+
+    if ((receive_proc_events(handle_proc_event) < 0) &&
+        (errno == ENOBUFS))
+      {
+      /* the kernel dropped events on the floor - start over from /proc */
+      log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__,
+        "proc connector events were lost, reloading the process table from /proc");
+
+      load_proc_table();
+      }
+    }
+
+  return(NULL);
+  }  /* END proc_connector_listen() */
+
+
+
+/*
+ * proc_connector_ack()
+ *
+ * Records the kernel's acknowledgement of our subscription. Any other
+ * event seen before it predates the /proc walk that seeds the table.
+ */
+
+static void proc_connector_ack(
+
+  struct proc_event *ev)
+
+  {
+  if ((ev->what == proc_event::PROC_EVENT_NONE) &&
+      (ev->event_data.ack.err == 0))
+    subscription_acked = true;
+  }  /* END proc_connector_ack() */
+
+
+
+/*
+ * proc_connector_subscribe()
+ *
+ * Asks the kernel to start (or stop) multicasting proc events to us.
+ */
+
+static int proc_connector_subscribe(
+
+  enum proc_cn_mcast_op op)
+
+  {
+  char             buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))]
+                     __attribute__((aligned(NLMSG_ALIGNTO)));
+  struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+  struct cn_msg   *msg;
+
+  memset(buf, 0, sizeof(buf));
+
+  nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+  nlh->nlmsg_type = NLMSG_DONE;
+  nlh->nlmsg_pid = 0;
+
+  msg = (struct cn_msg *)NLMSG_DATA(nlh);
+  msg->id.idx = CN_IDX_PROC;
+  msg->id.val = CN_VAL_PROC;
+  msg->len = sizeof(enum proc_cn_mcast_op);
+  memcpy(msg->data, &op, sizeof(op));
+
+  if (send(cn_sock, nlh, nlh->nlmsg_len, 0) < 0)
+    return(PBSE_SYSTEM);
+
+  return(PBSE_NONE);
+  }  /* END proc_connector_subscribe() */
+
+
+
+/*
+ * proc_connector_atfork_child()
+ *
+ * The listener thread doesn't survive fork(), so a child must not think
+ * the table is being kept current.
+ */
+
+static void proc_connector_atfork_child(void)
+
+  {
+  listener_running = false;
+
+  if (cn_sock >= 0)
+    {
+    close(cn_sock);
+    cn_sock = -1;
+    }
+  }  /* END proc_connector_atfork_child() */
+
+
+
+/*
+ * proc_connector_start()
+ *
+ * Subscribes to the proc connector, seeds the process table and starts
+ * the listener thread.
+ *
+ * @return PBSE_NONE if processes are being tracked, PBSE_SYSTEM if the
+ * caller should keep scanning /proc
+ */
+
+int proc_connector_start(void)
+
+  {
+  struct sockaddr_nl addr;
+  int                bufsize = PROC_CONNECTOR_RCVBUF;
+  time_t             give_up;
+
+  if (listener_running == true)
+    return(PBSE_NONE);
+
+  if ((cn_sock = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR)) < 0)
+    {
+    log_err(errno, __func__, "unable to open a proc connector socket, process tracking will scan /proc");
+    return(PBSE_SYSTEM);
+    }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = CN_IDX_PROC;
+  addr.nl_pid = 0;
+
+  /* a burst of forks shouldn't overflow the socket; root may exceed rmem_max */
+  if (setsockopt(cn_sock, SOL_SOCKET, SO_RCVBUFFORCE, &bufsize, sizeof(bufsize)) < 0)
+    setsockopt(cn_sock, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+  if ((bind(cn_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+      (proc_connector_subscribe(PROC_CN_MCAST_LISTEN) != PBSE_NONE))
+    {
+    log_err(errno, __func__, "unable to subscribe to the proc connector, process tracking will scan /proc");
+    close(cn_sock);
+    cn_sock = -1;
+    return(PBSE_SYSTEM);
+    }
+
+  /* without proc events in the kernel the subscription goes unanswered */
+  subscription_acked = false;
+  give_up = time(NULL) + 2;
+
+  while ((subscription_acked == false) &&
+         (time(NULL) <= give_up))
+    {
+    struct pollfd pfd;
+
+    pfd.fd = cn_sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, PROC_CONNECTOR_POLL_MS) > 0)
+      receive_proc_events(proc_connector_ack);
+    }
+
+  if ((subscription_acked == false) ||
+      (load_proc_table() != PBSE_NONE))
+    {
+    log_err(-1, __func__, "the proc connector is not delivering events, process tracking will scan /proc");
+    close(cn_sock);
+    cn_sock = -1;
+    return(PBSE_SYSTEM);
+    }
+
+  if (atfork_registered == false)
+    {
+    pthread_atfork(NULL, NULL, proc_connector_atfork_child);
+    atfork_registered = true;
+    }
+
+  listener_running = true;
+
+  if (pthread_create(&listener_thread, NULL, proc_connector_listen, NULL) != 0)
+    {
+    log_err(errno, __func__, "unable to start the proc connector thread, process tracking will scan /proc");
+    listener_running = false;
+    close(cn_sock);
+    cn_sock = -1;
+    return(PBSE_SYSTEM);
+    }
+
+  log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__,
+    "tracking job processes with the proc connector");
+
+  return(PBSE_NONE);
+  }  /* END proc_connector_start() */
+
+
+
+/*
+ * proc_connector_stop()
+ */
+
+void proc_connector_stop(void)
+
+  {
+  if (listener_running == false)
+    return;
+
+  listener_running = false;
+
+  pthread_join(listener_thread, NULL);
+
+  proc_connector_subscribe(PROC_CN_MCAST_IGNORE);
+
+  close(cn_sock);
+  cn_sock = -1;
+
+  pthread_mutex_lock(&proc_table_mutex);
+  proc_table.clear();
+  tracked_job_sids.clear();
+  pthread_mutex_unlock(&proc_table_mutex);
+  }  /* END proc_connector_stop() */
+
+
+
+bool proc_connector_active(void)
+
+  {
+  return(listener_running);
+  }  /* END proc_connector_active() */
+
+
+
+/*
+ * collect_job_pids()
+ *
+ * Lists every tracked process that belongs to one of the sessions in
+ * job_sids, either directly or through its lineage.
+ */
+
+void collect_job_pids(
+
+  const job_pid_set_t &job_sids,
+  pid2jobsid_map_t    &job_pids)
+
+  {
+  pthread_mutex_lock(&proc_table_mutex);
+
+  if (job_sids != tracked_job_sids)
+    {
+    tracked_job_sids = job_sids;
+    resolve_all_job_sids();
+    }
+
+  for (proc_table_t::iterator it = proc_table.begin(); it != proc_table.end(); it++)
+    {
+    if (it->second.job_sid != -1)
+      job_pids[it->first] = it->second.job_sid;
+    }
+
+  pthread_mutex_unlock(&proc_table_mutex);
+  }  /* END collect_job_pids() */
+
+
+
+/*
+ * collect_session_pids()
+ *
+ * Lists the tracked processes in session sid.
+ */
+
+void collect_session_pids(
+
+  pid_t               sid,
+  std::vector<pid_t> &pids)
+
+  {
+  pthread_mutex_lock(&proc_table_mutex);
+
+  for (proc_table_t::iterator it = proc_table.begin(); it != proc_table.end(); it++)
+    {
+    if (it->second.session == sid)
+      pids.push_back(it->first);
+    }
+
+  pthread_mutex_unlock(&proc_table_mutex);
+  }  /* END collect_session_pids() */
+
+
+
+/*
+ * proc_connector_get_job_pids()
+ *
+ * @param job_sids - the session ids of the jobs on this node
+ * @param job_pids - (O) pid to owning job session id
+ * @return PBSE_NONE, or -1 if the connector isn't tracking processes
+ */
+
+int proc_connector_get_job_pids(
+
+  const job_pid_set_t &job_sids,
+  pid2jobsid_map_t    &job_pids)
+
+  {
+  if (listener_running == false)
+    return(-1);
+
+  collect_job_pids(job_sids, job_pids);
+
+  return(PBSE_NONE);
+  }  /* END proc_connector_get_job_pids() */
+
+
+
+/*
+ * proc_connector_get_session_pids()
+ *
+ * @return PBSE_NONE, or -1 if the connector isn't tracking processes
+ */
+
+int proc_connector_get_session_pids(
+
+  pid_t               sid,
+  std::vector<pid_t> &pids)
+
+  {
+  if (listener_running == false)
+    return(-1);
+
+  collect_session_pids(sid, pids);
+
+  return(PBSE_NONE);
+  }  /* END proc_connector_get_session_pids() */
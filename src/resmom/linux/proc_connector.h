@@ -0,0 +1,21 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _PROC_CONNECTOR_H
+#define _PROC_CONNECTOR_H
+
+#include <sys/types.h>
+#include <vector>
+
+#include "pbs_job.h" /* job_pid_set_t, pid2jobsid_map_t */
+
+/* proc_connector.c */
+int  proc_connector_start(void);
+
+void proc_connector_stop(void);
+
+bool proc_connector_active(void);
+
+int  proc_connector_get_job_pids(const job_pid_set_t &job_sids, pid2jobsid_map_t &job_pids);
+
+int  proc_connector_get_session_pids(pid_t sid, std::vector<pid_t> &pids);
+
+#endif /* _PROC_CONNECTOR_H */
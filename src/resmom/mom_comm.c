@@ -99,6 +99,9 @@
 #include <arpa/inet.h>
 #endif
 #include <sys/wait.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include "libpbs.h"
 #include "list_link.h"
@@ -209,7 +212,12 @@ struct routefd
   unsigned short    r_fd;
   };
 
+#ifdef HAVE_SYS_EPOLL_H
+/* epoll instance of the fork_demux() child, sockets aren't capped at FD_SETSIZE */
+static int demux_epoll_fd = -1;
+#else
 fd_set readset;
+#endif
 
 
 /* external functions */
@@ -1931,15 +1939,15 @@ char *resc_string(
 
 
 /* create the list of sisters to contact for this radix group
- * and send the job along
+ * and send the job along. attrs are the job attributes to send
+ * (the list we received), or NULL to encode them from pjob.
  */
 int contact_sisters(
 
   job        *pjob,
   tm_event_t  event,
   int         sister_count,
-  char       *radix_hosts,
-  char       *radix_ports)
+  tlist_head *attrs)
 
   {
   int                index;
@@ -1959,7 +1967,8 @@ int contact_sisters(
 
   /* we have to have a sister count of 2 or more for
      this to work */
-  if (sister_count <= 2)
+  if ((sister_count <= 2) ||
+      (pjob->ji_sisters == NULL))
     {
     return(-1);
     }
@@ -1968,21 +1977,26 @@ int contact_sisters(
 
   CLEAR_HEAD(phead);
 
-  pattr = pjob->ji_wattr;
-
-  /* prepare the attributes to go out on the wire. at_encode does this */
-  for (i = 0;i < JOB_ATR_LAST;i++)
+  if (attrs == NULL)
     {
-    (job_attr_def + i)->at_encode(
-  	  pattr + i,
-  	  &phead,
-  	  (job_attr_def + i)->at_name,
-  	  NULL,
-  	  ATR_ENCODE_MOM,
-      ATR_DFLAG_ACCESS);
-    }  /* END for (i) */
+    pattr = pjob->ji_wattr;
+
+    /* prepare the attributes to go out on the wire. at_encode does this */
+    for (i = 0;i < JOB_ATR_LAST;i++)
+      {
+      (job_attr_def + i)->at_encode(
+    	  pattr + i,
+    	  &phead,
+    	  (job_attr_def + i)->at_name,
+    	  NULL,
+    	  ATR_ENCODE_MOM,
+        ATR_DFLAG_ACCESS);
+      }  /* END for (i) */
 
-  attrl_fixlink(&phead);
+    attrl_fixlink(&phead);
+
+    attrs = &phead;
+    }
 
   /* NYI: this code performs unnecessary steps. Fix later */
 
@@ -1990,24 +2004,14 @@ int contact_sisters(
 	 in req_quejob and req_commit on Mother Superior for non-job_radix jobs */
   alljobs_list.push_back(pjob);
 
-  /* initialize the nodes for every sister in this job
-     only the first mom_radix+1 entries will be used
-     for communication */
-  sister_job_nodes(pjob, radix_hosts, radix_ports);
+  /* every sister in our part of the radix was put in ji_sisters by
+     set_radix_parent() when the join arrived. Only the first
+     mom_radix+1 entries will be used for communication */
 
   /* we now need to create the list of sisters to send to
      our intermediate MOMs in our job_radix */
   sister_list = allocate_sister_list(mom_radix+1);
 
-  /* We need to get the address and port of the MOM who
-     called us (pjob->ji_sister[0]) so we can contact
-     her when we call back later */
-  np = &pjob->ji_sisters[0];
-  ret = get_hostaddr_hostent_af(&local_errno, np->hn_host, &af_family, &host_addr, &addr_len);
-  memmove(&np->sock_addr.sin_addr, host_addr, addr_len);
-  np->sock_addr.sin_port = htons(np->hn_port);
-  np->sock_addr.sin_family = af_family;
-
   /* Set this MOM as the first entry for everyone in the
      job_radix. This is how the children will know who
      called them. */
@@ -2064,7 +2068,7 @@ int contact_sisters(
       mom_radix,
       &pjob->ji_sisters[1],
       sister_list,
-      &phead,
+      attrs,
       INTERMEDIATE_MOM);
 
   free_sisterlist(sister_list, mom_radix);
@@ -2170,6 +2174,132 @@ void send_im_error(
 
 
 
+/*
+ * set_radix_parent()
+ *
+ * Builds ji_sisters from the host and port lists of a job_radix join and
+ * resolves the address of ji_sisters[0], the mom that sent us the join
+ * and that we report back to.
+ */
+
+void set_radix_parent(
+
+  job  *pjob,
+  char *radix_hosts,
+  char *radix_ports)
+
+  {
+  hnodent        *np;
+  char           *host_addr = NULL;
+  int             addr_len;
+  int             local_errno;
+  unsigned short  af_family;
+
+  sister_job_nodes(pjob, radix_hosts, radix_ports);
+
+  if (pjob->ji_sisters == NULL)
+    return;
+
+  np = &pjob->ji_sisters[0];
+
+  if ((get_hostaddr_hostent_af(&local_errno, np->hn_host, &af_family, &host_addr, &addr_len) == PBSE_NONE) &&
+      (host_addr != NULL))
+    {
+    memmove(&np->sock_addr.sin_addr, host_addr, addr_len);
+    np->sock_addr.sin_family = af_family;
+    }
+
+  np->sock_addr.sin_port = htons(np->hn_port);
+
+  free(host_addr);
+  } /* END set_radix_parent() */
+
+
+
+
+/*
+ * send_join_job_error()
+ *
+ * Reports that we couldn't join a job. With $pipelined_radix_launch a
+ * job_radix sister reports to the mom that sent it the join, which passes
+ * the failure up the radix without waiting on the rest of its sisters;
+ * otherwise the error goes straight to mother superior.
+ */
+
+void send_join_job_error(
+
+  int         err,
+  job        *pjob,
+  char       *cookie,
+  tm_event_t  event,
+  tm_task_id  fromtask)
+
+  {
+  struct sockaddr_in parent;
+
+  if ((MOMPipelinedRadixLaunch) &&
+      (pjob->ji_sisters != NULL))
+    {
+    parent = pjob->ji_sisters[0].sock_addr;
+
+    if (send_im_error_addr(err, &parent, pjob->ji_sisters[0].hn_port,
+          pjob->ji_qs.ji_jobid, cookie, event, fromtask) != DIS_SUCCESS)
+      {
+      snprintf(log_buffer, sizeof(log_buffer),
+        "Could not send join error %d to %s",
+        err,
+        pjob->ji_sisters[0].hn_host);
+      log_err(-1, __func__, log_buffer);
+      }
+
+    return;
+    }
+
+  send_im_error(err, 1, pjob, cookie, event, fromtask);
+  } /* END send_join_job_error() */
+
+
+
+
+/*
+ * forward_join_job_radix()
+ *
+ * Makes this mom the intermediate mom for its part of the job radix and
+ * sends the join on to the sisters below it.
+ *
+ * @param attrs - the job attributes to send, or NULL to encode them from pjob
+ * @return PBSE_NONE, or PBSE_SYSTEM if the demux sockets couldn't be set up
+ */
+
+int forward_join_job_radix(
+
+  job        *pjob,
+  tm_event_t  event,
+  int         sister_count,
+  tlist_head *attrs)
+
+  {
+  /* handle the case where we're contacting multiple nodes */
+  if ((pjob->ji_wattr[JOB_ATR_job_radix].at_flags & ATR_VFLAG_SET) &&
+      (pjob->ji_wattr[JOB_ATR_job_radix].at_val.at_long != 0))
+    {
+    pjob->ji_radix = pjob->ji_wattr[JOB_ATR_job_radix].at_val.at_long;
+    }
+
+  pjob->ji_im_nodeid = 1; /* this will identify us as an intermediate node later */
+
+  if (allocate_demux_sockets(pjob, INTERMEDIATE_MOM))
+    return(PBSE_SYSTEM);
+
+  contact_sisters(pjob, event, sister_count, attrs);
+  pjob->ji_intermediate_join_event = event;
+
+  return(PBSE_NONE);
+  } /* END forward_join_job_radix() */
+
+
+
+
 int reply_to_join_job_as_sister(
 
   job                *pjob,
@@ -2315,7 +2445,6 @@ int im_join_job_as_sister(
   int                 job_radix)
 
   {
-  hnodent             *np = NULL;
   attribute_def       *pdef;
   job                 *pjob;
   tlist_head           lhead;
@@ -2328,6 +2457,7 @@ int im_join_job_as_sister(
   int                  rc;
   int                  sister_count = 0;
   int                  resc_access_perm;
+  bool                 forwarded = false;
 
   char                 basename[50];
   char                 namebuf[MAXPATHLEN];
@@ -2500,6 +2630,10 @@ int im_join_job_as_sister(
     }
 
   pjob->ji_qs.ji_un_type  = JOB_UNION_TYPE_MOM;
+
+  /* the mom that sent us a job_radix join is the one we answer */
+  if (job_radix == TRUE)
+    set_radix_parent(pjob, radix_hosts, radix_ports);
   
   /* decode attributes from request into job structure */
   
@@ -2542,6 +2676,20 @@ int im_join_job_as_sister(
     }
 #endif  /* NVIDIA_GPUS */
 
+  if ((rc == 0) &&
+      (MOMPipelinedRadixLaunch) &&
+      (pjob->ji_qs.ji_svrflags & JOB_SVFLG_INTERMEDIATE_MOM))
+    {
+    /* pass the join on to our part of the radix before our own, much
+       slower, setup. The attributes go out exactly as they came in and
+       the hosts are needed to abort the job if a sister can't be reached */
+    if ((rc = job_nodes(*pjob)) == PBSE_NONE)
+      {
+      rc = forward_join_job_radix(pjob, event, sister_count, &lhead);
+      forwarded = true;
+      }
+    }
+
   free_attrlist(&lhead);
   
   if (rc != 0)
@@ -2555,7 +2703,7 @@ int im_join_job_as_sister(
       log_event(PBSEVENT_JOB,PBS_EVENTCLASS_JOB,pjob->ji_qs.ji_jobid,log_buffer);
       }
     
-    send_im_error(rc,1,pjob,cookie,event,fromtask);
+    send_join_job_error(rc, pjob, cookie, event, fromtask);
    
     mom_job_purge(pjob);
 
@@ -2568,13 +2716,14 @@ int im_join_job_as_sister(
     return(IM_DONE);
     }
   
-  if ((rc = job_nodes(*pjob)) != PBSE_NONE)
+  if ((forwarded == false) &&
+      ((rc = job_nodes(*pjob)) != PBSE_NONE))
     {
     snprintf(log_buffer, sizeof(log_buffer), "Could not parse the exec_host list for %s; aborting.",
       pjob->ji_qs.ji_jobid);
     log_err(rc, __func__, log_buffer);
 
-    send_im_error(ret, 1, pjob, cookie, event, fromtask);
+    send_join_job_error(rc, pjob, cookie, event, fromtask);
     
     mom_job_purge(pjob);
     
@@ -2614,7 +2763,7 @@ int im_join_job_as_sister(
         pjob->ji_qs.ji_jobid);
       log_err(-1, __func__, log_buffer);
 
-      send_im_error(PBSE_BADMOMSTATE, 1, pjob, cookie, event, fromtask);
+      send_join_job_error(PBSE_BADMOMSTATE, pjob, cookie, event, fromtask);
 
       mom_job_purge(pjob);
 
@@ -2637,7 +2786,7 @@ int im_join_job_as_sister(
     
     log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buffer);
     
-    send_im_error(PBSE_BADUSER,1,pjob,cookie,event,fromtask);
+    send_join_job_error(PBSE_BADUSER, pjob, cookie, event, fromtask);
     
     mom_job_purge(pjob);
 
@@ -2661,7 +2810,7 @@ int im_join_job_as_sister(
         pjob->ji_qs.ji_jobid,
         "cannot create tmp dir");
       
-      send_im_error(PBSE_BADUSER,1,pjob,cookie,event,fromtask);
+      send_join_job_error(PBSE_BADUSER, pjob, cookie, event, fromtask);
       
       mom_job_purge(pjob);
       
@@ -2705,7 +2854,7 @@ int im_join_job_as_sister(
     {
     sprintf(log_buffer, "Could not create cgroups for job %s.", pjob->ji_qs.ji_jobid);
     log_err(errno, __func__, log_buffer);
-    send_im_error(ret, 1, pjob, cookie, event, fromtask);
+    send_join_job_error(ret, pjob, cookie, event, fromtask);
     
     mom_job_purge(pjob);
     
@@ -2725,7 +2874,7 @@ int im_join_job_as_sister(
     {
     sprintf(log_buffer, "Could not create memory limit cgroups for job %s.", pjob->ji_qs.ji_jobid);
     log_err(errno, __func__, log_buffer);
-    send_im_error(ret, 1, pjob, cookie, event, fromtask);
+    send_join_job_error(ret, pjob, cookie, event, fromtask);
     
     mom_job_purge(pjob);
     
@@ -2743,7 +2892,7 @@ int im_join_job_as_sister(
     {
     sprintf(log_buffer, "Could not create device limits cgroups for job %s.", pjob->ji_qs.ji_jobid);
     log_err(errno, __func__, log_buffer);
-    send_im_error(ret, 1, pjob, cookie, event, fromtask);
+    send_join_job_error(ret, pjob, cookie, event, fromtask);
     
     mom_job_purge(pjob);
     
@@ -2761,7 +2910,7 @@ int im_join_job_as_sister(
   ret = run_prologue_scripts(pjob);
   if (ret != PBSE_NONE)
     {
-    send_im_error(ret, 1, pjob, cookie, event, fromtask);
+    send_join_job_error(ret, pjob, cookie, event, fromtask);
     
     mom_job_purge(pjob);
     
@@ -2778,7 +2927,7 @@ int im_join_job_as_sister(
   
   if (load_sp_switch(pjob) != 0)
     {
-    send_im_error(PBSE_SYSTEM,1,pjob,cookie,event,fromtask);
+    send_join_job_error(PBSE_SYSTEM, pjob, cookie, event, fromtask);
     
     log_err(-1, __func__, "cannot load sp switch table");
     
@@ -2810,24 +2959,14 @@ int im_join_job_as_sister(
   if ((job_radix == TRUE) &&
       (sister_count > 2))
     {
-    /* handle the case where we're contacting multiple nodes */
-    if ((pjob->ji_wattr[JOB_ATR_job_radix].at_flags & ATR_VFLAG_SET) &&
-        (pjob->ji_wattr[JOB_ATR_job_radix].at_val.at_long != 0))
-      {
-      pjob->ji_radix = pjob->ji_wattr[JOB_ATR_job_radix].at_val.at_long;
-      }
-
-    pjob->ji_im_nodeid = 1; /* this will identify us as an intermediate node later */
-
-    if (allocate_demux_sockets(pjob, INTERMEDIATE_MOM))
+    if ((forwarded == false) &&
+        (forward_join_job_radix(pjob, event, sister_count, NULL) != PBSE_NONE))
       {
       free(radix_hosts);
       free(radix_ports);
       return(IM_DONE);
       }
 
-    contact_sisters(pjob,event,sister_count,radix_hosts,radix_ports);
-    pjob->ji_intermediate_join_event = event;
     job_save(pjob,SAVEJOB_FULL,momport);
 
     free(radix_ports);
@@ -2837,28 +2976,9 @@ int im_join_job_as_sister(
     }
   else
     {
-    unsigned short  af_family;
-    char           *host_addr = NULL;
-    int             addr_len;
-    int             local_errno;
-
     /* handle the single contact case */
     if (job_radix == TRUE)
       {
-      sister_job_nodes(pjob, radix_hosts, radix_ports);
-      free(radix_ports);
-      radix_ports = NULL;
-
-      np = &pjob->ji_sisters[0];
-      if (np != NULL)
-        {
-        ret = get_hostaddr_hostent_af(&local_errno, np->hn_host, &af_family, &host_addr, &addr_len);
-        memmove(&np->sock_addr.sin_addr, host_addr, addr_len);
-        free(host_addr);
-        np->sock_addr.sin_port = htons(np->hn_port);
-        np->sock_addr.sin_family = af_family;
-        }
-
       /* This is a leaf node in the job radix hierarchy. pjob->ji_radix needs to be set to non-zero
          for later in tm_spawn calls. */
       pjob->ji_radix = 2;
@@ -5241,6 +5361,12 @@ int process_error_reply(
       job_start_error(pjob, errcode, netaddr(pSockAddr));
 
       break;
+
+    case IM_JOIN_JOB_RADIX:
+
+      rc = handle_im_join_job_radix_error(pjob, errcode, pSockAddr);
+
+      break;
       
     case IM_ABORT_JOB:
     case IM_KILL_JOB:
@@ -5507,6 +5633,69 @@ int pass_joined_successfully_up_the_chain(
 
 
 
+/*
+ * handle_im_join_job_radix_error()
+ *
+ * A sister in our part of the job radix couldn't join the job. Mother
+ * superior fails the job start, which aborts the job on every sister.
+ * An intermediate mom passes the first failure straight up the radix
+ * instead of waiting for the rest of its sisters, and only counts the
+ * ones after it since the job is already being aborted.
+ */
+
+int handle_im_join_job_radix_error(
+
+  job                *pjob,
+  int                 errcode,
+  struct sockaddr_in *pSockAddr) /* I */
+
+  {
+  struct sockaddr_in parent;
+
+  pjob->ji_radix_join_errors++;
+
+  snprintf(log_buffer, sizeof(log_buffer),
+    "%s: job_radix join failed on %s (%d), %d failure(s) in this part of the radix",
+    __func__,
+    netaddr(pSockAddr),
+    errcode,
+    pjob->ji_radix_join_errors);
+  log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buffer);
+
+  if (pjob->ji_radix_join_errors > 1)
+    return(IM_DONE);
+
+  if (pjob->ji_im_nodeid != 1)
+    {
+    if (am_i_mother_superior(*pjob) == false)
+      {
+      log_err(-1, __func__, "JOIN_JOB_RADIX ERROR and I'm not MS or an intermediate mom");
+      return(IM_FAILURE);
+      }
+
+    job_start_error(pjob, errcode, netaddr(pSockAddr));
+
+    return(IM_DONE);
+    }
+
+  parent = pjob->ji_sisters[0].sock_addr;
+
+  if (send_im_error_addr(errcode, &parent, pjob->ji_sisters[0].hn_port, pjob->ji_qs.ji_jobid,
+        pjob->ji_wattr[JOB_ATR_Cookie].at_val.at_str,
+        pjob->ji_intermediate_join_event, TM_NULL_TASK) != DIS_SUCCESS)
+    {
+    snprintf(log_buffer, sizeof(log_buffer),
+      "Could not pass the join error up to %s",
+      pjob->ji_sisters[0].hn_host);
+    log_err(-1, __func__, log_buffer);
+    }
+
+  return(IM_DONE);
+  } /* END handle_im_join_job_radix_error() */
+
+
+
+
 int handle_im_join_job_radix_response(
 
   struct tcp_chan    *chan,
@@ -5514,6 +5703,9 @@ int handle_im_join_job_radix_response(
   struct sockaddr_in *pSockAddr) /* I */
 
   {
+  struct timeval now;
+  struct timeval elapsed;
+
   close_conn(chan->sock, FALSE);
   svr_conn[chan->sock].cn_stay_open = FALSE;
   chan->sock = -1;
@@ -5522,6 +5714,10 @@ int handle_im_join_job_radix_response(
     {
     pjob->ji_outstanding--;
     }
+
+  /* how long this reply took since we sent the join on, to tune job_radix by */
+  gettimeofday(&now, NULL);
+  timeval_subtract(&elapsed, &now, &pjob->ji_radix_join_start);
   
   if (pjob->ji_outstanding == 0)
     {              
@@ -5547,15 +5743,21 @@ int handle_im_join_job_radix_response(
     /* All sisters in our job radix have reported in */
     if (pjob->ji_im_nodeid == 1)
       {
-      sprintf(log_buffer, "%s: all sisters for intermediate mom %s reported in",
+      sprintf(log_buffer, "%s: all sisters for intermediate mom %s reported in after %ld.%06ld seconds (radix %d)",
         __func__,
-        pjob->ji_sisters[0].hn_host);
+        pjob->ji_sisters[0].hn_host,
+        (long)elapsed.tv_sec,
+        (long)elapsed.tv_usec,
+        pjob->ji_radix);
       }
     else
       {
-      sprintf(log_buffer, "%s: all sisters for Mother Superior %s reported in",
+      sprintf(log_buffer, "%s: all sisters for Mother Superior %s reported in after %ld.%06ld seconds (radix %d)",
         __func__,
-        pjob->ji_hosts[0].hn_host);
+        pjob->ji_hosts[0].hn_host,
+        (long)elapsed.tv_sec,
+        (long)elapsed.tv_usec,
+        pjob->ji_radix);
       }
     
     if (LOGLEVEL >= 2)
@@ -5591,9 +5793,11 @@ int handle_im_join_job_radix_response(
     {
     if (LOGLEVEL >= 4)
       {
-      sprintf(log_buffer, "%s:joinjob response received from node %s",
+      sprintf(log_buffer, "%s:joinjob response received from node %s after %ld.%06ld seconds",
         __func__,
-        netaddr(pSockAddr));
+        netaddr(pSockAddr),
+        (long)elapsed.tv_sec,
+        (long)elapsed.tv_usec);
       
       log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buffer);
       }
@@ -8844,6 +9048,103 @@ done:
 
 
 
+/*
+ * demux_watch - start waiting for input on sock in the fork_demux() child
+ *
+ * @return 0 on success, -1 on failure
+ */
+
+static int demux_watch(
+
+  int sock)
+
+  {
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = sock;
+
+  return(epoll_ctl(demux_epoll_fd, EPOLL_CTL_ADD, sock, &ev));
+#else
+  if (sock >= FD_SETSIZE)
+    {
+    errno = EMFILE;
+    return(-1);
+    }
+
+  FD_SET(sock, &readset);
+
+  return(0);
+#endif
+  } /* END demux_watch() */
+
+
+
+/*
+ * demux_unwatch - stop waiting for input on sock, call before closing it
+ */
+
+static void demux_unwatch(
+
+  int sock)
+
+  {
+#ifdef HAVE_SYS_EPOLL_H
+  epoll_ctl(demux_epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+#else
+  FD_CLR(sock, &readset);
+#endif
+  } /* END demux_unwatch() */
+
+
+
+/*
+ * demux_wait_ready - wait up to timeout seconds for input on the watched
+ * sockets and place the ones that are readable into ready
+ *
+ * @return the number of ready sockets, 0 on timeout or -1 on failure
+ */
+
+static int demux_wait_ready(
+
+  int               timeout, /* I */
+  std::vector<int> &ready)   /* O */
+
+  {
+  int n;
+
+  ready.clear();
+
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event events[64];
+
+  n = epoll_wait(demux_epoll_fd, events, sizeof(events) / sizeof(events[0]), timeout * 1000);
+
+  for (int i = 0; i < n; i++)
+    ready.push_back(events[i].data.fd);
+#else
+  fd_set         selset = readset;
+  struct timeval tv;
+
+  tv.tv_usec = 0;
+  tv.tv_sec  = timeout;
+
+  n = select(FD_SETSIZE, &selset, (fd_set *)0, (fd_set *)0, &tv);
+
+  for (int i = 0; (i < FD_SETSIZE) && ((int)ready.size() < n); i++)
+    {
+    if (FD_ISSET(i, &selset))
+      ready.push_back(i);
+    }
+#endif
+
+  return(n);
+  } /* END demux_wait_ready() */
+
+
+
 #define READ_BUF_SIZE 1024
 
 int readit(
@@ -8861,16 +9162,15 @@ int readit(
     ret = send(fd, buf, amt, 0);
     if (ret == (size_t) -1)
       {
+      demux_unwatch(sock);
       close(sock);
       close(fd);
-      FD_CLR(sock, &readset);
       }
     }
   else
     {
+    demux_unwatch(sock);
     close(sock);
-
-    FD_CLR(sock, &readset);
     }
 
   return(amt);
@@ -8895,7 +9195,6 @@ void fork_demux(
 
   {
   pid_t             cpid;
-  struct timeval    timeout;
   int               i;
   int               retries;
   int               maxfd;
@@ -8905,7 +9204,7 @@ void fork_demux(
   int               fd2;
   int               im_mom_stdout; 
   int               im_mom_stderr;
-  fd_set            selset;
+  std::vector<int>  ready;
   pid_t             parent;
   u_long            ipaddr;
 	struct sigaction  act;
@@ -9011,9 +9310,26 @@ void fork_demux(
 
   /*  maxfd = sysconf(_SC_OPEN_MAX); */
 
+#ifdef HAVE_SYS_EPOLL_H
+  demux_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+#else
   FD_ZERO(&readset);
-  FD_SET(im_mom_stdout, &readset);
-  FD_SET(im_mom_stderr, &readset);
+#endif
+
+  if ((demux_watch(im_mom_stdout) != 0) ||
+      (demux_watch(im_mom_stderr) != 0))
+    {
+    perror("cannot wait for input on the demux sockets");
+    close(im_mom_stdout);
+    close(im_mom_stderr);
+
+    if (write_ac_socket(pipes[1], "fail", strlen("fail")) < 0)
+      perror(__func__);
+
+    close(pipes[1]);
+
+    _exit(5);
+    }
 
   if (listen(im_mom_stdout, TORQUE_LISTENQUEUE) < 0)
     {
@@ -9094,11 +9410,7 @@ void fork_demux(
   
   while (1)
     {
-    selset = readset;
-    timeout.tv_usec = 0;
-    timeout.tv_sec  = 20;
-    
-    n = select(FD_SETSIZE, &selset, (fd_set *)0, (fd_set *)0, &timeout);
+    n = demux_wait_ready(20, ready);
     
     if (n == -1)
       {
@@ -9108,7 +9420,7 @@ void fork_demux(
         }
       else
         {
-        perror("fork_demux: select failed\n");
+        perror("fork_demux: wait for input failed\n");
         close(im_mom_stdout);
         close(im_mom_stderr);
         close(fd1);
@@ -9131,12 +9443,13 @@ void fork_demux(
       }    /* END else if (n == 0) */
     
     
-    for (i = 0;(n != 0) && (i < maxfd);++i)
+    for (unsigned int r = 0; r < ready.size(); r++)
       {
-      if (FD_ISSET(i, &selset))
+      i = ready[r];
+
+      if ((i >= 0) && (i < maxfd))
         {
         /* this socket has data */
-        n--;
         
         switch (routem[i].r_which)
           {
@@ -9156,12 +9469,17 @@ void fork_demux(
               _exit(5);
               }
             
+            if (demux_watch(newsock) != 0)
+              {
+              perror("cannot wait for input on accepted socket");
+              close(newsock);
+              break;
+              }
+
             routem[newsock].r_which = routem[i].r_which == listen_out ? new_out : new_err;
             routem[newsock].r_fd = newsock;
             open_sockets++;
             
-            FD_SET(newsock, &readset);
-            
             break;
             
           case new_out:
@@ -9274,6 +9592,7 @@ received_node *get_received_node_entry(
     rn->hostname = hostname;
     
     rn->hellos_sent = 0;
+    rn->received_time = time(NULL);
 
     if (LOGLEVEL >= 7)
       {
@@ -9304,6 +9623,7 @@ received_node *get_received_node_entry(
     {
     /* make sure we aren't hold 2 statuses for the same node */
     rn->statuses.clear();
+    rn->received_time = time(NULL);
 
     if (LOGLEVEL >= 10)
       {
@@ -2,6 +2,7 @@
 #define _MOM_COMM_H
 #include "license_pbs.h" /* See here for the software license */
 #include "tm_.h" /* tm_event_t */
+#include "list_link.h" /* tlist_head */
 
 /* Forward declarations */
 struct job;
@@ -48,10 +49,18 @@ void task_saveinfo(struct task *ptask, char *name, void *info, size_t len);
 
 char *resc_string(struct job *pjob);
 
-int contact_sisters(struct job *pjob, tm_event_t parent_event, int sister_count, char *radix_hosts, char *radix_ports);
+int contact_sisters(struct job *pjob, tm_event_t parent_event, int sister_count, tlist_head *attrs);
 
 void send_im_error(int err, int reply, struct job *pjob, char *cookie, tm_event_t event, tm_task_id fromtask);
 
+int send_im_error_addr(int err, struct sockaddr_in *si, int mom_mgr_sock, char *jobid, char *cookie, tm_event_t event, tm_task_id fromtask);
+
+void set_radix_parent(struct job *pjob, char *radix_hosts, char *radix_ports);
+
+void send_join_job_error(int err, struct job *pjob, char *cookie, tm_event_t event, tm_task_id fromtask);
+
+int forward_join_job_radix(struct job *pjob, tm_event_t event, int sister_count, tlist_head *attrs);
+
 int im_join_job_as_sister(struct tcp_chan *chan, char *jobid, struct sockaddr_in *addr, char *cookie, tm_event_t event, int fromtask, int command, int job_radix);
 
 void im_kill_job_as_sister(struct job *pjob, tm_event_t event, unsigned int momport, int radix);
@@ -74,6 +83,8 @@ int im_get_tid(struct job *pjob, char *cookie, tm_event_t event, tm_task_id from
 
 int handle_im_join_job_response(struct tcp_chan *chan, struct job *pjob, struct sockaddr_in *addr);
 
+int handle_im_join_job_radix_error(struct job *pjob, int errcode, struct sockaddr_in *addr);
+
 int handle_im_kill_job_response(struct tcp_chan *chan, struct job *pjob, struct hnodent *np, int event_com, int nodeidx);
 
 int handle_im_spawn_task_response(struct tcp_chan *chan, struct job *pjob, tm_task_id event_task, tm_event_t event);
@@ -0,0 +1,485 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+#include <string>
+#include <vector>
+
+#include "mom_copy.h"
+
+/*
+ * The in-process copy engine used by req_cpyfile() for stage-in and
+ * stage-out files whose source and destination are both reachable from
+ * this host (local paths and $usecp mappings). It replaces one fork and
+ * exec of /bin/cp per file with a kernel side copy, and runs several
+ * copies at once on a small pool of threads so that jobs with many
+ * staged files, or one very large output file on a slow filesystem,
+ * don't hold up the others.
+ *
+ * Only regular files are copied here; directories, symlinks and other
+ * special files are left to "cp -rp". Like "cp -p" the permissions and
+ * timestamps of the source are preserved, and its ownership if we're
+ * allowed to set it.
+ */
+
+#define COPY_CHUNK_SIZE  (1 << 30)
+#define COPY_BUF_SIZE    (64 * 1024)
+
+enum copy_method
+  {
+  COPY_RANGE,
+  COPY_SENDFILE,
+  COPY_READ_WRITE
+  };
+
+typedef struct copy_pool
+  {
+  std::vector<copy_task *> *tasks;
+  size_t                    next;
+  pthread_mutex_t           mutex;
+  } copy_pool;
+
+
+
+/*
+ * can_copy_in_process()
+ *
+ * @return true if src is a regular file that copy_file_in_process() can copy
+ */
+
+bool can_copy_in_process(
+
+  const char *src)
+
+  {
+  struct stat sbuf;
+
+  /* "cp -r" copies symlinks as symlinks, so leave those to it */
+  if (lstat(src, &sbuf) != 0)
+    return(false);
+
+  return(S_ISREG(sbuf.st_mode));
+  } /* END can_copy_in_process() */
+
+
+
+static ssize_t copy_chunk(
+
+  copy_method method,
+  int         in,
+  int         out,
+  char       *buf)
+
+  {
+  ssize_t amt;
+
+  switch (method)
+    {
+    case COPY_RANGE:
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+      return(syscall(SYS_copy_file_range, in, NULL, out, NULL, COPY_CHUNK_SIZE, 0));
+#else
+      errno = ENOSYS;
+      return(-1);
+#endif
+
+    case COPY_SENDFILE:
+
+#ifdef __linux__
+      return(sendfile(out, in, NULL, COPY_CHUNK_SIZE));
+#else
+      errno = ENOSYS;
+      return(-1);
+#endif
+
+    default:
+
+      if ((amt = read(in, buf, COPY_BUF_SIZE)) > 0)
+        {
+        ssize_t written = 0;
+
+        while (written < amt)
+          {
+          ssize_t rc = write(out, buf + written, amt - written);
+
+          if (rc < 0)
+            {
+            if (errno == EINTR)
+              continue;
+
+            return(-1);
+            }
+
+          written += rc;
+          }
+        }
+
+      return(amt);
+    }
+  } /* END copy_chunk() */
+
+
+
+/*
+ * copy_data()
+ *
+ * Copies everything from in to out, starting with copy_file_range() and
+ * falling back to sendfile() and then read()/write() when the kernel or
+ * the filesystems involved don't support the faster call.
+ *
+ * @return 0 on success, else errno
+ */
+
+static int copy_data(
+
+  int   in,
+  int   out,
+  off_t size)
+
+  {
+  copy_method  method = COPY_RANGE;
+  off_t        copied = 0;
+  char        *buf = NULL;
+  int          rc = 0;
+
+  while (true)
+    {
+    ssize_t amt = copy_chunk(method, in, out, buf);
+
+    if (amt > 0)
+      {
+      copied += amt;
+      continue;
+      }
+
+    if (amt < 0)
+      {
+      if (errno == EINTR)
+        continue;
+
+      /* nothing was written by the failed call, so the next method picks up where it stopped */
+      if ((method != COPY_READ_WRITE) &&
+          ((errno == ENOSYS) ||
+           (errno == EXDEV) ||
+           (errno == EINVAL) ||
+           (errno == EOPNOTSUPP) ||
+           (errno == EBADF)))
+        {
+        method = (method == COPY_RANGE) ? COPY_SENDFILE : COPY_READ_WRITE;
+        }
+      else
+        {
+        rc = errno;
+        break;
+        }
+      }
+    else if ((copied == 0) &&
+             (size > 0) &&
+             (method != COPY_READ_WRITE))
+      {
+      /* some filesystems report EOF instead of an error for calls they can't do */
+      method = (method == COPY_RANGE) ? COPY_SENDFILE : COPY_READ_WRITE;
+      }
+    else
+      {
+      /* EOF */
+      break;
+      }
+
+    if ((method == COPY_READ_WRITE) &&
+        (buf == NULL) &&
+        ((buf = (char *)malloc(COPY_BUF_SIZE)) == NULL))
+      {
+      rc = ENOMEM;
+      break;
+      }
+    }
+
+  free(buf);
+
+  return(rc);
+  } /* END copy_data() */
+
+
+
+static int copy_failed(
+
+  std::string &err,
+  const char  *src,
+  const char  *dest,
+  const char  *what,
+  int          rc)
+
+  {
+  char buf[1024];
+
+  snprintf(buf, sizeof(buf), "cannot copy %s to %s: %s failed: %s",
+    src, dest, what, strerror(rc));
+  err = buf;
+
+  return(rc);
+  } /* END copy_failed() */
+
+
+
+/*
+ * copy_file_in_process()
+ *
+ * Copies the regular file src to dest as "cp -p" would. If dest is an
+ * existing directory the file is copied into it under its own name.
+ *
+ * @param src - the file to copy
+ * @param dest - the file or directory to copy it to
+ * @param err - set to a description of the failure
+ * @return 0 on success, else the errno of the failure
+ */
+
+int copy_file_in_process(
+
+  const char  *src,
+  const char  *dest,
+  std::string &err)
+
+  {
+  std::string     target(dest);
+  struct stat     src_stat;
+  struct stat     dest_stat;
+  struct timespec times[2];
+  int             in;
+  int             out;
+  int             rc;
+
+  if ((in = open(src, O_RDONLY | O_CLOEXEC)) < 0)
+    return(copy_failed(err, src, dest, "open", errno));
+
+  if (fstat(in, &src_stat) != 0)
+    {
+    rc = errno;
+    close(in);
+    return(copy_failed(err, src, dest, "stat", rc));
+    }
+
+  if (stat(dest, &dest_stat) == 0)
+    {
+    if (S_ISDIR(dest_stat.st_mode))
+      {
+      const char *base = strrchr(src, '/');
+
+      target += "/";
+      target += (base != NULL) ? base + 1 : src;
+
+      if (stat(target.c_str(), &dest_stat) != 0)
+        dest_stat.st_ino = 0;
+      }
+
+    /* opening the destination would truncate the source */
+    if ((dest_stat.st_ino == src_stat.st_ino) &&
+        (dest_stat.st_dev == src_stat.st_dev))
+      {
+      close(in);
+      err = "cannot copy ";
+      err += src;
+      err += " to ";
+      err += target;
+      err += ": they are the same file";
+      return(EINVAL);
+      }
+    }
+
+  if ((out = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, src_stat.st_mode & 0777)) < 0)
+    {
+    rc = errno;
+    close(in);
+    return(copy_failed(err, src, target.c_str(), "open", rc));
+    }
+
+  if ((rc = copy_data(in, out, src_stat.st_size)) != 0)
+    {
+    close(in);
+    close(out);
+    return(copy_failed(err, src, target.c_str(), "write", rc));
+    }
+
+  close(in);
+
+  /* like cp -p, keep the set-id bits only if the owner could be preserved as well */
+  if (fchown(out, src_stat.st_uid, src_stat.st_gid) != 0)
+    src_stat.st_mode &= ~(S_ISUID | S_ISGID);
+
+  if (fchmod(out, src_stat.st_mode & 07777) != 0)
+    {
+    rc = errno;
+    close(out);
+    return(copy_failed(err, src, target.c_str(), "chmod", rc));
+    }
+
+  times[0] = src_stat.st_atim;
+  times[1] = src_stat.st_mtim;
+
+  if (futimens(out, times) != 0)
+    {
+    rc = errno;
+    close(out);
+    return(copy_failed(err, src, target.c_str(), "set times", rc));
+    }
+
+  /* network filesystems may only report write errors here */
+  if (close(out) != 0)
+    return(copy_failed(err, src, target.c_str(), "close", errno));
+
+  return(0);
+  } /* END copy_file_in_process() */
+
+
+
+/*
+ * is_permanent_copy_error()
+ *
+ * @return true if retrying a copy that failed with rc can't help
+ */
+
+static bool is_permanent_copy_error(
+
+  int rc)
+
+  {
+  switch (rc)
+    {
+    case ENOENT:
+    case ENOTDIR:
+    case EISDIR:
+    case EACCES:
+    case EPERM:
+    case EROFS:
+    case ENAMETOOLONG:
+    case ELOOP:
+    case EINVAL:
+
+      return(true);
+
+    default:
+
+      return(false);
+    }
+  } /* END is_permanent_copy_error() */
+
+
+
+/*
+ * run_copy_task()
+ *
+ * Copies task's file, retrying like sys_copy() does
+ */
+
+static void run_copy_task(
+
+  copy_task *task)
+
+  {
+  for (task->attempts = 1; ; task->attempts++)
+    {
+    task->err.clear();
+
+    if ((task->rc = copy_file_in_process(task->src.c_str(), task->dest.c_str(), task->err)) == 0)
+      break;
+
+    if ((task->attempts >= COPY_ATTEMPTS) ||
+        (is_permanent_copy_error(task->rc)))
+      break;
+
+    if ((task->attempts % 2) == 0)
+      sleep(task->attempts / 2 * 3 + 1);
+    }
+  } /* END run_copy_task() */
+
+
+
+static void *copy_worker(
+
+  void *vp)
+
+  {
+  copy_pool *pool = (copy_pool *)vp;
+  copy_task *task;
+
+  while (true)
+    {
+    pthread_mutex_lock(&pool->mutex);
+
+    if (pool->next >= pool->tasks->size())
+      {
+      pthread_mutex_unlock(&pool->mutex);
+      break;
+      }
+
+    task = (*pool->tasks)[pool->next++];
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    run_copy_task(task);
+    }
+
+  return(NULL);
+  } /* END copy_worker() */
+
+
+
+/*
+ * run_copy_tasks()
+ *
+ * Copies every task's file using up to max_threads threads, including
+ * the calling thread, and returns once all of them are done. The outcome
+ * of each copy is left in its task.
+ *
+ * @param tasks - the copies to make
+ * @param max_threads - the most copies to run at once
+ */
+
+void run_copy_tasks(
+
+  std::vector<copy_task *> &tasks,
+  int                       max_threads)
+
+  {
+  std::vector<pthread_t> workers;
+  copy_pool              pool;
+  size_t                 nthreads = (max_threads > 1) ? max_threads : 1;
+
+  if (nthreads > tasks.size())
+    nthreads = tasks.size();
+
+  pool.tasks = &tasks;
+  pool.next = 0;
+  pthread_mutex_init(&pool.mutex, NULL);
+
+  for (size_t i = 1; i < nthreads; i++)
+    {
+    pthread_t tid;
+
+    /* if we can't start a worker, the ones we have share the load */
+    if (pthread_create(&tid, NULL, copy_worker, &pool) != 0)
+      break;
+
+    workers.push_back(tid);
+    }
+
+  copy_worker(&pool);
+
+  for (size_t i = 0; i < workers.size(); i++)
+    pthread_join(workers[i], NULL);
+
+  pthread_mutex_destroy(&pool.mutex);
+  } /* END run_copy_tasks() */
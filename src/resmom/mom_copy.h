@@ -0,0 +1,26 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _MOM_COPY_H
+#define _MOM_COPY_H
+
+#include <string>
+#include <vector>
+
+#define COPY_ATTEMPTS 3
+
+typedef struct copy_task
+  {
+  std::string src;
+  std::string dest;
+  int         rc;       /* 0 on success, else the errno of the last attempt */
+  int         attempts;
+  std::string err;      /* description of the last failure */
+  } copy_task;
+
+/* mom_copy.c */
+bool can_copy_in_process(const char *src);
+
+int  copy_file_in_process(const char *src, const char *dest, std::string &err);
+
+void run_copy_tasks(std::vector<copy_task *> &tasks, int max_threads);
+
+#endif /* _MOM_COPY_H */
@@ -455,6 +455,7 @@ const char *PBSServerCmds[] =
   "UPDATE",
   "STATUS",
   "GPU_STATUS",
+  "STATUS_DELTA",
   NULL
   };
 
@@ -860,21 +861,8 @@ void check_log(void)
       }
     }
 
-  if (log_file_max_size <= 0)
-    {
-    return;
-    }
-
-  if (log_size() >= log_file_max_size)
-    {
-    log_event(
-      PBSEVENT_SYSTEM | PBSEVENT_FORCE,
-      PBS_EVENTCLASS_SERVER,
-      msg_daemonname,
-      "Rolling log file");
-
-    log_roll(log_file_roll_depth);
-    }
+  /* the log writer rolls the log once it reaches log_file_max_size */
+  log_set_roll_limits(log_file_max_size, log_file_roll_depth);
 
   return;
   }  /* END check_log() */
@@ -4963,6 +4951,7 @@ int setup_program_environment(void)
 #endif  /* __CYGWIN__ */
 
   init_resc_defs();
+  index_attr_defs(job_attr_def, JOB_ATR_LAST);
 
   c |= mom_checkpoint_init();
 
@@ -7107,6 +7096,10 @@ int main(
     return -1;
     }
 
+  /* started here, after mom has daemonized, so the writer thread isn't lost in the fork */
+  if (log_async_init() != PBSE_NONE)
+    log_err(-1, __func__, "could not start the log writer thread, logging synchronously");
+
 #ifdef MIC
   check_for_mics(global_mic_count);
 #endif
@@ -239,6 +239,7 @@
 #include "lib_ifl.h" /* pbs_disconnect_socket */
 #include "alps_functions.h"
 #include "../lib/Libnet/lib_net.h" /* netaddr */
+#include "../lib/Libutils/lib_utils.h" /* get_status_delta */
 #include "net_cache.h"
 #include "mom_config.h"
 #include "mom_func.h"
@@ -538,6 +539,10 @@ int mom_server_add(
     pms->sock_addr.sin_family = AF_INET;
     pms->sock_addr.sin_port = htons(port);
 
+    pms->status_generation = 0;
+    pms->status_delta_retry = 0;
+    pms->acked_status.clear();
+
     mom_server_count++;
 
     sprintf(log_buffer, "server %s added", pms->pbs_servername);
@@ -1399,6 +1404,319 @@ int write_cached_statuses(
 
 
 
+/*
+ * write_cached_status_batch()
+ *
+ * Sends the statuses received from other moms to the server as a single
+ * compressed batch (see write_status_batch()) instead of one DIS string per
+ * status line. Each entry carries how long it waited here so the server can
+ * measure fan-in latency.
+ */
+
+int write_cached_status_batch(
+
+  struct tcp_chan *chan,
+  mom_server      *pms)
+
+  {
+  std::vector<status_batch_entry>                            entries;
+  container::item_container<received_node *>::item_iterator *iter;
+  received_node                                             *rn;
+  time_t                                                     now = time(NULL);
+  int                                                        ret;
+
+  received_statuses.lock();
+  iter = received_statuses.get_iterator();
+
+  while ((rn = iter->get_next_item()) != NULL)
+    {
+    if (rn->statuses.size() == 0)
+      continue;
+
+    entries.push_back(status_batch_entry());
+    entries.back().age = (now > rn->received_time) ? now - rn->received_time : 0;
+    entries.back().statuses.swap(rn->statuses);
+    }
+
+  delete iter;
+  received_statuses.unlock();
+
+  if ((LOGLEVEL >= 7) &&
+      (entries.size() > 0))
+    {
+    snprintf(log_buffer, sizeof(log_buffer),
+      "sending %u cached statuses to server %s in one batch",
+      (unsigned int)entries.size(), pms->pbs_servername);
+    log_record(PBSEVENT_SYSTEM, 0, __func__, log_buffer);
+    }
+
+  if ((ret = write_status_batch(chan, entries)) != DIS_SUCCESS)
+    mom_server_stream_error(chan->sock, pms->pbs_servername, __func__, "writing status batch");
+
+  return(ret);
+  } /* END write_cached_status_batch() */
+
+
+
+
+
+/*
+ * build_delta_status()
+ *
+ * Builds the status that deltas are computed over: the strings that
+ * write_update_header() would send followed by strings.
+ *
+ * @param current - set to the complete status
+ * @param strings - this mom's status strings
+ * @return true if the status asks the server for the cluster addresses
+ */
+
+bool build_delta_status(
+
+  std::vector<std::string> &current, /* O */
+  std::vector<std::string> &strings) /* I */
+
+  {
+  bool requested = false;
+
+  current.clear();
+  current.push_back(std::string("node=") + mom_alias);
+
+  if (should_request_cluster_addrs() == TRUE)
+    {
+    current.push_back("first_update=true");
+    requested = true;
+    }
+
+  current.insert(current.end(), strings.begin(), strings.end());
+
+  return(requested);
+  } /* END build_delta_status() */
+
+
+
+/*
+ * write_status_delta()
+ *
+ * Writes an IS_STATUS_DELTA message with the positions of current that
+ * differ from the status the server last acknowledged, or all of them if
+ * full is true.
+ *
+ *   Format
+ *
+ *   Protocol | Version | Command (IS_STATUS_DELTA) | mom service port | mom manager port
+ *   | delta version | base generation (0 = none) | new generation | status count
+ *   | changed count | changed count * (index | string)
+ *
+ * send_status_message() follows this with the statuses cached from other
+ * moms as a status batch and then IS_EOL_MESSAGE.
+ */
+
+int write_status_delta(
+
+  struct tcp_chan                *chan,
+  mom_server                     *pms,
+  const std::vector<std::string> &current,
+  bool                            full)
+
+  {
+  int                       ret;
+  std::vector<unsigned int> changed;
+
+  if (full == true)
+    {
+    for (unsigned int i = 0; i < current.size(); i++)
+      changed.push_back(i);
+    }
+  else
+    get_status_delta(pms->acked_status, current, changed);
+
+  if (LOGLEVEL >= 7)
+    {
+    snprintf(log_buffer, sizeof(log_buffer),
+      "sending %u of %u status strings to server %s",
+      (unsigned int)changed.size(), (unsigned int)current.size(), pms->pbs_servername);
+    log_record(PBSEVENT_SYSTEM, 0, __func__, log_buffer);
+    }
+
+  if (((ret = is_compose(chan, pms->pbs_servername, IS_STATUS_DELTA)) != DIS_SUCCESS) ||
+      ((ret = diswus(chan, pbs_mom_port)) != DIS_SUCCESS) ||
+      ((ret = diswus(chan, pbs_rm_port)) != DIS_SUCCESS) ||
+      ((ret = diswui(chan, IS_STATUS_DELTA_VER)) != DIS_SUCCESS) ||
+      ((ret = diswul(chan, (full == true) ? 0 : pms->status_generation)) != DIS_SUCCESS) ||
+      ((ret = diswul(chan, pms->status_generation + 1)) != DIS_SUCCESS) ||
+      ((ret = diswui(chan, current.size())) != DIS_SUCCESS) ||
+      ((ret = diswui(chan, changed.size())) != DIS_SUCCESS))
+    {
+    mom_server_stream_error(chan->sock, pms->pbs_servername, __func__, "writing status delta");
+    return(ret);
+    }
+
+  for (unsigned int i = 0; i < changed.size(); i++)
+    {
+    if (((ret = diswui(chan, changed[i])) != DIS_SUCCESS) ||
+        ((ret = diswst(chan, current[changed[i]].c_str())) != DIS_SUCCESS))
+      {
+      mom_server_stream_error(chan->sock, pms->pbs_servername, __func__, "writing status string");
+      break;
+      }
+    }
+
+  return(ret);
+  } /* END write_status_delta() */
+
+
+
+/*
+ * send_status_message()
+ *
+ * Connects to the server and sends one status update: a delta over current
+ * if current isn't NULL, otherwise the legacy IS_STATUS message.
+ *
+ * @param ret - set to the DIS error or the server's reply
+ * @return PBSE_NONE if the server was contacted, COULD_NOT_CONTACT_SERVER otherwise
+ */
+
+int send_status_message(
+
+  mom_server                     *pms,      /* I */
+  std::vector<std::string>       &strings,  /* I */
+  const std::vector<std::string> *current,  /* I */
+  bool                            full,     /* I */
+  int                            &ret)      /* O */
+
+  {
+  int              stream;
+  struct tcp_chan *chan = NULL;
+
+  ret = -1;
+
+  stream = tcp_connect_sockaddr((struct sockaddr *)&pms->sock_addr, sizeof(pms->sock_addr), false);
+
+  if (!IS_VALID_STREAM(stream))
+    return(COULD_NOT_CONTACT_SERVER);
+
+  if ((chan = DIS_tcp_setup(stream)) == NULL)
+    {
+    }
+  else if (current != NULL)
+    ret = write_status_delta(chan, pms, *current, full);
+  else if ((ret = write_update_header(chan, __func__, pms->pbs_servername)) == DIS_SUCCESS)
+    ret = write_my_server_status(chan, __func__, strings, pms, UPDATE_TO_SERVER);
+
+  if (ret != DIS_SUCCESS)
+    {
+    }
+  else if (current != NULL)
+    {
+    ret = write_cached_status_batch(chan, pms);
+    }
+  else
+    {
+    ret = write_cached_statuses(chan, __func__, pms, UPDATE_TO_SERVER);
+    }
+
+  if (ret != DIS_SUCCESS)
+    {
+    }
+  else if ((ret = diswst(chan, IS_EOL_MESSAGE)) != DIS_SUCCESS)
+    {
+    }
+  else if ((ret = DIS_tcp_wflush(chan)) != DIS_SUCCESS)
+    {
+    }
+  else
+    {
+    read_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER,
+      (current != NULL) ? IS_STATUS_DELTA : IS_STATUS, &ret);
+    }
+
+  if (chan != NULL)
+    DIS_tcp_cleanup(chan);
+
+  close(stream);
+
+  return(PBSE_NONE);
+  } /* END send_status_message() */
+
+
+
+/*
+ * send_status_delta()
+ *
+ * Sends the status as a delta against the last one the server acknowledged.
+ * A server that has lost our base gets a full status; one that doesn't
+ * understand deltas gets the legacy message and isn't sent deltas again
+ * for STATUS_DELTA_RETRY_INTERVAL.
+ */
+
+int send_status_delta(
+
+  mom_server               *pms,     /* M */
+  std::vector<std::string> &strings, /* I */
+  int                      &ret)     /* O */
+
+  {
+  std::vector<std::string> current;
+  bool                     requested = build_delta_status(current, strings);
+  bool                     full = (pms->status_generation == 0) ||
+                                  (time_now - pms->last_full_status >= STATUS_FULL_REFRESH_INTERVAL);
+  int                      rc;
+
+  rc = send_status_message(pms, strings, &current, full, ret);
+
+  if ((rc == PBSE_NONE) &&
+      (ret == IS_STATUS_BASE_UNKNOWN) &&
+      (full == false))
+    {
+    if (LOGLEVEL >= 3)
+      {
+      snprintf(log_buffer, sizeof(log_buffer),
+        "server %s needs a full status", pms->pbs_servername);
+      log_record(PBSEVENT_SYSTEM, 0, __func__, log_buffer);
+      }
+
+    full = true;
+    rc = send_status_message(pms, strings, &current, full, ret);
+    }
+
+  if (rc != PBSE_NONE)
+    return(rc);
+
+  if (ret == DIS_SUCCESS)
+    {
+    pms->status_generation++;
+    pms->acked_status.swap(current);
+
+    if (full == true)
+      pms->last_full_status = time_now;
+
+    if (requested == true)
+      requested_cluster_addrs = time_now;
+    }
+  else
+    {
+    pms->status_generation = 0;
+    pms->acked_status.clear();
+
+    if (ret == UNREAD_STATUS)
+      {
+      /* servers that don't know IS_STATUS_DELTA close the connection */
+      snprintf(log_buffer, sizeof(log_buffer),
+        "server %s didn't answer a status delta, sending a full status instead",
+        pms->pbs_servername);
+      log_record(PBSEVENT_SYSTEM, 0, __func__, log_buffer);
+
+      pms->status_delta_retry = time_now + STATUS_DELTA_RETRY_INTERVAL;
+
+      rc = send_status_message(pms, strings, NULL, true, ret);
+      }
+    }
+
+  return(rc);
+  } /* END send_status_delta() */
+
+
 
 /**
  * mom_server_update_stat
@@ -1417,10 +1735,8 @@ int mom_server_update_stat(
   std::vector<std::string> &strings)
  
   {
-  int              stream;
   int              ret = -1;
-  int              rc  = COULD_NOT_CONTACT_SERVER;
-  struct tcp_chan *chan = NULL;
+  int              rc;
 
   if ((pms->pbs_servername[0] == '\0') ||
       (time_now < (pms->MOMLastSendToServerTime + get_stat_update_interval())))
@@ -1430,38 +1746,18 @@ int mom_server_update_stat(
     return(NO_SERVER_CONFIGURED);
     }
 
-  stream = tcp_connect_sockaddr((struct sockaddr *)&pms->sock_addr, sizeof(pms->sock_addr), false);
+#ifndef NUMA_SUPPORT
+  if ((is_reporter_mom == FALSE) &&
+      (time_now >= pms->status_delta_retry))
+    rc = send_status_delta(pms, strings, ret);
+  else
+#endif
+    rc = send_status_message(pms, strings, NULL, true, ret);
  
-  if (IS_VALID_STREAM(stream))
+  if (rc == PBSE_NONE)
     {
-    if ((chan = DIS_tcp_setup(stream)) == NULL)
-      {
-      }
-    else if ((ret = write_update_header(chan, __func__, pms->pbs_servername)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = write_my_server_status(chan, __func__, strings, pms, UPDATE_TO_SERVER)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = write_cached_statuses(chan, __func__, pms, UPDATE_TO_SERVER)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = diswst(chan, IS_EOL_MESSAGE)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = DIS_tcp_wflush(chan)) != DIS_SUCCESS)
-      {
-      }
-    else
-      {
-      read_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER, IS_STATUS, &ret);
-      }
+    rc = COULD_NOT_CONTACT_SERVER;
 
-    if (chan != NULL)
-      DIS_tcp_cleanup(chan);
-      
-    close(stream);
-  
     if (ret != DIS_SUCCESS)
       {
 
@@ -1516,7 +1812,7 @@ int mom_server_update_stat(
       
       UpdateFailCount = 0;
       }
-    } /* END if valid stream */
+    } /* END if contacted */
   else
     {
     UpdateFailCount++;
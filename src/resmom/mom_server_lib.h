@@ -78,6 +78,8 @@ int write_my_server_status(struct tcp_chan *chan, const char *id, char *status_s
 
 int write_cached_statuses(struct tcp_chan *chan, const char *id, void *dest, int mode);
 
+int write_cached_status_batch(struct tcp_chan *chan, mom_server *pms);
+
 void node_comm_error(node_comm_t *nc, const char *message);
 
 int write_status_strings(char *stat_str, node_comm_t *nc);
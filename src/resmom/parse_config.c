@@ -166,6 +166,8 @@ char             MOMConfigVersion[64];
 int              MOMConfigDownOnError      = 0;
 int              MOMConfigRestart          = 0;
 int              MOMCudaVisibleDevices     = 1;
+int              MOMCgroupSampling         = 1;  /* sample jobs from their cgroups instead of all of /proc */
+int              MOMPipelinedRadixLaunch   = 0;  /* forward job_radix joins before setting the job up locally */
 double           wallfactor = 1.00;
 std::vector<cphosts> pcphosts;
 long             pe_alarm_time = PBS_PROLOG_TIME;
@@ -188,6 +190,7 @@ short            memory_pressure_duration  = 0; /* 0: off, >0: check and kill */
 int              max_join_job_wait_time = MAX_JOIN_WAIT_TIME;
 int              resend_join_job_wait_time = RESEND_WAIT_TIME;
 int              mom_hierarchy_retry_time = NODE_COMM_RETRY_TIME;
+int              stage_copy_threads = DEFAULT_STAGE_COPY_THREADS;
 std::string      presetup_prologue;
 
 
@@ -298,6 +301,9 @@ unsigned long setresendjoinjobwaittime(const char *);
 unsigned long setmomhierarchyretrytime(const char *);
 unsigned long setjobdirectorysticky(const char *);
 unsigned long setcudavisibledevices(const char *);
+unsigned long setcgroupsampling(const char *);
+unsigned long setpipelinedradixlaunch(const char *);
+unsigned long setstagecopythreads(const char *);
 unsigned long set_presetup_prologue(const char *);
 
 struct specials special[] = {
@@ -382,6 +388,9 @@ struct specials special[] = {
   { "mom_hierarchy_retry_time",  setmomhierarchyretrytime},
   { "jobdirectory_sticky", setjobdirectorysticky},
   { "cuda_visible_devices", setcudavisibledevices},
+  { "cgroup_sampling",      setcgroupsampling},
+  { "pipelined_radix_launch", setpipelinedradixlaunch},
+  { "stage_copy_threads",   setstagecopythreads},
   { "cray_check_rur",       setrur },
   { "presetup_prologue",    set_presetup_prologue},
   { NULL,                  NULL }
@@ -2288,6 +2297,8 @@ void reset_config_vars()
   MOMConfigDownOnError = 0;
   MOMConfigRestart = 0;
   MOMCudaVisibleDevices = 1;
+  MOMCgroupSampling = 1;
+  MOMPipelinedRadixLaunch = 0;
   wallfactor = 1.00;
   pcphosts.clear();
   pe_alarm_time = PBS_PROLOG_TIME;
@@ -2307,6 +2318,7 @@ void reset_config_vars()
   max_join_job_wait_time = MAX_JOIN_WAIT_TIME;
   resend_join_job_wait_time = RESEND_WAIT_TIME;
   mom_hierarchy_retry_time = NODE_COMM_RETRY_TIME;
+  stage_copy_threads = DEFAULT_STAGE_COPY_THREADS;
   LOGLEVEL = 0;
   
   // Clear varattrs
@@ -3319,3 +3331,72 @@ u_long setcudavisibledevices(
   return(1);
   }  /* END setcudavisibledevices() */
 
+
+
+u_long setcgroupsampling(
+
+  const char *value)  /* I */
+
+  {
+  int enable;
+
+  log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, value);
+
+  if ((enable = setbool(value)) != -1)
+    MOMCgroupSampling = enable;
+
+  return(1);
+  }  /* END setcgroupsampling() */
+
+
+
+u_long setpipelinedradixlaunch(
+
+  const char *value)  /* I */
+
+  {
+  int enable;
+
+  log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, value);
+
+  if ((enable = setbool(value)) != -1)
+    MOMPipelinedRadixLaunch = enable;
+
+  return(1);
+  }  /* END setpipelinedradixlaunch() */
+
+
+
+/*
+ * setstagecopythreads()
+ *
+ * Sets how many staged files req_cpyfile() copies at once without /bin/cp.
+ * 0 sends every copy through /bin/cp (or rcp/scp), one file at a time.
+ */
+
+unsigned long setstagecopythreads(
+
+  const char *value)  /* I */
+
+  {
+  char *end;
+  long  tmp;
+
+  log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, value);
+
+  if (value == NULL)
+    return(0);
+
+  tmp = strtol(value, &end, 10);
+
+  if ((end == value) ||
+      (*end != '\0') ||
+      (tmp < 0) ||
+      (tmp > MAX_STAGE_COPY_THREADS))
+    return(0);
+
+  stage_copy_threads = tmp;
+
+  return(1);
+  }  /* END setstagecopythreads() */
+
@@ -102,6 +102,10 @@
 #if defined(FD_SET_IN_SYS_SELECT_H)
 #  include <sys/select.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+#include <vector>
 #include "lib_ifl.h"
 #include "pbs_helper.h"
 
@@ -114,7 +118,110 @@ struct routem
   short  r_nl;
   };
 
+#ifdef HAVE_SYS_EPOLL_H
+/* sockets aren't capped at FD_SETSIZE with epoll */
+static int epoll_fd = -1;
+#else
 fd_set readset;
+#endif
+
+
+
+/*
+ * watch_sock - start waiting for input on sock
+ *
+ * @return 0 on success, -1 on failure
+ */
+
+static int watch_sock(
+
+  int sock)
+
+  {
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = sock;
+
+  return(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev));
+#else
+  if (sock >= FD_SETSIZE)
+    {
+    errno = EMFILE;
+    return(-1);
+    }
+
+  FD_SET(sock, &readset);
+
+  return(0);
+#endif
+  }  /* END watch_sock() */
+
+
+
+/*
+ * unwatch_sock - stop waiting for input on sock, call before closing it
+ */
+
+static void unwatch_sock(
+
+  int sock)
+
+  {
+#ifdef HAVE_SYS_EPOLL_H
+  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+#else
+  FD_CLR(sock, &readset);
+#endif
+  }  /* END unwatch_sock() */
+
+
+
+/*
+ * wait_ready - wait up to timeout seconds for input on the watched sockets
+ * and place the ones that are readable into ready
+ *
+ * @return the number of ready sockets, 0 on timeout or -1 on failure
+ */
+
+static int wait_ready(
+
+  int               timeout, /* I */
+  std::vector<int> &ready)   /* O */
+
+  {
+  int n;
+
+  ready.clear();
+
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event events[64];
+
+  n = epoll_wait(epoll_fd, events, sizeof(events) / sizeof(events[0]), timeout * 1000);
+
+  for (int i = 0; i < n; i++)
+    ready.push_back(events[i].data.fd);
+#else
+  fd_set         selset = readset;
+  struct timeval tv;
+
+  tv.tv_usec = 0;
+  tv.tv_sec  = timeout;
+
+  n = select(FD_SETSIZE, &selset, (fd_set *)0, (fd_set *)0, &tv);
+
+  for (int i = 0; (i < FD_SETSIZE) && ((int)ready.size() < n); i++)
+    {
+    if (FD_ISSET(i, &selset))
+      ready.push_back(i);
+    }
+#endif
+
+  return(n);
+  }  /* END wait_ready() */
+
 
 
 void readit(
@@ -165,11 +272,11 @@ void readit(
     }
   else
     {
+    unwatch_sock(sock);
+
     close(sock);
 
     prm->r_where = invalid;
-
-    FD_CLR(sock, &readset);
     }
 
   return;
@@ -193,7 +300,6 @@ int main(
   char *argv[])
 
   {
-  struct timeval timeout;
   int i;
   int maxfd;
   int main_sock_out = 3;
@@ -201,7 +307,7 @@ int main(
   int n;
   int newsock;
   pid_t parent;
-  fd_set selset;
+  std::vector<int> ready;
 
   struct routem *routem;
 
@@ -261,9 +367,19 @@ int main(
   routem[main_sock_out].r_where = new_out;
   routem[main_sock_err].r_where = new_err;
 
+#ifdef HAVE_SYS_EPOLL_H
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+#else
   FD_ZERO(&readset);
-  FD_SET(main_sock_out, &readset);
-  FD_SET(main_sock_err, &readset);
+#endif
+
+  if ((watch_sock(main_sock_out) != 0) ||
+      (watch_sock(main_sock_err) != 0))
+    {
+    perror("cannot wait for input");
+
+    exit(5);
+    }
 
   if (listen(main_sock_out, TORQUE_LISTENQUEUE) < 0)
     {
@@ -281,11 +397,7 @@ int main(
 
   while (1)
     {
-    selset = readset;
-    timeout.tv_usec = 0;
-    timeout.tv_sec  = 10;
-
-    n = select(FD_SETSIZE, &selset, (fd_set *)0, (fd_set *)0, &timeout);
+    n = wait_ready(10, ready);
 
     if (n == -1)
       {
@@ -295,7 +407,7 @@ int main(
         }
       else
         {
-        fprintf(stderr, "%s: select failed\n",
+        fprintf(stderr, "%s: wait for input failed\n",
           argv[0]);
 
         exit(1);
@@ -316,12 +428,13 @@ int main(
         }
       }    /* END else if (n == 0) */
 
-    for (i = 0;(n != 0) && (i < maxfd);++i)
+    for (unsigned int r = 0; r < ready.size(); r++)
       {
-      if (FD_ISSET(i, &selset))
+      i = ready[r];
+
+      if ((i >= 0) && (i < maxfd))
         {
         /* this socket has data */
-        n--;
 
         switch ((routem + i)->r_where)
           {
@@ -332,12 +445,25 @@ int main(
 
             newsock = accept(i, 0, 0);
 
+            if ((newsock < 0) || (newsock >= maxfd))
+              {
+              if (newsock >= 0)
+                close(newsock);
+
+              break;
+              }
+
+            if (watch_sock(newsock) != 0)
+              {
+              close(newsock);
+
+              break;
+              }
+
             (routem + newsock)->r_where = (routem + i)->r_where == new_out ?
             old_out :
             old_err;
 
-            FD_SET(newsock, &readset);
-
             break;
 
           case old_out:
@@ -119,6 +119,7 @@
 #include "alps_functions.h"
 #include "tcp.h" /* tcp_chan */
 #include "mom_config.h"
+#include "mom_copy.h"
 #include "power_state.hpp"
 #ifdef USE_RESOURCE_PLUGIN
 #include "plugin_internal.h"
@@ -3462,28 +3463,41 @@ void copy_file_cleanup(
 
 
 
+/* a local copy req_cpyfile() hands to the in-process copy engine */
+typedef struct local_copy
+  {
+  copy_task       task;
+  struct rqfpair *pair;
+  bool            from_spool;
+  std::string     localname;
+  } local_copy;
+
+
+
 /*
- * copy_and_process()
+ * process_copy_result()
  *
- * We have a lot of error processing around the call to sys_copy(). As a result, we move
- * it all into this function
+ * Reports a failed copy in bad_list, or removes the local copy of a file
+ * that was staged out successfully.
+ *
+ * @param rc - the result of the copy
+ * @param copy_err - the reason the copy failed, or NULL to take it from rcperr
+ * @return rc, or PBSE_NONE
  */
 
-int copy_and_process(
-    
-  bool  rmtflag,
-  char  *src,
-  char  *dest,
-  int    conn,
-  int    dir,
-  char  *localname,
-  char **bad_list,
-  int   &bad_files)
+int process_copy_result(
 
-  {
-  int rc;
+  int          rc,
+  const char  *copy_err,
+  const char  *src,
+  const char  *dest,
+  int          dir,
+  char        *localname,
+  char       **bad_list,
+  int         &bad_files)
 
-  if ((rc = sys_copy(rmtflag, src, dest, conn)) != 0)
+  {
+  if (rc != 0)
     {
     FILE *fp;
 
@@ -3500,9 +3514,16 @@ int copy_and_process(
 
     log_err(-1, __func__, log_buffer);
 
+    if (copy_err != NULL)
+      {
+      add_bad_list(bad_list, (char *)"*** error from copy", 1);
+      add_bad_list(bad_list, (char *)copy_err, 1);
+      add_bad_list(bad_list, (char *)"*** end error output", 1);
+      }
+
     /* copy message from rcp as well */
 
-    if ((fp = fopen(rcperr, "r")) != NULL)
+    else if ((fp = fopen(rcperr, "r")) != NULL)
       {
       add_bad_list(bad_list, (char *)"*** error from copy", 1);
 
@@ -3520,7 +3541,7 @@ int copy_and_process(
 
       add_bad_list(bad_list, (char *)"*** end error output", 1);
       }
-    } /* END if ((rc = sys_copy(...)) != 0) */
+    } /* END if (rc != 0) */
   else
     {
     /* Copy in/out succeeded */
@@ -3588,10 +3609,105 @@ int copy_and_process(
     }
 
   return(rc);
+  } // END process_copy_result()
+
+
+
+/*
+ * copy_and_process()
+ *
+ * We have a lot of error processing around the call to sys_copy(). As a result, we move
+ * it all into this function
+ */
+
+int copy_and_process(
+    
+  bool  rmtflag,
+  char  *src,
+  char  *dest,
+  int    conn,
+  int    dir,
+  char  *localname,
+  char **bad_list,
+  int   &bad_files)
+
+  {
+  int rc = sys_copy(rmtflag, src, dest, conn);
+
+  return(process_copy_result(rc, NULL, src, dest, dir, localname, bad_list, bad_files));
   } // END copy_and_process()
 
 
 
+/*
+ * run_local_copies()
+ *
+ * Makes the local copies req_cpyfile() has deferred, several at a time, and
+ * then reports on each of them in the order they were requested.
+ *
+ * @return PBSE_NONE if every copy succeeded, else COPY_FILE_FAIL
+ */
+
+int run_local_copies(
+
+  std::vector<local_copy> &copies,
+  int                      dir,
+  batch_request           *preq,
+  char                   **bad_list,
+  int                     &bad_files)
+
+  {
+  std::vector<copy_task *> tasks;
+  char                     localname[MAXPATHLEN + 1];
+  int                      rc = PBSE_NONE;
+
+  for (size_t i = 0; i < copies.size(); i++)
+    tasks.push_back(&copies[i].task);
+
+  run_copy_tasks(tasks, stage_copy_threads);
+
+  for (size_t i = 0; i < copies.size(); i++)
+    {
+    local_copy &lc = copies[i];
+
+    snprintf(localname, sizeof(localname), "%s", lc.localname.c_str());
+
+    if (LOGLEVEL >= 6)
+      {
+      snprintf(log_buffer, sizeof(log_buffer), "copied %s to %s in process: rc=%d, %d attempt(s)",
+        lc.task.src.c_str(),
+        lc.task.dest.c_str(),
+        lc.task.rc,
+        lc.task.attempts);
+
+      log_ext(-1, __func__, log_buffer, LOG_DEBUG);
+      }
+
+    if (process_copy_result(lc.task.rc,
+                            lc.task.err.c_str(),
+                            lc.task.src.c_str(),
+                            lc.task.dest.c_str(),
+                            dir,
+                            localname,
+                            bad_list,
+                            bad_files) == PBSE_NONE)
+      continue;
+
+    /* stage-in cleanup removes all of the request's files, so only do it once */
+    if ((rc == PBSE_NONE) ||
+        ((dir != STAGE_DIR_IN) && (dir != CKPT_DIR_IN)))
+      copy_file_cleanup(dir, lc.from_spool, preq, lc.pair, localname, sizeof(localname), bad_list);
+
+    rc = COPY_FILE_FAIL;
+    }
+
+  copies.clear();
+
+  return(rc);
+  } // END run_local_copies()
+
+
+
 /*
  * determine_spooldir()
  *
@@ -3723,6 +3839,7 @@ void req_cpyfile(
   int             rc;
   int             exitcode = 0;
   bool            rmtflag = false;
+  std::vector<local_copy> local_copies;
 
 #ifdef  _CRAY
   char            tmpdirname[MAXPATHLEN + 1];
@@ -4063,6 +4180,10 @@ void req_cpyfile(
       if (bad_list != NULL)
         bad_files = 1;
 
+      if ((local_copies.size() > 0) &&
+          (run_local_copies(local_copies, dir, preq, &bad_list, bad_files) != PBSE_NONE))
+        exitcode = COPY_FILE_FAIL;
+
       copy_file_cleanup(dir, from_spool, preq, pair, localname, sizeof(localname), &bad_list);
 
       break;
@@ -4100,6 +4221,26 @@ void req_cpyfile(
         continue;
         }
 
+      if ((rmtflag == false) &&
+          (stage_copy_threads > 0) &&
+          (can_copy_in_process(arg2)))
+        {
+        /* copied along with the request's other local files once they're all known */
+        local_copy lc;
+
+        lc.task.src = arg2;
+        lc.task.dest = arg3;
+        lc.task.rc = 0;
+        lc.task.attempts = 0;
+        lc.pair = pair;
+        lc.from_spool = from_spool;
+        lc.localname = localname;
+
+        local_copies.push_back(lc);
+
+        continue;
+        }
+
       if ((rc = copy_and_process(rmtflag,
                                  arg2,
                                  arg3,
@@ -4109,6 +4250,10 @@ void req_cpyfile(
                                  &bad_list,
                                  bad_files)) != PBSE_NONE)
         {
+        /* the local copies requested before this one would have been made first */
+        if (local_copies.size() > 0)
+          run_local_copies(local_copies, dir, preq, &bad_list, bad_files);
+
         copy_file_cleanup(dir, from_spool, preq, pair, localname, sizeof(localname), &bad_list);
         exitcode = COPY_FILE_FAIL;
 
@@ -4119,6 +4264,10 @@ void req_cpyfile(
       } // END for each source
     }  /* END for (pair) */
 
+  if ((local_copies.size() > 0) &&
+      (run_local_copies(local_copies, dir, preq, &bad_list, bad_files) != PBSE_NONE))
+    exitcode = COPY_FILE_FAIL;
+
 error:
 #ifdef HAVE_WORDEXP
   if (madefaketmpdir && !usedfaketmpdir)
@@ -67,6 +67,7 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 #include <sstream>
+#include <string>
 #include <vector>
 #include <stdio.h>
 #include <stdlib.h>
@@ -1902,6 +1903,53 @@ int mom_jobstarter_execute_job(
 
 
 
+/*
+ * write_join_job_attrs()
+ *
+ * Writes the job attributes of a join request to chan. The list is only
+ * DIS encoded the first time; the bytes are kept in encoded and copied
+ * as they are for every other sister, so a fan-out of n sisters encodes
+ * the job once instead of n times.
+ *
+ * @param chan - the request being written
+ * @param phead - the job attributes
+ * @param encoded - the encoded attributes, empty until the first call
+ * @return DIS_SUCCESS or a DIS error
+ */
+
+int write_join_job_attrs(
+
+  struct tcp_chan *chan,
+  tlist_head      *phead,
+  std::string     &encoded)
+
+  {
+  struct tcpdisbuf *tp = &chan->writebuf;
+  size_t            start;
+  int               rc;
+
+  if (encoded.size() == 0)
+    {
+    /* the buffer may be reallocated while encoding, so remember an offset */
+    start = tp->tdis_leadp - tp->tdis_thebuf;
+
+    if ((rc = encode_DIS_svrattrl(chan, (svrattrl *)GET_NEXT(*phead))) == DIS_SUCCESS)
+      encoded.assign(tp->tdis_thebuf + start, tp->tdis_leadp - tp->tdis_thebuf - start);
+
+    return(rc);
+    }
+
+  if (tcp_puts(chan, encoded.c_str(), encoded.size()) < 0)
+    return(DIS_NOCOMMIT);
+
+  tcp_wcommit(chan, TRUE);
+
+  return(DIS_SUCCESS);
+  } /* END write_join_job_attrs() */
+
+
+
+
 /* For intermediate moms when job_radix is set.
  * open a stream to each sister mom in this radix group
  * and send an IM_JOIN_JOB_RADIX request with all the sister
@@ -1924,11 +1972,16 @@ int open_tcp_stream_to_sisters(
   hnodent         *np;
   int              stream;
   eventent        *ep;
-  svrattrl        *psatl;
   struct tcp_chan *chan = NULL;
+  std::string      encoded_attrs;
+  struct timeval   now;
+  struct timeval   elapsed;
 
   np = hosts;
   pjob->ji_outstanding = 0;
+  pjob->ji_radix_join_errors = 0;
+
+  gettimeofday(&pjob->ji_radix_join_start, NULL);
 
   /* the sister lists have been made. Now contact the intermediate moms as designated by mom_radix */
   for (i = 1; i <= mom_radix; i++)
@@ -2027,8 +2080,7 @@ int open_tcp_stream_to_sisters(
     else
       {
       /* write jobattrs */
-      psatl = (svrattrl *)GET_NEXT(*phead);
-      if ((rc = encode_DIS_svrattrl(chan, psatl)) == DIS_SUCCESS)
+      if ((rc = write_join_job_attrs(chan, phead, encoded_attrs)) == DIS_SUCCESS)
         DIS_tcp_wflush(chan);
       }
 
@@ -2038,6 +2090,21 @@ int open_tcp_stream_to_sisters(
 
     }
 
+  if (LOGLEVEL >= 4)
+    {
+    gettimeofday(&now, NULL);
+    timeval_subtract(&elapsed, &now, &pjob->ji_radix_join_start);
+
+    snprintf(log_buffer, sizeof(log_buffer),
+      "join request sent to %d sisters (radix %d, %d byte attribute list) in %ld.%06ld seconds",
+      pjob->ji_outstanding,
+      mom_radix,
+      (int)encoded_attrs.size(),
+      (long)elapsed.tv_sec,
+      (long)elapsed.tv_usec);
+    log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buffer);
+    }
+
   return(PBSE_NONE);
   } /* end open_tcp_stream_to_sisters */
 
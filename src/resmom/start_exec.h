@@ -3,6 +3,8 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <pwd.h> /* passwd, gid_t */
 
+#include <string>
+
 #include "pbs_job.h" /* job, task, hnodent, pjobexec_t, task */
 #include "mom_func.h" /* var_table, radix_buf */
 #include "list_link.h" /* tlist_head */
@@ -35,6 +37,8 @@ int InitUserEnv(job *pjob, task *ptask, char **envp, struct passwd *pwdp, char *
 
 int mom_jobstarter_execute_job(job *pjob, char *shell, char *arg[], struct var_table *vtable);
 
+int write_join_job_attrs(struct tcp_chan *chan, tlist_head *phead, std::string &encoded);
+
 int open_tcp_stream_to_sisters(job *pjob, int com, tm_event_t parent_event, int mom_radix, hnodent *hosts, struct radix_buf **sister_list, tlist_head *phead, int flag);
 
 void free_sisterlist(struct radix_buf **list, int radix);
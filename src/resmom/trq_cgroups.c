@@ -9,7 +9,10 @@
 #include <string>
 #include <sstream>
 #include <set>
+#include <map>
+#include <list>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -777,46 +780,181 @@ int trq_cg_add_process_to_task_cgroup(
 
 
 
-unsigned long long trq_cg_read_numeric_value(
+/*
+ * Descriptors for the cgroup accounting files read on every poll, keyed by
+ * path. cgroupfs regenerates a file's contents whenever it is read from
+ * offset 0, so a descriptor can be kept for the life of the job and re-read
+ * with pread() instead of paying an open()/close() per file per sample.
+ * Job cgroups may be removed from a threadpool thread, hence the mutex.
+ *
+ * The mom still select()s in places, so descriptors numbered past FD_SETSIZE
+ * would break it. The cache is capped and the least recently read file is
+ * closed to make room, which on a busy node only costs the evicted file its
+ * open() on the next poll.
+ */
+#define CG_STAT_FDS_MAX 256
 
-  string &path,
-  bool   &error)
+typedef list<pair<string, int> > cg_stat_fd_list;
+
+cg_stat_fd_list                         cg_stat_fd_lru;  /* most recently read first */
+map<string, cg_stat_fd_list::iterator>  cg_stat_fds;
+pthread_mutex_t                         cg_stat_fds_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/*
+ * trq_cg_drop_cached_fd()
+ *
+ * Closes a cached descriptor and forgets it. cg_stat_fds_mutex must be held.
+ */
+
+void trq_cg_drop_cached_fd(
+
+  map<string, cg_stat_fd_list::iterator>::iterator it)
 
   {
-  int                fd;
-  struct stat        stat_buf;
-  unsigned long long val = 0;
-  char               buf[LOCAL_LOG_BUF_SIZE];
+  close(it->second->second);
+  cg_stat_fd_lru.erase(it->second);
+  cg_stat_fds.erase(it);
+  } // END trq_cg_drop_cached_fd()
 
-  error = false;
 
-  /* If we don't have a file or access to it return 0 */
-  /* probably a -l request and we are looking for a Rx.ty directory */
-  if (stat(path.c_str(), &stat_buf) == -1)
-    return(0);
 
-  fd = open(path.c_str(), O_RDONLY);
-  if (fd <= 0)
+/*
+ * trq_cg_read_cached_file()
+ *
+ * Reads the full contents of a cgroup file through a cached descriptor,
+ * opening it on first use. A cached descriptor that fails to read (the
+ * cgroup was removed out from under us) is closed and reopened once.
+ *
+ * @param path     - the cgroup file to read
+ * @param contents - (O) the file's contents
+ * @return PBSE_NONE on success, PBSE_SYSTEM with errno set otherwise
+ */
+
+int trq_cg_read_cached_file(
+
+  const string &path,
+  string       &contents)
+
+  {
+  char buf[LOCAL_LOG_BUF_SIZE];
+  int  rc = PBSE_SYSTEM;
+  int  saved_errno = 0;
+
+  contents.clear();
+
+  pthread_mutex_lock(&cg_stat_fds_mutex);
+
+  for (int attempt = 0; attempt < 2; attempt++)
     {
-    sprintf(log_buffer, "failed to open %s: %s", path.c_str(), strerror(errno));
-    log_err(errno, __func__, log_buffer);
-    error = true;
+    map<string, cg_stat_fd_list::iterator>::iterator it = cg_stat_fds.find(path);
+    int                                              fd;
+    off_t                                            offset = 0;
+    ssize_t                                          len;
+
+    if (it != cg_stat_fds.end())
+      {
+      fd = it->second->second;
+      cg_stat_fd_lru.splice(cg_stat_fd_lru.begin(), cg_stat_fd_lru, it->second);
+      }
+    else if ((fd = open(path.c_str(), O_RDONLY | O_CLOEXEC)) < 0)
+      {
+      saved_errno = errno;
+      break;
+      }
+    else
+      {
+      if (cg_stat_fds.size() >= CG_STAT_FDS_MAX)
+        trq_cg_drop_cached_fd(cg_stat_fds.find(cg_stat_fd_lru.back().first));
+
+      cg_stat_fd_lru.push_front(pair<string, int>(path, fd));
+      cg_stat_fds.insert(pair<string, cg_stat_fd_list::iterator>(path, cg_stat_fd_lru.begin()));
+      }
+
+    while ((len = pread(fd, buf, sizeof(buf), offset)) > 0)
+      {
+      contents.append(buf, len);
+      offset += len;
+      }
+
+    if (len == 0)
+      {
+      rc = PBSE_NONE;
+      break;
+      }
+
+    saved_errno = errno;
+    trq_cg_drop_cached_fd(cg_stat_fds.find(path));
+    contents.clear();
     }
-  else
+
+  pthread_mutex_unlock(&cg_stat_fds_mutex);
+
+  errno = saved_errno;
+
+  return(rc);
+  } // END trq_cg_read_cached_file()
+
+
+
+/*
+ * trq_cg_close_cached_files()
+ *
+ * Closes every cached descriptor that belongs to this job's cgroups.
+ *
+ * @param job_id - the id of the job whose cgroups are going away
+ */
+
+void trq_cg_close_cached_files(
+
+  const char *job_id)
+
+  {
+  string job_dir("/");
+
+  job_dir += job_id;
+  job_dir += "/";
+
+  pthread_mutex_lock(&cg_stat_fds_mutex);
+
+  for (map<string, cg_stat_fd_list::iterator>::iterator it = cg_stat_fds.begin(); it != cg_stat_fds.end();)
     {
-    int rc = read(fd, buf, LOCAL_LOG_BUF_SIZE);
+    if (it->first.find(job_dir) != string::npos)
+      trq_cg_drop_cached_fd(it++);
+    else
+      it++;
+    }
+
+  pthread_mutex_unlock(&cg_stat_fds_mutex);
+  } // END trq_cg_close_cached_files()
+
+
+
+unsigned long long trq_cg_read_numeric_value(
 
-    close(fd);
+  string &path,
+  bool   &error)
+
+  {
+  unsigned long long val = 0;
+  string             contents;
 
-    if (rc == -1)
+  error = false;
+
+  if (trq_cg_read_cached_file(path, contents) != PBSE_NONE)
+    {
+    /* If we don't have a file return 0 */
+    /* probably a -l request and we are looking for a Rx.ty directory */
+    if (errno != ENOENT)
       {
-      sprintf(buf, "read failed getting value from %s - %s", path.c_str(), strerror(errno));
-      log_err(errno, __func__, buf);
+      sprintf(log_buffer, "failed to read %s: %s", path.c_str(), strerror(errno));
+      log_err(errno, __func__, log_buffer);
       error = true;
       }
-    else if (rc != 0)
-      val = strtoull(buf, NULL, 10);
     }
+  else if (contents.size() != 0)
+    val = strtoull(contents.c_str(), NULL, 10);
 
   return(val);
   } // END trq_cg_read_numeric_value()
@@ -921,6 +1059,163 @@ int trq_cg_get_task_cput_stats(
 
 
 
+/*
+ * trq_cg_read_job_value()
+ *
+ * Reads a single number from one of the job's top level cgroup files.
+ *
+ * @return PBSE_NONE on success, PBSE_SYSTEM with errno set otherwise
+ */
+
+int trq_cg_read_job_value(
+
+  const string       &path,
+  unsigned long long &val)
+
+  {
+  string contents;
+
+  val = 0;
+
+  if (trq_cg_read_cached_file(path, contents) != PBSE_NONE)
+    return(PBSE_SYSTEM);
+
+  if (contents.size() != 0)
+    val = strtoull(contents.c_str(), NULL, 10);
+
+  return(PBSE_NONE);
+  } // END trq_cg_read_job_value()
+
+
+
+/*
+ * trq_cg_get_job_cput_stats()
+ *
+ * Gets the cpu time, in nanoseconds, charged to the job's cpuacct cgroup.
+ *
+ * @param job_id    - id of job
+ * @param cput_used - (O) nanoseconds of cpu time used
+ * @return PBSE_NONE on success, PBSE_SYSTEM with errno set otherwise
+ */
+
+int trq_cg_get_job_cput_stats(
+
+  const char         *job_id,
+  unsigned long long &cput_used)
+
+  {
+  return(trq_cg_read_job_value(cg_cpuacct_path + job_id + "/cpuacct.usage", cput_used));
+  } // END trq_cg_get_job_cput_stats()
+
+
+
+/*
+ * trq_cg_get_job_memory_stats()
+ *
+ * Gets the peak resident memory, in bytes, of the job's memory cgroup.
+ *
+ * @param job_id   - id of job
+ * @param mem_used - (O) bytes of memory used
+ * @return PBSE_NONE on success, PBSE_SYSTEM with errno set otherwise
+ */
+
+int trq_cg_get_job_memory_stats(
+
+  const char         *job_id,
+  unsigned long long &mem_used)
+
+  {
+  return(trq_cg_read_job_value(cg_memory_path + job_id + "/memory.max_usage_in_bytes", mem_used));
+  } // END trq_cg_get_job_memory_stats()
+
+
+
+/*
+ * trq_cg_add_pids_from_file()
+ *
+ * Appends the pids listed in a cgroup.procs file to pids.
+ */
+
+int trq_cg_add_pids_from_file(
+
+  const string  &path,
+  vector<pid_t> &pids)
+
+  {
+  string      contents;
+  const char *ptr;
+  char       *end;
+
+  if (trq_cg_read_cached_file(path, contents) != PBSE_NONE)
+    return(PBSE_SYSTEM);
+
+  ptr = contents.c_str();
+
+  while (*ptr != '\0')
+    {
+    long pid = strtol(ptr, &end, 10);
+
+    if (end == ptr)
+      break;
+
+    if (pid > 0)
+      pids.push_back((pid_t)pid);
+
+    ptr = end;
+    }
+
+  return(PBSE_NONE);
+  } // END trq_cg_add_pids_from_file()
+
+
+
+/*
+ * trq_cg_get_job_pids()
+ *
+ * Lists the processes that live in the job's cpuacct cgroup. Processes
+ * belonging to a -L request live in the per-task cgroups below the job's
+ * own, so those are read too when task_cgroups is set.
+ *
+ * @param job_id       - id of job
+ * @param task_cgroups - true if the job has per-task (R<x>.t<y>) cgroups
+ * @param pids         - (O) the pids found
+ * @return PBSE_NONE on success, PBSE_SYSTEM if the job's cgroup can't be read
+ */
+
+int trq_cg_get_job_pids(
+
+  const char    *job_id,
+  bool           task_cgroups,
+  vector<pid_t> &pids)
+
+  {
+  string job_path = cg_cpuacct_path + job_id;
+
+  if (trq_cg_add_pids_from_file(job_path + "/cgroup.procs", pids) != PBSE_NONE)
+    return(PBSE_SYSTEM);
+
+  if (task_cgroups == true)
+    {
+    DIR           *pdir;
+    struct dirent *dent;
+
+    if ((pdir = opendir(job_path.c_str())) == NULL)
+      return(PBSE_SYSTEM);
+
+    while ((dent = readdir(pdir)) != NULL)
+      {
+      if (dent->d_name[0] == 'R')
+        trq_cg_add_pids_from_file(job_path + "/" + dent->d_name + "/cgroup.procs", pids);
+      }
+
+    closedir(pdir);
+    }
+
+  return(PBSE_NONE);
+  } // END trq_cg_get_job_pids()
+
+
+
 int trq_cg_add_process_to_cgroup(
     
   string     &cgroup_path,
@@ -1895,6 +2190,8 @@ void trq_cg_delete_job_cgroups(
   bool        successfully_created)
 
   {
+  trq_cg_close_cached_files(job_id);
+
   trq_cg_delete_cgroup_path(cg_cpu_path + job_id, successfully_created);
 
   trq_cg_delete_cgroup_path(cg_cpuacct_path + job_id, successfully_created);
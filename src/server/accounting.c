@@ -84,6 +84,7 @@
  * acct_open()
  * acct_record()
  * acct_close()
+ * acct_writer_start()
  */
 
 
@@ -97,7 +98,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <string>
+#include <vector>
+#include <deque>
 #include "list_link.h"
 #include "attribute.h"
 #include "server_limits.h"
@@ -118,10 +124,30 @@
 
 static FILE         *acctfile;  /* open stream for log file */
 static volatile int  acct_opened = 0;
-static int           acct_opened_day;
+static int           acct_opened_day;  /* acct_day() of the open daily file */
 static int           acct_auto_switch = 0;
 pthread_mutex_t     *acctfile_mutex;
 
+/* records waiting for the writer thread, see acct_writer_start() */
+typedef struct acct_queued_rcd
+  {
+  int         day;  /* acct_day() of when the record was made */
+  std::string text;
+  } acct_queued_rcd;
+
+/* days only ever increase, unlike tm_yday across a new year */
+#define acct_day(ptm) (((ptm)->tm_year + 1900) * 1000 + (ptm)->tm_yday)
+
+static std::deque<acct_queued_rcd> acct_queue;
+static pthread_mutex_t             acct_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t              acct_queue_cond = PTHREAD_COND_INITIALIZER; /* records were queued */
+static pthread_cond_t              acct_space_cond = PTHREAD_COND_INITIALIZER; /* the queue has room */
+static bool                        acct_writer_running = false;
+static bool                        acct_writing = false; /* guarded by acctfile_mutex */
+
+static void acct_take_queued(std::deque<acct_queued_rcd> &records);
+static void acct_write_records(std::deque<acct_queued_rcd> &records);
+
 /* Global Data */
 
 extern attribute_def job_attr_def[];
@@ -337,7 +363,7 @@ int acct_open(
 
     acct_auto_switch = 1;
 
-    acct_opened_day = ptm->tm_yday;
+    acct_opened_day = acct_day(ptm);
     }
   else if (*filename == '\0')
     {
@@ -400,6 +426,15 @@ void acct_close(
 
   if (acct_opened == 1)
     {
+    /* queued records belong in the file being closed */
+    if (acct_writing == false)
+      {
+      std::deque<acct_queued_rcd> records;
+
+      acct_take_queued(records);
+      acct_write_records(records);
+      }
+
     fclose(acctfile);
 
     acct_opened = 0;
@@ -413,8 +448,352 @@ void acct_close(
 
 
 
+/*
+ * acct_append_json_string - append str to out as a quoted, escaped JSON string
+ */
+
+static void acct_append_json_string(
+
+  std::string       &out,
+  const std::string &str)
+
+  {
+  char hex[8];
+
+  out += '"';
+
+  for (size_t i = 0; i < str.size(); i++)
+    {
+    unsigned char c = str[i];
+
+    switch (c)
+      {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n";  break;
+      case '\r': out += "\\r";  break;
+      case '\t': out += "\\t";  break;
+
+      default:
+
+        if (c < 0x20)
+          {
+          snprintf(hex, sizeof(hex), "\\u%04x", c);
+          out += hex;
+          }
+        else
+          out += c;
+
+        break;
+      }
+    }
+
+  out += '"';
+  } /* END acct_append_json_string() */
+
+
+
+/*
+ * acct_is_json_number - true if value can be written as a JSON integer
+ */
+
+static bool acct_is_json_number(
+
+  const std::string &value)
+
+  {
+  size_t start = (value[0] == '-') ? 1 : 0;
+
+  if ((value.size() <= start) ||
+      (value.size() > 18) ||
+      ((value[start] == '0') && (value.size() > start + 1)))
+    return(false);
+
+  for (size_t i = start; i < value.size(); i++)
+    {
+    if (!isdigit(value[i]))
+      return(false);
+    }
+
+  return(true);
+  } /* END acct_is_json_number() */
+
+
+
+/*
+ * acct_record_to_json()
+ *
+ * Formats an accounting record as a single line JSON object: the date, time, record
+ * type and job id, then one member per key=value pair of text. Words that follow a
+ * pair without an '=' of their own are part of its value, and words before any pair
+ * are kept in "message". Integer values are written as numbers, the rest as strings.
+ *
+ * @param out - the string the record is appended to
+ * @param when - the time of the record
+ * @param stamp - when formatted as in text records
+ * @param acctype - the record type, PBS_ACCT_*
+ * @param jobid - the job's id
+ * @param text - the record's key=value pairs
+ */
+
+void acct_record_to_json(
+
+  std::string &out,
+  time_t       when,
+  const char  *stamp,
+  int          acctype,
+  const char  *jobid,
+  const char  *text)
+
+  {
+  std::vector<std::pair<std::string, std::string> > fields;
+  std::string  message;
+  std::string  type(1, (char)acctype);
+  const char  *ptr = text;
+  char         buf[32];
+
+  while (*ptr != '\0')
+    {
+    const char *end;
+    const char *equals = NULL;
+
+    if (*ptr == ' ')
+      {
+      ptr++;
+      continue;
+      }
+
+    for (end = ptr; (*end != ' ') && (*end != '\0'); end++)
+      {
+      if ((*end == '=') && (equals == NULL))
+        equals = end;
+      }
+
+    if ((equals != NULL) &&
+        (equals != ptr))
+      {
+      fields.push_back(std::pair<std::string, std::string>(
+        std::string(ptr, equals - ptr), std::string(equals + 1, end - equals - 1)));
+      }
+    else if (fields.size() > 0)
+      {
+      fields.back().second += ' ';
+      fields.back().second.append(ptr, end - ptr);
+      }
+    else
+      {
+      if (message.size() > 0)
+        message += ' ';
+
+      message.append(ptr, end - ptr);
+      }
+
+    ptr = end;
+    }
+
+  out += "{\"date\":";
+  acct_append_json_string(out, stamp);
+  snprintf(buf, sizeof(buf), ",\"time\":%ld", (long)when);
+  out += buf;
+  out += ",\"type\":";
+  acct_append_json_string(out, type);
+  out += ",\"jobid\":";
+  acct_append_json_string(out, jobid);
+
+  for (size_t i = 0; i < fields.size(); i++)
+    {
+    out += ',';
+    acct_append_json_string(out, fields[i].first);
+    out += ':';
+
+    if (acct_is_json_number(fields[i].second))
+      out += fields[i].second;
+    else
+      acct_append_json_string(out, fields[i].second);
+    }
+
+  if (message.size() > 0)
+    {
+    out += ",\"message\":";
+    acct_append_json_string(out, message);
+    }
+
+  out += "}\n";
+  } /* END acct_record_to_json() */
+
+
+
+/*
+ * acct_flush_batch - write batch to the accounting file, one write and at most one
+ * fsync for the whole batch. acctfile_mutex must be held.
+ */
+
+static void acct_flush_batch(
+
+  std::string &batch)
+
+  {
+  bool sync_file = false;
+
+  if (batch.size() == 0)
+    return;
+
+  if (acct_opened > 0)
+    {
+    if (fwrite(batch.c_str(), 1, batch.size(), acctfile) < batch.size())
+      log_err(errno, __func__, "cannot write accounting records");
+
+    get_svr_attr_b(SRV_ATR_AcctFsync, &sync_file);
+
+    if ((sync_file == true) &&
+        (fsync(fileno(acctfile)) != 0))
+      log_err(errno, __func__, "cannot sync the accounting file");
+    }
+
+  batch.clear();
+  } /* END acct_flush_batch() */
+
+
+
+/*
+ * acct_write_records()
+ *
+ * Writes records to the accounting file, switching to a new daily file when
+ * a record was made on a later day than the open file. A record from before
+ * midnight that is written after the switch goes into the new file rather than
+ * switching back. acctfile_mutex must be held.
+ */
+
+static void acct_write_records(
+
+  std::deque<acct_queued_rcd> &records)
+
+  {
+  std::string batch;
+
+  acct_writing = true;
+
+  if (acct_opened == 0)
+    acct_open(acct_file, true);
+
+  for (size_t i = 0; i < records.size(); i++)
+    {
+    if ((acct_auto_switch != 0) &&
+        (records[i].day > acct_opened_day))
+      {
+      acct_flush_batch(batch);
+
+      acct_close(true);
+
+      acct_open(NULL, true);
+      }
+
+    batch += records[i].text;
+    }
+
+  acct_flush_batch(batch);
+
+  acct_writing = false;
+  } /* END acct_write_records() */
+
+
+
+/*
+ * acct_take_queued - move every queued record into records and wake any
+ * account_record() call waiting for room
+ */
+
+static void acct_take_queued(
+
+  std::deque<acct_queued_rcd> &records)
+
+  {
+  pthread_mutex_lock(&acct_queue_mutex);
+
+  records.swap(acct_queue);
+
+  pthread_cond_broadcast(&acct_space_cond);
+
+  pthread_mutex_unlock(&acct_queue_mutex);
+  } /* END acct_take_queued() */
+
+
+
+static void *acct_writer(
+
+  void *vp)
+
+  {
+  std::deque<acct_queued_rcd> records;
+
+  while (1)
+    {
+    pthread_mutex_lock(&acct_queue_mutex);
+
+    while (acct_queue.empty())
+      pthread_cond_wait(&acct_queue_cond, &acct_queue_mutex);
+
+    pthread_mutex_unlock(&acct_queue_mutex);
+
+    /* take the file before the records so acct_close() never misses records in flight */
+    pthread_mutex_lock(acctfile_mutex);
+
+    acct_take_queued(records);
+    acct_write_records(records);
+
+    pthread_mutex_unlock(acctfile_mutex);
+
+    records.clear();
+    }
+
+  return(NULL);
+  } /* END acct_writer() */
+
+
+
+/*
+ * acct_writer_start()
+ *
+ * Starts the thread that writes accounting records. account_record() then only
+ * formats and queues records; the writer writes everything that queued up while
+ * it was busy in one write, with at most one fsync when accounting_fsync is set.
+ *
+ * @return PBSE_NONE on success
+ */
+
+int acct_writer_start(void)
+
+  {
+  pthread_t      writer;
+  pthread_attr_t attr;
+
+  if (acct_writer_running == true)
+    return(PBSE_NONE);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  if (pthread_create(&writer, &attr, acct_writer, NULL) != 0)
+    {
+    pthread_attr_destroy(&attr);
+    return(PBSE_SYSTEM);
+    }
+
+  pthread_attr_destroy(&attr);
+
+  acct_writer_running = true;
+
+  return(PBSE_NONE);
+  } /* END acct_writer_start() */
+
+
+
+
 /*
  * account_record - write basic accounting record
+ *
+ * The record is formatted here, in text or JSON lines as set by accounting_format,
+ * and written by the writer thread once acct_writer_start() has run.
  */
 
 void account_record(
@@ -424,42 +803,70 @@ void account_record(
   const char *text)  /* text to log, may be null */
 
   {
-  time_t     time_now = time(NULL);
-  struct tm *ptm;
-  struct tm  tmpPtm;
+  time_t      time_now = time(NULL);
+  struct tm  *ptm;
+  struct tm   tmpPtm;
+  char        stamp[64];
+  char       *format = NULL;
+  std::string line;
 
-  pthread_mutex_lock(acctfile_mutex);
-  if (acct_opened == 0)
+  ptm = localtime_r(&time_now,&tmpPtm);
+
+  if (text == NULL)
+    text = (char *)"";
+
+  snprintf(stamp, sizeof(stamp), "%02d/%02d/%04d %02d:%02d:%02d",
+    ptm->tm_mon + 1,
+    ptm->tm_mday,
+    ptm->tm_year + 1900,
+    ptm->tm_hour,
+    ptm->tm_min,
+    ptm->tm_sec);
+
+  if ((get_svr_attr_str(SRV_ATR_AcctFormat, &format) == PBSE_NONE) &&
+      (format != NULL) &&
+      (!strcmp(format, ACCT_FORMAT_JSON)))
     {
-    acct_open(acct_file, true);
+    acct_record_to_json(line, time_now, stamp, acctype, pjob->ji_qs.ji_jobid, text);
+    }
+  else
+    {
+    line = stamp;
+    line += ';';
+    line += (char)acctype;
+    line += ';';
+    line += pjob->ji_qs.ji_jobid;
+    line += ';';
+    line += text;
+    line += '\n';
     }
 
-  ptm = localtime_r(&time_now,&tmpPtm);
+  if (acct_writer_running == true)
+    {
+    pthread_mutex_lock(&acct_queue_mutex);
 
-  /* Do we need to switch files */
+    while (acct_queue.size() >= ACCT_QUEUE_MAX)
+      pthread_cond_wait(&acct_space_cond, &acct_queue_mutex);
 
-  if ((acct_auto_switch != 0) &&
-      (acct_opened_day != ptm->tm_yday))
-    {
-    acct_close(true);
+    acct_queue.push_back(acct_queued_rcd());
+    acct_queue.back().day = acct_day(ptm);
+    acct_queue.back().text.swap(line);
+
+    pthread_cond_signal(&acct_queue_cond);
 
-    acct_open(NULL, true);
+    pthread_mutex_unlock(&acct_queue_mutex);
     }
+  else
+    {
+    std::deque<acct_queued_rcd> records(1);
 
-  if (text == NULL)
-    text = (char *)"";
+    records[0].day = acct_day(ptm);
+    records[0].text.swap(line);
 
-  fprintf(acctfile, "%02d/%02d/%04d %02d:%02d:%02d;%c;%s;%s\n",
-          ptm->tm_mon + 1,
-          ptm->tm_mday,
-          ptm->tm_year + 1900,
-          ptm->tm_hour,
-          ptm->tm_min,
-          ptm->tm_sec,
-          (char)acctype,
-          pjob->ji_qs.ji_jobid,
-          text);
-  pthread_mutex_unlock(acctfile_mutex);
+    pthread_mutex_lock(acctfile_mutex);
+    acct_write_records(records);
+    pthread_mutex_unlock(acctfile_mutex);
+    }
 
   return;
   }  /* END account_record() */
@@ -30,6 +30,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <semaphore.h>
 
 #include <libxml/parser.h>
 #include <libxml/tree.h>
@@ -56,6 +57,9 @@
 #include "mutex_mgr.hpp"
 #include "batch_request.h"
 #include "alps_constants.h"
+#include "threadpool.h"
+#include "req_holdjob.h" /* get_hold, chk_hold_priv */
+#include "svr_chk_owner.h" /* svr_authorize_req */
 
 #include "../lib/Libutils/u_lock_ctl.h" /* lock_ss, unlock_ss */
 
@@ -77,9 +81,11 @@ extern char *path_arrays;
 extern char *path_jobs;
 extern int    LOGLEVEL;
 extern char *pbs_o_host;
+extern char *msg_permlog;
 
 
 extern int array_259_upgrade;
+extern sem_t *job_clone_semaphore;
 
 int         is_num(const char *);
 int         array_request_token_count(const char *);
@@ -197,6 +203,221 @@ job_array *get_array(
 
 
 
+/*
+ * get_uncreated_subjob_array()
+ *
+ * Finds the array holding job_id if job_id names one of its subjobs that hasn't been
+ * created yet.
+ *
+ * @param job_id - the id of the subjob, e.g. 1[5].napali
+ * @param index - RETURN: the subjob's index in the array
+ * @return the array, locked, or NULL if job_id isn't an uncreated subjob
+ */
+
+job_array *get_uncreated_subjob_array(
+
+  const char *job_id,
+  int        &index)
+
+  {
+  char        id_buf[PBS_MAXSVRJOBID + 1];
+  char        parent_id[PBS_MAXSVRJOBID + 1];
+  const char *bracket;
+  char       *end;
+  long        idx;
+  job_array  *pa;
+
+  if ((job_id == NULL) ||
+      ((bracket = strchr(job_id, '[')) == NULL))
+    return(NULL);
+
+  idx = strtol(bracket + 1, &end, 10);
+
+  if ((end == bracket + 1) ||
+      (*end != ']') ||
+      (idx < 0) ||
+      (idx > PBS_MAXJOBARRAY))
+    return(NULL);
+
+  snprintf(id_buf, sizeof(id_buf), "%s", job_id);
+  array_get_parent_id(id_buf, parent_id);
+
+  if ((pa = get_array(parent_id)) == NULL)
+    return(NULL);
+
+  if ((pa->is_deleted() == true) ||
+      (pa->uncreated_ids.contains(idx) == false))
+    {
+    unlock_ai_mutex(pa, __func__, NULL, LOGLEVEL);
+    return(NULL);
+    }
+
+  index = idx;
+
+  return(pa);
+  } /* END get_uncreated_subjob_array() */
+
+
+
+/*
+ * authorize_uncreated_subjob_req()
+ *
+ * An uncreated subjob has no owner of its own yet, so requests against it are checked
+ * against the owner of its array.
+ *
+ * @param pa - the locked array holding the subjob
+ * @param preq - the request naming the subjob
+ * @param job_id - the id of the subjob, for logging
+ * @return PBSE_NONE if the requestor may act on the subjob, PBSE_PERM otherwise
+ */
+
+int authorize_uncreated_subjob_req(
+
+  job_array     *pa,
+  batch_request *preq,
+  const char    *job_id)
+
+  {
+  char owner[PBS_MAXUSER + 1];
+  char log_buf[LOCAL_LOG_BUF_SIZE];
+
+  get_jobowner(pa->ai_qs.owner, owner);
+
+  if (svr_authorize_req(preq, owner, pa->ai_qs.submit_host) == -1)
+    {
+    snprintf(log_buf, sizeof(log_buf), msg_permlog,
+      preq->rq_type,
+      "Job",
+      job_id,
+      preq->rq_user,
+      preq->rq_host);
+
+    log_event(PBSEVENT_SECURITY, PBS_EVENTCLASS_JOB, job_id, log_buf);
+
+    return(PBSE_PERM);
+    }
+
+  return(PBSE_NONE);
+  } /* END authorize_uncreated_subjob_req() */
+
+
+
+/*
+ * materialize_array_subjob()
+ *
+ * Creates the array subjob job_id now if it belongs to an array and hasn't been created yet,
+ * so that a request naming it individually can act on it. The requestor must be allowed to
+ * act on the array, and the subjob is only created while the array is below its
+ * idle_slot_limit, the same limit job_clone_wt() paces creation with.
+ *
+ * @param job_id - the id of the subjob, e.g. 1[5].napali
+ * @param preq - the request naming the subjob
+ * @return PBSE_NONE if the subjob was created, PBSE_UNKJOBID if job_id isn't an uncreated
+ * subjob, PBSE_PERM if the requestor isn't authorized, PBSE_BADSTATE if the array is at its
+ * idle slot limit, or the error from creating it
+ */
+
+int materialize_array_subjob(
+
+  const char    *job_id,
+  batch_request *preq)
+
+  {
+  int        index;
+  int        rc;
+  job_array *pa;
+
+  if ((pa = get_uncreated_subjob_array(job_id, index)) == NULL)
+    return(PBSE_UNKJOBID);
+
+  if ((rc = authorize_uncreated_subjob_req(pa, preq, job_id)) != PBSE_NONE)
+    {
+    unlock_ai_mutex(pa, __func__, "1", LOGLEVEL);
+    return(rc);
+    }
+
+  if ((pa->ai_qs.idle_slot_limit != NO_SLOT_LIMIT) &&
+      (pa->ai_qs.num_idle >= pa->ai_qs.idle_slot_limit))
+    {
+    unlock_ai_mutex(pa, __func__, "2", LOGLEVEL);
+    return(PBSE_BADSTATE);
+    }
+
+  /* creating subjobs is tracked the same way job_clone_wt() tracks it */
+  sem_post(job_clone_semaphore);
+
+  rc = pa->create_subjob(index);
+
+  /* on FATAL_ERROR the array is gone and nothing is left locked */
+  if (rc != FATAL_ERROR)
+    {
+    if (rc == PBSE_NONE)
+      array_save(pa);
+
+    unlock_ai_mutex(pa, __func__, "3", LOGLEVEL);
+    }
+
+  sem_wait(job_clone_semaphore);
+
+  return(rc);
+  } /* END materialize_array_subjob() */
+
+
+
+/*
+ * delete_uncreated_subjob()
+ *
+ * Deletes the array subjob job_id if it hasn't been created yet by dropping its index from
+ * the array, counting it as done and purged like delete_array_range() does.
+ *
+ * @param job_id - the id of the subjob, e.g. 1[5].napali
+ * @param preq - the delete request naming the subjob
+ * @return PBSE_NONE if the subjob was dropped, PBSE_UNKJOBID if job_id isn't an uncreated
+ * subjob, or PBSE_PERM if the requestor isn't authorized
+ */
+
+int delete_uncreated_subjob(
+
+  const char    *job_id,
+  batch_request *preq)
+
+  {
+  int        index;
+  int        rc;
+  long       cancel_exit_code = 0;
+  job_array *pa;
+  char       parent_id[PBS_MAXSVRJOBID + 1];
+
+  if ((pa = get_uncreated_subjob_array(job_id, index)) == NULL)
+    return(PBSE_UNKJOBID);
+
+  if ((rc = authorize_uncreated_subjob_req(pa, preq, job_id)) != PBSE_NONE)
+    {
+    unlock_ai_mutex(pa, __func__, "1", LOGLEVEL);
+    return(rc);
+    }
+
+  get_svr_attr_l(SRV_ATR_ExitCodeCanceledJob, &cancel_exit_code);
+  pa->remove_uncreated_range(index, index, cancel_exit_code);
+
+  if (pa->ai_qs.num_purged == pa->ai_qs.num_jobs)
+    {
+    /* that was the array's last subjob */
+    snprintf(parent_id, sizeof(parent_id), "%s", pa->ai_qs.parent_id);
+    unlock_ai_mutex(pa, __func__, "2", LOGLEVEL);
+    array_delete(parent_id);
+    }
+  else
+    {
+    array_save(pa);
+    unlock_ai_mutex(pa, __func__, "3", LOGLEVEL);
+    }
+
+  return(PBSE_NONE);
+  } /* END delete_uncreated_subjob() */
+
+
+
 /*
  * get_and_remove_array()
  *
@@ -339,6 +560,41 @@ int array_info_xml(
 
 
 
+/*
+ * uncreated_holds_xml()
+ *
+ * Adds an element per hold type placed on uncreated subjobs, holding the range of indices
+ * it was placed on
+ */
+
+int uncreated_holds_xml(
+
+  xmlNodePtr       root_node, /* M */
+  const job_array *pa)        /* I */
+
+  {
+  std::string range;
+  char        type[MAXLINE];
+
+  for (std::map<long, subjob_index_set>::const_iterator it = pa->uncreated_holds.begin();
+       it != pa->uncreated_holds.end();
+       it++)
+    {
+    xmlNodePtr hold_node;
+
+    it->second.to_range_string(range);
+    snprintf(type, sizeof(type), "%ld", it->first);
+
+    if (((hold_node = xmlNewChild(root_node, NULL, (xmlChar *)UNCREATED_HOLD_TAG, (xmlChar *)range.c_str())) == NULL) ||
+        (xmlNewProp(hold_node, (xmlChar *)HOLD_TYPE_TAG, (xmlChar *)type) == NULL))
+      return(-1);
+    }
+
+  return(PBSE_NONE);
+  } // END uncreated_holds_xml()
+
+
+
 int array_save_xml(
 
   const job_array *pa,       /* I */  /* array info to be written to xml */
@@ -358,7 +614,13 @@ int array_save_xml(
       xmlDocSetRootElement(doc, root_node);
       if ((rc = array_info_xml(&root_node, (const array_info*) &(pa->ai_qs))) == PBSE_NONE)
         {
-        if (xmlNewChild(root_node, NULL, (xmlChar *)RANGE_TAG, (xmlChar *)pa->ai_qs.range_str.c_str()))
+        std::string uncreated;
+
+        pa->uncreated_ids.to_range_string(uncreated);
+
+        if ((xmlNewChild(root_node, NULL, (xmlChar *)RANGE_TAG, (xmlChar *)pa->ai_qs.range_str.c_str())) &&
+            (xmlNewChild(root_node, NULL, (xmlChar *)UNCREATED_TAG, (xmlChar *)uncreated.c_str())) &&
+            (uncreated_holds_xml(root_node, pa) == PBSE_NONE))
           {
           lock_ss();
 
@@ -638,6 +900,28 @@ int assign_array_info_fields(
     {
     pa->ai_qs.highest_id_created = strtol((const char *)content, NULL, 10);
     }
+  else if (!strcmp((const char *)xml_node->name, UNCREATED_HOLD_TAG))
+    {
+    xmlChar *type_attr = xmlGetProp(xml_node, (xmlChar *)HOLD_TYPE_TAG);
+    long     hold_type = (type_attr != NULL) ? strtol((const char *)type_attr, NULL, 10) : 0;
+
+    if ((hold_type <= 0) ||
+        (pa->uncreated_holds[hold_type].from_range_string((const char *)content) != PBSE_NONE))
+      {
+      snprintf(log_buf, buflen, "invalid uncreated subjob hold on array xml");
+      rc = -1;
+      }
+
+    if (type_attr != NULL)
+      xmlFree(type_attr);
+    }
+  else if (!strcmp((const char *)xml_node->name, UNCREATED_TAG))
+    {
+    if ((rc = pa->uncreated_ids.from_range_string((const char *)content)) == PBSE_NONE)
+      pa->uncreated_ids_recovered = true;
+    else
+      snprintf(log_buf, buflen, "invalid uncreated subjob range \"%s\" on array xml", (const char *)content);
+    }
   else
     {
     snprintf(log_buf, buflen, "unknown tag \"%s\" on array xml", (const char*) xml_node->name);
@@ -1386,14 +1670,259 @@ int array_request_parse_token(
 
 
 
+/*
+ * get_range_runs()
+ *
+ * Splits the indices of a range into runs of consecutive indices
+ *
+ * @param range_vec - the indices
+ * @param runs - the first and last index of each run
+ */
+
+void get_range_runs(
+
+  const std::vector<int>              &range_vec,
+  std::vector<std::pair<int, int> >   &runs)
+
+  {
+  runs.clear();
+
+  for (size_t i = 0; i < range_vec.size();)
+    {
+    size_t end = i;
+
+    while ((end + 1 < range_vec.size()) &&
+           (range_vec[end + 1] == range_vec[end] + 1))
+      end++;
+
+    runs.push_back(std::pair<int, int>(range_vec[i], range_vec[end]));
+
+    i = end + 1;
+    }
+  } /* END get_range_runs() */
+
+
+
+/*
+ * delete_subjob_batch_work()
+ *
+ * Deletes, or purges, the subjobs in a batch on a task pool thread. The array's counters
+ * change as each subjob is deleted, so qstat shows the progress, but the array is saved
+ * once when the batch is done instead of once per subjob.
+ *
+ * @param vp - the subjob_batch, freed here
+ */
+
+void *delete_subjob_batch_work(
+
+  void *vp)
+
+  {
+  subjob_batch *batch = (subjob_batch *)vp;
+  job_array    *pa;
+  long          cancel_exit_code = 0;
+  int           num_deleted = 0;
+
+  get_svr_attr_l(SRV_ATR_ExitCodeCanceledJob, &cancel_exit_code);
+
+  for (size_t i = 0; i < batch->job_ids.size(); i++)
+    {
+    const char *job_id = batch->job_ids[i].c_str();
+    job        *pjob;
+    int         old_state;
+
+    if ((pjob = svr_find_job(job_id, FALSE)) == NULL)
+      continue;
+
+    old_state = pjob->ji_qs.ji_state;
+
+    if (batch->purge == true)
+      {
+      /* force_purge_work() updates the array itself */
+      try
+        {
+        force_purge_work(pjob);
+        }
+      catch (int err)
+        {
+        if (err != PBSE_JOB_RECYCLED)
+          {
+          char log_buf[LOCAL_LOG_BUF_SIZE];
+          snprintf(log_buf, sizeof(log_buf), "Error when purging %s", job_id);
+          log_err(err, __func__, log_buf);
+          }
+        }
+
+      continue;
+      }
+
+    /* the job finished or was deleted some other way since it was batched */
+    if (old_state >= JOB_STATE_EXITING)
+      {
+      unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
+      continue;
+      }
+
+    /* attempt_delete() unlocks pjob. A job that has since become prerun is left for
+     * array_delete_wt() */
+    if (attempt_delete(pjob) == false)
+      continue;
+
+    /* running jobs will increase the deleted count when their obit is reported */
+    if (old_state != JOB_STATE_RUNNING)
+      num_deleted++;
+
+    if ((pa = get_array(batch->array_id.c_str())) != NULL)
+      {
+      pa->update_array_values(old_state, aeTerminate, job_id, cancel_exit_code);
+      unlock_ai_mutex(pa, __func__, "1", LOGLEVEL);
+      }
+    }
+
+  if ((pa = get_array(batch->array_id.c_str())) != NULL)
+    {
+    pa->ai_qs.num_failed += num_deleted;
+    pa->end_bulk_update();
+    unlock_ai_mutex(pa, __func__, "2", LOGLEVEL);
+    }
+
+  delete batch;
+
+  return(NULL);
+  } /* END delete_subjob_batch_work() */
+
+
+
+/*
+ * batch_subjob_delete()
+ *
+ * Sorts the created subjob at index into the batch that will delete it. Running subjobs
+ * are batched by the node they run on so that each node's kill requests go out together,
+ * and everything else goes into one bulk batch. The array must be locked.
+ *
+ * @param purge - true if the subjob is being purged rather than deleted
+ * @param skip_exiting - true if subjobs that are already exiting are left alone
+ * @return PBSE_NONE if the subjob was batched or didn't need to be, PBSE_BADSTATE if it
+ * can't be deleted yet, or PBSE_UNKJOBID if the index has no subjob
+ */
+
+int batch_subjob_delete(
+
+  job_array                            *pa,
+  int                                   index,
+  bool                                  purge,
+  bool                                  skip_exiting,
+  subjob_batch                         *bulk,
+  std::map<pbs_net_t, subjob_batch *>  &by_node)
+
+  {
+  job *pjob;
+
+  if (pa->job_ids[index] == NULL)
+    return(PBSE_UNKJOBID);
+
+  if ((pjob = svr_find_job(pa->job_ids[index], FALSE)) == NULL)
+    {
+    free(pa->job_ids[index]);
+    pa->job_ids[index] = NULL;
+
+    return(PBSE_UNKJOBID);
+    }
+
+  mutex_mgr pjob_mutex(pjob->ji_mutex, true);
+
+  if ((pjob->ji_qs.ji_state >= JOB_STATE_EXITING) &&
+      (skip_exiting == true))
+    return(PBSE_NONE);
+
+  if (purge == false)
+    {
+    if ((pjob->ji_qs.ji_state == JOB_STATE_TRANSIT) ||
+        (pjob->ji_qs.ji_substate == JOB_SUBSTATE_PRERUN))
+      return(PBSE_BADSTATE);
+
+    if (pjob->ji_qs.ji_state == JOB_STATE_RUNNING)
+      {
+      subjob_batch *&node_batch = by_node[pjob->ji_qs.ji_un.ji_exect.ji_momaddr];
+
+      if (node_batch == NULL)
+        node_batch = new subjob_batch(pa->ai_qs.parent_id, false);
+
+      node_batch->job_ids.push_back(pjob->ji_qs.ji_jobid);
+
+      return(PBSE_NONE);
+      }
+    }
+
+  bulk->job_ids.push_back(pjob->ji_qs.ji_jobid);
+
+  return(PBSE_NONE);
+  } /* END batch_subjob_delete() */
+
+
+
+/*
+ * dispatch_subjob_batch()
+ *
+ * Hands batch to a task pool thread, or frees it if it is empty. The array must be locked.
+ */
+
+void dispatch_subjob_batch(
+
+  job_array    *pa,
+  subjob_batch *batch)
+
+  {
+  if (batch->job_ids.size() == 0)
+    {
+    delete batch;
+    return;
+    }
+
+  pa->begin_bulk_update();
+
+  if (enqueue_threadpool_request(delete_subjob_batch_work, batch, task_pool) != PBSE_NONE)
+    {
+    /* do the work here instead. The batch locks the array itself */
+    pthread_mutex_unlock(pa->ai_mutex);
+    delete_subjob_batch_work(batch);
+    pthread_mutex_lock(pa->ai_mutex);
+    }
+  } /* END dispatch_subjob_batch() */
+
+
+
+/*
+ * dispatch_subjob_batches()
+ *
+ * Hands the bulk batch and each node's batch to task pool threads. The array must be locked.
+ */
+
+void dispatch_subjob_batches(
+
+  job_array                            *pa,
+  subjob_batch                         *bulk,
+  std::map<pbs_net_t, subjob_batch *>  &by_node)
+
+  {
+  for (std::map<pbs_net_t, subjob_batch *>::iterator it = by_node.begin(); it != by_node.end(); it++)
+    dispatch_subjob_batch(pa, it->second);
+
+  dispatch_subjob_batch(pa, bulk);
+  } /* END dispatch_subjob_batches() */
+
+
+
 /*
  * delete_array_range()
  *
- * deletes a range from a specific array
+ * deletes a range from a specific array. Subjobs that were never created are dropped here;
+ * the created ones are deleted asynchronously in batches.
  *
  * @param pa - the array whose jobs are deleted
  * @param range_str - the user-given range to delete 
- * @return - the number of jobs skipped, -1 if range error 
+ * @return - the number of jobs skipped, -1 if range error, or NO_JOBS_IN_ARRAY if the
+ * range held the array's last subjobs and none of them had been created
  */
 int delete_array_range(
 
@@ -1402,15 +1931,15 @@ int delete_array_range(
   bool       purge)
 
   {
-  job                *pjob;
-  char               *range;
-  std::vector<int>    range_vec;
+  char                                *range;
+  std::vector<int>                     range_vec;
+  std::vector<std::pair<int, int> >    runs;
+  std::map<pbs_net_t, subjob_batch *>  by_node;
+  subjob_batch                        *bulk;
 
-  int                 num_skipped = 0;
-  int                 num_deleted = 0;
-  bool                deleted;
-  int                 running;
-  long                cancel_exit_code = 0;
+  int                                  num_skipped = 0;
+  int                                  num_dropped = 0;
+  long                                 cancel_exit_code = 0;
 
   /* get just the numeric range specified, '=' should
    * always be there since we put it there in qdel */
@@ -1427,80 +1956,38 @@ int delete_array_range(
 
   get_svr_attr_l(SRV_ATR_ExitCodeCanceledJob, &cancel_exit_code);
 
-  for (size_t i = 0; i < range_vec.size(); i++)
-    {
-    int index = range_vec[i];
-
-    /* don't stomp on other memory */
-    if (index >= pa->ai_qs.array_size)
-      continue;
-    
-    if (pa->job_ids[index] == NULL)
-      continue;
+  /* drop the subjobs that were never created first so that deleting the others doesn't
+   * instantiate them, a consecutive run of the range at a time */
+  get_range_runs(range_vec, runs);
 
-    if ((pjob = svr_find_job(pa->job_ids[index], FALSE)) == NULL)
-      {
-      free(pa->job_ids[index]);
-      pa->job_ids[index] = NULL;
-      }
-    else
-      {
-      mutex_mgr pjob_mutex = mutex_mgr(pjob->ji_mutex, true);
-      if (pjob->ji_qs.ji_state >= JOB_STATE_EXITING)
-        {
-        /* invalid state for request,  skip */
-        continue;
-        }
+  for (size_t i = 0; i < runs.size(); i++)
+    num_dropped += pa->remove_uncreated_range(runs[i].first, runs[i].second, cancel_exit_code);
 
-      int old_state = pjob->ji_qs.ji_state;
+  if (num_dropped > 0)
+    {
+    /* nothing is left to delete if only uncreated subjobs remained */
+    if (pa->ai_qs.num_purged == pa->ai_qs.num_jobs)
+      return(NO_JOBS_IN_ARRAY);
 
-      running = (pjob->ji_qs.ji_state == JOB_STATE_RUNNING);
+    array_save(pa);
+    }
 
-      pthread_mutex_unlock(pa->ai_mutex);
-      if (purge == true)
-        {
-        deleted = true;
+  bulk = new subjob_batch(pa->ai_qs.parent_id, purge);
 
-        try
-          {
-          force_purge_work(pjob);
-          }
-        catch (int err)
-          {
-          if (err != PBSE_JOB_RECYCLED)
-            {
-            char log_buf[LOCAL_LOG_BUF_SIZE];
-            sprintf(log_buf, "Error when purging %s", pa->job_ids[i]);
-            log_err(err, __func__, log_buf);
-            deleted = false;
-            }
-          }
-        }
-      else
-        deleted = attempt_delete(pjob);
-      
-      // Both attempt_delete and force_purge_work unlock pjob
-      pjob_mutex.set_unlock_on_exit(false);
-      pthread_mutex_lock(pa->ai_mutex);
+  for (size_t i = 0; i < range_vec.size(); i++)
+    {
+    int index = range_vec[i];
 
-      if (deleted == false)
-        {
-        /* if the job was deleted, this mutex would be taked care of elsewhere. When it fails,
-         * release it here */
-        num_skipped++;
-        }
-      else 
-        {
-        /* running jobs will increase the deleted count when their obit is reported */
-        if (running == FALSE)
-          num_deleted++;
+    /* don't stomp on other memory */
+    if ((index < 0) ||
+        (index >= pa->ai_qs.array_size))
+      continue;
 
-        pa->update_array_values(old_state, aeTerminate, pa->job_ids[i], cancel_exit_code);
-        }
-      }
+    if (batch_subjob_delete(pa, index, purge, true, bulk, by_node) == PBSE_BADSTATE)
+      num_skipped++;
     }
 
-  pa->ai_qs.num_failed += num_deleted;
+  dispatch_subjob_batches(pa, bulk, by_node);
 
   return(num_skipped);
   } /* END delete_array_range() */
@@ -1535,11 +2022,12 @@ int first_job_index(
 /* 
  * delete_whole_array()
  *
- * iterates over the array and deletes the whole thing
+ * iterates over the array and deletes the whole thing. Subjobs that were never created are
+ * dropped here; the created ones are deleted asynchronously in batches.
  *
  * @param pa - the array to be deleted
  * @param purge - true if the array should be purged, false if it's a normal delete
- * @return - the number of jobs skipped
+ * @return - the number of jobs skipped, or NO_JOBS_IN_ARRAY if no subjobs had been created
  */
 int delete_whole_array(
 
@@ -1547,96 +2035,35 @@ int delete_whole_array(
   bool       purge)
 
   {
-  int  i;
-  int  num_skipped = 0;
-  int  num_jobs = 0;
-  int  num_deleted = 0;
-  bool deleted;
-  int  running;
-  long cancel_exit_code = 0;
-
-  std::string array_id = pa->ai_qs.parent_id;
+  int                                  num_skipped = 0;
+  int                                  num_jobs = 0;
+  long                                 cancel_exit_code = 0;
+  std::map<pbs_net_t, subjob_batch *>  by_node;
+  subjob_batch                        *bulk;
 
   get_svr_attr_l(SRV_ATR_ExitCodeCanceledJob, &cancel_exit_code);
 
-  job *pjob;
-
-  for (i = 0; i < pa->ai_qs.array_size; i++)
-    {
-    if (pa->job_ids[i] == NULL)
-      continue;
-
-    if ((pjob = svr_find_job(pa->job_ids[i], FALSE)) == NULL)
-      {
-      free(pa->job_ids[i]);
-      pa->job_ids[i] = NULL;
-      }
-    else
-      {
-      mutex_mgr pjob_mutex = mutex_mgr(pjob->ji_mutex, true);
-      num_jobs++;
-
-      if ((pjob->ji_qs.ji_state >= JOB_STATE_EXITING) &&
-          (purge == false))
-        {
-        /* invalid state for request,  skip */
-        continue;
-        }
-
-      int old_state = pjob->ji_qs.ji_state;
-        
-      running = (pjob->ji_qs.ji_state == JOB_STATE_RUNNING);
-
-      pthread_mutex_unlock(pa->ai_mutex);
+  /* drop the subjobs that were never created so that deleting the others doesn't
+   * instantiate them */
+  if (pa->remove_uncreated_range(0, pa->ai_qs.array_size - 1, cancel_exit_code) > 0)
+    array_save(pa);
 
-      if (purge)
-        {
-        deleted = true;
+  bulk = new subjob_batch(pa->ai_qs.parent_id, purge);
 
-        try
-          {
-          force_purge_work(pjob);
-          }
-        catch (int err)
-          {
-          if (err != PBSE_JOB_RECYCLED)
-            {
-            char log_buf[LOCAL_LOG_BUF_SIZE];
-            sprintf(log_buf, "Error when purging %s", pa->job_ids[i]);
-            log_err(err, __func__, log_buf);
-            deleted = false;
-            }
-          }
-        }
-      else
-        deleted = attempt_delete(pjob);
+  for (int i = 0; i < pa->ai_qs.array_size; i++)
+    {
+    int rc = batch_subjob_delete(pa, i, purge, purge == false, bulk, by_node);
 
-      /* we come out of attempt_delete unlocked */
-      pjob_mutex.set_unlock_on_exit(false);
+    if (rc == PBSE_UNKJOBID)
+      continue;
 
-      if (deleted == false)
-        {
-        /* if the job was deleted, this mutex would be taked care of elsewhere.
-         * When it fails, release it here */
-        num_skipped++;
-        }
-      else if (running == FALSE)
-        {
-        /* running jobs will increase the deleted count when their obit is reported */
-        num_deleted++;
-        }
+    num_jobs++;
 
-      if ((pa = get_array(array_id.c_str())) == NULL)
-        break;
-      
-      if ((deleted == true) &&
-          (purge == false))
-        pa->update_array_values(old_state, aeTerminate, pa->job_ids[i], cancel_exit_code);
-      }
+    if (rc == PBSE_BADSTATE)
+      num_skipped++;
     }
 
-  if (pa != NULL)
-    pa->ai_qs.num_failed += num_deleted;
+  dispatch_subjob_batches(pa, bulk, by_node);
 
   if (num_jobs == 0)
     return(NO_JOBS_IN_ARRAY);
@@ -1699,6 +2126,19 @@ int hold_array_range(
         unlock_ji_mutex(pjob, __func__, NULL, LOGLEVEL);
         }
       }
+
+    /* subjobs that haven't been created get the hold when they are */
+    if (pa->uncreated_ids.size() > 0)
+      {
+      std::vector<std::pair<int, int> > runs;
+
+      get_range_runs(range_vec, runs);
+
+      for (size_t i = 0; i < runs.size(); i++)
+        pa->hold_uncreated_range(runs[i].first, runs[i].second, temphold->at_val.at_long);
+
+      array_save(pa);
+      }
     }
 
   return(PBSE_NONE);
@@ -1706,6 +2146,44 @@ int hold_array_range(
 
 
 
+/*
+ * release_uncreated_holds()
+ *
+ * Releases the holds named in preq from the uncreated subjobs from start to end, inclusive
+ *
+ * @return PBSE_NONE, or the error if the holds are invalid or preq may not release them
+ */
+
+int release_uncreated_holds(
+
+  job_array            *pa,
+  struct batch_request *preq,
+  int                   start,
+  int                   end)
+
+  {
+  pbs_attribute  temphold;
+  const char    *pset;
+  int            rc;
+
+  if (pa->uncreated_holds.size() == 0)
+    return(PBSE_NONE);
+
+  if ((rc = get_hold(&preq->rq_ind.rq_hold.rq_orig.rq_attr, &pset, &temphold)) != PBSE_NONE)
+    return(rc);
+
+  if ((rc = chk_hold_priv(temphold.at_val.at_long, preq->rq_perm)) != PBSE_NONE)
+    return(rc);
+
+  pa->release_uncreated_range(start, end, temphold.at_val.at_long);
+
+  array_save(pa);
+
+  return(PBSE_NONE);
+  } /* END release_uncreated_holds() */
+
+
+
 
 int release_array_range(
 
@@ -1757,6 +2235,19 @@ int release_array_range(
       }
     }
 
+  if (pa->uncreated_holds.size() > 0)
+    {
+    std::vector<std::pair<int, int> > runs;
+
+    get_range_runs(range_vec, runs);
+
+    for (size_t i = 0; i < runs.size(); i++)
+      {
+      if ((rc = release_uncreated_holds(pa, preq, runs[i].first, runs[i].second)) != PBSE_NONE)
+        return(rc);
+      }
+    }
+
   return(PBSE_NONE);
   } /* END release_array_range() */
 
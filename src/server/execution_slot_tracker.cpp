@@ -11,15 +11,22 @@ const int  SUBSET_TOO_LARGE = -3;
 const bool OCCUPIED = true;
 const bool FREE = false;
 
+/*
+ * Slots are kept in slot_words, SLOT_WORD_BITS to a word. The bits past
+ * slot_count in the last word are always clear, so whole words can be
+ * compared, counted and combined without masking everywhere.
+ */
+
 execution_slot_tracker::execution_slot_tracker(const execution_slot_tracker& est)
   {
-  this->slots = est.slots;
+  this->slot_words = est.slot_words;
+  this->slot_count = est.slot_count;
   this->open_count = est.open_count;
   } /* END copy constructor */
 
 
 
-execution_slot_tracker::execution_slot_tracker() : open_count(0)
+execution_slot_tracker::execution_slot_tracker() : slot_words(), slot_count(0), open_count(0)
   {
   } /* END default contructor */
 
@@ -30,10 +37,11 @@ execution_slot_tracker::execution_slot_tracker(
   const int size)
 
   {
-  this->open_count = 0;
-  
-  for (int i = 0; i < size; i++)
-    this->add_execution_slot();
+  int count = (size > 0) ? size : 0;
+
+  this->slot_words.assign((count + SLOT_WORD_BITS - 1) / SLOT_WORD_BITS, 0);
+  this->slot_count = count;
+  this->open_count = count;
   }
 
 
@@ -45,13 +53,33 @@ execution_slot_tracker& execution_slot_tracker::operator= (
   if (this == &est)
     return(*this);
 
-  this->slots = est.slots;
+  this->slot_words = est.slot_words;
+  this->slot_count = est.slot_count;
   this->open_count = est.open_count;
   return(*this);
   } /* END = operator */
 
 
 
+/*
+ * valid_bits()
+ * @return the bits of slot_words[word_index] that are slots
+ */
+slot_word_t execution_slot_tracker::valid_bits(
+
+  int word_index) const
+
+  {
+  int tail = this->slot_count - (word_index * SLOT_WORD_BITS);
+
+  if (tail >= SLOT_WORD_BITS)
+    return(~(slot_word_t)0);
+
+  return(((slot_word_t)1 << tail) - 1);
+  } /* END valid_bits() */
+
+
+
 /*
  * unset_subset()
  * @pre-cond: subset must be of an equal or smaller size than this execution slot tracker object
@@ -65,10 +93,12 @@ int execution_slot_tracker::unset_subset(
   if (subset.get_total_execution_slots() > this->get_total_execution_slots())
     return(SUBSET_TOO_LARGE);
 
-  for (int i = 0; i < subset.get_total_execution_slots(); i++)
+  for (unsigned int i = 0; i < subset.slot_words.size(); i++)
     {
-    if (subset.slots[i] == OCCUPIED)
-      this->mark_as_free(i);
+    slot_word_t freed = this->slot_words[i] & subset.slot_words[i];
+
+    this->open_count += __builtin_popcountll(freed);
+    this->slot_words[i] &= ~freed;
     }
 
   return(PBSE_NONE);
@@ -88,26 +118,20 @@ int execution_slot_tracker::mark_as_used (
   int index)
 
   {
-  int size = this->slots.size();
-
   if ((index < 0) ||
-      (index >= size))
+      (index >= this->slot_count))
     return(OUT_OF_RANGE);
 
-  try 
-    {
-    if (this->slots[index] == FREE)
-      {
-      this->slots[index] = OCCUPIED;
-      this->open_count--;
-      }
+  slot_word_t &word = this->slot_words[index / SLOT_WORD_BITS];
+  slot_word_t  bit = (slot_word_t)1 << (index % SLOT_WORD_BITS);
 
-    return(PBSE_NONE);
-    }
-  catch (std::out_of_range &oor)
+  if ((word & bit) == 0)
     {
-    return(OUT_OF_RANGE);
+    word |= bit;
+    this->open_count--;
     }
+
+  return(PBSE_NONE);
   }
 
 
@@ -124,26 +148,20 @@ int execution_slot_tracker::mark_as_free (
   int index)
 
   {
-  int size = this->slots.size();
-
   if ((index < 0) ||
-      (index >= size))
+      (index >= this->slot_count))
     return(OUT_OF_RANGE);
   
-  try
-    {
-    if (this->slots[index] == OCCUPIED)
-      {
-      this->slots[index] = FREE;
-      this->open_count++;
-      }
+  slot_word_t &word = this->slot_words[index / SLOT_WORD_BITS];
+  slot_word_t  bit = (slot_word_t)1 << (index % SLOT_WORD_BITS);
 
-    return(PBSE_NONE);
-    }
-  catch (std::out_of_range &oor)
+  if ((word & bit) != 0)
     {
-    return(OUT_OF_RANGE);
+    word &= ~bit;
+    this->open_count++;
     }
+
+  return(PBSE_NONE);
   }
   
 
@@ -198,15 +216,45 @@ int execution_slot_tracker::reserve_execution_slots(
   while (est.get_total_execution_slots() < this->get_total_execution_slots())
     est.add_execution_slot();
 
-  for (int i = 0; i < this->slots.size() && reserved_so_far < num_slots_to_reserve; i++)
+  for (unsigned int i = 0;
+       (i < this->slot_words.size()) && (reserved_so_far < num_slots_to_reserve);
+       i++)
     {
-    if (this->slots[i] == FREE)
+    slot_word_t free_bits = ~this->slot_words[i] & this->valid_bits(i);
+    int         free_count = __builtin_popcountll(free_bits);
+    slot_word_t taken;
+
+    if (free_count == 0)
+      continue;
+
+    if (free_count <= num_slots_to_reserve - reserved_so_far)
       {
-      reserved_so_far++;
-      this->mark_as_used(i);
+      /* the whole word fits in what's left */
+      taken = free_bits;
+      reserved_so_far += free_count;
+      }
+    else
+      {
+      /* take the lowest free slots one at a time */
+      taken = 0;
+
+      while (reserved_so_far < num_slots_to_reserve)
+        {
+        slot_word_t lowest = free_bits & -free_bits;
+
+        taken |= lowest;
+        free_bits &= ~lowest;
+        reserved_so_far++;
+        }
 
-      est.mark_as_used(i);
+      free_count = __builtin_popcountll(taken);
       }
+
+    this->slot_words[i] |= taken;
+    this->open_count -= free_count;
+
+    est.open_count -= __builtin_popcountll(taken & ~est.slot_words[i]);
+    est.slot_words[i] |= taken;
     }
 
   return(PBSE_NONE);
@@ -226,16 +274,7 @@ int execution_slot_tracker::unreserve_execution_slots(
   const execution_slot_tracker &subset)
 
   {
-  if (this->slots.size() < subset.slots.size())
-    return(SUBSET_TOO_LARGE);
-
-  for (int i = 0; i < subset.slots.size(); i++)
-    {
-    if (subset.slots[i] == OCCUPIED)
-      this->mark_as_free(i);
-    }
-
-  return(PBSE_NONE);
+  return(this->unset_subset(subset));
   }
 
 
@@ -249,7 +288,7 @@ int execution_slot_tracker::get_number_free() const
 
 int execution_slot_tracker::get_total_execution_slots() const
   {
-  return(this->slots.size());
+  return(this->slot_count);
   }
 
 
@@ -257,7 +296,10 @@ int execution_slot_tracker::get_total_execution_slots() const
 void execution_slot_tracker::add_execution_slot ()
 
   {
-  this->slots.push_back(FREE);
+  if (this->slot_count % SLOT_WORD_BITS == 0)
+    this->slot_words.push_back(0);
+
+  this->slot_count++;
   this->open_count++;
   }
 
@@ -265,19 +307,22 @@ void execution_slot_tracker::add_execution_slot ()
 
 int execution_slot_tracker::remove_execution_slot ()
   {
-  try
-    {
-    if (this->slots[this->slots.size() - 1] == FREE)
-      this->open_count--;
-
-    this->slots.pop_back();
+  int last = this->slot_count - 1;
 
-    return(PBSE_NONE);
-    }
-  catch (...)
-    {
+  if (last < 0)
     return(-4);
-    }
+
+  if (this->is_occupied(last) == false)
+    this->open_count--;
+  else
+    this->slot_words[last / SLOT_WORD_BITS] &= ~((slot_word_t)1 << (last % SLOT_WORD_BITS));
+
+  this->slot_count--;
+
+  if (this->slot_count % SLOT_WORD_BITS == 0)
+    this->slot_words.pop_back();
+
+  return(PBSE_NONE);
   }
 
 
@@ -292,24 +337,28 @@ int execution_slot_tracker::get_next_occupied_index(
   int &iterator) const
 
   {
-  int occupied_index = -1;
-
   if (iterator == -1)
     iterator = 0;
 
-  while (iterator < this->slots.size())
+  while (iterator < this->slot_count)
     {
-    if (this->slots[iterator] == OCCUPIED)
+    int         bit = iterator % SLOT_WORD_BITS;
+    slot_word_t occupied = this->slot_words[iterator / SLOT_WORD_BITS] >> bit;
+
+    if (occupied != 0)
       {
-      occupied_index = iterator;
-      iterator++;
-      break;
+      int occupied_index = iterator + __builtin_ctzll(occupied);
+
+      iterator = occupied_index + 1;
+      return(occupied_index);
       }
-    else
-      iterator++;
+
+    iterator += SLOT_WORD_BITS - bit;
     }
 
-  return(occupied_index);
+  iterator = this->slot_count;
+
+  return(-1);
   }
 
 bool execution_slot_tracker::is_occupied(
@@ -317,21 +366,9 @@ bool execution_slot_tracker::is_occupied(
   int index) const
 
   {
-  int  size = this->slots.size();
-  bool occupied = false;
-
   if ((index < 0) ||
-      (index >= size))
-    return(false);
-  
-  try
-    {
-    occupied = this->slots[index] == OCCUPIED;
-    }
-  catch (std::out_of_range &oor)
-    {
+      (index >= this->slot_count))
     return(false);
-    }
 
-  return(occupied);
+  return((this->slot_words[index / SLOT_WORD_BITS] >> (index % SLOT_WORD_BITS)) & 1);
   }
@@ -0,0 +1,301 @@
+#include "free_node_index.hpp"
+
+
+indexed_node::indexed_node() : in_available(false), in_free_slots(0), in_free_gpus(0),
+                               in_properties()
+  {
+  }
+
+
+
+free_node_index::free_node_index() : fni_nodes(), fni_available(), fni_by_property(),
+                                     fni_by_slots(), fni_by_gpus(), fni_unindexable()
+  {
+  pthread_mutex_init(&this->fni_mutex, NULL);
+  }
+
+
+
+free_node_index::~free_node_index()
+
+  {
+  pthread_mutex_destroy(&this->fni_mutex);
+  }
+
+
+
+/*
+ * unlink_node()
+ *
+ * Takes the node out of the secondary indexes. fni_mutex must be held.
+ */
+
+void free_node_index::unlink_node(
+
+  int                 node_id,
+  const indexed_node &in)
+
+  {
+  std::map<int, std::set<int> >::iterator         count_it;
+  std::map<std::string, std::set<int> >::iterator prop_it;
+
+  if (in.in_available == false)
+    return;
+
+  this->fni_available.erase(node_id);
+
+  if ((count_it = this->fni_by_slots.find(in.in_free_slots)) != this->fni_by_slots.end())
+    {
+    count_it->second.erase(node_id);
+    if (count_it->second.size() == 0)
+      this->fni_by_slots.erase(count_it);
+    }
+
+  if ((count_it = this->fni_by_gpus.find(in.in_free_gpus)) != this->fni_by_gpus.end())
+    {
+    count_it->second.erase(node_id);
+    if (count_it->second.size() == 0)
+      this->fni_by_gpus.erase(count_it);
+    }
+
+  for (unsigned int i = 0; i < in.in_properties.size(); i++)
+    {
+    if ((prop_it = this->fni_by_property.find(in.in_properties[i])) != this->fni_by_property.end())
+      {
+      prop_it->second.erase(node_id);
+      if (prop_it->second.size() == 0)
+        this->fni_by_property.erase(prop_it);
+      }
+    }
+  } /* END unlink_node() */
+
+
+
+/*
+ * link_node()
+ *
+ * Adds an available node to the secondary indexes. fni_mutex must be held.
+ */
+
+void free_node_index::link_node(
+
+  int                 node_id,
+  const indexed_node &in)
+
+  {
+  if (in.in_available == false)
+    return;
+
+  this->fni_available.insert(node_id);
+  this->fni_by_slots[in.in_free_slots].insert(node_id);
+  this->fni_by_gpus[in.in_free_gpus].insert(node_id);
+
+  for (unsigned int i = 0; i < in.in_properties.size(); i++)
+    this->fni_by_property[in.in_properties[i]].insert(node_id);
+  } /* END link_node() */
+
+
+
+/*
+ * update()
+ *
+ * Records the node's current state. Called with the node locked whenever
+ * its state, free execution slots or free gpus may have changed.
+ *
+ * @param node_id - the node's nd_id
+ * @param available - true if the node can be given work now
+ * @param free_slots - the node's free execution slots
+ * @param free_gpus - the node's free gpus
+ * @param properties - the node's properties
+ */
+
+void free_node_index::update(
+
+  int                             node_id,
+  bool                            available,
+  int                             free_slots,
+  int                             free_gpus,
+  const std::vector<std::string> &properties)
+
+  {
+  pthread_mutex_lock(&this->fni_mutex);
+
+  indexed_node &in = this->fni_nodes[node_id];
+
+  if ((in.in_available != available) ||
+      (in.in_free_slots != free_slots) ||
+      (in.in_free_gpus != free_gpus) ||
+      (in.in_properties != properties))
+    {
+    this->unlink_node(node_id, in);
+
+    in.in_available = available;
+    in.in_free_slots = free_slots;
+    in.in_free_gpus = free_gpus;
+    in.in_properties = properties;
+
+    this->link_node(node_id, in);
+    }
+
+  pthread_mutex_unlock(&this->fni_mutex);
+  } /* END update() */
+
+
+
+/*
+ * mark_unindexable()
+ *
+ * Notes a node whose work is placed on its numa or alps subnodes. The
+ * index doesn't track subnodes, so it can't be used while such nodes exist.
+ */
+
+void free_node_index::mark_unindexable(
+
+  int node_id)
+
+  {
+  pthread_mutex_lock(&this->fni_mutex);
+  this->fni_unindexable.insert(node_id);
+  pthread_mutex_unlock(&this->fni_mutex);
+  } /* END mark_unindexable() */
+
+
+
+/*
+ * remove()
+ *
+ * Forgets a node that is being deleted
+ */
+
+void free_node_index::remove(
+
+  int node_id)
+
+  {
+  std::map<int, indexed_node>::iterator it;
+
+  pthread_mutex_lock(&this->fni_mutex);
+
+  if ((it = this->fni_nodes.find(node_id)) != this->fni_nodes.end())
+    {
+    this->unlink_node(node_id, it->second);
+    this->fni_nodes.erase(it);
+    }
+
+  this->fni_unindexable.erase(node_id);
+
+  pthread_mutex_unlock(&this->fni_mutex);
+  } /* END remove() */
+
+
+
+/*
+ * is_usable()
+ *
+ * @return true if selection can start from this index
+ */
+
+bool free_node_index::is_usable()
+
+  {
+  bool usable;
+
+  pthread_mutex_lock(&this->fni_mutex);
+  usable = (this->fni_unindexable.size() == 0) && (this->fni_nodes.size() > 0);
+  pthread_mutex_unlock(&this->fni_mutex);
+
+  return(usable);
+  } /* END is_usable() */
+
+
+
+/*
+ * get_candidates()
+ *
+ * Adds the available nodes with at least min_slots free slots, min_gpus free
+ * gpus and every property in properties to candidates. The search starts
+ * from whichever index yields the fewest nodes.
+ *
+ * @return the number of nodes added
+ */
+
+int free_node_index::get_candidates(
+
+  int                             min_slots,
+  int                             min_gpus,
+  const std::vector<std::string> &properties,
+  std::set<int>                  &candidates)
+
+  {
+  std::set<int>                                   by_count;
+  const std::set<int>                            *start = NULL;
+  std::map<int, std::set<int> >::iterator         count_it;
+  std::map<std::string, std::set<int> >::iterator prop_it;
+  int                                             added = 0;
+
+  pthread_mutex_lock(&this->fni_mutex);
+
+  for (unsigned int i = 0; i < properties.size(); i++)
+    {
+    if ((prop_it = this->fni_by_property.find(properties[i])) == this->fni_by_property.end())
+      {
+      // no available node has this property
+      pthread_mutex_unlock(&this->fni_mutex);
+      return(0);
+      }
+
+    if ((start == NULL) ||
+        (prop_it->second.size() < start->size()))
+      start = &prop_it->second;
+    }
+
+  if (start == NULL)
+    {
+    if (min_gpus > 0)
+      {
+      for (count_it = this->fni_by_gpus.lower_bound(min_gpus); count_it != this->fni_by_gpus.end(); count_it++)
+        by_count.insert(count_it->second.begin(), count_it->second.end());
+      }
+    else if (min_slots > 0)
+      {
+      for (count_it = this->fni_by_slots.lower_bound(min_slots); count_it != this->fni_by_slots.end(); count_it++)
+        by_count.insert(count_it->second.begin(), count_it->second.end());
+      }
+    else
+      by_count = this->fni_available;
+
+    start = &by_count;
+    }
+
+  for (std::set<int>::const_iterator it = start->begin(); it != start->end(); it++)
+    {
+    const indexed_node &in = this->fni_nodes[*it];
+    bool                fits = (in.in_free_slots >= min_slots) && (in.in_free_gpus >= min_gpus);
+
+    for (unsigned int i = 0; (fits == true) && (i < properties.size()); i++)
+      fits = this->fni_by_property[properties[i]].count(*it) > 0;
+
+    if ((fits == true) &&
+        (candidates.insert(*it).second == true))
+      added++;
+    }
+
+  pthread_mutex_unlock(&this->fni_mutex);
+
+  return(added);
+  } /* END get_candidates() */
+
+
+
+int free_node_index::count_available()
+
+  {
+  int count;
+
+  pthread_mutex_lock(&this->fni_mutex);
+  count = this->fni_available.size();
+  pthread_mutex_unlock(&this->fni_mutex);
+
+  return(count);
+  } /* END count_available() */
+
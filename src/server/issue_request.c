@@ -213,7 +213,7 @@ int relay_to_mom(
   unlock_ji_mutex(pjob, __func__, NULL, LOGLEVEL);
   *pjob_ptr = NULL;
 
-  handle = svr_connect(addr, port, &local_errno, NULL, NULL);
+  handle = svr_connect_pooled(addr, port, &local_errno, NULL);
 
   if (handle < 0)
     {
@@ -476,6 +476,39 @@ int handle_local_request(
 
 
 
+/*
+ * request_can_reuse_connection - the mom answers these requests in-line and
+ * keeps reading from the connection afterward, so once the reply has been
+ * read the connection can be handed back to the pool. Requests which make
+ * the mom fork, stream files or register close functions are not re-used.
+ */
+
+bool request_can_reuse_connection(
+
+  int rq_type)
+
+  {
+  switch (rq_type)
+    {
+    case PBS_BATCH_DeleteJob:
+    case PBS_BATCH_SignalJob:
+    case PBS_BATCH_AsySignalJob:
+    case PBS_BATCH_ModifyJob:
+    case PBS_BATCH_AsyModifyJob:
+    case PBS_BATCH_MessJob:
+    case PBS_BATCH_StatusJob:
+
+      return(true);
+
+    default:
+
+      return(false);
+    }
+  } /* END request_can_reuse_connection() */
+
+
+
+
 int send_request_to_remote_server(
     
   int            conn,
@@ -767,7 +800,13 @@ int send_request_to_remote_server(
   DIS_tcp_cleanup(chan);
 
   if (close_handle == true)
-    svr_disconnect(conn);
+    {
+    bool reusable = (rc == PBSE_NONE) &&
+                    (tmp_rc == PBSE_NONE) &&
+                    (request_can_reuse_connection(request->rq_type) == true);
+
+    svr_release_connection(conn, reusable);
+    }
   
   pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, 0);
 
@@ -11,6 +11,7 @@
 void reissue_to_svr(struct work_task *);
 
 int handle_local_request(int conn, batch_request *request);
+bool request_can_reuse_connection(int rq_type);
 
 void release_req(struct work_task *pwt);
 
@@ -152,6 +152,7 @@ void job::set_plugin_resource_usage(
 
   {
   this->ji_plugin_usage_info[name] = value;
+  this->invalidate_status_cache();
   }
   
 
@@ -171,6 +172,8 @@ void job::set_plugin_resource_usage_from_json(
 
   for (size_t i = 0; i < keys.size(); i++)
     this->ji_plugin_usage_info[keys[i]] = resources[keys[i]].asString();
+
+  this->invalidate_status_cache();
   }
 
 
@@ -21,6 +21,289 @@ int create_and_queue_array_subjob(job_array *pa, mutex_mgr &array_mgr, job *temp
 
 const int DEFAULT_IDLE_SLOT_LIMIT = 300;
 
+#define SUBJOB_WORD_BITS 64
+
+
+
+void subjob_index_set::clear()
+
+  {
+  this->words.clear();
+  this->count = 0;
+  this->first_word = 0;
+  } // END clear()
+
+
+
+void subjob_index_set::add(
+
+  int index)
+
+  {
+  if (index < 0)
+    return;
+
+  size_t             word = index / SUBJOB_WORD_BITS;
+  unsigned long long bit = 1ULL << (index % SUBJOB_WORD_BITS);
+
+  if (word >= this->words.size())
+    this->words.resize(word + 1, 0);
+
+  if ((this->words[word] & bit) == 0)
+    {
+    this->words[word] |= bit;
+    this->count++;
+
+    if (word < this->first_word)
+      this->first_word = word;
+    }
+  } // END add()
+
+
+
+/*
+ * add_range()
+ *
+ * Adds every index from start to end, inclusive, a word at a time
+ */
+
+void subjob_index_set::add_range(
+
+  int start,
+  int end)
+
+  {
+  if (start < 0)
+    start = 0;
+
+  if (end < start)
+    return;
+
+  if ((size_t)(end / SUBJOB_WORD_BITS) >= this->words.size())
+    this->words.resize(end / SUBJOB_WORD_BITS + 1, 0);
+
+  if ((size_t)(start / SUBJOB_WORD_BITS) < this->first_word)
+    this->first_word = start / SUBJOB_WORD_BITS;
+
+  while (start <= end)
+    {
+    size_t             word = start / SUBJOB_WORD_BITS;
+    int                low = start % SUBJOB_WORD_BITS;
+    int                high = SUBJOB_WORD_BITS - 1;
+    unsigned long long mask;
+
+    if (end - start < high - low)
+      high = low + end - start;
+
+    mask = (high == SUBJOB_WORD_BITS - 1) ? ~0ULL : ((1ULL << (high + 1)) - 1);
+    mask &= ~((1ULL << low) - 1);
+
+    this->count += __builtin_popcountll(~this->words[word] & mask);
+    this->words[word] |= mask;
+
+    start += high - low + 1;
+    }
+  } // END add_range()
+
+
+
+bool subjob_index_set::contains(
+
+  int index) const
+
+  {
+  size_t word = index / SUBJOB_WORD_BITS;
+
+  if ((index < 0) ||
+      (word >= this->words.size()))
+    return(false);
+
+  return((this->words[word] & (1ULL << (index % SUBJOB_WORD_BITS))) != 0);
+  } // END contains()
+
+
+
+bool subjob_index_set::remove(
+
+  int index)
+
+  {
+  if (this->contains(index) == false)
+    return(false);
+
+  this->words[index / SUBJOB_WORD_BITS] &= ~(1ULL << (index % SUBJOB_WORD_BITS));
+  this->count--;
+
+  return(true);
+  } // END remove()
+
+
+
+/*
+ * remove_range()
+ *
+ * Removes every index from start to end, inclusive, a word at a time
+ *
+ * @return the number of indices that were removed
+ */
+
+int subjob_index_set::remove_range(
+
+  int start,
+  int end)
+
+  {
+  int removed = 0;
+
+  if (start < 0)
+    start = 0;
+
+  if (end >= (int)(this->words.size() * SUBJOB_WORD_BITS))
+    end = this->words.size() * SUBJOB_WORD_BITS - 1;
+
+  while (start <= end)
+    {
+    size_t             word = start / SUBJOB_WORD_BITS;
+    int                low = start % SUBJOB_WORD_BITS;
+    int                high = SUBJOB_WORD_BITS - 1;
+    unsigned long long mask;
+
+    if (end - start < high - low)
+      high = low + end - start;
+
+    mask = (high == SUBJOB_WORD_BITS - 1) ? ~0ULL : ((1ULL << (high + 1)) - 1);
+    mask &= ~((1ULL << low) - 1);
+
+    removed += __builtin_popcountll(this->words[word] & mask);
+    this->words[word] &= ~mask;
+
+    start += high - low + 1;
+    }
+
+  this->count -= removed;
+
+  return(removed);
+  } // END remove_range()
+
+
+
+/*
+ * first()
+ *
+ * @return the lowest index in the set, or -1 if the set is empty
+ */
+
+int subjob_index_set::first()
+
+  {
+  while ((this->first_word < this->words.size()) &&
+         (this->words[this->first_word] == 0))
+    this->first_word++;
+
+  if (this->first_word >= this->words.size())
+    return(-1);
+
+  return(this->first_word * SUBJOB_WORD_BITS + __builtin_ctzll(this->words[this->first_word]));
+  } // END first()
+
+
+
+int subjob_index_set::size() const
+
+  {
+  return(this->count);
+  } // END size()
+
+
+
+/*
+ * from_range_string()
+ *
+ * Replaces the set's contents with the indices in range_str
+ *
+ * @param range_str - a string of the form %d[[-%d][,%d[-%d]]...]
+ * @return PBSE_NONE or the rc from translate_range_string_to_vector()
+ */
+
+int subjob_index_set::from_range_string(
+
+  const char *range_str)
+
+  {
+  std::vector<int> indices;
+  int              rc;
+
+  this->clear();
+
+  if ((rc = translate_range_string_to_vector(range_str, indices)) != PBSE_NONE)
+    return(rc);
+
+  for (size_t i = 0; i < indices.size(); i++)
+    this->add(indices[i]);
+
+  return(PBSE_NONE);
+  } // END from_range_string()
+
+
+
+/*
+ * to_range_string()
+ *
+ * Writes the set as a string of the form %d[[-%d][,%d[-%d]]...]
+ */
+
+void subjob_index_set::to_range_string(
+
+  std::string &range_str) const
+
+  {
+  char buf[MAXLINE];
+  int  begin = -1;
+  int  prev = -1;
+
+  range_str.clear();
+
+  for (size_t word = this->first_word; word < this->words.size(); word++)
+    {
+    unsigned long long bits = this->words[word];
+
+    while (bits != 0)
+      {
+      int index = word * SUBJOB_WORD_BITS + __builtin_ctzll(bits);
+
+      bits &= bits - 1;
+
+      if (index == prev + 1)
+        {
+        prev = index;
+        continue;
+        }
+
+      if (begin != -1)
+        {
+        if (begin == prev)
+          snprintf(buf, sizeof(buf), "%s%d", (range_str.size() == 0) ? "" : ",", begin);
+        else
+          snprintf(buf, sizeof(buf), "%s%d-%d", (range_str.size() == 0) ? "" : ",", begin, prev);
+
+        range_str += buf;
+        }
+
+      begin = prev = index;
+      }
+    }
+
+  if (begin != -1)
+    {
+    if (begin == prev)
+      snprintf(buf, sizeof(buf), "%s%d", (range_str.size() == 0) ? "" : ",", begin);
+    else
+      snprintf(buf, sizeof(buf), "%s%d-%d", (range_str.size() == 0) ? "" : ",", begin, prev);
+
+    range_str += buf;
+    }
+  } // END to_range_string()
+
 
 
 // array_info empty constructor
@@ -55,7 +338,8 @@ array_info::~array_info()
 
 // job_array empty constructor
 job_array::job_array() : job_ids(NULL), jobs_recovered(0), ai_ghost_recovered(false), uncreated_ids(),
-                         ai_mutex(NULL), ai_qs(), being_deleted(false)
+                         uncreated_ids_recovered(false), uncreated_holds(), bulk_updates(0),
+                         save_deferred(false), ai_mutex(NULL), ai_qs(), being_deleted(false)
 
   {
   this->ai_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
@@ -235,19 +519,24 @@ int job_array::parse_array_request(
   const char *request)
 
   {
-  int  rc = PBSE_NONE;
-  long max_array_size;
-  char log_buf[LOCAL_LOG_BUF_SIZE];
+  int              rc = PBSE_NONE;
+  long             max_array_size;
+  char             log_buf[LOCAL_LOG_BUF_SIZE];
+  std::vector<int> indices;
+
   this->uncreated_ids.clear();
 
-  if ((rc = translate_range_string_to_vector(request, this->uncreated_ids)) != PBSE_NONE)
+  if ((rc = translate_range_string_to_vector(request, indices)) != PBSE_NONE)
     return(rc);
 
+  for (size_t i = 0; i < indices.size(); i++)
+    this->uncreated_ids.add(indices[i]);
+
   this->ai_qs.range_str = request;
   this->ai_qs.num_jobs = this->uncreated_ids.size();
 
   // size of array is the biggest index + 1
-  this->ai_qs.array_size = this->uncreated_ids[this->uncreated_ids.size() - 1] + 1;
+  this->ai_qs.array_size = indices[indices.size() - 1] + 1;
 
   if (get_svr_attr_l(SRV_ATR_MaxArraySize, &max_array_size) == PBSE_NONE)
     {
@@ -284,18 +573,14 @@ bool job_array::need_to_update_slot_limits() const
  *
  * Determines the index of the next subjob that should be created
  *
- * @param internal_index - the index of uncreated_ids that corresponds to the subjob index returned
  * @return the index of the next subjob to be created, or -1 if no job should be created
  * at this time.
  */
 
-int job_array::get_next_index_to_create(
-    
-  int &internal_index)
+int job_array::get_next_index_to_create()
 
   {
   int index = -1;
-  internal_index = -1;
 
   // Don't instantiate new jobs after we've been deleted
   if (this->being_deleted == false)
@@ -303,15 +588,7 @@ int job_array::get_next_index_to_create(
     if ((this->ai_qs.idle_slot_limit == NO_SLOT_LIMIT) ||
         (this->ai_qs.num_idle < this->ai_qs.idle_slot_limit))
       {
-      for (size_t i = 0; i < this->uncreated_ids.size(); i++)
-        {
-        if (this->uncreated_ids[i] != -1)
-          {
-          index = this->uncreated_ids[i];
-          internal_index = i;
-          break;
-          }
-        }
+      index = this->uncreated_ids.first();
       }
     }
 
@@ -320,6 +597,74 @@ int job_array::get_next_index_to_create(
 
 
 
+/*
+ * create_subjob()
+ *
+ * Instantiates the subjob at index from the array's template job. The array must be
+ * locked and is still locked on return.
+ *
+ * @param index - the index of the subjob to create
+ * @return PBSE_NONE if the subjob was created, PBSE_UNKJOBID if index isn't an uncreated
+ * subjob, or the error from creating it
+ */
+
+int job_array::create_subjob(
+
+  int index)
+
+  {
+  int rc;
+
+  if (this->uncreated_ids.contains(index) == false)
+    return(PBSE_UNKJOBID);
+
+  job *template_job = svr_find_job(this->ai_qs.parent_id, FALSE);
+
+  if (template_job == NULL)
+    return(PBSE_UNKJOBID);
+
+  mutex_mgr template_mgr(template_job->ji_mutex, true);
+  mutex_mgr array_mgr(this->ai_mutex, true);
+
+  // the caller still holds the array
+  array_mgr.set_unlock_on_exit(false);
+
+  char  old_id[PBS_MAXSVRJOBID + 1];
+  char  prev_job_id[PBS_MAXSVRJOBID + 1];
+  char *hostname_extension;
+  char *bracket;
+
+  strcpy(old_id, template_job->ji_qs.ji_jobid);
+  hostname_extension = strchr(old_id, '.');
+  bracket = strchr(old_id, '[');
+
+  if (bracket != NULL)
+    *bracket = '\0';
+
+  if (hostname_extension != NULL)
+    snprintf(prev_job_id, sizeof(prev_job_id), "%s[%d]%s",
+      old_id, this->ai_qs.highest_id_created, hostname_extension);
+  else
+    snprintf(prev_job_id, sizeof(prev_job_id), "%s[%d]", old_id, this->ai_qs.highest_id_created);
+
+  std::string prev_id(prev_job_id);
+  
+  rc = create_and_queue_array_subjob(this, array_mgr, template_job, template_mgr,
+                                     index, prev_id, false);
+
+  if (rc == PBSE_NONE)
+    {
+    this->uncreated_ids.remove(index);
+
+    if (index > this->ai_qs.highest_id_created)
+      this->ai_qs.highest_id_created = index;
+    }
+
+  return(rc);
+  } // END create_subjob()
+
+
+
 /*
  * create_job_if_needed()
  *
@@ -329,50 +674,46 @@ int job_array::get_next_index_to_create(
 void job_array::create_job_if_needed()
 
   {
-  int  uncreated_ids_index;
-  int  next_index = this->get_next_index_to_create(uncreated_ids_index);
+  int next_index = this->get_next_index_to_create();
 
   if (next_index >= 0)
-    {
-    job *template_job = svr_find_job(this->ai_qs.parent_id, FALSE);
+    this->create_subjob(next_index);
+  } // END create_job_if_needed()
 
-    if (template_job != NULL)
-      {
-      mutex_mgr template_mgr(template_job->ji_mutex, true);
-      mutex_mgr array_mgr(this->ai_mutex, true);
 
-      char  old_id[PBS_MAXSVRJOBID + 1];
-      char  prev_job_id[PBS_MAXSVRJOBID + 1];
-      char *hostname_extension;
-      char *bracket;
 
-      strcpy(old_id, template_job->ji_qs.ji_jobid);
-      hostname_extension = strchr(old_id, '.');
-      bracket = strchr(old_id, '[');
+/*
+ * remove_uncreated_range()
+ *
+ * Drops the uncreated subjobs from start to end, inclusive, without instantiating them.
+ * They're counted as done and purged, as if each had been created and then deleted.
+ *
+ * @param exit_status - the exit status recorded for the dropped subjobs
+ * @return the number of subjobs dropped
+ */
 
-      if (bracket != NULL)
-        *bracket = '\0';
+int job_array::remove_uncreated_range(
 
-      if (hostname_extension != NULL)
-        snprintf(prev_job_id, sizeof(prev_job_id), "%s[%d]%s",
-          old_id, this->ai_qs.highest_id_created, hostname_extension);
-      else
-        snprintf(prev_job_id, sizeof(prev_job_id), "%s[%d]", old_id, this->ai_qs.highest_id_created);
+  int start,
+  int end,
+  int exit_status)
 
-      std::string prev_id(prev_job_id);
-      
-      int rc = create_and_queue_array_subjob(this, array_mgr, template_job, template_mgr,
-                                             next_index, prev_id, false);
+  {
+  int removed = this->uncreated_ids.remove_range(start, end);
 
-      if (rc == PBSE_NONE)
-        {
-        this->uncreated_ids[uncreated_ids_index] = -1;
-        this->ai_qs.highest_id_created = next_index;
-        }
-      }
+  if (removed > 0)
+    {
+    this->ai_qs.jobs_done += removed;
+    this->ai_qs.num_purged += removed;
+
+    if (exit_status == 0)
+      this->ai_qs.num_successful += removed;
+    else
+      this->ai_qs.num_failed += removed;
     }
 
-  } // END create_job_if_needed()
+  return(removed);
+  } // END remove_uncreated_range()
 
 
 
@@ -452,8 +793,6 @@ void job_array::update_array_values(
       else
         this->ai_qs.num_failed++;
 
-      array_save(this);
-
       /* update slot limit hold if necessary */
       if (get_svr_attr_b(SRV_ATR_MoabArrayCompatible, &moab_compatible) != PBSE_NONE)
         moab_compatible = false;
@@ -528,9 +867,7 @@ void job_array::update_array_values(
       break;
     }
 
-  set_array_depend_holds(this);
-
-  array_save(this);
+  this->request_save();
   } /* END update_array_values() */
 
 
@@ -538,23 +875,166 @@ void job_array::update_array_values(
 /*
  * initialize_uncreated_ids()
  *
- * Populates the uncreated ids vector, usually called after a restart
+ * Populates the uncreated ids, usually called after a restart. Array files that didn't
+ * record them are assumed to have created every index up to highest_id_created.
  */
 
 void job_array::initialize_uncreated_ids()
 
   {
-  std::vector<int> temp;
-  translate_range_string_to_vector(this->ai_qs.range_str.c_str(), temp);
+  if (this->uncreated_ids_recovered == true)
+    return;
 
-  this->uncreated_ids.clear();
+  this->uncreated_ids.from_range_string(this->ai_qs.range_str.c_str());
+  this->uncreated_ids.remove_range(0, this->ai_qs.highest_id_created);
+  }
+
+
+
+/*
+ * hold_uncreated_range()
+ *
+ * Records holds for the sub jobs from start to end, inclusive, that haven't been created
+ * yet. Created sub jobs are held individually.
+ *
+ * @param holds - the hold bits to place
+ */
+
+void job_array::hold_uncreated_range(
+
+  int  start,
+  int  end,
+  long holds)
+
+  {
+  for (long bit = 1; bit <= holds; bit <<= 1)
+    {
+    if ((holds & bit) != 0)
+      this->uncreated_holds[bit].add_range(start, end);
+    }
+  } // END hold_uncreated_range()
+
+
+
+/*
+ * release_uncreated_range()
+ *
+ * Removes holds recorded for the uncreated sub jobs from start to end, inclusive
+ *
+ * @param holds - the hold bits to release
+ */
+
+void job_array::release_uncreated_range(
+
+  int  start,
+  int  end,
+  long holds)
+
+  {
+  std::map<long, subjob_index_set>::iterator it = this->uncreated_holds.begin();
 
-  for (size_t i = 0; i < temp.size(); i++)
+  while (it != this->uncreated_holds.end())
     {
-    if (temp[i] > this->ai_qs.highest_id_created)
-      this->uncreated_ids.push_back(temp[i]);
+    if ((holds & it->first) != 0)
+      {
+      it->second.remove_range(start, end);
+
+      if (it->second.size() == 0)
+        {
+        this->uncreated_holds.erase(it++);
+        continue;
+        }
+      }
+
+    it++;
     }
-  }
+  } // END release_uncreated_range()
+
+
+
+/*
+ * get_uncreated_holds()
+ *
+ * @return the hold bits recorded for the sub job at index
+ */
+
+long job_array::get_uncreated_holds(
+
+  int index) const
+
+  {
+  long holds = 0;
+
+  for (std::map<long, subjob_index_set>::const_iterator it = this->uncreated_holds.begin();
+       it != this->uncreated_holds.end();
+       it++)
+    {
+    if (it->second.contains(index))
+      holds |= it->first;
+    }
+
+  return(holds);
+  } // END get_uncreated_holds()
+
+
+
+/*
+ * begin_bulk_update()
+ *
+ * Starts an operation that updates the array for many sub jobs. Until the last such operation
+ * ends, requests to save the array are only remembered. The array must be locked.
+ */
+
+void job_array::begin_bulk_update()
+
+  {
+  this->bulk_updates++;
+  } // END begin_bulk_update()
+
+
+
+/*
+ * end_bulk_update()
+ *
+ * Ends a bulk operation, saving the array if it changed and no other bulk operation is
+ * still running. The array must be locked.
+ */
+
+void job_array::end_bulk_update()
+
+  {
+  if (this->bulk_updates > 0)
+    this->bulk_updates--;
+
+  if ((this->bulk_updates == 0) &&
+      (this->save_deferred == true))
+    {
+    this->save_deferred = false;
+
+    set_array_depend_holds(this);
+    array_save(this);
+    }
+  } // END end_bulk_update()
+
+
+
+/*
+ * request_save()
+ *
+ * Saves the array now, or once the running bulk operations end. The array must be locked.
+ */
+
+void job_array::request_save()
+
+  {
+  if (this->bulk_updates > 0)
+    this->save_deferred = true;
+  else
+    {
+    set_array_depend_holds(this);
+    array_save(this);
+    }
+  } // END request_save()
 
 
 
@@ -314,6 +314,11 @@ char *get_correct_jobname(
 /*
  * Searches the array passed in for the job_id
  * @parent svr_find_job()
+ * The lookup doesn't take aj's lock. The job's item is pinned while its
+ * mutex is taken, so a job removed from aj in the meantime is seen and
+ * treated as not found. The job itself is kept valid by the recycler.
+ * @param locked - whether the caller holds aj's lock, which the lookup
+ * doesn't need. The job is returned locked either way.
  */
 
 job *find_job_by_array(
@@ -324,7 +329,8 @@ job *find_job_by_array(
   bool        locked)
 
   {
-  job *pj = NULL;
+  job                    *pj = NULL;
+  container::item<job *> *pinned;
 
   if (aj == NULL)
     {
@@ -337,18 +343,21 @@ job *find_job_by_array(
     return(NULL);
     }
 
-  if (locked == false)
-    aj->lock();
-  
-  pj = aj->find(job_id);
+  if ((pinned = aj->pin(job_id, pj)) == NULL)
+    return(NULL);
 
-  if (locked == false)
-    aj->unlock();
+  lock_ji_mutex(pj, __func__, NULL, LOGLEVEL);
 
-  if (pj != NULL)
+  if (aj->removed_while_pinned(pinned, pj) == true)
     {
-    lock_ji_mutex(pj, __func__, NULL, LOGLEVEL);
+    unlock_ji_mutex(pj, __func__, "removed", LOGLEVEL);
+    pj = NULL;
+    }
+
+  aj->unpin(pinned);
 
+  if (pj != NULL)
+    {
     if (get_subjob == TRUE)
       {
       if (pj->ji_cray_clone != NULL)
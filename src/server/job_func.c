@@ -1128,7 +1128,8 @@ job *job_clone(
  * @param template_job_mgr - the mutex manager for the template job
  * @param index - the index for the new array sub job
  * @param prev_job_id - we store the new job's id here
- * @return FATAL_ERROR if the array disappears while it was unlocked.
+ * @return FATAL_ERROR if the array disappears while it was unlocked. The caller
+ *         still owns any job_clone_semaphore count it posted.
  *         NONFATAL_ERROR if something happens to the subjob
  *         PBSE_NONE on sucess
  */
@@ -1167,6 +1168,15 @@ int create_and_queue_array_subjob(
 
   mutex_mgr clone_mgr(pjobclone->ji_mutex, true);
 
+  /* apply the holds placed on this index before it was created */
+  long holds = pa->get_uncreated_holds(index);
+
+  if (holds != 0)
+    {
+    pjobclone->ji_wattr[JOB_ATR_hold].at_val.at_long |= holds;
+    pjobclone->ji_wattr[JOB_ATR_hold].at_flags |= ATR_VFLAG_SET;
+    }
+
   svr_evaljobstate(*pjobclone, newstate, newsub, 1);
 
   /* do this so that  svr_setjobstate() doesn't alter sv_jobstates,
@@ -1195,10 +1205,7 @@ int create_and_queue_array_subjob(
       }
 
     if ((pa = get_array(arrayid.c_str())) == NULL)
-      {
-      sem_wait(job_clone_semaphore);
       return(FATAL_ERROR);
-      }
 
     array_mgr.mark_as_locked();
 
@@ -1213,7 +1220,6 @@ int create_and_queue_array_subjob(
       clone_mgr.set_unlock_on_exit(false);
       }
 
-    sem_wait(job_clone_semaphore);
     return(FATAL_ERROR);
     }
     
@@ -1226,10 +1232,7 @@ int create_and_queue_array_subjob(
     svr_job_purge(pjobclone);
     
     if ((pa = get_array(arrayid.c_str())) == NULL)
-      {
-      sem_wait(job_clone_semaphore);
       return(FATAL_ERROR);
-      }
 
     array_mgr.mark_as_locked();
     
@@ -1237,6 +1240,9 @@ int create_and_queue_array_subjob(
     }
     
   prev_job_id = pjobclone->ji_qs.ji_jobid;
+
+  if (holds != 0)
+    pa->release_uncreated_range(index, index, holds);
   
   pa->ai_qs.num_idle++;
   pa->ai_qs.num_cloned++;
@@ -1420,13 +1426,11 @@ void *job_clone_wt(
 
   template_job_mgr.unlock();
 
-  for (size_t i = 0; i < pa->uncreated_ids.size(); i++)
-    {
-    if (pa->uncreated_ids[i] == -1)
-      continue;
+  int index;
 
-    int index = pa->uncreated_ids[i];
-    pa->uncreated_ids[i] = -1;
+  while ((index = pa->uncreated_ids.first()) != -1)
+    {
+    pa->uncreated_ids.remove(index);
     pa->ai_qs.highest_id_created = index;
 
     /* This job already exists. This can happen when trying to recover a job
@@ -1439,6 +1443,8 @@ void *job_clone_wt(
 
     if (rc == FATAL_ERROR)
       {
+      /* the array is gone and nothing is left locked */
+      sem_wait(job_clone_semaphore);
       return(NULL);
       }
 
@@ -1446,7 +1452,7 @@ void *job_clone_wt(
     if ((pa->ai_qs.idle_slot_limit != NO_SLOT_LIMIT) &&
         (pa->ai_qs.idle_slot_limit <= pa->ai_qs.num_idle))
       break;
-    }  /* END for (i) */
+    }  /* END while (index != -1) */
 
   array_save(pa);
 
@@ -1957,7 +1963,7 @@ int svr_job_purge(
           do_delete_array = true;
           }
         else
-          array_save(pa);
+          pa->request_save();
         
         unlock_ai_mutex(pa, __func__, "1", LOGLEVEL);
         }
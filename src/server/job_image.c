@@ -0,0 +1,474 @@
+#include "license_pbs.h" /* See here for the software license */
+/*
+ * job_image.c - the binary job image format (see job_image.h)
+ *
+ * Functions included are:
+ *   encode_job_image()
+ *   save_job_image()
+ *   job_recov_image()
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include "pbs_ifl.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "pbs_job.h"
+#include "pbs_error.h"
+#include "log.h"
+#include "../lib/Liblog/pbs_log.h"
+#include "lib_ifl.h"
+#include "utils.h"
+#include "job_image.h"
+#include "job_recov.h"
+
+
+extern attribute_def job_attr_def[];
+
+void decode_attribute(svrattrl *pal, job **pjob, bool freeExisting);
+int  check_fileprefix(const char *filename, job **pjob, char *log_buf, size_t buf_len);
+#ifndef PBS_MOM
+void translate_dependency_to_string(pbs_attribute *pattr, std::string &value);
+#endif
+
+
+
+/*
+ * add_image_attr() - append one attribute record to the image
+ */
+
+static void add_image_attr(
+
+  std::string  &image,  /* M */
+  const char   *name,   /* I */
+  const char   *resc,   /* I (optional) */
+  const char   *value,  /* I */
+  unsigned int  flags)  /* I */
+
+  {
+  job_image_attr rec;
+  size_t         start = image.size();
+
+  memset(&rec, 0, sizeof(rec));
+
+  rec.jia_flags = flags;
+  rec.jia_name_len = strlen(name) + 1;
+  rec.jia_resc_len = (resc != NULL) ? strlen(resc) + 1 : 0;
+  rec.jia_value_len = strlen(value) + 1;
+  rec.jia_size = JOB_IMAGE_PAD(sizeof(rec) + rec.jia_name_len + rec.jia_resc_len + rec.jia_value_len);
+
+  image.append((const char *)&rec, sizeof(rec));
+  image.append(name, rec.jia_name_len);
+
+  if (resc != NULL)
+    image.append(resc, rec.jia_resc_len);
+
+  image.append(value, rec.jia_value_len);
+  image.resize(start + rec.jia_size, '\0');
+  } /* END add_image_attr() */
+
+
+
+/*
+ * encode_job_image() - serialize pjob into image
+ *
+ * The attributes are encoded the same way they are for the XML job file:
+ * resource lists are saved one resource per record, everything else as the
+ * string attr_to_str() produces.
+ *
+ * @return PBSE_NONE on success, -1 if an attribute couldn't be encoded
+ */
+
+int encode_job_image(
+
+  job         *pjob,   /* M (attribute modify flags are cleared) */
+  std::string &image)  /* O */
+
+  {
+  job_image_header  hdr;
+  tlist_head        lhead;
+  svrattrl         *pal;
+  pbs_attribute    *pattr = pjob->ji_wattr;
+  int               rc = PBSE_NONE;
+
+  memset(&hdr, 0, sizeof(hdr));
+  image.clear();
+  image.reserve(4096);
+
+  hdr.jih_magic = JOB_IMAGE_MAGIC;
+  hdr.jih_version = JOB_IMAGE_VERSION;
+  hdr.jih_header_size = sizeof(hdr);
+  hdr.jih_qs_version = PBS_QS_VERSION;
+
+  /* the header is filled in last */
+  image.append(JOB_IMAGE_PAD(sizeof(hdr)), '\0');
+
+  hdr.jih_qs_offset = image.size();
+  hdr.jih_qs_size = sizeof(pjob->ji_qs);
+  image.append((const char *)&pjob->ji_qs, sizeof(pjob->ji_qs));
+  /* the section is a copy of the current struct jobfix whatever the job was recovered from */
+  ((struct jobfix *)&image[hdr.jih_qs_offset])->qs_version = PBS_QS_VERSION;
+  image.resize(JOB_IMAGE_PAD(image.size()), '\0');
+
+  hdr.jih_attr_offset = image.size();
+
+  CLEAR_HEAD(lhead);
+
+  for (int i = 0; i < JOB_ATR_LAST; i++)
+    {
+    if ((job_attr_def[i].at_type == ATR_TYPE_ACL) ||
+        ((pattr[i].at_flags & ATR_VFLAG_SET) == 0))
+      continue;
+
+    if ((i != JOB_ATR_resource) &&
+        (i != JOB_ATR_resc_used) &&
+        (i != JOB_ATR_req_information))
+      {
+      std::string value;
+
+#ifndef PBS_MOM
+      if (i == JOB_ATR_depend)
+        translate_dependency_to_string(pattr + i, value);
+      else
+#endif
+        attr_to_str(value, job_attr_def + i, pattr[i], false);
+
+      if (value.size() == 0)
+        continue;
+
+      add_image_attr(image, job_attr_def[i].at_name, NULL, value.c_str(), pattr[i].at_flags);
+      hdr.jih_attr_count++;
+      }
+    else
+      {
+      if (job_attr_def[i].at_encode(pattr + i,
+            &lhead,
+            job_attr_def[i].at_name,
+            NULL,
+            ATR_ENCODE_SAVE,
+            ATR_DFLAG_ACCESS) < 0)
+        rc = -1;
+
+      while ((pal = (svrattrl *)GET_NEXT(lhead)) != NULL)
+        {
+        if ((rc == PBSE_NONE) &&
+            (pal->al_atopl.resource != NULL))
+          {
+          add_image_attr(image,
+            job_attr_def[i].at_name,
+            pal->al_atopl.resource,
+            (pal->al_atopl.value != NULL) ? pal->al_atopl.value : "",
+            pal->al_flags);
+          hdr.jih_attr_count++;
+          }
+
+        delete_link(&pal->al_link);
+        free(pal);
+        }
+
+      if (rc != PBSE_NONE)
+        return(rc);
+      }
+
+    pattr[i].at_flags &= ~ATR_VFLAG_MODIFY;
+    }
+
+  hdr.jih_attr_size = image.size() - hdr.jih_attr_offset;
+
+#ifdef PBS_MOM
+  job_image_mom mom;
+
+  mom.jim_stdout = pjob->ji_stdout;
+  mom.jim_stderr = pjob->ji_stderr;
+  mom.jim_taskid = pjob->ji_taskid;
+  mom.jim_nodeid = pjob->ji_nodeid;
+
+  hdr.jih_mom_offset = image.size();
+  hdr.jih_mom_size = sizeof(mom);
+  image.append((const char *)&mom, sizeof(mom));
+#endif /* PBS_MOM */
+
+  hdr.jih_checksum = job_image_checksum(image.data() + hdr.jih_qs_offset, image.size() - hdr.jih_qs_offset);
+
+  image.replace(0, sizeof(hdr), (const char *)&hdr, sizeof(hdr));
+
+  return(PBSE_NONE);
+  } /* END encode_job_image() */
+
+
+
+/*
+ * save_job_image() - write pjob's image to filename
+ *
+ * @return PBSE_NONE on success, -1 on failure
+ */
+
+int save_job_image(
+
+  job        *pjob,      /* M */
+  const char *filename)  /* I */
+
+  {
+  std::string image;
+  int         fds;
+  int         rc;
+  char        log_buf[LOCAL_LOG_BUF_SIZE];
+
+  if (encode_job_image(pjob, image) != PBSE_NONE)
+    {
+    log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid,
+      "could not encode the job's attributes");
+    return(-1);
+    }
+
+  if ((fds = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0)
+    {
+    snprintf(log_buf, sizeof(log_buf), "could not open %s", filename);
+    log_err(errno, __func__, log_buf);
+    return(-1);
+    }
+
+  rc = write_buffer((char *)image.data(), image.size(), fds);
+
+  if (close(fds) != 0)
+    rc = -1;
+
+  if (rc != PBSE_NONE)
+    {
+    snprintf(log_buf, sizeof(log_buf), "failed writing job to %s", filename);
+    log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buf);
+    unlink(filename);
+    return(-1);
+    }
+
+  return(PBSE_NONE);
+  } /* END save_job_image() */
+
+
+
+/*
+ * validate_image_header() - check a mapped image's layout before any of it is used
+ *
+ * @return PBSE_NONE if the image is sane, PBSE_INVALID_SYNTAX if this isn't a job
+ * image at all, or -1 if it's a job image that can't be used
+ */
+
+static int validate_image_header(
+
+  const char *map,      /* I */
+  size_t      map_size, /* I */
+  char       *log_buf,  /* O */
+  size_t      buf_len)  /* I */
+
+  {
+  const job_image_header *hdr = (const job_image_header *)map;
+  const struct jobfix    *qs;
+
+  if ((map_size < sizeof(*hdr)) ||
+      (hdr->jih_magic != JOB_IMAGE_MAGIC))
+    return(PBSE_INVALID_SYNTAX);
+
+  if (hdr->jih_version != JOB_IMAGE_VERSION)
+    {
+    snprintf(log_buf, buf_len, "unsupported job image version %u", hdr->jih_version);
+    return(-1);
+    }
+
+  if ((hdr->jih_header_size != sizeof(*hdr)) ||
+      (hdr->jih_qs_size != sizeof(struct jobfix)) ||
+      (hdr->jih_qs_version != PBS_QS_VERSION))
+    {
+    snprintf(log_buf, buf_len, "job image was written with a different ji_qs layout (version %#010x)",
+      hdr->jih_qs_version);
+    return(-1);
+    }
+
+  if (((size_t)hdr->jih_qs_offset + hdr->jih_qs_size > map_size) ||
+      ((size_t)hdr->jih_attr_offset + hdr->jih_attr_size > map_size) ||
+      ((size_t)hdr->jih_mom_offset + hdr->jih_mom_size > map_size) ||
+      (hdr->jih_qs_offset % JOB_IMAGE_ALIGN != 0) ||
+      (hdr->jih_attr_offset % JOB_IMAGE_ALIGN != 0) ||
+      (hdr->jih_qs_offset < sizeof(*hdr)))
+    {
+    snprintf(log_buf, buf_len, "job image is truncated");
+    return(-1);
+    }
+
+  if (job_image_checksum(map + hdr->jih_qs_offset, map_size - hdr->jih_qs_offset) != hdr->jih_checksum)
+    {
+    snprintf(log_buf, buf_len, "job image checksum mismatch");
+    return(-1);
+    }
+
+  /* ji_qs is used straight from the mapping, so check its strings are terminated */
+  qs = (const struct jobfix *)(map + hdr->jih_qs_offset);
+
+  if ((qs->qs_version != PBS_QS_VERSION) ||
+      (memchr(qs->ji_jobid, '\0', sizeof(qs->ji_jobid)) == NULL) ||
+      (memchr(qs->ji_fileprefix, '\0', sizeof(qs->ji_fileprefix)) == NULL) ||
+      (memchr(qs->ji_queue, '\0', sizeof(qs->ji_queue)) == NULL) ||
+      (memchr(qs->ji_destin, '\0', sizeof(qs->ji_destin)) == NULL))
+    {
+    snprintf(log_buf, buf_len, "job image has a corrupt ji_qs section");
+    return(-1);
+    }
+
+  return(PBSE_NONE);
+  } /* END validate_image_header() */
+
+
+
+/*
+ * decode_image_attrs() - decode the attribute records of a mapped image into pj
+ *
+ * The svrattrl handed to the decoders points straight into the mapping, so
+ * nothing is copied on the way.
+ */
+
+static int decode_image_attrs(
+
+  const char *map,      /* I */
+  job       **pj,       /* M */
+  char       *log_buf,  /* O */
+  size_t      buf_len)  /* I */
+
+  {
+  const job_image_header *hdr = (const job_image_header *)map;
+  const char             *pos = map + hdr->jih_attr_offset;
+  const char             *end = pos + hdr->jih_attr_size;
+  const char             *prev_name = "";
+  svrattrl                pal;
+
+  for (uint32_t i = 0; i < hdr->jih_attr_count; i++)
+    {
+    const job_image_attr *rec = (const job_image_attr *)pos;
+    const char           *strings = pos + sizeof(*rec);
+
+    if ((end - pos < (ptrdiff_t)sizeof(*rec)) ||
+        (rec->jia_size < sizeof(*rec)) ||
+        (rec->jia_size > (size_t)(end - pos)) ||
+        ((size_t)sizeof(*rec) + rec->jia_name_len + rec->jia_resc_len + rec->jia_value_len > rec->jia_size) ||
+        (rec->jia_name_len == 0) ||
+        (rec->jia_value_len == 0) ||
+        (strings[rec->jia_name_len - 1] != '\0') ||
+        ((rec->jia_resc_len != 0) &&
+         (strings[rec->jia_name_len + rec->jia_resc_len - 1] != '\0')) ||
+        (strings[rec->jia_name_len + rec->jia_resc_len + rec->jia_value_len - 1] != '\0'))
+      {
+      snprintf(log_buf, buf_len, "job image attribute %u is corrupt", i);
+      return(-1);
+      }
+
+    memset(&pal, 0, sizeof(pal));
+    CLEAR_LINK(pal.al_link);
+
+    pal.al_name = (char *)strings;
+    pal.al_resc = (rec->jia_resc_len != 0) ? (char *)strings + rec->jia_name_len : NULL;
+    pal.al_value = (char *)strings + rec->jia_name_len + rec->jia_resc_len;
+    pal.al_flags = rec->jia_flags;
+
+    /* a resource list is several records in a row, only clear it for the first */
+    decode_attribute(&pal, pj, strcmp(prev_name, pal.al_name) != 0);
+
+    prev_name = pal.al_name;
+    pos += rec->jia_size;
+    }
+
+  return(PBSE_NONE);
+  } /* END decode_image_attrs() */
+
+
+
+/*
+ * job_recov_image() - recover a job from a binary job image
+ *
+ * The file is mmap()ed and validated in place; ji_qs is then copied into the
+ * job and the attributes are decoded directly from the mapping.
+ *
+ * @return PBSE_NONE on success, PBSE_INVALID_SYNTAX if filename isn't a job
+ * image (the caller should try the older formats), -1 on failure
+ */
+
+int job_recov_image(
+
+  const char  *filename,  /* I */   /* pathname to job save file */
+  job        **pjob,      /* M */   /* pointer to a pointer of job structure to fill info */
+  char        *log_buf,   /* O */   /* buffer to hold error message */
+  size_t       buf_len)   /* I */   /* len of the error buffer */
+
+  {
+  int          fds;
+  struct stat  sb;
+  char        *map;
+  int          rc;
+  job         *pj = *pjob;
+
+  if ((fds = open(filename, O_RDONLY, 0)) < 0)
+    {
+    snprintf(log_buf, buf_len, "unable to open %s", filename);
+    return(-1);
+    }
+
+  if ((fstat(fds, &sb) != 0) ||
+      (sb.st_size < (off_t)sizeof(job_image_header)))
+    {
+    close(fds);
+    return(PBSE_INVALID_SYNTAX);
+    }
+
+  map = (char *)mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fds, 0);
+  close(fds);
+
+  if (map == MAP_FAILED)
+    {
+    snprintf(log_buf, buf_len, "unable to map %s", filename);
+    return(-1);
+    }
+
+  if ((rc = validate_image_header(map, sb.st_size, log_buf, buf_len)) == PBSE_NONE)
+    {
+    const job_image_header *hdr = (const job_image_header *)map;
+
+    memcpy(&pj->ji_qs, map + hdr->jih_qs_offset, sizeof(pj->ji_qs));
+
+    if ((rc = check_fileprefix(filename, pjob, log_buf, buf_len)) == PBSE_NONE)
+      rc = decode_image_attrs(map, pjob, log_buf, buf_len);
+
+#ifdef PBS_MOM
+    if ((rc == PBSE_NONE) &&
+        (hdr->jih_mom_size >= sizeof(job_image_mom)))
+      {
+      const job_image_mom *mom = (const job_image_mom *)(map + hdr->jih_mom_offset);
+
+      pj->ji_stdout = mom->jim_stdout;
+      pj->ji_stderr = mom->jim_stderr;
+      pj->ji_taskid = mom->jim_taskid;
+      pj->ji_nodeid = mom->jim_nodeid;
+      }
+#endif /* PBS_MOM */
+    }
+  else if (rc != PBSE_INVALID_SYNTAX)
+    {
+    std::string msg(log_buf);
+
+    snprintf(log_buf, buf_len, "%s: %s", filename, msg.c_str());
+    }
+
+  munmap(map, sb.st_size);
+
+  return(rc);
+  } /* END job_recov_image() */
+
+/* END job_image.c */
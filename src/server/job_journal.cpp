@@ -0,0 +1,588 @@
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "job_journal.hpp"
+#include "pbs_error.h"
+
+
+/*
+ * journal_checksum()
+ *
+ * FNV-1a over every byte of the record up to the checksum itself
+ */
+
+static unsigned int journal_checksum(
+
+  const job_journal_record &rec)
+
+  {
+  const unsigned char *bytes = (const unsigned char *)&rec;
+  unsigned int         hash = 2166136261U;
+
+  for (size_t i = 0; i < offsetof(job_journal_record, jr_checksum); i++)
+    {
+    hash ^= bytes[i];
+    hash *= 16777619U;
+    }
+
+  return(hash);
+  } // END journal_checksum()
+
+
+
+/*
+ * init_journal_record()
+ *
+ * Zeroes rec (including padding, which is covered by the checksum) and fills in the header
+ * @param rec - the record to initialize
+ * @param type - JOURNAL_DELTA or JOURNAL_SNAPSHOT
+ * @param jobid - the id of the job this record is for
+ */
+
+void init_journal_record(
+
+  job_journal_record &rec,
+  unsigned int        type,
+  const char         *jobid)
+
+  {
+  memset(&rec, 0, sizeof(rec));
+
+  rec.jr_magic = JOURNAL_MAGIC;
+  rec.jr_type = type;
+  snprintf(rec.jr_jobid, sizeof(rec.jr_jobid), "%s", jobid);
+  } // END init_journal_record()
+
+
+
+bool journal_record_is_valid(
+
+  const job_journal_record &rec)
+
+  {
+  if ((rec.jr_magic != JOURNAL_MAGIC) ||
+      ((rec.jr_type != JOURNAL_DELTA) &&
+       (rec.jr_type != JOURNAL_SNAPSHOT)) ||
+      (memchr(rec.jr_jobid, '\0', sizeof(rec.jr_jobid)) == NULL))
+    return(false);
+
+  return(rec.jr_checksum == journal_checksum(rec));
+  } // END journal_record_is_valid()
+
+
+
+job_journal::job_journal() : path(), old_path(), fd(-1), appended(0), durable(0), rotated_at(0),
+                             syncing(false), dirty(), replayed()
+
+  {
+  pthread_mutex_init(&this->jj_mutex, NULL);
+  pthread_cond_init(&this->jj_cond, NULL);
+  }
+
+
+
+job_journal::~job_journal()
+
+  {
+  if (this->fd >= 0)
+    ::close(this->fd);
+
+  pthread_cond_destroy(&this->jj_cond);
+  pthread_mutex_destroy(&this->jj_mutex);
+  }
+
+
+
+void job_journal::set_path(
+
+  const char *p)
+
+  {
+  pthread_mutex_lock(&this->jj_mutex);
+  this->path = p;
+  this->old_path = this->path + JOURNAL_OLD_SUFFIX;
+  pthread_mutex_unlock(&this->jj_mutex);
+  } // END set_path()
+
+
+
+/*
+ * replay_file()
+ *
+ * Reads the records in filename into replayed. A short or corrupt record means the
+ * server went down in the middle of an append, so it and anything after it are ignored.
+ * Called with jj_mutex held.
+ * @param filename - the journal file to read
+ * @return the number of records read, or -1 if the file couldn't be opened
+ */
+
+int job_journal::replay_file(
+
+  const char *filename)
+
+  {
+  int                records = 0;
+  int                rfd;
+  job_journal_record rec;
+
+  if ((rfd = ::open(filename, O_RDONLY, 0)) < 0)
+    {
+    if (errno == ENOENT)
+      return(0);
+
+    return(-1);
+    }
+
+  while (read(rfd, &rec, sizeof(rec)) == (ssize_t)sizeof(rec))
+    {
+    if (journal_record_is_valid(rec) == false)
+      break;
+
+    if (rec.jr_type == JOURNAL_DELTA)
+      this->replayed[rec.jr_jobid] = rec;
+    else
+      this->replayed.erase(rec.jr_jobid);
+
+    records++;
+    }
+
+  ::close(rfd);
+
+  return(records);
+  } // END replay_file()
+
+
+
+/*
+ * replay()
+ *
+ * Loads the newest delta for each job from both journal generations. Jobs whose
+ * newest record is a snapshot are already up to date on disk and are left out.
+ * @return the number of records read, or -1 if a journal file couldn't be opened
+ */
+
+int job_journal::replay()
+
+  {
+  int old_records;
+  int records;
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  this->replayed.clear();
+
+  if (((old_records = this->replay_file(this->old_path.c_str())) < 0) ||
+      ((records = this->replay_file(this->path.c_str())) < 0))
+    {
+    pthread_mutex_unlock(&this->jj_mutex);
+    return(-1);
+    }
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(old_records + records);
+  } // END replay()
+
+
+
+/*
+ * get_replayed()
+ *
+ * @param jobid - the job to look up
+ * @param rec - set to the job's newest replayed delta
+ * @return true if replay() found a delta for this job
+ */
+
+bool job_journal::get_replayed(
+
+  const char         *jobid,
+  job_journal_record &rec)
+
+  {
+  bool                                                found = false;
+  std::map<std::string, job_journal_record>::iterator it;
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  it = this->replayed.find(jobid);
+
+  if (it != this->replayed.end())
+    {
+    rec = it->second;
+    found = true;
+    }
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(found);
+  } // END get_replayed()
+
+
+
+/*
+ * open()
+ *
+ * Starts an empty journal. This discards both generations, so it should only be called
+ * once every replayed job has been written back out with a full save.
+ * @return PBSE_NONE on success, -1 if the journal couldn't be created
+ */
+
+int job_journal::open()
+
+  {
+  int rc = PBSE_NONE;
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  if (this->fd >= 0)
+    ::close(this->fd);
+
+  unlink(this->old_path.c_str());
+
+  this->fd = ::open(this->path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600);
+
+  if (this->fd < 0)
+    rc = -1;
+
+  this->appended = 0;
+  this->durable = 0;
+  this->rotated_at = 0;
+  this->dirty.clear();
+  this->replayed.clear();
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(rc);
+  } // END open()
+
+
+
+void job_journal::close()
+
+  {
+  pthread_mutex_lock(&this->jj_mutex);
+
+  while (this->syncing == true)
+    pthread_cond_wait(&this->jj_cond, &this->jj_mutex);
+
+  if (this->fd >= 0)
+    {
+    fdatasync(this->fd);
+    ::close(this->fd);
+    this->fd = -1;
+    }
+
+  pthread_mutex_unlock(&this->jj_mutex);
+  } // END close()
+
+
+
+bool job_journal::is_open()
+
+  {
+  bool open;
+
+  pthread_mutex_lock(&this->jj_mutex);
+  open = (this->fd >= 0);
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(open);
+  } // END is_open()
+
+
+
+/*
+ * commit()
+ *
+ * Waits until record number seq is on disk. The first waiter syncs everything that has
+ * been appended so far and the others sleep until it's done, so a burst of saves shares
+ * one fdatasync(). Called with jj_mutex held.
+ * @param seq - the record that must be durable
+ * @return PBSE_NONE on success, -1 if the sync failed
+ */
+
+int job_journal::commit(
+
+  unsigned long seq)
+
+  {
+  unsigned long target;
+  int           sync_fd;
+  int           rc;
+
+  while (this->durable < seq)
+    {
+    if (this->syncing == true)
+      {
+      pthread_cond_wait(&this->jj_cond, &this->jj_mutex);
+      continue;
+      }
+
+    this->syncing = true;
+    target = this->appended;
+    sync_fd = this->fd;
+
+    pthread_mutex_unlock(&this->jj_mutex);
+    rc = fdatasync(sync_fd);
+    pthread_mutex_lock(&this->jj_mutex);
+
+    this->syncing = false;
+
+    if ((rc == 0) &&
+        (this->durable < target))
+      this->durable = target;
+
+    pthread_cond_broadcast(&this->jj_cond);
+
+    if (rc != 0)
+      return(-1);
+    }
+
+  return(PBSE_NONE);
+  } // END commit()
+
+
+
+/*
+ * append()
+ *
+ * Writes rec to the journal and waits for it to be committed
+ * @param rec - the record to add. Its checksum is filled in here.
+ * @return PBSE_NONE once rec is durable, -1 if it couldn't be written. On failure the
+ * caller should fall back to writing the job file.
+ */
+
+int job_journal::append(
+
+  const job_journal_record &rec)
+
+  {
+  job_journal_record to_write = rec;
+  unsigned long      seq;
+  int                rc;
+
+  to_write.jr_checksum = journal_checksum(to_write);
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  if (this->fd < 0)
+    {
+    pthread_mutex_unlock(&this->jj_mutex);
+    return(-1);
+    }
+
+  if (write(this->fd, &to_write, sizeof(to_write)) != (ssize_t)sizeof(to_write))
+    {
+    // don't leave a partial record in front of the next one
+    if (ftruncate(this->fd, (this->appended - this->rotated_at) * sizeof(to_write)) != 0)
+      {
+      ::close(this->fd);
+      this->fd = -1;
+      }
+
+    pthread_mutex_unlock(&this->jj_mutex);
+    return(-1);
+    }
+
+  seq = ++this->appended;
+
+  if (rec.jr_type == JOURNAL_DELTA)
+    this->dirty.insert(rec.jr_jobid);
+  else
+    this->dirty.erase(rec.jr_jobid);
+
+  rc = this->commit(seq);
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(rc);
+  } // END append()
+
+
+
+/*
+ * has_deltas()
+ *
+ * @return true if the journal holds state for jobid that is newer than its job file
+ */
+
+bool job_journal::has_deltas(
+
+  const char *jobid)
+
+  {
+  bool found;
+
+  pthread_mutex_lock(&this->jj_mutex);
+  found = (this->dirty.find(jobid) != this->dirty.end()) ||
+          (this->replayed.find(jobid) != this->replayed.end());
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(found);
+  } // END has_deltas()
+
+
+
+/*
+ * snapshot_taken()
+ *
+ * Records that jobid's file was just fully written (and synced), so its earlier deltas
+ * must not be replayed over it.
+ * @param jobid - the job that was saved
+ * @return PBSE_NONE on success, -1 if the snapshot record couldn't be written
+ */
+
+int job_journal::snapshot_taken(
+
+  const char *jobid)
+
+  {
+  job_journal_record rec;
+  bool               needed;
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  this->replayed.erase(jobid);
+  needed = (this->fd >= 0) && (this->dirty.find(jobid) != this->dirty.end());
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  if (needed == false)
+    return(PBSE_NONE);
+
+  init_journal_record(rec, JOURNAL_SNAPSHOT, jobid);
+
+  return(this->append(rec));
+  } // END snapshot_taken()
+
+
+
+/*
+ * forget()
+ *
+ * Drops jobid from the set of jobs needing a snapshot, for jobs that no longer exist
+ */
+
+void job_journal::forget(
+
+  const char *jobid)
+
+  {
+  pthread_mutex_lock(&this->jj_mutex);
+  this->dirty.erase(jobid);
+  this->replayed.erase(jobid);
+  pthread_mutex_unlock(&this->jj_mutex);
+  } // END forget()
+
+
+
+/*
+ * rotate()
+ *
+ * Starts compaction: the current journal becomes the old generation and new records go
+ * to an empty file. If an old generation is still around from a compaction that didn't
+ * finish, it is kept and the current journal keeps growing until that one is done.
+ * @param to_snapshot - set to the jobs that need a full save before finish_compaction()
+ * @return PBSE_NONE on success, -1 if the journal isn't open or couldn't be rotated
+ */
+
+int job_journal::rotate(
+
+  std::vector<std::string> &to_snapshot)
+
+  {
+  int new_fd;
+  int rc = PBSE_NONE;
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  if (this->fd < 0)
+    {
+    pthread_mutex_unlock(&this->jj_mutex);
+    return(-1);
+    }
+
+  while (this->syncing == true)
+    pthread_cond_wait(&this->jj_cond, &this->jj_mutex);
+
+  if (access(this->old_path.c_str(), F_OK) != 0)
+    {
+    if (fdatasync(this->fd) == 0)
+      {
+      this->durable = this->appended;
+      pthread_cond_broadcast(&this->jj_cond);
+      }
+
+    if (rename(this->path.c_str(), this->old_path.c_str()) != 0)
+      rc = -1;
+    else if ((new_fd = ::open(this->path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600)) < 0)
+      {
+      // keep appending to the only generation there is
+      rename(this->old_path.c_str(), this->path.c_str());
+      rc = -1;
+      }
+    else
+      {
+      ::close(this->fd);
+      this->fd = new_fd;
+      this->rotated_at = this->appended;
+      }
+    }
+
+  if (rc == PBSE_NONE)
+    to_snapshot.assign(this->dirty.begin(), this->dirty.end());
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(rc);
+  } // END rotate()
+
+
+
+/*
+ * finish_compaction()
+ *
+ * Removes the old generation. Every job returned by rotate() must have been saved first.
+ */
+
+int job_journal::finish_compaction()
+
+  {
+  int rc = PBSE_NONE;
+
+  pthread_mutex_lock(&this->jj_mutex);
+
+  if ((unlink(this->old_path.c_str()) != 0) &&
+      (errno != ENOENT))
+    rc = -1;
+
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(rc);
+  } // END finish_compaction()
+
+
+
+/*
+ * get_appended()
+ *
+ * @return the number of records in the current journal file
+ */
+
+unsigned long job_journal::get_appended()
+
+  {
+  unsigned long count;
+
+  pthread_mutex_lock(&this->jj_mutex);
+  count = this->appended - this->rotated_at;
+  pthread_mutex_unlock(&this->jj_mutex);
+
+  return(count);
+  } // END get_appended()
@@ -122,6 +122,8 @@
 #include "array.h"
 #include "../lib/Libutils/u_lock_ctl.h" /* lock_ss, unlock_ss */
 #include "job_func.h"
+#include "job_journal.hpp"
+#include "mutex_mgr.hpp"
 #else
 #include "../resmom/mom_job_func.h"
 #endif
@@ -159,6 +161,11 @@ extern int LOGLEVEL;
 
 const int DEFAULT_ARRAY_RECOV_SIZE = 101;
 
+#ifndef PBS_MOM
+/* quick saves of job state go here instead of to the job files */
+job_journal server_job_journal;
+#endif
+
 /* data global only to this file */
 
 
@@ -1173,6 +1180,226 @@ int saveJobToXML(
   } /* saveJobToXML */
 
 
+#ifndef PBS_MOM
+/*
+ * journal_job_state() - append the job's state to the job journal in place of
+ * rewriting its job file. Quick saves only change the fields recorded here.
+ *
+ * @return PBSE_NONE once the record is on disk, -1 if the caller should do a full save
+ */
+
+int journal_job_state(
+
+  job *pjob)  /* I */
+
+  {
+  job_journal_record rec;
+
+  if (server_job_journal.is_open() == false)
+    return(-1);
+
+  init_journal_record(rec, JOURNAL_DELTA, pjob->ji_qs.ji_jobid);
+
+  rec.jr_state = pjob->ji_qs.ji_state;
+  rec.jr_substate = pjob->ji_qs.ji_substate;
+  rec.jr_svrflags = pjob->ji_qs.ji_svrflags;
+  rec.jr_stime = pjob->ji_qs.ji_stime;
+  rec.jr_mtime = pjob->ji_wattr[JOB_ATR_mtime].at_val.at_long;
+
+  if (pjob->ji_wattr[JOB_ATR_etime].at_flags & ATR_VFLAG_SET)
+    {
+    rec.jr_etime_set = TRUE;
+    rec.jr_etime = pjob->ji_wattr[JOB_ATR_etime].at_val.at_long;
+    }
+
+  if (server_job_journal.append(rec) != PBSE_NONE)
+    {
+    log_event(PBSEVENT_ERROR | PBSEVENT_SECURITY, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid,
+      "could not journal the job's state, saving the job file instead");
+    return(-1);
+    }
+
+  return(PBSE_NONE);
+  } /* END journal_job_state() */
+
+
+
+/*
+ * apply_journaled_state() - bring a job that was just read from its job file
+ * up to date with the newest state found in the job journal
+ */
+
+void apply_journaled_state(
+
+  job *pjob)  /* M */
+
+  {
+  job_journal_record rec;
+  char               log_buf[LOCAL_LOG_BUF_SIZE];
+
+  if (server_job_journal.get_replayed(pjob->ji_qs.ji_jobid, rec) == false)
+    return;
+
+  pjob->ji_qs.ji_state = rec.jr_state;
+  pjob->ji_qs.ji_substate = rec.jr_substate;
+  pjob->ji_qs.ji_svrflags = rec.jr_svrflags;
+  pjob->ji_qs.ji_stime = rec.jr_stime;
+
+  pjob->ji_wattr[JOB_ATR_substate].at_val.at_long = rec.jr_substate;
+  pjob->ji_wattr[JOB_ATR_mtime].at_val.at_long = rec.jr_mtime;
+
+  if (rec.jr_etime_set)
+    {
+    pjob->ji_wattr[JOB_ATR_etime].at_val.at_long = rec.jr_etime;
+    pjob->ji_wattr[JOB_ATR_etime].at_flags |= ATR_VFLAG_SET;
+    }
+  else
+    job_attr_def[JOB_ATR_etime].at_free(&pjob->ji_wattr[JOB_ATR_etime]);
+
+  if (LOGLEVEL >= 7)
+    {
+    snprintf(log_buf, sizeof(log_buf), "state %d substate %d recovered from the job journal",
+      rec.jr_state,
+      rec.jr_substate);
+    log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buf);
+    }
+  } /* END apply_journaled_state() */
+
+
+
+/*
+ * sync_job_file() - make sure a job file is on disk before the journal records
+ * that it supersedes are dropped
+ */
+
+void sync_job_file(
+
+  const char *filename)  /* I */
+
+  {
+  int fds;
+
+  if ((fds = open(filename, O_RDONLY, 0)) < 0)
+    return;
+
+  if (fsync(fds) != 0)
+    log_err(errno, __func__, filename);
+
+  close(fds);
+  } /* END sync_job_file() */
+
+
+
+/*
+ * replay_job_journal() - read the job journal left by the last server so that
+ * job_recov() can apply it. Called before the jobs are recovered.
+ *
+ * @return the number of journal records read, or -1 on error
+ */
+
+int replay_job_journal(
+
+  const char *path)  /* I */
+
+  {
+  int  records;
+  char log_buf[LOCAL_LOG_BUF_SIZE];
+
+  server_job_journal.set_path(path);
+
+  if ((records = server_job_journal.replay()) < 0)
+    {
+    snprintf(log_buf, sizeof(log_buf), "could not read the job journal %s", path);
+    log_err(errno, __func__, log_buf);
+    }
+  else if (records > 0)
+    {
+    snprintf(log_buf, sizeof(log_buf), "replaying %d job journal records", records);
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+    }
+
+  return(records);
+  } /* END replay_job_journal() */
+
+
+
+/*
+ * open_job_journal() - start journaling quick saves. Called once the jobs are
+ * recovered, at which point every replayed record has been saved to its job
+ * file and the old journal can be thrown away.
+ */
+
+int open_job_journal()
+
+  {
+  char log_buf[LOCAL_LOG_BUF_SIZE];
+
+  if (server_job_journal.open() != PBSE_NONE)
+    {
+    snprintf(log_buf, sizeof(log_buf),
+      "could not open the job journal, job state changes will be saved to the job files");
+    log_err(errno, __func__, log_buf);
+
+    return(-1);
+    }
+
+  return(PBSE_NONE);
+  } /* END open_job_journal() */
+
+
+
+/*
+ * compact_job_journal() - fold the journaled state back into the job files so
+ * the journal doesn't grow without bound
+ */
+
+void compact_job_journal()
+
+  {
+  std::vector<std::string> to_snapshot;
+  job                     *pjob;
+  bool                     all_saved = true;
+  char                     log_buf[LOCAL_LOG_BUF_SIZE];
+
+  if ((server_job_journal.is_open() == false) ||
+      (server_job_journal.get_appended() == 0))
+    return;
+
+  if (server_job_journal.rotate(to_snapshot) != PBSE_NONE)
+    {
+    log_err(errno, __func__, "could not rotate the job journal");
+    return;
+    }
+
+  for (unsigned int i = 0; i < to_snapshot.size(); i++)
+    {
+    if ((pjob = svr_find_job(to_snapshot[i].c_str(), TRUE)) == NULL)
+      {
+      /* the job is gone, so are its files */
+      server_job_journal.forget(to_snapshot[i].c_str());
+      continue;
+      }
+
+    mutex_mgr job_mutex(pjob->ji_mutex, true);
+
+    if (job_save(pjob, SAVEJOB_FULL, 0) != PBSE_NONE)
+      all_saved = false;
+    }
+
+  if (all_saved == true)
+    server_job_journal.finish_compaction();
+
+  if (LOGLEVEL >= 6)
+    {
+    snprintf(log_buf, sizeof(log_buf), "compacted the job journal, %d jobs saved",
+      (int)to_snapshot.size());
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+    }
+  } /* END compact_job_journal() */
+#endif /* !PBS_MOM */
+
+
+
 /*
  * job_save() - Saves (or updates) a job structure image on disk
  *
@@ -1180,18 +1407,14 @@ int saveJobToXML(
  *    - a full update for an existing file, or
  *    - a full write for a new job
  *
- * For a quick update, the data written is less than a disk block
- * size and no size change occurs; so it is rewritten in place.
+ * The job is written as a binary job image (see job_image.h). To
+ * insure no data is ever lost due to system crash the new image is
+ * written to a temp name and then renamed over the old job file.
  *
- * For a full update (usually following modify job request), to
- * insure no data is ever lost due to system crash:
- * 1. write new image to a new file using a temp name
- * 2. unlink the old (image) file
- * 3. link the correct name to the new file
- * 4. unlink the temp name
- *
- * For a new file write, first time, the data is written directly to
- * the file.
+ * On the server a quick update is appended to the job journal instead
+ * (see journal_job_state()), and a full update of a job with journaled
+ * state is followed by a snapshot record so the journal isn't replayed
+ * over the newer job file.
  *
  *      RETURN:  0 - success, -1 - failure
  */
@@ -1213,6 +1436,9 @@ int job_save(
 #ifndef PBS_MOM
   // get the adjusted path_jobs path
   std::string   adjusted_path_jobs = get_path_jobdata(pjob->ji_qs.ji_jobid, path_jobs);
+
+  // the job is saved because it changed, so any cached qstat output is stale
+  pjob->invalidate_status_cache();
 #endif
 
 
@@ -1260,28 +1486,42 @@ int job_save(
     {
     pjob->ji_wattr[JOB_ATR_mtime].at_val.at_long = time_now;
     }
-
-  if (!(saveJobToXML(pjob, namebuf2)))
+#ifndef PBS_MOM
+  else if ((updatetype == SAVEJOB_QUICK) &&
+           (journal_job_state(pjob) == PBSE_NONE))
     {
-    unlink(namebuf1);
+    /* only the job's state changed and the journal has it */
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, 0);
+    return(PBSE_NONE);
+    }
+#endif
 
-    if (link(namebuf2, namebuf1) == -1)
+  if (save_job_image(pjob, namebuf2) == PBSE_NONE)
+    {
+    if (rename(namebuf2, namebuf1) == -1)
       {
       log_event(
         PBSEVENT_ERROR | PBSEVENT_SECURITY,
         PBS_EVENTCLASS_JOB,
         pjob->ji_qs.ji_jobid,
-        (char *)"Link in job_save failed");
+        (char *)"Rename in job_save failed");
       }
     else
       {
-      unlink(namebuf2);
+#ifndef PBS_MOM
+      /* the job file is now newer than anything journaled for this job */
+      if (server_job_journal.has_deltas(pjob->ji_qs.ji_jobid) == true)
+        {
+        sync_job_file(namebuf1);
+        server_job_journal.snapshot_taken(pjob->ji_qs.ji_jobid);
+        }
+#endif
       }
     }
-  else /* saveJobToXML failed */
+  else /* save_job_image failed */
     {
     log_event(PBSEVENT_ERROR | PBSEVENT_SECURITY, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid,
-      "call to saveJobToXML in job_save failed");
+      "call to save_job_image in job_save failed");
     pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, 0);
     return -1;
     }
@@ -1293,6 +1533,8 @@ int job_save(
 
 
 #ifndef PBS_MOM
+pthread_mutex_t ghost_array_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * ghost_create_jobs_array()
  *
@@ -1493,16 +1735,26 @@ int set_array_job_ids(
     pa = get_array(parent_id);
     if (pa == NULL)
       {
-      if (ghost_array_recovery)
-        {
-        pa = ghost_create_jobs_array(pj, parent_id);
-        }
-      else
+      /* subjobs are recovered concurrently; only one of them may create the ghost */
+      pthread_mutex_lock(&ghost_array_mutex);
+
+      if ((pa = get_array(parent_id)) == NULL)
         {
-        job_abt(&pj, "Array job missing array struct, aborting job");
-        snprintf(log_buf, buflen, "array struct missing for array job %s", pj->ji_qs.ji_jobid);
-        return(-1);
+        if (ghost_array_recovery)
+          {
+          pa = ghost_create_jobs_array(pj, parent_id);
+          }
+        else
+          {
+          pthread_mutex_unlock(&ghost_array_mutex);
+
+          job_abt(&pj, "Array job missing array struct, aborting job");
+          snprintf(log_buf, buflen, "array struct missing for array job %s", pj->ji_qs.ji_jobid);
+          return(-1);
+          }
         }
+
+      pthread_mutex_unlock(&ghost_array_mutex);
       }
 
     strcpy(pj->ji_arraystructid, parent_id);
@@ -1774,16 +2026,21 @@ job *job_recov(
   // job directory path, filename
   snprintf(namebuf, MAXPATHLEN, "%s%s", path_jobs, filename);
   
-  if ((rc = job_recov_xml(namebuf, &pj, log_buf, logBufLen)) &&
-      (rc == PBSE_INVALID_SYNTAX))
+  if (((rc = job_recov_image(namebuf, &pj, log_buf, logBufLen)) == PBSE_INVALID_SYNTAX) &&
+      ((rc = job_recov_xml(namebuf, &pj, log_buf, logBufLen)) == PBSE_INVALID_SYNTAX))
     rc = job_recov_binary(namebuf, &pj, log_buf, logBufLen);
 #else
-  if ((rc = job_recov_xml(filename, &pj, log_buf, logBufLen)) &&
-      (rc == PBSE_INVALID_SYNTAX))
+  /* job files written by older servers are XML or the original binary format */
+  if (((rc = job_recov_image(filename, &pj, log_buf, logBufLen)) == PBSE_INVALID_SYNTAX) &&
+      ((rc = job_recov_xml(filename, &pj, log_buf, logBufLen)) == PBSE_INVALID_SYNTAX))
     rc = job_recov_binary(filename, &pj, log_buf, logBufLen);
 
   if (rc == PBSE_NONE)
+    {
+    apply_journaled_state(pj);
+
     rc = set_array_job_ids(&pj, log_buf, logBufLen);
+    }
 #endif
 
 
@@ -2,6 +2,7 @@
 #define _JOB_RECOV_H
 #include "license_pbs.h" /* See here for the software license */
 #include "job_recovery.h"
+#include <string>
 
 
 
@@ -12,5 +13,14 @@ job *job_recov(const char *);
 void   add_fix_fields(xmlNodePtr *rnode, const job *pjob);
 void   add_union_fields(xmlNodePtr *rnode, const job *pjob);
 int    saveJobToXML(job *pjob, const char *filename);
+int    job_recov_xml(const char *filename, job **pjob, char *log_buf, size_t buf_len);
+int    encode_job_image(job *pjob, std::string &image);
+int    save_job_image(job *pjob, const char *filename);
+int    job_recov_image(const char *filename, job **pjob, char *log_buf, size_t buf_len);
+#ifndef PBS_MOM
+int    journal_job_state(job *pjob);
+void   apply_journaled_state(job *pjob);
+void   sync_job_file(const char *filename);
+#endif
 
 #endif /* _JOB_RECOV_H */
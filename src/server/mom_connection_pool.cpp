@@ -0,0 +1,224 @@
+#include "mom_connection_pool.hpp"
+
+
+/*
+ * Constructor
+ *
+ * @param max - the maximum number of idle connections kept per mom. 0 disables pooling.
+ * @param timeout - the number of seconds a connection may sit idle before it is evicted
+ */
+
+mom_connection_pool::mom_connection_pool(
+
+  unsigned int max,
+  int          timeout) : idle(), max_per_node(max), idle_timeout(timeout)
+
+  {
+  pthread_mutex_init(&this->mcp_mutex, NULL);
+  }
+
+
+
+mom_connection_pool::~mom_connection_pool()
+
+  {
+  pthread_mutex_destroy(&this->mcp_mutex);
+  }
+
+
+
+/*
+ * checkout()
+ *
+ * Removes the most recently used idle connection to addr:port from the pool
+ * @param addr - the mom's address in host order
+ * @param port - the mom's port
+ * @return the connection handle, or -1 if there are no idle connections to this mom
+ */
+
+int mom_connection_pool::checkout(
+
+  pbs_net_t    addr,
+  unsigned int port)
+
+  {
+  int                                                               handle = -1;
+  std::map<mom_endpoint, std::vector<pooled_connection> >::iterator it;
+
+  pthread_mutex_lock(&this->mcp_mutex);
+
+  it = this->idle.find(mom_endpoint(addr, port));
+
+  if ((it != this->idle.end()) &&
+      (it->second.size() > 0))
+    {
+    handle = it->second.back().handle;
+    it->second.pop_back();
+    }
+
+  pthread_mutex_unlock(&this->mcp_mutex);
+
+  return(handle);
+  } // END checkout()
+
+
+
+/*
+ * checkin()
+ *
+ * Parks handle in the pool for later re-use
+ * @param addr - the mom's address in host order
+ * @param port - the mom's port
+ * @param handle - the connection handle to park
+ * @param now - the current time
+ * @return true if the pool took ownership of handle, false if the caller must disconnect it
+ */
+
+bool mom_connection_pool::checkin(
+
+  pbs_net_t    addr,
+  unsigned int port,
+  int          handle,
+  time_t       now)
+
+  {
+  bool pooled = false;
+
+  if (handle < 0)
+    return(false);
+
+  pthread_mutex_lock(&this->mcp_mutex);
+
+  std::vector<pooled_connection> &conns = this->idle[mom_endpoint(addr, port)];
+
+  if (conns.size() < this->max_per_node)
+    {
+    conns.push_back(pooled_connection(handle, now));
+    pooled = true;
+    }
+
+  pthread_mutex_unlock(&this->mcp_mutex);
+
+  return(pooled);
+  } // END checkin()
+
+
+
+/*
+ * evict_idle()
+ *
+ * Removes every connection that hasn't been used in idle_timeout seconds
+ * @param now - the current time
+ * @param evicted - the handles removed from the pool, which the caller must disconnect
+ */
+
+void mom_connection_pool::evict_idle(
+
+  time_t            now,
+  std::vector<int> &evicted)
+
+  {
+  std::map<mom_endpoint, std::vector<pooled_connection> >::iterator it;
+
+  pthread_mutex_lock(&this->mcp_mutex);
+
+  it = this->idle.begin();
+
+  while (it != this->idle.end())
+    {
+    std::vector<pooled_connection> &conns = it->second;
+    unsigned int                    kept = 0;
+
+    // the vector is in checkin order, so the oldest connections are at the front
+    for (unsigned int i = 0; i < conns.size(); i++)
+      {
+      if (now - conns[i].last_used >= this->idle_timeout)
+        evicted.push_back(conns[i].handle);
+      else
+        conns[kept++] = conns[i];
+      }
+
+    conns.resize(kept, pooled_connection(-1, 0));
+
+    if (conns.size() == 0)
+      this->idle.erase(it++);
+    else
+      it++;
+    }
+
+  pthread_mutex_unlock(&this->mcp_mutex);
+  } // END evict_idle()
+
+
+
+/*
+ * purge()
+ *
+ * Removes all of the idle connections to addr:port, for example when the mom goes down
+ * @param addr - the mom's address in host order
+ * @param port - the mom's port
+ * @param evicted - the handles removed from the pool, which the caller must disconnect
+ */
+
+void mom_connection_pool::purge(
+
+  pbs_net_t         addr,
+  unsigned int      port,
+  std::vector<int> &evicted)
+
+  {
+  std::map<mom_endpoint, std::vector<pooled_connection> >::iterator it;
+
+  pthread_mutex_lock(&this->mcp_mutex);
+
+  it = this->idle.find(mom_endpoint(addr, port));
+
+  if (it != this->idle.end())
+    {
+    for (unsigned int i = 0; i < it->second.size(); i++)
+      evicted.push_back(it->second[i].handle);
+
+    this->idle.erase(it);
+    }
+
+  pthread_mutex_unlock(&this->mcp_mutex);
+  } // END purge()
+
+
+
+unsigned int mom_connection_pool::idle_count(
+
+  pbs_net_t    addr,
+  unsigned int port)
+
+  {
+  unsigned int                                                      count = 0;
+  std::map<mom_endpoint, std::vector<pooled_connection> >::iterator it;
+
+  pthread_mutex_lock(&this->mcp_mutex);
+
+  it = this->idle.find(mom_endpoint(addr, port));
+
+  if (it != this->idle.end())
+    count = it->second.size();
+
+  pthread_mutex_unlock(&this->mcp_mutex);
+
+  return(count);
+  } // END idle_count()
+
+
+
+unsigned int mom_connection_pool::get_max_per_node() const
+
+  {
+  return(this->max_per_node);
+  }
+
+
+
+int mom_connection_pool::get_idle_timeout() const
+
+  {
+  return(this->idle_timeout);
+  }
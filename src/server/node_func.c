@@ -429,6 +429,7 @@ int chk_characteristic(
         !(nci->state & INUSE_OFFLINE))
       {
       *pneed_todo |= WRITENODE_STATE;  /*marked offline */
+      record_node_state(pnode);
 
       strcat(tmpLine, "offline set");
       }
@@ -436,6 +437,7 @@ int chk_characteristic(
         (nci->state & INUSE_OFFLINE))
       {
       *pneed_todo |= WRITENODE_STATE;  /*removed offline*/
+      record_node_state(pnode);
 
       strcat(tmpLine, "offline cleared");
       }
@@ -870,6 +872,10 @@ void effective_node_delete(
   if (remove_node(&allnodes, pnode) != PBSE_NONE)
     return;
 
+  remove_from_free_node_index(pnode);
+  forget_node_state(pnode->get_name());
+  forget_received_status(pnode->get_name());
+
   pnode->unlock_node(__func__, NULL, LOGLEVEL);
 
   //The node has been removed from the allnodes array.
@@ -1657,6 +1663,7 @@ static int finalize_create_pbs_node(char     *pname, /* node name w/o any :ts
   free(pul);
 
   insert_node(&allnodes,pnode);
+  update_free_node_index(pnode);
 
   svr_totnodes++;
 
@@ -2543,6 +2550,7 @@ int setup_nodes(void)
   char               line[MAXLINE << 4];
 
   struct pbsnode    *np;
+  std::map<std::string, int> saved_states;
 
   snprintf(log_buf, sizeof(log_buf), "%s()", __func__);
 
@@ -2551,35 +2559,32 @@ int setup_nodes(void)
   if ((err = parse_nodes_file()) != PBSE_NONE)
     return(err);
     
-  nin = fopen(path_nodestate, "r");
+  read_node_states(saved_states);
 
-  if (nin != NULL)
+  for (std::map<std::string, int>::iterator it = saved_states.begin();
+       it != saved_states.end();
+       it++)
     {
-    while (fscanf(nin, "%s %d",
-                  line,
-                  &num) == 2)
+    snprintf(line, sizeof(line), "%s", it->first.c_str());
+
+    if ((np = find_nodebyname(line)) == NULL)
       {
-      if ((np = find_nodebyname(line)) == NULL)
+      if (isdigit(line[0]))
         {
-        if (isdigit(line[0]))
-          {
-          // If cray enabled, create the node if it looks like a Cray subnode
-          np = create_alps_subnode(alps_reporter, line);
-          }
+        // If cray enabled, create the node if it looks like a Cray subnode
+        np = create_alps_subnode(alps_reporter, line);
         }
+      }
 
-      if (np != NULL)
-        {
-        // Update the state accordingly
-        np->nd_state = num;
+    if (np != NULL)
+      {
+      // Update the state accordingly
+      np->nd_state = it->second;
 
-        /* exclusive bits are calculated later in set_old_nodes() */
-        np->nd_state &= ~INUSE_JOB;
-        np->unlock_node(__func__, "no match", LOGLEVEL);
-        }
+      /* exclusive bits are calculated later in set_old_nodes() */
+      np->nd_state &= ~INUSE_JOB;
+      np->unlock_node(__func__, "no match", LOGLEVEL);
       }
-
-    fclose(nin);
     }
 
   nin = fopen(path_nodepowerstate, "r");
@@ -3173,6 +3178,7 @@ int create_partial_pbs_node(
     }
 
   insert_node(&allnodes,pnode);
+  update_free_node_index(pnode);
   auth_hosts.add_authorized_address(addr, pnode->nd_mom_port, pnode->get_name());
   
   svr_totnodes++;
@@ -0,0 +1,129 @@
+#include "node_liveness.hpp"
+
+
+node_liveness_tracker::node_liveness_tracker() : nlt_by_time(), nlt_nodes()
+  {
+  pthread_mutex_init(&this->nlt_mutex, NULL);
+  }
+
+
+
+node_liveness_tracker::~node_liveness_tracker()
+
+  {
+  pthread_mutex_destroy(&this->nlt_mutex);
+  }
+
+
+
+/*
+ * heard_from()
+ *
+ * Records that node_name reported at time when. Called on every status
+ * received from a mom.
+ */
+
+void node_liveness_tracker::heard_from(
+
+  const char *node_name,
+  time_t      when)
+
+  {
+  std::map<std::string, deadline_map::iterator>::iterator it;
+
+  pthread_mutex_lock(&this->nlt_mutex);
+
+  if ((it = this->nlt_nodes.find(node_name)) != this->nlt_nodes.end())
+    {
+    if (it->second->first != when)
+      {
+      this->nlt_by_time.erase(it->second);
+      it->second = this->nlt_by_time.insert(std::pair<time_t, std::string>(when, node_name));
+      }
+    }
+  else
+    {
+    this->nlt_nodes[node_name] =
+      this->nlt_by_time.insert(std::pair<time_t, std::string>(when, node_name));
+    }
+
+  pthread_mutex_unlock(&this->nlt_mutex);
+  } /* END heard_from() */
+
+
+
+/*
+ * forget()
+ *
+ * Stops tracking a node
+ */
+
+void node_liveness_tracker::forget(
+
+  const char *node_name)
+
+  {
+  std::map<std::string, deadline_map::iterator>::iterator it;
+
+  pthread_mutex_lock(&this->nlt_mutex);
+
+  if ((it = this->nlt_nodes.find(node_name)) != this->nlt_nodes.end())
+    {
+    this->nlt_by_time.erase(it->second);
+    this->nlt_nodes.erase(it);
+    }
+
+  pthread_mutex_unlock(&this->nlt_mutex);
+  } /* END forget() */
+
+
+
+/*
+ * pop_quiet_since()
+ *
+ * Removes every node that hasn't been heard from since cutoff and adds its
+ * name to quiet, oldest first. Nodes that turn out to be alive must be
+ * passed to heard_from() again.
+ *
+ * @return the number of names added
+ */
+
+int node_liveness_tracker::pop_quiet_since(
+
+  time_t                    cutoff,
+  std::vector<std::string> &quiet)
+
+  {
+  int                    count = 0;
+  deadline_map::iterator it;
+
+  pthread_mutex_lock(&this->nlt_mutex);
+
+  while (((it = this->nlt_by_time.begin()) != this->nlt_by_time.end()) &&
+         (it->first < cutoff))
+    {
+    quiet.push_back(it->second);
+    this->nlt_nodes.erase(it->second);
+    this->nlt_by_time.erase(it);
+    count++;
+    }
+
+  pthread_mutex_unlock(&this->nlt_mutex);
+
+  return(count);
+  } /* END pop_quiet_since() */
+
+
+
+size_t node_liveness_tracker::size()
+
+  {
+  size_t count;
+
+  pthread_mutex_lock(&this->nlt_mutex);
+  count = this->nlt_nodes.size();
+  pthread_mutex_unlock(&this->nlt_mutex);
+
+  return(count);
+  } /* END size() */
+
@@ -142,6 +142,9 @@
 #include "plugin_internal.h"
 #include "json/json.h"
 #include "authorized_hosts.hpp"
+#include "free_node_index.hpp"
+#include "node_liveness.hpp"
+#include "node_state_file.hpp"
 
 #define IS_VALID_STR(STR)  (((STR) != NULL) && ((STR)[0] != '\0'))
 
@@ -161,6 +164,9 @@ int                     gpu_err_reset = FALSE;    /* was a gpu errcount reset re
 /* on server shutdown, (qmgr mods)  */
 
 all_nodes               allnodes;
+free_node_index         free_nodes_index;
+node_liveness_tracker   node_liveness;
+node_state_file         node_states;
 
 static int              num_addrnote_tasks = 0; /* number of outstanding send_cluster_addrs tasks */
 pthread_mutex_t        *addrnote_mutex = NULL;
@@ -389,6 +395,10 @@ void update_node_state(
 
       np->nd_state |= INUSE_DOWN;
       np->nd_state &= ~INUSE_UNKNOWN;
+
+      /* don't hand out pooled connections to a mom that went away */
+      if (np->nd_addrs.size() > 0)
+        close_pooled_mom_connections(np->nd_addrs[0], np->nd_mom_port);
       }
 
     /* ignoring the obvious possibility of a "down,busy" node */
@@ -439,6 +449,8 @@ void update_node_state(
     log_record(PBSEVENT_SCHED, PBS_EVENTCLASS_REQUEST, __func__, log_buf);
     }
 
+  update_free_node_index(np);
+
   return;
   }  /* END update_node_state() */
 
@@ -883,6 +895,8 @@ void process_job_attribute_information(
           }
         }
 
+      pjob->invalidate_status_cache();
+
       // Only update the last reported time if the mother superior is reporting it.
       if (node_addr == pjob->ji_qs.ji_un.ji_exect.ji_momaddr)
         pjob->ji_last_reported_time = time(NULL);
@@ -942,6 +956,8 @@ void process_legacy_job_attribute_information(
       attr_val = threadsafe_tokenizer(&attr_work, ",");
       }
 
+    pjob->invalidate_status_cache();
+
     // Only update the last reported time if the mother superior is reporting it.
     if (node_addr == pjob->ji_qs.ji_un.ji_exect.ji_momaddr)
       pjob->ji_last_reported_time = time(NULL);
@@ -1413,6 +1429,10 @@ void stream_eof(
 
 /*
  * wrapper task that check_nodes places in the thread pool's queue
+ *
+ * Only the nodes node_liveness reports as quiet for chk_len seconds are
+ * visited. Nodes that are checked and left alone are put back so they are
+ * looked at again after another chk_len.
  */
 
 void *check_nodes_work(
@@ -1420,33 +1440,48 @@ void *check_nodes_work(
   void *vp)
 
   {
-  work_task        *ptask = (struct work_task *)vp;
-
-  struct pbsnode   *np = NULL;
-  long              chk_len = 300;
-  char              log_buf[LOCAL_LOG_BUF_SIZE];
-  time_t            time_now = time(NULL);
+  work_task                *ptask = (struct work_task *)vp;
 
-  node_iterator     iter;
+  struct pbsnode           *np = NULL;
+  long                      chk_len = 300;
+  char                      log_buf[LOCAL_LOG_BUF_SIZE];
+  time_t                    time_now = time(NULL);
+  std::vector<std::string>  quiet;
   
   /* load min refresh interval */
   get_svr_attr_l(SRV_ATR_check_rate, &chk_len);
 
+  node_liveness.pop_quiet_since(time_now - chk_len, quiet);
+
   if (LOGLEVEL >= 5)
     {
-    sprintf(log_buf, "verifying nodes are active (min_refresh = %d seconds)", (int)chk_len);
+    sprintf(log_buf, "verifying nodes are active (min_refresh = %d seconds, %d quiet nodes)",
+      (int)chk_len, (int)quiet.size());
 
     log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, __func__, log_buf);
     }
 
-  /* evaluate all nodes */
-  reinitialize_node_iterator(&iter);
-
-  while ((np = next_node(&allnodes,np,&iter)) != NULL)
+  for (unsigned int i = 0; i < quiet.size(); i++)
     {
-    if (!(np->nd_state & INUSE_NOT_READY))
+    if ((np = find_nodebyname(quiet[i].c_str())) == NULL)
+      continue;
+
+    /* as in next_node(), only the numa and alps subnodes are checked */
+    if ((np->num_node_boards > 0) ||
+        (np->nd_is_alps_reporter))
       {
-      if (np->nd_lastupdate < (time_now - chk_len)) 
+      np->unlock_node(__func__, NULL, LOGLEVEL);
+      continue;
+      }
+
+    if (np->nd_lastupdate >= (time_now - chk_len))
+      {
+      /* it reported after we looked */
+      node_liveness.heard_from(quiet[i].c_str(), np->nd_lastupdate);
+      }
+    else
+      {
+      if (!(np->nd_state & INUSE_NOT_READY))
         {
         if (LOGLEVEL >= 6)
           {
@@ -1467,17 +1502,14 @@ void *check_nodes_work(
           }
         
         update_node_state(np, (INUSE_DOWN));    
-          
-        /* The node is up. Do not mark the node down, but schedule a check_nodes */
         }
-      }
-    } /* END for each node */
 
-  if (iter.node_index != NULL)
-    delete iter.node_index;
+      /* a node can become ready again without reporting, keep watching it */
+      node_liveness.heard_from(quiet[i].c_str(), time_now);
+      }
 
-  if (iter.alps_index != NULL)
-    delete iter.alps_index;
+    np->unlock_node(__func__, NULL, LOGLEVEL);
+    } /* END for each quiet node */
 
   if (ptask->wt_parm1 == NULL)
     {
@@ -1505,7 +1537,7 @@ void check_nodes(
   struct work_task *ptask)  /* I (modified) */
 
   {
-  int rc = enqueue_threadpool_request(check_nodes_work, ptask, task_pool);
+  int rc = enqueue_threadpool_request_lane(check_nodes_work, ptask, task_pool, TP_LANE_HIGH);
 
   if (rc)
     {
@@ -1523,98 +1555,92 @@ void *write_node_state_work(
   void *vp)
 
   {
-  struct pbsnode *np = NULL;
-  static char    *fmt = (char *)"%s %d\n";
-  static FILE    *nstatef = NULL;
-  int             savemask;
-
-  pthread_mutex_lock(node_state_mutex);
-
   if (LOGLEVEL >= 5)
     {
     DBPRT(("write_node_state_work: entered\n"))
     }
 
-  /* don't store volatile states like down and unknown */
+  node_states.set_path(path_nodestate);
+  node_states.flush();
 
-  savemask = INUSE_OFFLINE | INUSE_RESERVE;
+  return(NULL);
+  } /* END write_node_state_work() */
 
-  if (nstatef != NULL)
-    {
-    fseek(nstatef, 0L, SEEK_SET); /* rewind and clear */
 
-    if (ftruncate(fileno(nstatef), (off_t)0) != 0)
-      {
-      log_err(errno, __func__, "could not truncate file");
 
-      pthread_mutex_unlock(node_state_mutex);
-      
-      return(NULL);
-      }
-    }
-  else
-    {
-    /* need to open for first time, temporary-move to pbsd_init */
+/*
+ * record_node_state()
+ *
+ * Queues the part of the node's state that survives a restart to be
+ * appended to the node state file by the next write_node_state(). Only
+ * offline nodes carry their state forward; volatile states like down and
+ * unknown are never stored.
+ */
 
-    if ((nstatef = fopen(path_nodestate, "w+")) == NULL)
-      {
-      log_err(errno, __func__, "could not open file");
+void record_node_state(
 
-      pthread_mutex_unlock(node_state_mutex);
-      
-      return(NULL);
-      }
-    }
+  struct pbsnode *pnode)
 
-  /*
-  ** The only state that carries forward is if the
-  ** node has been marked offline.
-  */
-  if (cray_enabled == true)
-    {
-    node_iterator   iter;
-    reinitialize_node_iterator(&iter);
+  {
+  int saved = 0;
 
-    while ((np = next_node(&allnodes, np, &iter)) != NULL)
-      {
-      if (np->nd_state & INUSE_OFFLINE)
-        {
-        fprintf(nstatef, fmt, np->get_name(), np->nd_state & savemask);
-        }
+  if (pnode->nd_state & INUSE_OFFLINE)
+    saved = pnode->nd_state & (INUSE_OFFLINE | INUSE_RESERVE);
 
-      np->unlock_node(__func__, NULL, LOGLEVEL);
-      } /* END for each node */
-    }
-  else
-    {
-    all_nodes_iterator *iter = NULL;
+  node_states.record(pnode->get_name(), saved);
+  } /* END record_node_state() */
 
-    while ((np = next_host(&allnodes,&iter,NULL)) != NULL)
-      {
-      if (np->nd_state & INUSE_OFFLINE)
-        {
-        fprintf(nstatef, fmt, np->get_name(), np->nd_state & savemask);
-        }
 
-      np->unlock_node(__func__, NULL, LOGLEVEL);
-      } /* END for each node */
 
-    if (iter != NULL)
-      delete iter;
-    }
+/*
+ * forget_node_state()
+ *
+ * Drops whatever the node state file holds for a deleted node
+ */
 
-  if (fflush(nstatef) != 0)
-    {
-    log_err(errno, __func__, "failed saving node state to disk");
-    }
+void forget_node_state(
 
-  fclose(nstatef);
-  nstatef = NULL;
+  const char *node_name)
 
-  pthread_mutex_unlock(node_state_mutex);
+  {
+  node_states.record(node_name, 0);
+  node_liveness.forget(node_name);
+  } /* END forget_node_state() */
 
-  return(NULL);
-  } /* END write_node_state_work() */
+
+
+/*
+ * read_node_states()
+ *
+ * @param states - set to the saved state of each node in the node state file
+ */
+
+int read_node_states(
+
+  std::map<std::string, int> &states)
+
+  {
+  node_states.set_path(path_nodestate);
+
+  return(node_states.load(states));
+  } /* END read_node_states() */
+
+
+
+/*
+ * update_node_liveness()
+ *
+ * Records that the node was just heard from. Call with the node locked after
+ * setting nd_lastupdate.
+ */
+
+void update_node_liveness(
+
+  struct pbsnode *pnode)
+
+  {
+  node_liveness.heard_from(pnode->get_name(), pnode->nd_lastupdate);
+  } /* END update_node_liveness() */
 
 
 
@@ -1961,6 +1987,53 @@ int gpu_count(
 
 
 
+/*
+ * update_free_node_index()
+ *
+ * Refreshes the node's entry in free_nodes_index. Call with the node locked
+ * after changing its state, execution slots, gpus or properties.
+ */
+
+void update_free_node_index(
+
+  struct pbsnode *pnode)
+
+  {
+  bool available;
+
+  // subnodes are reached through their parents
+  if (pnode->parent != NULL)
+    return;
+
+  if ((pnode->num_node_boards > 0) ||
+      (pnode->nd_is_alps_reporter))
+    {
+    free_nodes_index.mark_unindexable(pnode->nd_id);
+    return;
+    }
+
+  available = ((pnode->nd_state & (INUSE_OFFLINE | INUSE_NOT_READY | INUSE_RESERVE | INUSE_JOB)) == 0) &&
+              (pnode->nd_power_state == POWER_STATE_RUNNING);
+
+  free_nodes_index.update(pnode->nd_id,
+                          available,
+                          pnode->nd_slots.get_number_free(),
+                          gpu_count(pnode, TRUE),
+                          pnode->get_properties());
+  } /* END update_free_node_index() */
+
+
+
+void remove_from_free_node_index(
+
+  struct pbsnode *pnode)
+
+  {
+  free_nodes_index.remove(pnode->nd_id);
+  } /* END remove_from_free_node_index() */
+
+
+
 
 
 /*
@@ -3031,6 +3104,87 @@ int select_nodes_using_hostlist(
 
 
 
+/*
+ * select_from_indexed_nodes()
+ *
+ * Checks only the nodes that free_nodes_index lists as able to satisfy one of the
+ * reqs. The index can lag behind the nodes, so every candidate is still checked
+ * with node_is_spec_acceptable() under its lock.
+ *
+ * @param checked - the ids of the nodes that were looked at
+ * @return the number of nodes recorded
+ */
+
+int select_from_indexed_nodes(
+
+  complete_spec_data            &all_reqs,        /* I */
+  std::list<node_job_add_info>  *naji_list,       /* O (optional) */
+  int                           *eligible_nodes,  /* O */
+  alps_req_data                **ard_array,       /* O (optional) */
+  int                            first_node_id,   /* I */
+  int                            num_alps_reqs,   /* I */
+  enum job_types                 job_type,        /* I */
+  char                          *ProcBMStr,       /* I (optional) */
+  bool                           job_is_exclusive,
+  std::set<int>                 &checked)         /* O */
+
+  {
+  std::set<int>   candidates;
+  struct pbsnode *pnode;
+  int             num = 0;
+
+  for (int i = 0; i < all_reqs.num_reqs; i++)
+    {
+    single_spec_data         &req = all_reqs.reqs[i];
+    std::vector<std::string>  props;
+
+    if (req.nodes <= 0)
+      continue;
+
+    for (unsigned int j = 0; j < req.plist.size(); j++)
+      {
+      if (req.plist[j].mark != 0)
+        props.push_back(req.plist[j].name);
+      }
+
+    free_nodes_index.get_candidates(req.ppn, req.gpu, props, candidates);
+    }
+
+  for (std::set<int>::iterator it = candidates.begin(); it != candidates.end(); it++)
+    {
+    if ((pnode = find_nodebyid(*it)) == NULL)
+      continue;
+
+    checked.insert(*it);
+
+    for (int i = 0; i < all_reqs.num_reqs; i++)
+      {
+      single_spec_data &req = all_reqs.reqs[i];
+
+      if (req.nodes > 0)
+        {
+        if (node_is_spec_acceptable(pnode, req, ProcBMStr, eligible_nodes, job_is_exclusive) == true)
+          {
+          record_fitting_node(num, pnode, naji_list, req, first_node_id, req.req_id, num_alps_reqs, job_type, all_reqs, ard_array);
+
+          if (all_reqs.total_nodes == 0)
+            break;
+          }
+        }
+      }
+
+    pnode->unlock_node(__func__, NULL, LOGLEVEL);
+
+    /* are all reqs satisfied? */
+    if (all_reqs.total_nodes == 0)
+      break;
+    }
+
+  return(num);
+  } /* END select_from_indexed_nodes() */
+
+
+
 /*
  * select_from_all_nodes()
  *
@@ -3038,6 +3192,10 @@ int select_nodes_using_hostlist(
  * node(s) that we are searching for. This is O(N) with respect to the number of nodes in the system
  * as each request is checked against each node at locking time.
  *
+ * When free_nodes_index can be used, the nodes it offers are tried first and the full
+ * walk only happens if they can't satisfy the request. Nodes that were already tried
+ * are skipped so that eligible_nodes counts each node once.
+ *
  * @pre-cond: all_reqs, eligible_nodes, and first_node_name must all be valid parameters
  * @post-cond: the nodes in the list are saved in naji to be added for the job later
  */
@@ -3058,12 +3216,27 @@ int select_from_all_nodes(
   node_iterator   iter;
   struct pbsnode *pnode = NULL;
   int             num = 0;
+  std::set<int>   checked;
+
+  if ((cray_enabled != true) &&
+      (free_nodes_index.is_usable() == true))
+    {
+    num = select_from_indexed_nodes(all_reqs, naji_list, eligible_nodes, ard_array, first_node_id,
+                                    num_alps_reqs, job_type, ProcBMStr, job_is_exclusive, checked);
+
+    if (all_reqs.total_nodes == 0)
+      return(num);
+    }
   
   reinitialize_node_iterator(&iter);
 
   /* iterate over all nodes */
   while ((pnode = next_node(&allnodes,pnode,&iter)) != NULL)
     {
+    if ((checked.size() > 0) &&
+        (checked.find(pnode->nd_id) != checked.end()))
+      continue;
+
     /* check each req against this node to see if it satisfies it */
     for (int i = 0; i < all_reqs.num_reqs; i++)
       {
@@ -4574,6 +4747,7 @@ int build_hostlist_nodes_req(
 #endif
         }
 
+      update_free_node_index(pnode);
       pnode->unlock_node(__func__, NULL, LOGLEVEL);
       }
 
@@ -5629,6 +5803,8 @@ int remove_job_from_node(
     save_node_usage(pnode);
     }
 #endif
+
+  update_free_node_index(pnode);
   
   return(PBSE_NONE);
   } /* END remove_job_from_node() */
@@ -5690,6 +5866,7 @@ void free_nodes(
       remove_job_from_node(pnode, pjob->ji_internal_id);
       remove_job_from_nodes_gpus(pnode, pjob);
       remove_job_from_nodes_mics(pnode, pjob);
+      update_free_node_index(pnode);
       pnode->unlock_node(__func__, NULL, LOGLEVEL);
       }
     }
@@ -5869,6 +6046,7 @@ int set_one_old(
     if (pnode->nd_slots.get_number_free() <= 0)
       pnode->nd_state |= INUSE_JOB;
 
+    update_free_node_index(pnode);
     pnode->unlock_node(__func__, NULL, LOGLEVEL);
     }
   else
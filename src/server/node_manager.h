@@ -18,6 +18,8 @@ job *find_job_by_node(struct pbsnode *pnode, char *jobid);
 void update_job_data(struct pbsnode *np, char *jobstring_in);
 
 int is_stat_get(const char *node_name, struct tcp_chan *chan);
+int is_stat_delta_get(const char *node_name, struct tcp_chan *chan);
+void log_hierarchy_fanin_stats();
 
 int is_compose(struct tcp_chan *chan, int command);
 
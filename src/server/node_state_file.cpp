@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "node_state_file.hpp"
+#include "pbs_error.h"
+#include "log.h"
+
+
+node_state_file::node_state_file() : nsf_path(), nsf_states(), nsf_pending(), nsf_records(0)
+  {
+  pthread_mutex_init(&this->nsf_pending_mutex, NULL);
+  pthread_mutex_init(&this->nsf_file_mutex, NULL);
+  }
+
+
+
+node_state_file::~node_state_file()
+
+  {
+  pthread_mutex_destroy(&this->nsf_pending_mutex);
+  pthread_mutex_destroy(&this->nsf_file_mutex);
+  }
+
+
+
+void node_state_file::set_path(
+
+  const char *path)
+
+  {
+  pthread_mutex_lock(&this->nsf_file_mutex);
+  this->nsf_path = path;
+  pthread_mutex_unlock(&this->nsf_file_mutex);
+  } /* END set_path() */
+
+
+
+/*
+ * load()
+ *
+ * Reads the file, keeping the last record for each node.
+ *
+ * @param states - set to the saved non-zero state of each node
+ * @return PBSE_NONE, including when there is no file yet
+ */
+
+int node_state_file::load(
+
+  std::map<std::string, int> &states) /* O */
+
+  {
+  FILE *nin;
+  char  name[1024];
+  int   state;
+
+  pthread_mutex_lock(&this->nsf_file_mutex);
+
+  this->nsf_states.clear();
+  this->nsf_records = 0;
+
+  if ((nin = fopen(this->nsf_path.c_str(), "r")) != NULL)
+    {
+    while (fscanf(nin, "%1023s %d", name, &state) == 2)
+      {
+      this->nsf_records++;
+
+      if (state == 0)
+        this->nsf_states.erase(name);
+      else
+        this->nsf_states[name] = state;
+      }
+
+    fclose(nin);
+    }
+
+  states = this->nsf_states;
+
+  pthread_mutex_unlock(&this->nsf_file_mutex);
+
+  return(PBSE_NONE);
+  } /* END load() */
+
+
+
+/*
+ * record()
+ *
+ * Queues a node's new state to be appended by the next flush(). Doesn't
+ * touch the file, so it is safe to call with the node locked.
+ *
+ * @param node_name - the node
+ * @param state - the state to save, 0 to save nothing for the node
+ */
+
+void node_state_file::record(
+
+  const char *node_name,
+  int         state)
+
+  {
+  pthread_mutex_lock(&this->nsf_pending_mutex);
+  this->nsf_pending.push_back(std::pair<std::string, int>(node_name, state));
+  pthread_mutex_unlock(&this->nsf_pending_mutex);
+  } /* END record() */
+
+
+
+/*
+ * flush()
+ *
+ * Appends the queued changes that differ from what the file already says,
+ * then compacts the file if most of it is stale.
+ *
+ * @return PBSE_NONE or PBSE_SYSTEM if the file couldn't be written
+ */
+
+int node_state_file::flush()
+
+  {
+  std::vector<std::pair<std::string, int> > pending;
+  FILE                                     *nout = NULL;
+  int                                       rc = PBSE_NONE;
+
+  pthread_mutex_lock(&this->nsf_pending_mutex);
+  pending.swap(this->nsf_pending);
+  pthread_mutex_unlock(&this->nsf_pending_mutex);
+
+  pthread_mutex_lock(&this->nsf_file_mutex);
+
+  for (unsigned int i = 0; i < pending.size(); i++)
+    {
+    std::map<std::string, int>::iterator it = this->nsf_states.find(pending[i].first);
+    int                                  saved = (it == this->nsf_states.end()) ? 0 : it->second;
+
+    if (saved == pending[i].second)
+      continue;
+
+    if ((nout == NULL) &&
+        ((nout = fopen(this->nsf_path.c_str(), "a")) == NULL))
+      {
+      log_err(errno, __func__, "could not open file");
+      rc = PBSE_SYSTEM;
+      break;
+      }
+
+    fprintf(nout, "%s %d\n", pending[i].first.c_str(), pending[i].second);
+    this->nsf_records++;
+
+    if (pending[i].second == 0)
+      this->nsf_states.erase(it);
+    else
+      this->nsf_states[pending[i].first] = pending[i].second;
+    }
+
+  if (nout != NULL)
+    {
+    if (fflush(nout) != 0)
+      {
+      log_err(errno, __func__, "failed saving node state to disk");
+      rc = PBSE_SYSTEM;
+      }
+
+    fclose(nout);
+    }
+
+  if ((rc == PBSE_NONE) &&
+      (this->nsf_records > NODE_STATE_COMPACT_MIN_RECORDS) &&
+      (this->nsf_records > this->nsf_states.size() * 2))
+    rc = this->compact_locked();
+
+  pthread_mutex_unlock(&this->nsf_file_mutex);
+
+  return(rc);
+  } /* END flush() */
+
+
+
+/*
+ * compact_locked()
+ *
+ * Rewrites the file with one record per node that has a saved state. The new
+ * file is written beside the old one and renamed over it so a crash leaves
+ * one or the other. nsf_file_mutex must be held.
+ */
+
+int node_state_file::compact_locked()
+
+  {
+  std::string tmp_path(this->nsf_path);
+  FILE       *nout;
+
+  tmp_path += ".new";
+
+  if ((nout = fopen(tmp_path.c_str(), "w")) == NULL)
+    {
+    log_err(errno, __func__, "could not open file");
+    return(PBSE_SYSTEM);
+    }
+
+  for (std::map<std::string, int>::iterator it = this->nsf_states.begin();
+       it != this->nsf_states.end();
+       it++)
+    fprintf(nout, "%s %d\n", it->first.c_str(), it->second);
+
+  if (fflush(nout) != 0)
+    {
+    log_err(errno, __func__, "failed saving node state to disk");
+    fclose(nout);
+    unlink(tmp_path.c_str());
+    return(PBSE_SYSTEM);
+    }
+
+  fclose(nout);
+
+  if (rename(tmp_path.c_str(), this->nsf_path.c_str()) != 0)
+    {
+    log_err(errno, __func__, "could not replace the node state file");
+    unlink(tmp_path.c_str());
+    return(PBSE_SYSTEM);
+    }
+
+  this->nsf_records = this->nsf_states.size();
+
+  return(PBSE_NONE);
+  } /* END compact_locked() */
+
+
+
+int node_state_file::compact()
+
+  {
+  int rc;
+
+  pthread_mutex_lock(&this->nsf_file_mutex);
+  rc = this->compact_locked();
+  pthread_mutex_unlock(&this->nsf_file_mutex);
+
+  return(rc);
+  } /* END compact() */
+
+
+
+unsigned int node_state_file::get_record_count()
+
+  {
+  unsigned int count;
+
+  pthread_mutex_lock(&this->nsf_file_mutex);
+  count = this->nsf_records;
+  pthread_mutex_unlock(&this->nsf_file_mutex);
+
+  return(count);
+  } /* END get_record_count() */
+
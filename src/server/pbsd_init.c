@@ -194,6 +194,7 @@ extern char *path_node_usage;
 extern char *path_mom_hierarchy;
 extern char *path_nodes_new;
 extern char *path_nodestate;
+extern char *path_job_journal;
 extern char *path_nodepowerstate;
 extern char *path_nodenote;
 extern char *path_nodenote_new;
@@ -203,7 +204,8 @@ extern char *path_pbs_environment;
 
 extern int                      queue_rank;
 extern char                     server_name[];
-extern std::list<timed_task>   *task_list_timed;
+extern attribute_def            node_attr_def[];
+extern std::vector<timed_task> *task_list_timed;
 extern pthread_mutex_t          task_list_timed_mutex;
 task_recycler                   tr;
 extern all_jobs                alljobs;
@@ -271,7 +273,7 @@ void  resume_net_move(struct work_task *);
 void  rm_files(char *);
 void  stop_me(int);
 void  change_logs_handler(int sig);
-int   process_jobs_dirent(const char *);
+job  *recover_job_file(const char *);
 int   process_arrays_dirent(const char *, int);
 long  jobid_to_long(std::string);
 bool  is_array_job(std::string);
@@ -819,6 +821,7 @@ int initialize_paths()
   path_svrlog        = build_path(path_home, PBS_LOGFILES, suffix_slash);
   path_jobinfo_log   = build_path(path_home, PBS_JOBINFOLOGDIR, suffix_slash);
   path_track         = build_path(path_priv, PBS_TRACKING, NULL);
+  path_job_journal   = build_path(path_priv, PBS_JOB_JOURNAL, NULL);
   path_nodes         = build_path(path_priv, NODE_DESCRIP, NULL);
   path_node_usage    = build_path(path_priv, NODE_USAGE, suffix_slash);
   path_nodes_new     = build_path(path_priv, NODE_DESCRIP, new_tag);
@@ -977,7 +980,7 @@ int initialize_data_structures_and_mutexes()
 
   initialize_recycler();
 
-  task_list_timed = new std::list<timed_task>();
+  task_list_timed = new std::vector<timed_task>();
   pthread_mutex_init(&task_list_timed_mutex, NULL);
 
   initialize_task_recycler();
@@ -990,6 +993,12 @@ int initialize_data_structures_and_mutexes()
   acctfile_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
   pthread_mutex_init(acctfile_mutex, NULL);
 
+  /* attribute names are looked up for every request, so hash them once */
+  index_attr_defs(job_attr_def, JOB_ATR_LAST);
+  index_attr_defs(svr_attr_def, SRV_ATR_LAST);
+  index_attr_defs(que_attr_def, QA_ATR_LAST);
+  index_attr_defs(node_attr_def, ND_ATR_LAST);
+
   return(PBSE_NONE);
   } /* END initialize_data_structures_and_mutexes() */
 
@@ -1115,6 +1124,9 @@ int setup_server_attrs(
     return(-1);
     }
 
+  if (acct_writer_start() != PBSE_NONE)
+    log_err(-1, __func__, "could not start the accounting writer thread, writing records synchronously");
+
   if (server.sv_attr[SRV_ATR_RecordJobInfo].at_val.at_bool)
     {
     rc = job_log_open(job_log_file, path_jobinfo_log);
@@ -1464,19 +1476,300 @@ void mark_as_badjob(
 
 
 
+/*
+ * recovery_elapsed() - seconds since start
+ */
+
+double recovery_elapsed(
+
+  struct timeval &start)
+
+  {
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+
+  return((now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1000000.0);
+  } /* END recovery_elapsed() */
+
+
+
+/*
+ * get_recovery_threads()
+ *
+ * Recovery is mostly waiting on the disk, so use twice as many threads as
+ * there are processors.
+ *
+ * @return the number of threads a recovery pass may use
+ */
+
+int get_recovery_threads()
+
+  {
+  long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (nprocs < 1)
+    nprocs = 1;
+
+  if (nprocs * 2 > PBS_MAX_RECOVERY_THREADS)
+    return(PBS_MAX_RECOVERY_THREADS);
+
+  return(nprocs * 2);
+  } /* END get_recovery_threads() */
+
+
+
+/*
+ * recovery_worker() - process items of a recovery pass until none are left
+ */
+
+void *recovery_worker(
+
+  void *vp)
+
+  {
+  recovery_pass *pass = (recovery_pass *)vp;
+  size_t         item;
+
+  for (;;)
+    {
+    pthread_mutex_lock(&pass->mutex);
+
+    if (pass->next >= pass->count)
+      {
+      pthread_mutex_unlock(&pass->mutex);
+      break;
+      }
+
+    item = pass->next++;
+
+    pthread_mutex_unlock(&pass->mutex);
+
+    pass->process(pass->data, item);
+    }
+
+  return(NULL);
+  } /* END recovery_worker() */
+
+
+
+/*
+ * run_recovery_pass()
+ *
+ * Runs pass on up to max_threads threads and waits for it to finish. The
+ * threadpools can't be used for this because they aren't started until
+ * recovery is done. If threads can't be created the calling thread does
+ * the work itself.
+ *
+ * @param pass - the items to process. next and mutex are initialized here.
+ * @param max_threads - the most threads to use
+ */
+
+void run_recovery_pass(
+
+  recovery_pass *pass,        /* M */
+  int            max_threads) /* I */
+
+  {
+  std::vector<pthread_t> threads;
+  struct timeval         start;
+  pthread_t              tid;
+  char                   log_buf[LOCAL_LOG_BUF_SIZE];
+
+  gettimeofday(&start, NULL);
+
+  pass->next = 0;
+  pthread_mutex_init(&pass->mutex, NULL);
+
+  if ((size_t)max_threads > pass->count)
+    max_threads = pass->count;
+
+  for (int i = 0; i < max_threads; i++)
+    {
+    if (pthread_create(&tid, NULL, recovery_worker, pass) != 0)
+      break;
+
+    threads.push_back(tid);
+    }
+
+  /* does all of the work if no threads could be created */
+  recovery_worker(pass);
+
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_mutex_destroy(&pass->mutex);
+
+  snprintf(log_buf, sizeof(log_buf), "%s: %lu items in %.3f seconds using %d threads",
+    pass->stage,
+    (unsigned long)pass->count,
+    recovery_elapsed(start),
+    (int)threads.size() + 1);
+  log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
+  } /* END run_recovery_pass() */
+
+
+
+/*
+ * read_recovery_dir()
+ *
+ * Reads the entries of scan->dir. If buckets is non-NULL, the
+ * use_jobs_subdirs directories (0-9) are added to it instead of being
+ * treated as entries.
+ */
+
+void read_recovery_dir(
+
+  recovery_scan              *scan,     /* M */
+  std::vector<recovery_scan> *buckets)  /* O (optional) */
+
+  {
+  DIR           *dir;
+  struct dirent *pdirent;
+
+  if ((dir = opendir(scan->dir.c_str())) == NULL)
+    {
+    char log_buf[LOCAL_LOG_BUF_SIZE];
+
+    snprintf(log_buf, sizeof(log_buf), "unable to open %s", scan->dir.c_str());
+    log_err(errno, __func__, log_buf);
+
+    scan->rc = -1;
+    return;
+    }
+
+  while ((pdirent = readdir(dir)) != NULL)
+    {
+    scan->entries++;
+
+    /* chk_save_file() skips these when it's given a relative name */
+    if (pdirent->d_name[0] == '.')
+      continue;
+
+    if ((buckets != NULL) &&
+        (strlen(pdirent->d_name) == 1) &&
+        (isdigit(pdirent->d_name[0])))
+      {
+      recovery_scan bucket;
+
+      bucket.dir = scan->dir + pdirent->d_name + "/";
+      bucket.entries = 0;
+      bucket.rc = PBSE_NONE;
+      buckets->push_back(bucket);
+      }
+    else
+      scan->files.push_back(scan->dir + pdirent->d_name);
+    }
+
+  closedir(dir);
+  } /* END read_recovery_dir() */
+
+
+
+void scan_bucket(
+
+  void   *data,
+  size_t  item)
+
+  {
+  std::vector<recovery_scan> *buckets = (std::vector<recovery_scan> *)data;
+
+  read_recovery_dir(&buckets->at(item), NULL);
+  } /* END scan_bucket() */
+
+
+
+/*
+ * scan_recovery_dirs()
+ *
+ * Lists base and, when use_subdirs is set, its use_jobs_subdirs buckets.
+ * The buckets are read concurrently.
+ *
+ * @param base - the directory to scan, ending in '/'
+ * @param use_subdirs - the value of use_jobs_subdirs
+ * @param files - set to the full path of every entry found
+ * @param entries - set to the number of directory entries read
+ * @return PBSE_NONE, or -1 if base can't be read
+ */
+
+int scan_recovery_dirs(
+
+  const char               *base,        /* I */
+  bool                      use_subdirs, /* I */
+  std::vector<std::string> &files,       /* O */
+  int                      &entries)     /* O */
+
+  {
+  recovery_scan              top;
+  std::vector<recovery_scan> buckets;
+  recovery_pass              pass;
+
+  top.dir = base;
+  top.entries = 0;
+  top.rc = PBSE_NONE;
+
+  read_recovery_dir(&top, (use_subdirs == true) ? &buckets : NULL);
+
+  if (top.rc != PBSE_NONE)
+    return(top.rc);
+
+  memset(&pass, 0, sizeof(pass));
+  pass.stage = "scan directories";
+  pass.count = buckets.size();
+  pass.process = scan_bucket;
+  pass.data = &buckets;
+
+  if (pass.count > 0)
+    run_recovery_pass(&pass, pass.count);
+
+  files.swap(top.files);
+  entries = top.entries;
+
+  for (size_t i = 0; i < buckets.size(); i++)
+    {
+    files.insert(files.end(), buckets[i].files.begin(), buckets[i].files.end());
+    entries += buckets[i].entries;
+    }
+
+  return(PBSE_NONE);
+  } /* END scan_recovery_dirs() */
+
+
+
+typedef struct array_recovery_data
+  {
+  std::vector<std::string> *files;
+  std::vector<int>          rcs;
+  int                       type;
+  } array_recovery_data;
+
+
+
+void recover_array_item(
+
+  void   *data,
+  size_t  item)
+
+  {
+  array_recovery_data *ard = (array_recovery_data *)data;
+
+  ard->rcs[item] = process_arrays_dirent(ard->files->at(item).c_str(), ard->type);
+  } /* END recover_array_item() */
+
+
+
 int handle_array_recovery(
     
   int type)
 
   {
-  char              log_buf[LOCAL_LOG_BUF_SIZE];
-  struct dirent    *pdirent;
-  struct dirent    *pdirent_sub;
-  DIR              *dir;
-  DIR              *dir_sub;
-  int               rc = PBSE_NONE;
-  int               rc2 = PBSE_NONE;
-  bool              use_jobs_subdirs = false;
+  char                      log_buf[LOCAL_LOG_BUF_SIZE];
+  int                       rc = PBSE_NONE;
+  bool                      use_jobs_subdirs = false;
+  int                       entries = 0;
+  std::vector<std::string>  files;
+  array_recovery_data       ard;
+  recovery_pass             pass;
 
   if (chdir(path_arrays) != 0)
     {
@@ -1490,74 +1783,49 @@ int handle_array_recovery(
     return(-1);
     }
 
-  if ((dir = opendir(".")) == NULL)
-    return -1;
-
   // get the value of use_jobs_subdirs if set
   get_svr_attr_b(SRV_ATR_use_jobs_subdirs, &use_jobs_subdirs);
 
-  while ((pdirent = readdir(dir)) != NULL)
-    {
-    // if we are using divided subdirectories for arrays
-    //   need to move into them
-    if ((use_jobs_subdirs == TRUE) && (strlen(pdirent->d_name) == 1) &&
-        isdigit(pdirent->d_name[0]))
-      {
-      if (chdir(pdirent->d_name) != 0)
-        {
-        rc = -1;
-        break;
-        }
-      if ((dir_sub = opendir(".")) == NULL)
-        {
-        rc = -1;
-        break;
-        }
-      while ((pdirent_sub = readdir(dir_sub)) != NULL)
-        {
-        rc = process_arrays_dirent(pdirent_sub->d_name, type);
-        }
-      closedir(dir_sub);
+  if (scan_recovery_dirs(path_arrays, use_jobs_subdirs, files, entries) != PBSE_NONE)
+    return(-1);
 
-      if (chdir(path_arrays) != 0)
-        {
-        sprintf(log_buf, msg_init_chdir, path_arrays);
+  ard.files = &files;
+  ard.rcs.resize(files.size(), PBSE_NONE);
+  ard.type = type;
 
-        log_err(errno, __func__, log_buf);
+  memset(&pass, 0, sizeof(pass));
+  pass.stage = "recover arrays";
+  pass.count = files.size();
+  pass.process = recover_array_item;
+  pass.data = &ard;
 
-        sprintf(log_buf, "%s:2", __func__);
-        unlock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
+  run_recovery_pass(&pass, get_recovery_threads());
 
-        closedir(dir);
-        return(-1);
-        }
-      }
-    else
-      {
-      rc = process_arrays_dirent(pdirent->d_name, type);
-      }
-    if (rc != PBSE_NONE)
-      {
-      rc2 = rc;
-      }
+  for (size_t i = 0; i < ard.rcs.size(); i++)
+    {
+    if (ard.rcs[i] != PBSE_NONE)
+      rc = ard.rcs[i];
     }
 
-  closedir(dir);
+  if (rc != PBSE_NONE)
+    {
+    /* a failed array recovery has always left this unlocked */
+    sprintf(log_buf, "%s:3", __func__);
+    unlock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
+    }
 
-  if (rc2 != PBSE_NONE)
-    rc = rc2;
   return(rc);
   } /* handle_array_recovery() */
 
 /**
  * Process an arrays directory entry
- * @param dirent_name - name of the entry
+ * @param path - full path of the entry
  * @param type - recovery type
  */
 
 int process_arrays_dirent(
 
-  const char *dirent_name,
+  const char *path,
   int         type)
 
   {
@@ -1568,32 +1836,29 @@ int process_arrays_dirent(
   int               array_suf_len = strlen(ARRAY_FILE_SUFFIX);
   char             *psuffix;
 
-  if (chk_save_file(dirent_name) == PBSE_NONE)
+  if (chk_save_file(path) == PBSE_NONE)
     {
     /* if not create or clean recovery, recover arrays */
 
     if (type != RECOV_CREATE)
       {
       /* skip files without the proper suffix */
-      baselen = strlen(dirent_name) - array_suf_len;
+      baselen = strlen(path) - array_suf_len;
 
-      psuffix = (char *)dirent_name + baselen;
+      psuffix = (char *)path + baselen;
 
       if (strcmp(psuffix, ARRAY_FILE_SUFFIX))
         return(rc);
 
-      if ((rc = array_recov(dirent_name, &pa)) != PBSE_NONE)
+      if ((rc = array_recov(path, &pa)) != PBSE_NONE)
         {
         sprintf(log_buf,
           "could not recover array-struct from file %s--skipping. job array can not be recovered.",
-          dirent_name);
+          path);
 
         log_err(errno, __func__, log_buf);
 
-        sprintf(log_buf, "%s:3", __func__);
-        unlock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
-
-        mark_as_badjob(dirent_name);
+        mark_as_badjob(path);
         }
       else
         {
@@ -1603,7 +1868,7 @@ int process_arrays_dirent(
       }
     else
       {
-      unlink(dirent_name);
+      unlink(path);
       }
     }
   return(rc);
@@ -1648,24 +1913,77 @@ bool is_array_job(std::string jid)
 
 
 
+typedef struct job_recovery_data
+  {
+  std::vector<std::string> *files;
+  std::vector<job *>        jobs;       /* the job recovered from each file, if any */
+  int                       files_read; /* updated atomically by the recovery threads */
+  } job_recovery_data;
+
+
+
+/*
+ * recover_job_item()
+ *
+ * Runs on several recovery threads at once. job_recov() only touches the
+ * job it is reading plus locally scoped buffers, and the attribute decode
+ * and ATR_ACTION_RECOV actions it reaches either work on the job alone,
+ * take their own locks (set_task(), get_jobs_queue(), the journal replay
+ * and ghost array mutexes) or return early for recovery (action_resc(),
+ * depend_on_que(), ck_checkpoint()). Anything added to that path must
+ * keep to the same rules.
+ */
+
+void recover_job_item(
+
+  void   *data,
+  size_t  item)
+
+  {
+  job_recovery_data *jrd = (job_recovery_data *)data;
+  char               log_buf[LOCAL_LOG_BUF_SIZE];
+  int                files_read;
+
+  jrd->jobs[item] = recover_job_file(jrd->files->at(item).c_str());
+
+  files_read = __sync_add_and_fetch(&jrd->files_read, 1);
+
+  if ((files_read % 1000) == 0)
+    {
+    snprintf(log_buf, sizeof(log_buf), "%d files read from disk", files_read);
+    log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
+    }
+  } /* END recover_job_item() */
+
+
+
+/*
+ * handle_job_recovery()
+ *
+ * The job files are found by scanning path_jobs (its use_jobs_subdirs
+ * buckets concurrently), read and parsed by a set of recovery threads,
+ * and then initialized one at a time in job id order so that queue ranks
+ * and array linkage come out the same as a serial recovery.
+ */
+
 int handle_job_recovery(
 
   int type)
 
   {
-  char              log_buf[LOCAL_LOG_BUF_SIZE];
-  int               rc = PBSE_NONE;
-  int               job_rc = PBSE_NONE;
-  int               logtype;
-  struct dirent    *pdirent;
-  struct dirent    *pdirent_sub;
-  DIR              *dir;
-  DIR              *dir_sub;
-  int               had;
-  job              *pjob;
-  time_t            time_now = time(NULL);
-  char              basen[MAXPATHLEN+1];
-  bool              use_jobs_subdirs = false;
+  char                      log_buf[LOCAL_LOG_BUF_SIZE];
+  int                       rc = PBSE_NONE;
+  int                       job_rc = PBSE_NONE;
+  int                       logtype;
+  int                       had;
+  job                      *pjob;
+  time_t                    time_now = time(NULL);
+  char                      basen[MAXPATHLEN+1];
+  bool                      use_jobs_subdirs = false;
+  std::vector<std::string>  files;
+  job_recovery_data         jrd;
+  recovery_pass             pass;
+  struct timeval            start;
 
   JobArray.clear();
   recovered_job_count = 0;
@@ -1688,9 +2006,10 @@ int handle_job_recovery(
   sprintf(log_buf, "%s:2", __func__);
   unlock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
 
-  dir = opendir(".");
+  // get the value of use_jobs_subdirs if set
+  get_svr_attr_b(SRV_ATR_use_jobs_subdirs, &use_jobs_subdirs);
 
-  if (dir == NULL)
+  if (scan_recovery_dirs(path_jobs, use_jobs_subdirs, files, recovered_job_count) != PBSE_NONE)
     {
     if (type != RECOV_CREATE)
       {
@@ -1708,81 +2027,28 @@ int handle_job_recovery(
     }
   else
     {
-    // get the value of use_jobs_subdirs if set
-    get_svr_attr_b(SRV_ATR_use_jobs_subdirs, &use_jobs_subdirs);
-
-    while ((pdirent = readdir(dir)) != NULL)
-      {
-      // if we are using divided subdirectories for jobs
-      //   need to move into them
-      if ((use_jobs_subdirs == TRUE) && (strlen(pdirent->d_name) == 1) &&
-          isdigit(pdirent->d_name[0]))
-        {
-        if (chdir(pdirent->d_name) != 0)
-          {
-          char path_buf[1024];
-
-          snprintf(path_buf, sizeof(path_buf), "%s%s", path_arrays, pdirent->d_name);
-
-          sprintf(log_buf, msg_init_chdir, path_buf);
-
-          log_err(errno, __func__, log_buf);
-
-          sprintf(log_buf, "%s:1", __func__);
-          unlock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
-
-          closedir(dir);
-          return(-1);
-          }
-        dir_sub = opendir(".");
-        if (dir_sub == NULL)
-          {
-          if (type != RECOV_CREATE)
-            {
-            if (had == 0)
-              {
-              log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, msg_daemonname, msg_init_nojobs);
-              }
-            else
-              {
-              sprintf(log_buf, msg_init_exptjobs, had, recovered_job_count);
-
-              log_err(-1, __func__, log_buf);
-              }
-            }
-          }
-        else
-          {
-          while ((pdirent_sub = readdir(dir_sub)) != NULL)
-            {
-            process_jobs_dirent(pdirent_sub->d_name);
-            }
+    snprintf(log_buf, LOCAL_LOG_BUF_SIZE, "%d total files read from disk", recovered_job_count);
+    log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
 
-          closedir(dir_sub);
+    jrd.files = &files;
+    jrd.jobs.resize(files.size(), NULL);
+    jrd.files_read = 0;
 
-          if (chdir(path_jobs) != 0)
-            {
-            sprintf(log_buf, msg_init_chdir, path_jobs);
-        
-            log_err(errno, __func__, log_buf);
+    memset(&pass, 0, sizeof(pass));
+    pass.stage = "recover jobs";
+    pass.count = files.size();
+    pass.process = recover_job_item;
+    pass.data = &jrd;
 
-            sprintf(log_buf, "%s:1", __func__);
-            unlock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
+    run_recovery_pass(&pass, get_recovery_threads());
 
-            closedir(dir);
-            return(-1);
-            }
-          }
-        }
-      else
-        {
-        process_jobs_dirent(pdirent->d_name);
-        }
+    for (size_t i = 0; i < jrd.jobs.size(); i++)
+      {
+      if (jrd.jobs[i] != NULL)
+        JobArray[jrd.jobs[i]->ji_qs.ji_jobid] = jrd.jobs[i];
       }
 
-    snprintf(log_buf, LOCAL_LOG_BUF_SIZE, "%d total files read from disk", recovered_job_count);
-    log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
-    closedir(dir);
+    gettimeofday(&start, NULL);
 
     int Index = 0;
     std::map<std::string, job *>::iterator JobArray_iter;
@@ -1860,6 +2126,11 @@ int handle_job_recovery(
         Index = 0;
       }
 
+    snprintf(log_buf, sizeof(log_buf), "initialize jobs: %lu jobs in %.3f seconds",
+      (unsigned long)JobArray.size(),
+      recovery_elapsed(start));
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
+
     sprintf(log_buf, "%s:1", __func__);
     lock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
 
@@ -1900,83 +2171,62 @@ int handle_job_recovery(
   } /* END handle_job_recovery() */
 
 /**
- * Process a jobs directory entry
- * @param dirent_name - name of the entry
+ * Recover the job in a jobs directory entry. Called from the recovery threads.
+ * @param path - full path of the entry
+ * @return the recovered job (unlocked), or NULL if path isn't a job file or
+ * couldn't be recovered
  */
 
-int process_jobs_dirent(
+job *recover_job_file(
 
-  const char *dirent_name)
+  const char *path)
 
   {
   char              log_buf[LOCAL_LOG_BUF_SIZE];
-  int               rc = PBSE_NONE;
   int               baselen = 0;
   job              *pjob;
   char             *psuffix;
   const char       *job_suffix = JOB_FILE_SUFFIX;
   int               job_suf_len = strlen(job_suffix);
-  char              basen[MAXPATHLEN+1];
 
-  recovered_job_count++;
-  if ((recovered_job_count % 1000) == 0)
-    {
-    snprintf(log_buf, LOCAL_LOG_BUF_SIZE, "%d files read from disk", recovered_job_count);
-    log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
-    }
+  if (chk_save_file(path) != 0)
+    return(NULL);
 
-  if (chk_save_file(dirent_name) == 0)
-    {
-    /* recover the jobs */
-    baselen = strlen(dirent_name) - job_suf_len;
+  /* recover the jobs */
+  baselen = strlen(path) - job_suf_len;
 
-    psuffix = (char *)dirent_name + baselen;
-    if (!strcmp(psuffix, JOB_FILE_TMP_SUFFIX))
+  psuffix = (char *)path + baselen;
+  if (!strcmp(psuffix, JOB_FILE_TMP_SUFFIX))
+    {
+    if ((pjob = job_recov(path)) != NULL)
       {
-      if ((pjob = job_recov(dirent_name)) != NULL)
-        {
-        pjob->ji_is_array_template = true;
-
+      pjob->ji_is_array_template = true;
 
-        JobArray[pjob->ji_qs.ji_jobid] = pjob;
-
-        unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
-        }
-
-      return(rc);
+      unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
       }
 
-    if (strcmp(psuffix, job_suffix))
-      return(rc);
+    return(pjob);
+    }
 
-    if ((pjob = job_recov(dirent_name)) != NULL)
-      {
-      JobArray[pjob->ji_qs.ji_jobid] = pjob;
+  if (strcmp(psuffix, job_suffix))
+    return(NULL);
 
-      unlock_ji_mutex(pjob, __func__, "2", LOGLEVEL);
-      }
-    else
-      {
-      sprintf(log_buf, msg_init_badjob, dirent_name);
-
-      log_err(-1, __func__, log_buf);
+  if ((pjob = job_recov(path)) != NULL)
+    {
+    unlock_ji_mutex(pjob, __func__, "2", LOGLEVEL);
+    }
+  else
+    {
+    sprintf(log_buf, msg_init_badjob, path);
 
-      /* remove corrupt job */
-      snprintf(basen, sizeof(basen), "%s%s", dirent_name, JOB_BAD_SUFFIX);
+    log_err(-1, __func__, log_buf);
 
-      if (link(dirent_name, basen) < 0)
-        {
-        log_err(errno, __func__, "failed to link corrupt .JB file to .BD");
-        }
-      else
-        {
-        unlink(dirent_name);
-        }
-      }
+    /* remove corrupt job */
+    mark_as_badjob(path);
     }
 
-  return(rc);
-  } /* END process_jobs_dirent() */
+  return(pjob);
+  } /* END recover_job_file() */
 
 
 int cleanup_recovered_arrays()
@@ -2095,6 +2345,9 @@ int handle_job_and_array_recovery(
   int rc;
   int tmp_rc;
 
+  /* state changes journaled since the job files were last written */
+  replay_job_journal(path_job_journal);
+
   rc = handle_array_recovery(type);
   
   if ((tmp_rc = handle_job_recovery(type)) != PBSE_NONE)
@@ -2108,6 +2361,9 @@ int handle_job_and_array_recovery(
   if (rc == PBSE_NONE)
     rc = tmp_rc;
 
+  /* every recovered job has been re-saved, so start a new journal */
+  open_job_journal();
+
   return(rc);
   } /* END handle_job_and_array_recovery() */
 
@@ -1,6 +1,9 @@
 #ifndef _PBSD_INIT_H
 #define _PBSD_INIT_H
 #include "license_pbs.h" /* See here for the software license */
+#include <pthread.h>
+#include <string>
+#include <vector>
 
 /*
  * dynamic array, with utility functions for easy appending
@@ -21,6 +24,34 @@ int DArrayAppend(darray_t *Array, void *Item);
 
 /* static int SortPrioAscend(const void *A, const void *B); */
 
+/*
+ * A recovery pass runs process() on items 0 .. count - 1 from a set of
+ * recovery threads that each claim the next unprocessed item.
+ */
+
+typedef struct recovery_pass
+  {
+  const char       *stage;      /* for the timing log message */
+  size_t            count;
+  size_t            next;       /* next unclaimed item */
+  pthread_mutex_t   mutex;
+  void            (*process)(void *data, size_t item);
+  void             *data;
+  } recovery_pass;
+
+/* one directory read while looking for job or array files */
+typedef struct recovery_scan
+  {
+  std::string               dir;      /* ends in '/' */
+  std::vector<std::string>  files;    /* full paths of the entries found */
+  int                       entries;  /* directory entries read */
+  int                       rc;
+  } recovery_scan;
+
+void run_recovery_pass(recovery_pass *pass, int max_threads);
+
+int scan_recovery_dirs(const char *base, bool use_subdirs, std::vector<std::string> &files, int &entries);
+
 void update_default_np();
 
 void add_server_names_to_acl_hosts(void);
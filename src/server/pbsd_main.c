@@ -147,6 +147,7 @@
 #include "node_func.h"
 #include "mom_hierarchy_handler.h"
 #include "completed_jobs_map.h"
+#include "svr_connect.h"
 
 
 #define TASK_CHECK_INTERVAL      10
@@ -155,6 +156,7 @@
 #define TSERVER_HA_CHECK_TIME    1  /* 1 second sleep time between checks on the lock file for high availability */
 #define UPDATE_TIMEOUT_INTERVAL  10
 #define UPDATE_LOGLEVEL_INTERVAL 10
+#define THREADPOOL_STATS_INTERVAL 300
 
 /* external functions called */
 
@@ -243,6 +245,7 @@ char                   *path_node_usage;
 char                   *path_mom_hierarchy;
 char                   *path_nodes_new;
 char                   *path_nodestate;
+char                   *path_job_journal;
 char                   *path_nodepowerstate;
 char                   *path_nodenote;
 char                   *path_nodenote_new;
@@ -918,30 +921,38 @@ pthread_t      route_retry_thread_id = -1;
 void *check_tasks(void *notUsed)
 
   {
-  work_task *ptask;
-  int        rc = PBSE_NONE;
+  std::vector<work_task *> expired;
+  int                      rc = PBSE_NONE;
 
-  time_t     time_now;
+  time_t                   time_now;
 
   pthread_mutex_lock(check_tasks_mutex);
 
   time_now = time(NULL);
   last_task_check_time = time_now;
 
-  while ((ptask = pop_timed_task(time_now)) != NULL)
+  while ((rc == PBSE_NONE) &&
+         (pop_timed_tasks(time_now, expired, TIMED_TASK_BATCH) > 0))
     {
-    rc = dispatch_timed_task(ptask); /* will delete link */
-
-    /* if dispatch_task does not return PBSE_NONE 
-       it is because we have used up our alotment of threads.
-       Break for now and come back to this next time 
-       through the main_loop 
-     */
-    if (rc != PBSE_NONE)
+    for (unsigned int i = 0; i < expired.size(); i++)
       {
-      pthread_mutex_unlock(ptask->wt_mutex);
-      break;
+      work_task *ptask = expired[i];
+
+      /* if dispatch_task does not return PBSE_NONE
+         it is because we have used up our alotment of threads.
+         Put the rest back for now and come back to them next time
+         through the main_loop
+       */
+      if (rc != PBSE_NONE)
+        insert_timed_task(ptask);
+      else
+        rc = dispatch_timed_task(ptask); /* will delete link */
+
+      if (rc != PBSE_NONE)
+        pthread_mutex_unlock(ptask->wt_mutex);
       }
+
+    expired.clear();
     }
 
   /* should the scheduler be run?  If so, adjust the schedule time  */
@@ -1288,6 +1299,7 @@ void main_loop(void)
   time_t        time_now = time(NULL);
 //  time_t        try_hellos = 0;
   time_t        update_loglevel = 0;
+  time_t        log_pool_stats = 0;
 
   extern char  *msg_startup2; /* log message   */
   char          log_buf[LOCAL_LOG_BUF_SIZE];
@@ -1296,6 +1308,8 @@ void main_loop(void)
   void check_log(struct work_task *);
   void check_job_log(struct work_task *);
   void check_acct_log(struct work_task *);
+  void check_mom_connections(struct work_task *);
+  void check_job_journal(struct work_task *);
 
   server.sv_started = time_now; /* time server started */
 
@@ -1332,6 +1346,11 @@ void main_loop(void)
 
   set_task(WORK_Timed,time_now + 10,check_acct_log, (char *)NULL, FALSE);
 
+  if (PBS_MOM_POOL_MAX_PER_NODE > 0)
+    set_task(WORK_Timed, time_now + PBS_MOM_POOL_IDLE_TIME, check_mom_connections, (char *)NULL, FALSE);
+
+  set_task(WORK_Timed, time_now + PBS_JOURNAL_COMPACT_TIME, check_job_journal, (char *)NULL, FALSE);
+
   /*
    * Now at last, we are ready to do some batch work.  The
    * following section constitutes the "main" loop of the server
@@ -1422,6 +1441,16 @@ void main_loop(void)
       LOGLEVEL = log;
       }
 
+    if ((LOGLEVEL >= 6) &&
+        (time_now >= log_pool_stats))
+      {
+      log_pool_stats = time_now + THREADPOOL_STATS_INTERVAL;
+      log_threadpool_stats(request_pool, "request_pool");
+      log_threadpool_stats(task_pool, "task_pool");
+      log_threadpool_stats(async_pool, "async_pool");
+      log_hierarchy_fanin_stats();
+      }
+
     /* 
      * Can we comment this out? Would anything above change the
      * server state without setting the 'state' variable? 
@@ -1882,6 +1911,9 @@ int main(
   log_open(log_file, path_log);
   pthread_mutex_unlock(&log_mutex);
 
+  if (log_async_init() != PBSE_NONE)
+    log_err(-1, msg_daemonname, "could not start the log writer thread, logging synchronously");
+
   sprintf(log_buf, msg_startup1, server_name, server_init_type);
 
   log_event(
@@ -1951,6 +1983,8 @@ int main(
 
   acct_close(false);
 
+  log_async_stop();
+
   pthread_mutex_lock(&log_mutex);
   log_close(1);
   pthread_mutex_unlock(&log_mutex);
@@ -2047,11 +2081,12 @@ void check_log(
   struct work_task *ptask) /* I */
 
   {
-  long    keep_days =0;
-  long    max_size = 0;
-  char    log_buf[LOCAL_LOG_BUF_SIZE];
-  time_t  time_now = time(NULL);
-  char   *version = NULL;
+  static bool roll_depth_out_of_range = false;
+  long        keep_days =0;
+  long        max_size = 0;
+  char        log_buf[LOCAL_LOG_BUF_SIZE];
+  time_t      time_now = time(NULL);
+  char       *version = NULL;
 
   /* remove logs older than LogKeepDays */
   if (get_svr_attr_l(SRV_ATR_LogKeepDays, &keep_days) == PBSE_NONE)
@@ -2072,31 +2107,34 @@ void check_log(
       }
     }
 
+  /* the log writer rolls the log once it reaches max_size */
   if (get_svr_attr_l(SRV_ATR_LogFileMaxSize, &max_size) == PBSE_NONE)
     {
     long roll_depth = 1;
 
-    if ((log_size() >= max_size) &&
-        (max_size > 0))
-      {
-      log_event(
-        PBSEVENT_SYSTEM | PBSEVENT_FORCE,
-        PBS_EVENTCLASS_SERVER,
-        msg_daemonname,
-        (char *)"Rolling log file");
-
-      get_svr_attr_l(SRV_ATR_LogFileRollDepth, &roll_depth);
+    get_svr_attr_l(SRV_ATR_LogFileRollDepth, &roll_depth);
 
-      if ((roll_depth >= INT_MAX) || (roll_depth < 1))
-        {
+    if ((roll_depth >= INT_MAX) || (roll_depth < 1))
+      {
+      /* only complain when the depth goes bad, not on every check */
+      if ((max_size > 0) &&
+          (roll_depth_out_of_range == false))
         log_err(-1, "check_log", (char *)"log roll cancelled, logfile depth is out of range");
-        }
-      else
-        {
-        log_roll(roll_depth);
-        }
+
+      roll_depth_out_of_range = (max_size > 0);
+      log_set_roll_limits(0, 1);
+      }
+    else
+      {
+      roll_depth_out_of_range = false;
+      log_set_roll_limits(max_size, roll_depth);
       }
     }
+  else
+    {
+    roll_depth_out_of_range = false;
+    log_set_roll_limits(0, 1);
+    }
 
 
   /* periodically record the version and loglevel */
@@ -2156,6 +2194,55 @@ void check_acct_log(
 
 
 
+/*
+ * check_mom_connections - close pooled mom connections that have been
+ * idle for PBS_MOM_POOL_IDLE_TIME seconds
+ */
+
+void check_mom_connections(
+
+  struct work_task *ptask) /* I */
+
+  {
+  time_t time_now = time(NULL);
+
+  close_idle_mom_connections(time_now);
+
+  free(ptask->wt_mutex);
+  free(ptask);
+
+  set_task(WORK_Timed, time_now + (PBS_MOM_POOL_IDLE_TIME / 2), check_mom_connections, (char *)NULL, FALSE);
+
+  return;
+  } /* END check_mom_connections */
+
+
+
+
+/*
+ * check_job_journal - fold the job state changes journaled since the last
+ * check back into the job files
+ */
+
+void check_job_journal(
+
+  struct work_task *ptask) /* I */
+
+  {
+  compact_job_journal();
+
+  free(ptask->wt_mutex);
+  free(ptask);
+
+  set_task(WORK_Timed, time(NULL) + PBS_JOURNAL_COMPACT_TIME, check_job_journal, (char *)NULL, FALSE);
+
+  return;
+  } /* END check_job_journal */
+
+
+
+
+
 /*
  * get_port - parse host:port for -M and -S and -l option
  * Returns into *port and *addr if and only if that part is specified
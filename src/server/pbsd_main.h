@@ -27,6 +27,10 @@ void check_log(struct work_task *ptask);
 
 void check_acct_log(struct work_task *ptask);
 
+void check_mom_connections(struct work_task *ptask);
+
+void check_job_journal(struct work_task *ptask);
+
 char *extract_dir(char *FullPath, char *Dir, int DirSize);
 
 int is_ha_lock_file_valid(char *lockfile);
@@ -440,6 +440,14 @@ const char *pbsnode::get_name() const
 
 
 
+const std::vector<std::string> &pbsnode::get_properties() const
+
+  {
+  return(this->nd_properties);
+  }
+
+
+
 int pbsnode::get_error() const
 
   {
@@ -331,7 +331,10 @@ struct pbsnode *determine_node_from_str(
     }
   
   if (next != NULL)
+    {
     next->nd_lastupdate = time(NULL);
+    update_node_liveness(next);
+    }
 
   return(next);
   } /* END determine_node_from_str() */
@@ -98,6 +98,7 @@
 #include "mutex_mgr.hpp"
 #include "id_map.hpp"
 #include "plugin_internal.h"
+#include "mom_update.h"
 
 
 extern attribute_def    node_attr_def[];   /* node attributes defs */
@@ -277,6 +278,7 @@ struct pbsnode *get_numa_from_str(
   numa->lock_node(__func__, "numa numa update", LOGLEVEL);
   
   numa->nd_lastupdate = time(NULL);
+  update_node_liveness(numa);
   
   return(numa);
   } /* END get_numa_from_str() */
@@ -332,12 +334,14 @@ struct pbsnode *get_node_from_str(
         }
       
       next->nd_lastupdate = time(NULL);
+      update_node_liveness(next);
       }
     }
   else
     {
     next = np;
     next->nd_lastupdate = time(NULL);
+    update_node_liveness(next);
     }
 
   /* next may be NULL */
@@ -731,6 +735,9 @@ int save_node_status(
 
   np->nd_status = new_status;
 
+  // gpus, power state and np may have changed with this status
+  update_free_node_index(np);
+
   return(rc);
   } /* END save_node_status() */
 
@@ -805,17 +812,52 @@ void update_layout_if_needed(
  *
  * @param nd_name - the name of the node who sent this update
  * @param status_info - a list of each status string sent in
+ * @param changed - for a delta update, which strings differ from the last
+ * update. NULL means every string is new.
  * @return PBSE_NONE on SUCCESS, PBSE_* on error
  */
 
 int process_status_info(
 
   const char               *nd_name,
-  std::vector<std::string> &status_info)
+  std::vector<std::string> &status_info,
+  const std::vector<bool>  *changed)
+
+  {
+  pbsnode *current;
+
+  /* if original node cannot be found do not process the update */
+  if ((current = find_nodebyname(nd_name)) == NULL)
+    return(PBSE_NONE);
+
+  return(process_node_status(current, nd_name, status_info, changed));
+  } /* END process_status_info() */
+
+
+
+/*
+ * process_node_status()
+ *
+ * Applies status strings to current. The strings may switch to other nodes
+ * with "node=" (statuses forwarded through the mom hierarchy) or to numa
+ * boards.
+ *
+ * @param current - the node the status starts with, locked. It is unlocked
+ * on return.
+ * @param name - the node that sent the status
+ * @param changed - if not NULL, false for each string that is the same as
+ * in the node's previous status
+ * @return PBSE_NONE or SEND_HELLO if the mom asked for the hierarchy
+ */
+
+int process_node_status(
+
+  pbsnode                  *current,     /* I (unlocked on return) */
+  const char               *name,        /* I */
+  std::vector<std::string> &status_info, /* I */
+  const std::vector<bool>  *changed)     /* I */
 
   {
-  const char     *name = nd_name;
-  pbsnode        *current;
   bool            mom_job_sync = true;
   bool            auto_np = false;
   bool            down_on_error = false;
@@ -830,10 +872,6 @@ int process_status_info(
   get_svr_attr_b(SRV_ATR_NoteAppendOnError, &note_append_on_error);
   get_svr_attr_b(SRV_ATR_DownOnError, &down_on_error);
 
-  /* if original node cannot be found do not process the update */
-  if ((current = find_nodebyname(nd_name)) == NULL)
-    return(PBSE_NONE);
-
   //A node we put to sleep is up and running.
   if (current->nd_power_state != POWER_STATE_RUNNING)
     {
@@ -935,7 +973,7 @@ int process_status_info(
       sji->sync_jobs = mom_job_sync;
         
       // sji is freed in sync_node_jobs()
-      enqueue_threadpool_request(sync_node_jobs, sji, task_pool);
+      enqueue_threadpool_request_lane(sync_node_jobs, sji, task_pool, TP_LANE_HIGH);
 
       continue;
       }
@@ -975,11 +1013,6 @@ int process_status_info(
       if (dont_change_state == FALSE)
         process_state_str(current, str);
       }
-    else if ((allow_any_mom == TRUE) &&
-             (!strncmp(str, "uname", 5))) 
-      {
-      process_uname_str(current, str);
-      }
     else if (!strncmp(str, "me", 2))  /* shorter str compare than "message" */
       {
       if ((!strncmp(str, "message=ERROR", 13)) &&
@@ -994,10 +1027,6 @@ int process_status_info(
           }
         }
       }
-    else if (!strncmp(str,"macaddr=",8))
-      {
-      update_node_mac_addr(current,str + 8);
-      }
     else if ((mom_job_sync == true) &&
              (!strncmp(str, "jobdata=", 8)))
       {
@@ -1006,10 +1035,25 @@ int process_status_info(
       }
     else if ((auto_np) &&
              (!(strncmp(str, "ncpus=", 6))))
-
       {
+      /* np can change under an unchanged ncpus (qmgr, auto_node_np turned on) */
       handle_auto_np(current, str);
       }
+    else if ((changed != NULL) &&
+             (i < changed->size()) &&
+             ((*changed)[i] == false))
+      {
+      /* the rest only record what the string says, and it hasn't changed */
+      }
+    else if ((allow_any_mom == TRUE) &&
+             (!strncmp(str, "uname", 5))) 
+      {
+      process_uname_str(current, str);
+      }
+    else if (!strncmp(str,"macaddr=",8))
+      {
+      update_node_mac_addr(current,str + 8);
+      }
     else if (!strncmp(str, "version=", 8))
       {
       current->set_version(str + 8);
@@ -1027,7 +1071,7 @@ int process_status_info(
     rc = SEND_HELLO;
     
   return(rc);
-  } /* END process_status_info() */
+  } /* END process_node_status() */
 
 
 
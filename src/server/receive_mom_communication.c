@@ -83,6 +83,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <vector>
+#include <map>
 #include <string>
 
 #include "pbs_config.h"
@@ -98,6 +99,7 @@
 #include "threadpool.h"
 #include "../lib/Libnet/lib_net.h"
 #include "../lib/Libutils/u_lock_ctl.h"
+#include "../lib/Libutils/lib_utils.h" /* apply_status_delta */
 #include "mutex_mgr.hpp"
 #include "server_comm.h"
 #include "mom_hierarchy_handler.h"
@@ -111,6 +113,50 @@ job *get_job_from_job_usage_info(job_usage_info *jui, struct pbsnode *pnode);
 int  unlock_ji_mutex(job *, const char *, const char *, int);
 
 
+/*
+ * The last status each mom sent, rebuilt from its deltas. A mom sends only
+ * the positions that changed since the generation it names as its base.
+ */
+
+struct received_status_base
+  {
+  unsigned long            generation;
+  std::vector<std::string> status;
+
+  received_status_base() : generation(0), status() {}
+  };
+
+std::map<std::string, received_status_base> received_statuses;
+pthread_mutex_t                             received_statuses_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*
+ * How long statuses forwarded in batches waited at the forwarding mom, per
+ * hierarchy level of the node the status is for. Reset each time it is logged.
+ */
+
+struct fanin_level_stats
+  {
+  unsigned long statuses;
+  unsigned long total_age;
+  unsigned long max_age;
+
+  fanin_level_stats() : statuses(0), total_age(0), max_age(0) {}
+  };
+
+std::vector<fanin_level_stats> fanin_stats;
+unsigned long                  fanin_batches = 0;
+pthread_mutex_t                fanin_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* a status batch handed to a task_pool thread */
+struct status_batch_work
+  {
+  std::string                     reporter;
+  std::vector<status_batch_entry> entries;
+  };
+
+
 /* 
  * reads all of the status information from stream
  * and stores it in a dynamic string
@@ -196,13 +242,379 @@ int is_stat_get(
   if (is_reporter_node(node_name))
     rc = process_alps_status(node_name, status_info);
   else
-    rc = process_status_info(node_name, status_info);
+    rc = process_status_info(node_name, status_info, NULL);
 
   return(rc);
   }  /* END is_stat_get() */
 
 
 
+/*
+ * read_status_delta()
+ *
+ * Reads an IS_STATUS_DELTA body and applies it to the last status received
+ * from node_name.
+ *
+ * @param node_name - the node sending the delta
+ * @param chan - the connection to read from
+ * @param status - set to the node's complete status on success
+ * @param changed - set to true for each position of status that changed
+ * @return DIS_SUCCESS, a DIS error, or IS_STATUS_BASE_UNKNOWN if the
+ * delta's base isn't the status we have for this node
+ */
+
+int read_status_delta(
+
+  const char               *node_name,  /* I */
+  struct tcp_chan          *chan,       /* I */
+  std::vector<std::string> &status,     /* O */
+  std::vector<bool>        &changed)    /* O */
+
+  {
+  int                       rc;
+  unsigned int              version;
+  unsigned long             base_gen;
+  unsigned long             gen;
+  unsigned int              count;
+  unsigned int              nchanged;
+  std::vector<unsigned int> indexes;
+  std::vector<std::string>  values;
+  char                     *value;
+
+  version = disrui(chan, &rc);
+  if (rc != DIS_SUCCESS)
+    return(rc);
+
+  if (version != IS_STATUS_DELTA_VER)
+    return(DIS_PROTO);
+
+  base_gen = disrul(chan, &rc);
+  if (rc == DIS_SUCCESS)
+    gen = disrul(chan, &rc);
+  if (rc == DIS_SUCCESS)
+    count = disrui(chan, &rc);
+  if (rc == DIS_SUCCESS)
+    nchanged = disrui(chan, &rc);
+  if (rc != DIS_SUCCESS)
+    return(rc);
+
+  if (nchanged > count)
+    return(DIS_PROTO);
+
+  for (unsigned int i = 0; i < nchanged; i++)
+    {
+    indexes.push_back(disrui(chan, &rc));
+    if (rc != DIS_SUCCESS)
+      return(rc);
+
+    if ((value = disrst(chan, &rc)) == NULL)
+      return((rc == DIS_SUCCESS) ? DIS_NOMALLOC : rc);
+
+    values.push_back(value);
+    free(value);
+
+    if (rc != DIS_SUCCESS)
+      return(rc);
+    }
+
+  pthread_mutex_lock(&received_statuses_mutex);
+
+  std::map<std::string, received_status_base>::iterator it = received_statuses.find(node_name);
+
+  if (base_gen != 0)
+    {
+    if ((it == received_statuses.end()) ||
+        (it->second.generation != base_gen))
+      {
+      // we restarted or missed an update, the mom must start over
+      pthread_mutex_unlock(&received_statuses_mutex);
+      return(IS_STATUS_BASE_UNKNOWN);
+      }
+    }
+  else
+    {
+    it = received_statuses.insert(
+           std::pair<std::string, received_status_base>(node_name, received_status_base())).first;
+    it->second.status.clear();
+    }
+
+  if (apply_status_delta(it->second.status, count, indexes, values, changed) != PBSE_NONE)
+    {
+    received_statuses.erase(it);
+    pthread_mutex_unlock(&received_statuses_mutex);
+    return(DIS_PROTO);
+    }
+
+  it->second.generation = gen;
+  status = it->second.status;
+
+  pthread_mutex_unlock(&received_statuses_mutex);
+
+  return(DIS_SUCCESS);
+  } /* END read_status_delta() */
+
+
+
+/*
+ * forget_received_status()
+ *
+ * Drops the status kept for a deleted node's deltas
+ */
+
+void forget_received_status(
+
+  const char *node_name)
+
+  {
+  pthread_mutex_lock(&received_statuses_mutex);
+  received_statuses.erase(node_name);
+  pthread_mutex_unlock(&received_statuses_mutex);
+  } /* END forget_received_status() */
+
+
+
+/*
+ * record_fanin_latency()
+ *
+ * @param level - the node's level in the mom hierarchy
+ * @param age - seconds its status waited at the forwarding mom
+ */
+
+void record_fanin_latency(
+
+  unsigned int  level,
+  unsigned long age)
+
+  {
+  pthread_mutex_lock(&fanin_stats_mutex);
+
+  if (level >= fanin_stats.size())
+    fanin_stats.resize(level + 1);
+
+  fanin_stats[level].statuses++;
+  fanin_stats[level].total_age += age;
+
+  if (age > fanin_stats[level].max_age)
+    fanin_stats[level].max_age = age;
+
+  pthread_mutex_unlock(&fanin_stats_mutex);
+  } /* END record_fanin_latency() */
+
+
+
+/*
+ * log_hierarchy_fanin_stats()
+ *
+ * Logs the status batches received since the last call and how long the
+ * statuses in them waited at each level of the hierarchy, then starts over.
+ */
+
+void log_hierarchy_fanin_stats()
+
+  {
+  std::vector<fanin_level_stats> stats;
+  unsigned long                  batches;
+  char                           log_buf[LOCAL_LOG_BUF_SIZE];
+
+  pthread_mutex_lock(&fanin_stats_mutex);
+  stats.swap(fanin_stats);
+  batches = fanin_batches;
+  fanin_batches = 0;
+  pthread_mutex_unlock(&fanin_stats_mutex);
+
+  if (batches == 0)
+    return;
+
+  snprintf(log_buf, sizeof(log_buf), "%lu status batches received", batches);
+  log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+
+  for (unsigned int i = 0; i < stats.size(); i++)
+    {
+    if (stats[i].statuses == 0)
+      continue;
+
+    snprintf(log_buf, sizeof(log_buf),
+      "hierarchy level %u: %lu statuses, average wait %lu seconds, max wait %lu seconds",
+      i, stats[i].statuses, stats[i].total_age / stats[i].statuses, stats[i].max_age);
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+    }
+  } /* END log_hierarchy_fanin_stats() */
+
+
+
+/*
+ * process_status_batch()
+ *
+ * Applies each status in a batch forwarded by reporter, one node lookup
+ * per entry.
+ *
+ * @return the number of entries applied
+ */
+
+int process_status_batch(
+
+  const char                      *reporter,
+  std::vector<status_batch_entry> &entries)
+
+  {
+  int      processed = 0;
+  pbsnode *pnode;
+
+  pthread_mutex_lock(&fanin_stats_mutex);
+  fanin_batches++;
+  pthread_mutex_unlock(&fanin_stats_mutex);
+
+  for (unsigned int i = 0; i < entries.size(); i++)
+    {
+    std::string node_name(entries[i].statuses[0].c_str() + strlen("node="));
+
+    if ((pnode = find_nodebyname(node_name.c_str())) == NULL)
+      {
+      if (LOGLEVEL >= 3)
+        {
+        char log_buf[LOCAL_LOG_BUF_SIZE];
+
+        snprintf(log_buf, sizeof(log_buf),
+          "%s forwarded a status for unknown node %s", reporter, node_name.c_str());
+        log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE, __func__, log_buf);
+        }
+
+      continue;
+      }
+
+    record_fanin_latency(pnode->nd_hierarchy_level, entries[i].age);
+
+    if (process_node_status(pnode, reporter, entries[i].statuses, NULL) == SEND_HELLO)
+      {
+      /* the mom that asked for the hierarchy is the one the status is for */
+      if ((pnode = find_nodebyname(node_name.c_str())) != NULL)
+        {
+        hierarchy_handler.sendHierarchyToANode(pnode);
+        pnode->unlock_node(__func__, NULL, LOGLEVEL);
+        }
+      }
+
+    processed++;
+    }
+
+  return(processed);
+  } /* END process_status_batch() */
+
+
+
+void *process_status_batch_work(
+
+  void *vp)
+
+  {
+  status_batch_work *work = (status_batch_work *)vp;
+
+  process_status_batch(work->reporter.c_str(), work->entries);
+
+  delete work;
+
+  return(NULL);
+  } /* END process_status_batch_work() */
+
+
+
+/*
+ * read_forwarded_statuses()
+ *
+ * Reads the status batch and trailing strings that follow an IS_STATUS_DELTA
+ * body. The batch is processed on a task_pool thread, on the high lane with the
+ * rest of the node status work, so that this connection is answered without
+ * waiting for every node in it to be updated.
+ */
+
+int read_forwarded_statuses(
+
+  const char               *node_name,
+  struct tcp_chan          *chan,
+  std::vector<std::string> &status_info)
+
+  {
+  status_batch_work *work = new status_batch_work();
+  int                rc;
+
+  if ((rc = read_status_batch(chan, work->entries)) != DIS_SUCCESS)
+    {
+    delete work;
+    return(rc);
+    }
+
+  get_status_info(chan, status_info);
+
+  if (work->entries.size() == 0)
+    {
+    delete work;
+    return(DIS_SUCCESS);
+    }
+
+  work->reporter = node_name;
+
+  if (enqueue_threadpool_request_lane(process_status_batch_work, work, task_pool, TP_LANE_HIGH) != PBSE_NONE)
+    process_status_batch_work(work);
+
+  return(DIS_SUCCESS);
+  } /* END read_forwarded_statuses() */
+
+
+
+/*
+ * is_stat_delta_get()
+ *
+ * Handles IS_STATUS_DELTA. The statuses the mom is forwarding for other
+ * nodes follow the delta as one compressed batch.
+ */
+
+int is_stat_delta_get(
+
+  const char      *node_name,
+  struct tcp_chan *chan)
+
+  {
+  int                      rc;
+  char                     log_buf[LOCAL_LOG_BUF_SIZE];
+  std::vector<std::string> status_info;
+  std::vector<bool>        changed;
+
+  if (LOGLEVEL >= 3)
+    {
+    sprintf(log_buf, "received status delta from node %s", node_name);
+    log_record(PBSEVENT_SCHED, PBS_EVENTCLASS_REQUEST, __func__, log_buf);
+    }
+
+  rc = read_status_delta(node_name, chan, status_info, changed);
+
+  if (rc == IS_STATUS_BASE_UNKNOWN)
+    {
+    // still take the statuses this mom is forwarding, it won't send them again
+    status_info.clear();
+
+    if ((rc = read_forwarded_statuses(node_name, chan, status_info)) != DIS_SUCCESS)
+      return(rc);
+
+    if (status_info.size() > 0)
+      process_status_info(node_name, status_info, NULL);
+
+    return(IS_STATUS_BASE_UNKNOWN);
+    }
+  else if (rc != DIS_SUCCESS)
+    return(rc);
+
+  if ((rc = read_forwarded_statuses(node_name, chan, status_info)) != DIS_SUCCESS)
+    return(rc);
+
+  changed.resize(status_info.size(), true);
+
+  rc = process_status_info(node_name, status_info, &changed);
+
+  return(rc);
+  }  /* END is_stat_delta_get() */
+
+
+
 /*
  * Function to check if there is a job assigned to this gpu
  */
@@ -272,6 +684,7 @@ const char *PBSServerCmds2[] =
   "UPDATE",
   "STATUS",
   "GPU_STATUS",
+  "STATUS_DELTA",
   NULL
   };
 
@@ -495,6 +908,7 @@ void *svr_is_request(
       break;
 
     case IS_STATUS:
+    case IS_STATUS_DELTA:
 
       {
       std::string node_name = node->get_name();
@@ -502,14 +916,17 @@ void *svr_is_request(
       if (LOGLEVEL >= 2)
         {
         snprintf(log_buf, LOCAL_LOG_BUF_SIZE,
-            "IS_STATUS received from %s", node->get_name());
+            "%s received from %s", PBSServerCmds2[command], node->get_name());
 
         log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, __func__, log_buf);
         }
 
       node_mutex.unlock();
 
-      ret = is_stat_get(node_name.c_str(), chan);
+      if (command == IS_STATUS_DELTA)
+        ret = is_stat_delta_get(node_name.c_str(), chan);
+      else
+        ret = is_stat_get(node_name.c_str(), chan);
 
       node = find_nodebyname(node_name.c_str());
 
@@ -521,13 +938,19 @@ void *svr_is_request(
         if (ret == SEND_HELLO)
           {
           //struct hello_info *hi = new hello_info(node->nd_id);
-          write_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER, IS_STATUS, DIS_SUCCESS);
+          write_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER, command, DIS_SUCCESS);
 
           hierarchy_handler.sendHierarchyToANode(node);
           ret = DIS_SUCCESS;
           }
         else
-          write_tcp_reply(chan,IS_PROTOCOL,IS_PROTOCOL_VER,IS_STATUS,ret);
+          write_tcp_reply(chan,IS_PROTOCOL,IS_PROTOCOL_VER,command,ret);
+        }
+
+      if (ret == IS_STATUS_BASE_UNKNOWN)
+        {
+        // the reply asks the mom for a full status, nothing is wrong
+        ret = DIS_SUCCESS;
         }
 
       if (ret != DIS_SUCCESS)
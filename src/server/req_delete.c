@@ -1157,6 +1157,30 @@ int handle_single_delete(
   {
   char *jobid = preq->rq_ind.rq_delete.rq_objname;
   job  *pjob = svr_find_job(jobid, FALSE);
+  int   rc;
+
+  if (pjob == NULL)
+    {
+    /* array subjobs that haven't been created yet are dropped from the array instead */
+    rc = delete_uncreated_subjob(jobid, preq);
+
+    if (rc == PBSE_NONE)
+      {
+      /* nothing is left to do asynchronously */
+      if (preq_tmp != NULL)
+        free_br(preq_tmp);
+
+      reply_ack(preq);
+
+      return(PBSE_NONE);
+      }
+    else if (rc == PBSE_PERM)
+      {
+      req_reject(PBSE_PERM, 0, preq, NULL, "operation not permitted");
+
+      return(PBSE_NONE);
+      }
+    }
 
   if (pjob == NULL)
     {
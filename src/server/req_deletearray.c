@@ -213,7 +213,14 @@ int req_deletearray(
     /* parse the array range */
     num_skipped = delete_array_range(pa, range, purge);
 
-    if (num_skipped < 0)
+    /* NO_JOBS_IN_ARRAY means the array's last subjobs were never created and have been
+     * dropped, so no subjob purge will remove the array later; that holds for -p too */
+    if (num_skipped == NO_JOBS_IN_ARRAY)
+      {
+      pa_mutex.unlock();
+      array_delete(preq->rq_ind.rq_delete.rq_objname);
+      }
+    else if (num_skipped < 0)
       {
       /* ERROR */
       req_reject(PBSE_IVALREQ,0,preq,NULL,"Error in specified array range");
@@ -232,19 +239,17 @@ int req_deletearray(
       log_record(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, __func__, log_buf);
       }
 
-    if (((num_skipped = delete_whole_array(pa, purge)) == NO_JOBS_IN_ARRAY) &&
-        (purge == false))
+    /* as above, an array with no created subjobs is deleted here, purged or not */
+    if ((num_skipped = delete_whole_array(pa, purge)) == NO_JOBS_IN_ARRAY)
       {
       pa_mutex.unlock();
       array_delete(preq->rq_ind.rq_delete.rq_objname);
       }
     }
 
-  // If purge is true, the array is gone at this point in time, mark the mutex manager 
-  // unlocked
-  if (purge == true)
-    pa_mutex.set_lock_state(false);
-  else if (num_skipped != NO_JOBS_IN_ARRAY)
+  // The created subjobs are deleted asynchronously, so the array is still here unless it
+  // had no subjobs left
+  if (num_skipped != NO_JOBS_IN_ARRAY)
     {
     pa_mutex.unlock();
     
@@ -166,6 +166,12 @@ int req_holdarray(
         hold_job(&temphold, pjob);
         }
       }
+
+    if (pa->uncreated_ids.size() > 0)
+      {
+      pa->hold_uncreated_range(0, pa->ai_qs.array_size - 1, temphold.at_val.at_long);
+      array_save(pa);
+      }
     }
 
   reply_ack(preq);
@@ -127,6 +127,7 @@ int get_hold(tlist_head *, const char **, pbs_attribute *);
 
 /* external functions */
 extern int svr_authorize_jobreq(struct batch_request *,job *);
+extern int svr_authorize_req(struct batch_request *preq, char *owner, char *submit_host);
 extern job *chk_job_request(char *,struct batch_request *);
 
 /*
@@ -256,6 +257,10 @@ int req_holdjob(
       if (pjob != NULL)
         {
         pjob->ji_qs.ji_svrflags |= JOB_SVFLG_HASRUN | JOB_SVFLG_CHECKPOINT_FILE;
+
+        /* the journal only keeps the state, the new hold needs the job file */
+        if (old_hold != *hold_val)
+          pjob->ji_modified = 1;
         
         job_save(pjob, SAVEJOB_QUICK, 0);
         
@@ -550,6 +555,9 @@ int release_whole_array(
       }
     }
 
+  if ((rc = release_uncreated_holds(pa, preq, 0, pa->ai_qs.array_size - 1)) != PBSE_NONE)
+    return(rc);
+
   /* SUCCESS */
   return(PBSE_NONE);
   } /* END release_whole_array */
@@ -581,7 +589,8 @@ int req_releasearray(
     if (((index = first_job_index(pa)) == -1) ||
         (pa->job_ids[index] == NULL))
       {
-      return(PBSE_NONE);
+      pjob = NULL;
+      break;
       }
 
     if ((pjob = svr_find_job(pa->job_ids[index], FALSE)) == NULL)
@@ -593,15 +602,29 @@ int req_releasearray(
       break;
     }
 
-  mutex_mgr pjob_mutex = mutex_mgr(pjob->ji_mutex, true);
-
-  if (svr_authorize_jobreq(preq, pjob) == -1)
+  if (pjob != NULL)
     {
-    req_reject(PBSE_PERM,0,preq,NULL,NULL);
-    return(PBSE_NONE);
+    mutex_mgr pjob_mutex = mutex_mgr(pjob->ji_mutex, true);
+
+    if (svr_authorize_jobreq(preq, pjob) == -1)
+      {
+      req_reject(PBSE_PERM,0,preq,NULL,NULL);
+      return(PBSE_NONE);
+      }
     }
+  else
+    {
+    /* no subjob has been created yet, authorize against the array's owner */
+    char owner[PBS_MAXUSER + 1];
+
+    get_jobowner(pa->ai_qs.owner, owner);
 
-  pjob_mutex.unlock();
+    if (svr_authorize_req(preq, owner, pa->ai_qs.submit_host) == -1)
+      {
+      req_reject(PBSE_PERM,0,preq,NULL,NULL);
+      return(PBSE_NONE);
+      }
+    }
 
   range = preq->rq_extend;
   if ((range != NULL) &&
@@ -127,6 +127,7 @@
 #include "../lib/Liblog/log_event.h"
 #include "svrfunc.h"
 #include "pbs_job.h"
+#include "acct.h" /* ACCT_FORMAT_TEXT, ACCT_FORMAT_JSON */
 #include "pbs_nodes.h"
 #include "work_task.h"
 #include "mcom.h"
@@ -988,6 +989,8 @@ int mgr_set_node_attr(
 
   update_subnode(pnode);
 
+  update_free_node_index(pnode);
+
   return(rc);
   }  /* END mgr_set_node_attr() */
 
@@ -2754,6 +2757,36 @@ int check_default_gpu_mode_str(
 
 
 
+
+/*
+ * check_accounting_format_str()
+ *
+ * Makes sure accounting_format is one of the record formats accounting.c writes
+ * @return PBSE_NONE on success or PBSE_ATTRTYPE if a bad value
+ */
+
+int check_accounting_format_str(
+
+  pbs_attribute *pattr,
+  void          *pobj,
+  int            actmode)
+
+  {
+  char *format = pattr->at_val.at_str;
+
+  if (actmode != ATR_ACTION_ALTER)
+    return(PBSE_NONE);
+
+  if ((format == NULL) ||
+      ((strcmp(format, ACCT_FORMAT_TEXT)) &&
+       (strcmp(format, ACCT_FORMAT_JSON))))
+    return(PBSE_ATTRTYPE);
+
+  return(PBSE_NONE);
+  } // END check_accounting_format_str()
+
+
+
 /*
  * free_extraresc() makes sure that the init_resc_defs() is called after
  * the list has changed by 'unset'.
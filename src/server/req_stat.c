@@ -252,12 +252,19 @@ int req_stat_job(
       {
       type = tjstJob;
 
-      if ((pjob = svr_find_job(name, FALSE)) == NULL)
+      if ((pjob = svr_find_job(name, FALSE)) != NULL)
+        unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
+      else
         {
-        rc = PBSE_UNKJOBID;
+        /* array subjobs that haven't been created yet are statused from their array */
+        int        index;
+        job_array *pa = get_uncreated_subjob_array(name, index);
+
+        if (pa == NULL)
+          rc = PBSE_UNKJOBID;
+        else
+          unlock_ai_mutex(pa, __func__, "1", LOGLEVEL);
         }
-      else
-        unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
       }
     }
   else if (isalpha(name[0]))
@@ -565,6 +572,70 @@ bool in_execution_queue(
 
 
 
+/*
+ * status_uncreated_subjob()
+ *
+ * Statuses an array subjob that hasn't been created yet. Nothing is created; the status
+ * comes from the array's template job, reported under the subjob's id and in the state
+ * the subjob will be queued in.
+ *
+ * @param job_id - the id of the subjob
+ * @param pstathd - RETURN: head of list to append status to
+ * @return PBSE_NONE on success, PBSE_UNKJOBID if job_id isn't an uncreated subjob, or the
+ * error from status_job()
+ */
+
+int status_uncreated_subjob(
+
+  const char    *job_id,
+  batch_request *preq,
+  svrattrl      *pal,
+  tlist_head    *pstathd,
+  bool           condensed,
+  int           *bad)
+
+  {
+  int                index;
+  int                rc;
+  long               holds;
+  job_array         *pa;
+  job               *template_job;
+  struct brp_status *pstat;
+  svrattrl          *pattr;
+
+  if ((pa = get_uncreated_subjob_array(job_id, index)) == NULL)
+    return(PBSE_UNKJOBID);
+
+  std::string template_id(pa->ai_qs.parent_id);
+  holds = pa->get_uncreated_holds(index);
+
+  unlock_ai_mutex(pa, __func__, NULL, LOGLEVEL);
+
+  if ((template_job = svr_find_job(template_id.c_str(), FALSE)) == NULL)
+    return(PBSE_UNKJOBID);
+
+  mutex_mgr template_mgr(template_job->ji_mutex, true);
+
+  if ((rc = status_job(template_job, preq, pal, pstathd, condensed, bad)) != PBSE_NONE)
+    return(rc);
+
+  pstat = (struct brp_status *)GET_PRIOR(*pstathd);
+  snprintf(pstat->brp_objname, sizeof(pstat->brp_objname), "%s", job_id);
+
+  for (pattr = (svrattrl *)GET_NEXT(pstat->brp_attr);
+       pattr != NULL;
+       pattr = (svrattrl *)GET_NEXT(pattr->al_link))
+    {
+    if ((!strcmp(pattr->al_name, ATTR_state)) &&
+        (pattr->al_valln > 1))
+      pattr->al_value[0] = (holds != 0) ? 'H' : 'Q';
+    }
+
+  return(PBSE_NONE);
+  } // END status_uncreated_subjob()
+
+
+
 /*
  * req_stat_job_step2 - continue with statusing of jobs
  *
@@ -630,10 +701,19 @@ void req_stat_job_step2(
 
       unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
       }
-    else
+    else if ((rc = status_uncreated_subjob(preq->rq_ind.rq_status.rq_id, preq, pal,
+                   &preply->brp_un.brp_status, cntl->sc_condensed, &bad)) == PBSE_NONE)
+      {
+      reply_send_svr(preq);
+      }
+    else if (rc == PBSE_UNKJOBID)
       {
       req_reject(PBSE_JOBNOTFOUND, bad, preq, NULL, NULL);
       }
+    else
+      {
+      req_reject(rc, bad, preq, NULL, NULL);
+      }
     }
   else
     {
@@ -805,7 +885,7 @@ int stat_to_mom(
 
   /* get connection to MOM */
   node->unlock_node(__func__, "before svr_connect", LOGLEVEL);
-  handle = svr_connect(job_momaddr, job_momport, &rc, NULL, NULL);
+  handle = svr_connect_pooled(job_momaddr, job_momport, &rc, NULL);
 
   if (handle >= 0)
     {
@@ -11,6 +11,8 @@
 
 int req_stat_job(struct batch_request *preq);
 
+int status_uncreated_subjob(const char *job_id, struct batch_request *preq, svrattrl *pal, tlist_head *pstathd, bool condensed, int *bad);
+
 int stat_to_mom(const char *job_id, struct stat_cntl *cntl);
 
 void stat_mom_job(const char *jobid);
@@ -787,6 +787,7 @@ int init_resc_defs(void)
   int                   rindex = 0;
   int                   dindex = 0;
   int                   unkindex = 0;
+  resource_def         *previous = svr_resc_def;
 #ifndef PBS_MOM
 
   resource_def         *tmpresc = NULL;
@@ -872,6 +873,9 @@ int init_resc_defs(void)
 
   svr_resc_size = rindex + 1;
 
+  /* the index for the array this replaces is replaced with it */
+  index_resc_defs(svr_resc_def, svr_resc_size, previous);
+
   return(PBSE_NONE);
   } /* END init_resc_defs() */
 
@@ -86,6 +86,9 @@
  * Included funtions are:
  * status_job()
  * status_attrib()
+ * find_status_cache()
+ * save_status_cache()
+ * copy_status_cache()
  */
 #include <stdlib.h>
 #include "libpbs.h"
@@ -116,6 +119,158 @@ extern attribute_def job_attr_def[];
 
 extern struct server server;
 
+#define WALLTIME_REMAINING_NAME "Walltime"
+#define WALLTIME_REMAINING_RESC "Remaining"
+
+int add_walltime_remaining(int, pbs_attribute *, tlist_head *);
+
+
+
+/*
+ * find_status_cache()
+ *
+ * Full job statuses (no attribute list) are cached with the job. A cached
+ * encoding is used until the job's attributes change, which clears the
+ * cache, or until it is JOB_STATUS_CACHE_TTL seconds old, which bounds
+ * how stale it can get if some attribute is written without invalidating.
+ *
+ * @return the cached encoding for this kind of request or NULL
+ */
+
+job_status_cache *find_status_cache(
+
+  job    *pjob,
+  int     priv,
+  int     owner,
+  bool    condensed,
+  time_t  time_now)
+
+  {
+  for (unsigned int i = 0; i < pjob->ji_status_cache.size(); i++)
+    {
+    job_status_cache &jsc = pjob->ji_status_cache[i];
+
+    if ((jsc.jsc_priv == priv) &&
+        (jsc.jsc_owner == owner) &&
+        (jsc.jsc_condensed == condensed))
+      {
+      if (time_now - jsc.jsc_built >= JOB_STATUS_CACHE_TTL)
+        {
+        pjob->ji_status_cache.erase(pjob->ji_status_cache.begin() + i);
+        return(NULL);
+        }
+
+      return(&jsc);
+      }
+    }
+
+  return(NULL);
+  } /* END find_status_cache() */
+
+
+
+/*
+ * save_status_cache()
+ *
+ * Stores the svrattrl blocks in phead with the job. Walltime remaining
+ * depends on the time of the request, so only its position is stored.
+ * Nothing is cached if some block wasn't laid out by attrlist_alloc().
+ */
+
+void save_status_cache(
+
+  job        *pjob,
+  tlist_head *phead,
+  int         priv,
+  int         owner,
+  bool        condensed,
+  time_t      time_now)
+
+  {
+  job_status_cache  jsc;
+  svrattrl         *pal;
+
+  jsc.jsc_priv = priv;
+  jsc.jsc_owner = owner;
+  jsc.jsc_condensed = condensed;
+  jsc.jsc_built = time_now;
+
+  for (pal = (svrattrl *)GET_NEXT(*phead);
+       pal != NULL;
+       pal = (svrattrl *)GET_NEXT(pal->al_link))
+    {
+    int size = pal->al_tsize;
+
+    if ((pal->al_name != (char *)pal + sizeof(svrattrl)) ||
+        (size != (int)sizeof(svrattrl) + pal->al_nameln + pal->al_rescln + pal->al_valln))
+      return;
+
+    if ((pal->al_resc != NULL) &&
+        (!strcmp(pal->al_name, WALLTIME_REMAINING_NAME)) &&
+        (!strcmp(pal->al_resc, WALLTIME_REMAINING_RESC)))
+      size = 0;
+
+    jsc.jsc_blob.insert(jsc.jsc_blob.end(), (char *)&size, (char *)&size + sizeof(size));
+    jsc.jsc_blob.insert(jsc.jsc_blob.end(), (char *)pal, (char *)pal + size);
+    }
+
+  if (pjob->ji_status_cache.size() >= JOB_STATUS_CACHE_VARIANTS)
+    pjob->ji_status_cache.erase(pjob->ji_status_cache.begin());
+
+  pjob->ji_status_cache.push_back(jsc);
+  } /* END save_status_cache() */
+
+
+
+/*
+ * copy_status_cache()
+ *
+ * Appends a copy of each cached svrattrl block to phead
+ *
+ * @return PBSE_NONE or PBSE_SYSTEM if memory ran out
+ */
+
+int copy_status_cache(
+
+  job              *pjob,
+  job_status_cache *jsc,
+  tlist_head       *phead)
+
+  {
+  size_t offset = 0;
+
+  while (offset < jsc->jsc_blob.size())
+    {
+    int       size;
+    svrattrl *pal;
+
+    memcpy(&size, &jsc->jsc_blob[offset], sizeof(size));
+    offset += sizeof(size);
+
+    if (size == 0)
+      {
+      add_walltime_remaining(JOB_ATR_start_time, pjob->ji_wattr, phead);
+      continue;
+      }
+
+    if ((pal = (svrattrl *)malloc(size)) == NULL)
+      return(PBSE_SYSTEM);
+
+    memcpy(pal, &jsc->jsc_blob[offset], size);
+    offset += size;
+
+    CLEAR_LINK(pal->al_link);
+    pal->al_atopl.next = NULL;
+    pal->al_name = (char *)pal + sizeof(svrattrl);
+    pal->al_resc = (pal->al_rescln > 0) ? pal->al_name + pal->al_nameln : NULL;
+    pal->al_value = pal->al_name + pal->al_nameln + pal->al_rescln;
+
+    append_link(phead, &pal->al_link, pal);
+    }
+
+  return(PBSE_NONE);
+  } /* END copy_status_cache() */
+
 
 
 
@@ -141,6 +296,9 @@ int status_job(
   int                IsOwner = 0;
   bool               query_others = false;
   long               condensed_timeout = JOB_CONDENSED_TIMEOUT;
+  job_status_cache  *jsc = NULL;
+  time_t             time_now = time(NULL);
+  int                priv = preq->rq_perm & ATR_DFLAG_RDACC;
 
   /* Make sure procct is removed from the job 
      resource attributes */
@@ -163,7 +321,7 @@ int status_job(
 
   // if the job has been modified within the timeout, send the full output
   if ((condensed == true) &&
-      (time(NULL) < pjob->ji_mod_time + condensed_timeout))
+      (time_now < pjob->ji_mod_time + condensed_timeout))
     condensed = false;
 
   /* allocate reply structure and fill in header portion */
@@ -185,7 +343,14 @@ int status_job(
   /* add attributes to the status reply */
   *bad = 0;
 
-  if (status_attrib(
+  if (pal == NULL)
+    jsc = find_status_cache(pjob, priv, IsOwner, condensed, time_now);
+
+  if (jsc != NULL)
+    {
+    return(copy_status_cache(pjob, jsc, &pstat->brp_attr));
+    }
+  else if (status_attrib(
         pal,
         job_attr_def,
         pjob->ji_wattr,
@@ -203,6 +368,9 @@ int status_job(
     pjob->encode_plugin_resource_usage(&pstat->brp_attr);
     }
 
+  if (pal == NULL)
+    save_status_cache(pjob, &pstat->brp_attr, priv, IsOwner, condensed, time_now);
+
   return (PBSE_NONE);
   }  /* END status_job() */
 
@@ -242,7 +410,7 @@ int add_walltime_remaining(
       snprintf(buf,MAXPATHLEN,"%ld",remaining);
       
       len = strlen(buf);
-      pal = attrlist_create("Walltime","Remaining",len+1);
+      pal = attrlist_create(WALLTIME_REMAINING_NAME, WALLTIME_REMAINING_RESC, len+1);
       
       if (pal != NULL)
         {
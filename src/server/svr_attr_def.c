@@ -120,6 +120,7 @@ int         update_user_acls(pbs_attribute *pattr, void *pobject, int actmode);
 int         update_group_acls(pbs_attribute *pattr, void *pobject, int actmode);
 int         node_exception_check(pbs_attribute *pattr, void *pobject, int actmode);
 int         check_default_gpu_mode_str(pbs_attribute *pattr, void *pobject, int actmode);
+int         check_accounting_format_str(pbs_attribute *pattr, void *pobject, int actmode);
 extern int  keep_completed_val_check(pbs_attribute *pattr,void *pobj,int actmode);
 /* DIAGTODO: write diag_attr_def.c */
 
@@ -1651,4 +1652,30 @@ attribute_def svr_attr_def[] =
    PARENT_TYPE_SERVER
   },
 
+  // SRV_ATR_AcctFormat
+  {(char *)ATTR_accounting_format, // "accounting_format"
+   decode_str,
+   encode_str,
+   set_str,
+   comp_str,
+   free_null,
+   check_accounting_format_str,
+   MGR_ONLY_SET,
+   ATR_TYPE_STR,
+   PARENT_TYPE_SERVER
+  },
+
+  // SRV_ATR_AcctFsync
+  {(char *)ATTR_accounting_fsync, // "accounting_fsync"
+   decode_b,
+   encode_b,
+   set_b,
+   comp_b,
+   free_null,
+   NULL_FUNC,
+   MGR_ONLY_SET,
+   ATR_TYPE_BOOL,
+   PARENT_TYPE_SERVER
+  },
+
   };
@@ -101,6 +101,7 @@
 #include "net_cache.h"
 #include "../lib/Libnet/lib_net.h"
 #include "ji_mutex.h"
+#include "array.h"
 
 /* Global Data */
 
@@ -650,8 +651,30 @@ job *chk_job_request(
 
   {
   job *pjob = NULL;
+  int  rc;
 
+  /* array subjobs that haven't been created yet are created when named individually */
   if ((pjob = svr_find_job(jobid, FALSE)) == NULL)
+    {
+    rc = materialize_array_subjob(jobid, preq);
+
+    if (rc == PBSE_NONE)
+      pjob = svr_find_job(jobid, FALSE);
+    else if (rc == PBSE_PERM)
+      {
+      req_reject(PBSE_PERM, 0, preq, NULL, "operation not permitted");
+
+      return(NULL);
+      }
+    else if (rc == PBSE_BADSTATE)
+      {
+      req_reject(PBSE_BADSTATE, 0, preq, NULL, "array subjob has not been created yet");
+
+      return(NULL);
+      }
+    }
+
+  if (pjob == NULL)
     {
     log_event(
       PBSEVENT_DEBUG,
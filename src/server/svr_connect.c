@@ -106,6 +106,8 @@
 #include <stdio.h>
 #include <signal.h>
 #include <unistd.h>
+#include <poll.h>
+#include <vector>
 #include "libpbs.h"
 #include "log.h"
 #include "../lib/Liblog/pbs_log.h"
@@ -119,6 +121,7 @@
 #include "node_func.h" /* addr_ok */
 #include "tcp.h" /* tcp_chan */
 #include "../lib/Libutils/u_lock_ctl.h"
+#include "mom_connection_pool.hpp"
 
 
 /* global data */
@@ -133,6 +136,9 @@ extern int               LOGLEVEL;
 extern ssize_t read_blocking_socket(int, void *, ssize_t);
 extern int get_num_connections();
 
+/* idle, already authenticated connections to moms that can be re-used */
+mom_connection_pool mom_connections(PBS_MOM_POOL_MAX_PER_NODE, PBS_MOM_POOL_IDLE_TIME);
+
 
 
 /*
@@ -435,6 +441,231 @@ void svr_disconnect(
 
 
 
+/*
+ * drop_connection - close a connection made with svr_connect() without
+ * the disconnect handshake, for connections that are known to be dead.
+ */
+
+static void drop_connection(
+
+  int handle)  /* I */
+
+  {
+  if ((handle < 0) || (handle >= PBS_LOCAL_CONNECTION))
+    return;
+
+  pthread_mutex_lock(connection[handle].ch_mutex);
+
+  close_conn(connection[handle].ch_socket, FALSE);
+
+  if (connection[handle].ch_errtxt != NULL)
+    {
+    free(connection[handle].ch_errtxt);
+    connection[handle].ch_errtxt = NULL;
+    }
+
+  connection[handle].ch_errno = 0;
+  connection[handle].ch_inuse = FALSE;
+
+  pthread_mutex_unlock(connection[handle].ch_mutex);
+  }  /* END drop_connection() */
+
+
+
+/*
+ * pooled_connection_is_usable - health check for a handle taken from
+ * mom_connections. Nothing should arrive on an idle connection, so a
+ * socket that polls readable has either been closed by the mom or has
+ * stray data on it and can't be re-used.
+ */
+
+bool pooled_connection_is_usable(
+
+  int handle)  /* I */
+
+  {
+  int           sock;
+  bool          in_use;
+  enum conn_type active;
+  struct pollfd pfd;
+
+  if ((handle < 0) || (handle >= PBS_LOCAL_CONNECTION))
+    return(false);
+
+  pthread_mutex_lock(connection[handle].ch_mutex);
+  sock = connection[handle].ch_socket;
+  in_use = connection[handle].ch_inuse;
+  pthread_mutex_unlock(connection[handle].ch_mutex);
+
+  if ((in_use == false) ||
+      (sock < 0) ||
+      (sock >= PBS_NET_MAX_CONNECTIONS))
+    return(false);
+
+  pthread_mutex_lock(svr_conn[sock].cn_mutex);
+  active = svr_conn[sock].cn_active;
+  pthread_mutex_unlock(svr_conn[sock].cn_mutex);
+
+  if (active == Idle)
+    return(false);
+
+  pfd.fd = sock;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  /* readable, hung up or in error */
+  if (poll(&pfd, 1, 0) != 0)
+    return(false);
+
+  return(true);
+  }  /* END pooled_connection_is_usable() */
+
+
+
+/*
+ * svr_connect_pooled - like svr_connect(), but re-uses an idle connection
+ * to the mom from mom_connections when there is a healthy one.
+ *
+ * The handle should be given back with svr_release_connection().
+ */
+
+int svr_connect_pooled(
+
+  pbs_net_t        hostaddr,  /* host order */
+  unsigned int     port,      /* I */
+  int             *my_err,    /* O */
+  struct pbsnode  *pnode)     /* I (optional) */
+
+  {
+  int  handle;
+  int  sock;
+  char log_buf[LOCAL_LOG_BUF_SIZE];
+
+  while ((handle = mom_connections.checkout(hostaddr, port)) >= 0)
+    {
+    if (pooled_connection_is_usable(handle) == true)
+      {
+      /* back in the read set, as svr_connect() would have left it */
+      pthread_mutex_lock(connection[handle].ch_mutex);
+      sock = connection[handle].ch_socket;
+      pthread_mutex_unlock(connection[handle].ch_mutex);
+
+      globalset_add_sock(sock, hostaddr, port);
+
+      if (LOGLEVEL >= 7)
+        {
+        snprintf(log_buf, sizeof(log_buf), "re-using pooled connection handle %d to port %d",
+          handle,
+          port);
+
+        log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+        }
+
+      return(handle);
+      }
+
+    drop_connection(handle);
+    }
+
+  return(svr_connect(hostaddr, port, my_err, pnode, NULL));
+  }  /* END svr_connect_pooled() */
+
+
+
+/*
+ * svr_release_connection - done with a handle from svr_connect_pooled().
+ *
+ * If reusable is true and the mom's pool has room the connection stays open
+ * for the next request, otherwise it is closed with svr_disconnect().
+ */
+
+void svr_release_connection(
+
+  int  handle,    /* I */
+  bool reusable)  /* I */
+
+  {
+  int       sock;
+  pbs_net_t addr;
+  unsigned  port;
+
+  if ((reusable == true) &&
+      (handle >= 0) &&
+      (handle < PBS_LOCAL_CONNECTION))
+    {
+    pthread_mutex_lock(connection[handle].ch_mutex);
+    sock = connection[handle].ch_socket;
+    pthread_mutex_unlock(connection[handle].ch_mutex);
+
+    if ((sock >= 0) &&
+        (sock < PBS_NET_MAX_CONNECTIONS))
+      {
+      pthread_mutex_lock(svr_conn[sock].cn_mutex);
+      addr = svr_conn[sock].cn_addr;
+      port = svr_conn[sock].cn_port;
+      pthread_mutex_unlock(svr_conn[sock].cn_mutex);
+
+      /* only connections to moms are pooled, other servers get a disconnect */
+      if (port != pbs_server_port_dis)
+        {
+        /* a pooled socket has no cn_func to read it, so while it sits in the
+         * pool wait_request() must not wake up for it (e.g. when the mom closes
+         * her end). pooled_connection_is_usable() checks it on checkout */
+        globalset_del_sock(sock);
+
+        if (mom_connections.checkin(addr, port, handle, time(NULL)) == true)
+          return;
+        }
+      }
+    }
+
+  svr_disconnect(handle);
+  }  /* END svr_release_connection() */
+
+
+
+/*
+ * close_idle_mom_connections - disconnect pooled mom connections that
+ * haven't been used for PBS_MOM_POOL_IDLE_TIME seconds. This keeps us well
+ * ahead of the mom timing the connection out on her side.
+ */
+
+void close_idle_mom_connections(
+
+  time_t now)  /* I */
+
+  {
+  std::vector<int> evicted;
+
+  mom_connections.evict_idle(now, evicted);
+
+  for (unsigned int i = 0; i < evicted.size(); i++)
+    svr_disconnect(evicted[i]);
+  }  /* END close_idle_mom_connections() */
+
+
+
+/*
+ * close_pooled_mom_connections - disconnect every pooled connection to
+ * the mom at hostaddr:port, for when she is known to be gone.
+ */
+
+void close_pooled_mom_connections(
+
+  pbs_net_t    hostaddr,  /* host order */
+  unsigned int port)      /* I */
+
+  {
+  std::vector<int> evicted;
+
+  mom_connections.purge(hostaddr, port, evicted);
+
+  for (unsigned int i = 0; i < evicted.size(); i++)
+    drop_connection(evicted[i]);
+  }  /* END close_pooled_mom_connections() */
+
+
+
 /*
  * parse_servername - parse a server/mom name in the form:
  * hostname[:service_port][/#][+hostname...]
@@ -10,5 +10,10 @@ void connection_clear(int con_pos);
 int svr_connect(pbs_net_t hostaddr, unsigned int port, int *local_errno, struct pbsnode *pnode, void *(*func)(void *));
 void svr_disconnect_sock(int handle);
 void svr_disconnect(int handle);
+int svr_connect_pooled(pbs_net_t hostaddr, unsigned int port, int *my_err, struct pbsnode *pnode);
+void svr_release_connection(int handle, bool reusable);
+bool pooled_connection_is_usable(int handle);
+void close_idle_mom_connections(time_t now);
+void close_pooled_mom_connections(pbs_net_t hostaddr, unsigned int port);
 int get_connection_entry(int *conn_pos);
 #endif /* _SVR_CONNECT_H */
@@ -346,13 +346,16 @@ void set_resc_assigned(
  * This routine is not directly called.
  * Rather it is referenced by an at_action field.
  * This is invoked inside of a loop over attributes in req_quejob.
+ * Recovered values were checked when they were set, and csv_nth() is not
+ * safe to call from the concurrent job recovery threads, so recovery skips
+ * the check.
  */
 
 int ck_checkpoint(
 
   pbs_attribute *pattr,
   void          *pobject, /* not used */
-  int            mode) /* not used */
+  int            mode)
 
   {
   char *val;
@@ -361,6 +364,9 @@ int ck_checkpoint(
   int len;
   char *str;
 
+  if (mode == ATR_ACTION_RECOV)
+    return(0);
+
   val = pattr->at_val.at_str;
 
   if (val == NULL)
@@ -1133,6 +1133,8 @@ int svr_setjobstate(
   if (is_valid_state_transition(*pjob, newstate, newsubstate) == false)
     return(PBSE_BAD_JOB_STATE_TRANSITION);
 
+  pjob->invalidate_status_cache();
+
   if (pjob->ji_parent_job != NULL)
     return(set_subjob_state(pjob, newstate, newsubstate, has_queue_mutex));
 
@@ -806,7 +806,7 @@ void svr_mailowner(
   if (email_delay == 0)
     {
     /* have a thread do the work of sending the mail */
-    enqueue_threadpool_request(send_the_mail, new mail_info(mi), task_pool);
+    enqueue_threadpool_request_lane(send_the_mail, new mail_info(mi), task_pool, TP_LANE_LOW);
     }
   else if (pending_emails.add_email_entry(mi) == true)
     {
@@ -89,7 +89,7 @@
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
-#include <list>
+#include <vector>
 
 #include "portability.h"
 #include <stdlib.h>
@@ -108,9 +108,140 @@ extern void check_nodes(struct work_task *);
 
 /* Global Data Items: */
 
-std::list<timed_task>  *task_list_timed;
-extern pthread_mutex_t  task_list_timed_mutex;
-extern task_recycler    tr;
+std::vector<timed_task> *task_list_timed;
+extern pthread_mutex_t   task_list_timed_mutex;
+extern task_recycler     tr;
+
+static unsigned long     timed_task_seq = 0;
+
+
+
+/*
+ * the helpers below maintain task_list_timed as a 4-ary min-heap. Each
+ * work task remembers its slot in wt_heap_slot so that it can be removed
+ * without a search. task_list_timed_mutex must be held.
+ */
+
+static inline bool timed_task_before(
+
+  const timed_task &a,
+  const timed_task &b)
+
+  {
+  if (a.task_time != b.task_time)
+    return(a.task_time < b.task_time);
+
+  return(a.seq < b.seq);
+  } /* END timed_task_before() */
+
+
+
+static inline void place_timed_task(
+
+  std::vector<timed_task> &heap,
+  unsigned int             index,
+  const timed_task        &tt)
+
+  {
+  heap[index] = tt;
+  tt.wt->wt_heap_slot = index + 1;
+  } /* END place_timed_task() */
+
+
+
+static void timed_task_sift_up(
+
+  std::vector<timed_task> &heap,
+  unsigned int             index)
+
+  {
+  timed_task tt = heap[index];
+
+  while (index > 0)
+    {
+    unsigned int parent = (index - 1) / TIMED_TASK_HEAP_ARITY;
+
+    if (timed_task_before(tt, heap[parent]) == false)
+      break;
+
+    place_timed_task(heap, index, heap[parent]);
+    index = parent;
+    }
+
+  place_timed_task(heap, index, tt);
+  } /* END timed_task_sift_up() */
+
+
+
+static void timed_task_sift_down(
+
+  std::vector<timed_task> &heap,
+  unsigned int             index)
+
+  {
+  timed_task   tt = heap[index];
+  unsigned int size = heap.size();
+
+  for (;;)
+    {
+    unsigned int first = index * TIMED_TASK_HEAP_ARITY + 1;
+    unsigned int last = first + TIMED_TASK_HEAP_ARITY;
+    unsigned int smallest;
+
+    if (first >= size)
+      break;
+
+    if (last > size)
+      last = size;
+
+    smallest = first;
+    for (unsigned int child = first + 1; child < last; child++)
+      {
+      if (timed_task_before(heap[child], heap[smallest]))
+        smallest = child;
+      }
+
+    if (timed_task_before(heap[smallest], tt) == false)
+      break;
+
+    place_timed_task(heap, index, heap[smallest]);
+    index = smallest;
+    }
+
+  place_timed_task(heap, index, tt);
+  } /* END timed_task_sift_down() */
+
+
+
+/*
+ * remove the task in slot index from the heap and return it
+ */
+
+static work_task *timed_task_remove_at(
+
+  std::vector<timed_task> &heap,
+  unsigned int             index)
+
+  {
+  work_task  *wt = heap[index].wt;
+  timed_task  last = heap.back();
+
+  heap.pop_back();
+  wt->wt_heap_slot = 0;
+
+  if (index < heap.size())
+    {
+    place_timed_task(heap, index, last);
+
+    if ((index > 0) &&
+        (timed_task_before(last, heap[(index - 1) / TIMED_TASK_HEAP_ARITY])))
+      timed_task_sift_up(heap, index);
+    else
+      timed_task_sift_down(heap, index);
+    }
+
+  return(wt);
+  } /* END timed_task_remove_at() */
 
 
 
@@ -119,69 +250,115 @@ void insert_timed_task(
   work_task *wt)
 
   {
-  std::list<timed_task>::iterator it;
-  bool                            inserted = false;
-  timed_task                      tt;
+  timed_task tt;
 
   tt.wt = wt;
   tt.task_time = wt->wt_event;
 
   pthread_mutex_lock(&task_list_timed_mutex);
 
-  for (it = task_list_timed->begin(); it != task_list_timed->end(); it++)
+  tt.seq = timed_task_seq++;
+  task_list_timed->push_back(tt);
+  timed_task_sift_up(*task_list_timed, task_list_timed->size() - 1);
+
+  pthread_mutex_unlock(&task_list_timed_mutex);
+  } /* END insert_timed_task() */
+
+
+
+/*
+ * remove_timed_task - take a task off the timed list before it expires
+ *
+ * The task's mutex must be held. It may be released and re-acquired to
+ * respect the lock order used by pop_timed_task().
+ *
+ * @return true if the task was on the timed list
+ */
+
+bool remove_timed_task(
+
+  work_task *wt) /* M */
+
+  {
+  bool removed = false;
+
+  if (pthread_mutex_trylock(&task_list_timed_mutex))
     {
-    if (it->task_time >= tt.task_time)
-      {
-      task_list_timed->insert(it, tt);
-      inserted = true;
-      break;
-      }
+    pthread_mutex_unlock(wt->wt_mutex);
+    pthread_mutex_lock(&task_list_timed_mutex);
+    pthread_mutex_lock(wt->wt_mutex);
     }
 
-  if (inserted == false)
-    task_list_timed->push_back(tt);
+  if ((wt->wt_heap_slot != 0) &&
+      (wt->wt_heap_slot <= task_list_timed->size()) &&
+      ((*task_list_timed)[wt->wt_heap_slot - 1].wt == wt))
+    {
+    timed_task_remove_at(*task_list_timed, wt->wt_heap_slot - 1);
+    removed = true;
+    }
 
   pthread_mutex_unlock(&task_list_timed_mutex);
-  } /* END insert_timed_task() */
+
+  return(removed);
+  } /* END remove_timed_task() */
 
 
 
 /*
- * pop_timed_task - return task from list of timed tasks.
+ * pop_timed_tasks - remove up to max_tasks expired tasks from the timed list
  *
- * Returns NULL or pointer to a timed task with its mutex locked.
+ * The tasks are appended to expired in the order they're due, each with
+ * its mutex locked.
+ *
+ * @return the number of tasks popped
  */
 
-work_task *pop_timed_task(
+int pop_timed_tasks(
 
-  time_t  time_now)
+  time_t                    time_now,  /* I */
+  std::vector<work_task *> &expired,   /* O */
+  unsigned int              max_tasks) /* I */
 
   {
-  struct work_task                *wt = NULL;
-  std::list<timed_task>::iterator  it;
+  int popped = 0;
 
-  // lock the mutex for the timed task list
   pthread_mutex_lock(&task_list_timed_mutex);
 
-  if (task_list_timed->begin() != task_list_timed->end())
+  while ((popped < (int)max_tasks) &&
+         (task_list_timed->empty() == false) &&
+         (task_list_timed->front().task_time <= time_now))
     {
-    it = task_list_timed->begin();
+    work_task *wt = timed_task_remove_at(*task_list_timed, 0);
 
-    if (it->task_time <= time_now)
-      {
-      wt = it->wt;
-      task_list_timed->pop_front();
-      }
+    pthread_mutex_lock(wt->wt_mutex);
+    expired.push_back(wt);
+    popped++;
     }
 
-  // lock the mutex for the task
-  if (wt != NULL)
-    pthread_mutex_lock(wt->wt_mutex);
-  
-  // unlock the mutex for the timed task list
   pthread_mutex_unlock(&task_list_timed_mutex);
 
-  return(wt);
+  return(popped);
+  } /* END pop_timed_tasks() */
+
+
+
+/*
+ * pop_timed_task - return task from list of timed tasks.
+ *
+ * Returns NULL or pointer to a timed task with its mutex locked.
+ */
+
+work_task *pop_timed_task(
+
+  time_t  time_now)
+
+  {
+  std::vector<work_task *> expired;
+
+  if (pop_timed_tasks(time_now, expired, 1) == 0)
+    return(NULL);
+
+  return(expired[0]);
   } /* END pop_timed_task() */
 
 
@@ -346,6 +523,9 @@ void delete_task(
   struct work_task *ptask) /* M */
 
   {
+  if (ptask->wt_heap_slot != 0)
+    remove_timed_task(ptask);
+
   if (ptask->wt_tasklist)
     remove_task(ptask->wt_tasklist,ptask);
 
@@ -540,7 +720,7 @@ int insert_task_into_recycler(
   ptask->wt_being_recycled = TRUE;
 
   if (tr.tasks.tasks.size() >= MAX_TASKS_IN_RECYCLER)
-    enqueue_threadpool_request(remove_some_recycle_tasks, NULL, task_pool);
+    enqueue_threadpool_request_lane(remove_some_recycle_tasks, NULL, task_pool, TP_LANE_LOW);
 
   rc = insert_task(&tr.tasks, ptask);
 
@@ -51,6 +51,14 @@ int get_svr_attr_b(int index, bool *b)
   return(0);
   }
 
+char *accounting_format = NULL;
+
+int get_svr_attr_str(int index, char **str)
+  {
+  *str = accounting_format;
+  return(0);
+  }
+
 void log_err(int errnum, const char *routine, const char *text) {}
 void log_record(int eventtype, int objclass, const char *objname, const char *text) {}
 void log_event(int eventtype, int objclass, const char *objname, const char *text) {}
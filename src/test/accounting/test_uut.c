@@ -5,10 +5,14 @@
 #include <string>
 #include "pbs_error.h"
 #include "pbs_job.h"
+#include "acct.h"
 #include "test_accounting.h"
+#include <unistd.h>
 
 
 extern char *acct_file;
+extern char *accounting_format;
+extern pthread_mutex_t *acctfile_mutex;
 void add_procs_and_nodes_used(job &pjob, std::string &acct_data);
 const char *exec1 = "napali/0+napali/1+napali/2+napali/3+napali/4+napali/5";
 const char *exec2 = "2/0+2/1+2/2+2/3+3/0+3/1+3/2+3/3+4/0+4/1+4/2+4/3";
@@ -41,6 +45,75 @@ START_TEST(test_add_procs_and_nodes_used)
   }
 END_TEST
 
+START_TEST(test_acct_record_to_json)
+  {
+  std::string out;
+
+  acct_record_to_json(out, 1500000000, "07/13/2017 20:40:00", PBS_ACCT_END, "1.napali",
+    "user=bob jobname=two words ctime=1499999000 Exit_status=0 resources_used.walltime=00:01:00");
+  fail_unless(out == "{\"date\":\"07/13/2017 20:40:00\",\"time\":1500000000,\"type\":\"E\","
+                     "\"jobid\":\"1.napali\",\"user\":\"bob\",\"jobname\":\"two words\","
+                     "\"ctime\":1499999000,\"Exit_status\":0,"
+                     "\"resources_used.walltime\":\"00:01:00\"}\n", out.c_str());
+
+  out.clear();
+  acct_record_to_json(out, 1500000000, "07/13/2017 20:40:00", PBS_ACCT_CHKPNT, "1.napali",
+    "Checkpointed \"and\" held");
+  fail_unless(out == "{\"date\":\"07/13/2017 20:40:00\",\"time\":1500000000,\"type\":\"C\","
+                     "\"jobid\":\"1.napali\",\"message\":\"Checkpointed \\\"and\\\" held\"}\n",
+                     out.c_str());
+
+  // leading zeros aren't valid JSON numbers
+  out.clear();
+  acct_record_to_json(out, 0, "", PBS_ACCT_QUEUE, "2.napali", "queue=007");
+  fail_unless(out.find("\"queue\":\"007\"") != std::string::npos, out.c_str());
+  }
+END_TEST
+
+START_TEST(test_account_record_writer)
+  {
+  char  dir[] = "/tmp/acct_testXXXXXX";
+  char  path[256];
+  char  line[1024];
+  FILE *fp;
+  int   records = 0;
+  job   pjob;
+
+  fail_unless(mkdtemp(dir) != NULL);
+  snprintf(path, sizeof(path), "%s/acct", dir);
+  acct_file = path;
+  accounting_format = strdup(ACCT_FORMAT_JSON);
+
+  acctfile_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+  pthread_mutex_init(acctfile_mutex, NULL);
+
+  strcpy(pjob.ji_qs.ji_jobid, "3.napali");
+
+  fail_unless(acct_open(acct_file, false) == 0);
+  fail_unless(acct_writer_start() == PBSE_NONE);
+
+  for (int i = 0; i < 500; i++)
+    account_record(PBS_ACCT_QUEUE, &pjob, "queue=batch");
+
+  // closing the file writes whatever is still queued
+  acct_close(false);
+
+  fail_unless((fp = fopen(path, "r")) != NULL);
+
+  while (fgets(line, sizeof(line), fp) != NULL)
+    {
+    fail_unless(strstr(line, "\"type\":\"Q\",\"jobid\":\"3.napali\",\"queue\":\"batch\"}") != NULL, line);
+    records++;
+    }
+
+  fclose(fp);
+  fail_unless(records == 500, "%d records", records);
+
+  unlink(path);
+  rmdir(dir);
+  }
+END_TEST
+
 START_TEST(test_two)
   {
 
@@ -53,6 +126,8 @@ Suite *accounting_suite(void)
   Suite *s = suite_create("accounting_suite methods");
   TCase *tc_core = tcase_create("test_add_procs_and_nodes_used");
   tcase_add_test(tc_core, test_add_procs_and_nodes_used);
+  tcase_add_test(tc_core, test_acct_record_to_json);
+  tcase_add_test(tc_core, test_account_record_writer);
   suite_add_tcase(s, tc_core);
 
   tc_core = tcase_create("test_two");
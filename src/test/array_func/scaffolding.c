@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <semaphore.h>
 
 #include "pbs_job.h" /* job */
 #include "batch_request.h" /* batch_request */
@@ -10,6 +11,7 @@
 #include "array.h" /* job_array */
 #include "server.h" /* server */
 #include "mutex_mgr.hpp"
+#include "threadpool.h"
 
 const char *text_name              = "text";
 
@@ -104,6 +106,26 @@ bool attempt_delete(void *j)
 
 void force_purge_work(job *pjob) {}
 
+threadpool_t *task_pool;
+int           batches_enqueued;
+
+int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *tp)
+  {
+  batches_enqueued++;
+  return(0);
+  }
+
+int get_hold(tlist_head *phead, const char **pset, pbs_attribute *temphold)
+  {
+  temphold->at_val.at_long = HOLD_u;
+  return(0);
+  }
+
+int chk_hold_priv(long val, int perm)
+  {
+  return(0);
+  }
+
 void append_link(tlist_head *head, list_link *new_link, void *pobj)
   {
   fprintf(stderr, "The call to append_link needs to be mocked!!\n");
@@ -379,3 +401,21 @@ int create_and_queue_array_subjob(
   {
   return(PBSE_NONE);
   }
+
+sem_t *job_clone_semaphore;
+
+const char *msg_permlog = "Unauthorized Request, request type: %d, Object: %s, Name: %s, request from: %s@%s";
+
+void get_jobowner(char *from, char *to)
+  {
+  strcpy(to, from);
+  }
+
+int svr_authorize_req(struct batch_request *preq, char *owner, char *submit_host)
+  {
+  // only the owner is authorized
+  if (strncmp(owner, preq->rq_user, strlen(preq->rq_user)))
+    return(-1);
+
+  return(0);
+  }
@@ -26,6 +26,9 @@ extern char *path_arrays;
 extern bool place_hold;
 extern int  unlocked;
 extern all_arrays allarrays;
+extern int  batches_enqueued;
+
+void get_range_runs(const std::vector<int> &range_vec, std::vector<std::pair<int, int> > &runs);
 
 
 job_array *get_job_array(
@@ -131,6 +134,185 @@ START_TEST(parse_array_dom_test)
 END_TEST
 
 
+START_TEST(delete_uncreated_range_test)
+  {
+  job_array *pa = new job_array();
+  char       range[] = "range=0-4,8";
+
+  path_arrays = (char *)"./";
+  strcpy(pa->ai_qs.fileprefix, "uncreated");
+  strcpy(pa->ai_qs.parent_id, "2[].napali");
+  pa->ai_qs.num_jobs = 10;
+  pa->ai_qs.array_size = 10;
+  pa->job_ids = (char **)calloc(10, sizeof(char *));
+  pa->uncreated_ids.from_range_string("0-9");
+
+  // None of the subjobs exist, so they are dropped without being created
+  fail_unless(delete_array_range(pa, range, false) == 0);
+  fail_unless(pa->uncreated_ids.size() == 4);
+  fail_unless(pa->uncreated_ids.first() == 5);
+  fail_unless(pa->ai_qs.jobs_done == 6);
+  fail_unless(pa->ai_qs.num_purged == 6);
+
+  // Deleting the rest leaves nothing in the array
+  char rest[] = "range=5-9";
+  fail_unless(delete_array_range(pa, rest, false) == NO_JOBS_IN_ARRAY);
+  fail_unless(pa->uncreated_ids.size() == 0);
+  fail_unless(pa->ai_qs.num_purged == pa->ai_qs.num_jobs);
+  }
+END_TEST
+
+
+START_TEST(batch_delete_range_test)
+  {
+  job_array *pa = new job_array();
+  char       range[] = "range=0-3";
+
+  path_arrays = (char *)"./";
+  strcpy(pa->ai_qs.fileprefix, "batched");
+  strcpy(pa->ai_qs.parent_id, "3[].napali");
+  pa->ai_qs.num_jobs = 10;
+  pa->ai_qs.array_size = 10;
+  pa->job_ids = (char **)calloc(10, sizeof(char *));
+  pa->job_ids[0] = strdup("3[0].napali");
+  pa->job_ids[1] = strdup("3[1].napali");
+  pa->uncreated_ids.from_range_string("2-9");
+
+  // both created subjobs go to a single bulk batch, the uncreated ones are dropped
+  batches_enqueued = 0;
+  fail_unless(delete_array_range(pa, range, true) == 0);
+  fail_unless(batches_enqueued == 1);
+  fail_unless(pa->bulk_updates == 1);
+  fail_unless(pa->uncreated_ids.size() == 6);
+  fail_unless(pa->uncreated_ids.first() == 4);
+  }
+END_TEST
+
+
+START_TEST(uncreated_subjob_request_test)
+  {
+  job_array     *pa = new job_array();
+  batch_request  owner_req;
+  batch_request  other_req;
+
+  memset(&owner_req, 0, sizeof(owner_req));
+  memset(&other_req, 0, sizeof(other_req));
+  strcpy(owner_req.rq_user, "dbeer");
+  strcpy(other_req.rq_user, "other");
+
+  path_arrays = (char *)"./";
+  strcpy(pa->ai_qs.fileprefix, "requested");
+  strcpy(pa->ai_qs.parent_id, "4[].napali");
+  strcpy(pa->ai_qs.owner, "dbeer@napali");
+  pa->ai_qs.num_jobs = 3;
+  pa->ai_qs.array_size = 3;
+  pa->job_ids = (char **)calloc(3, sizeof(char *));
+  pa->uncreated_ids.from_range_string("0-2");
+  allarrays.insert(pa, pa->ai_qs.parent_id);
+
+  // only the array's owner may act on its uncreated subjobs
+  fail_unless(delete_uncreated_subjob("4[1].napali", &other_req) == PBSE_PERM);
+  fail_unless(materialize_array_subjob("4[1].napali", &other_req) == PBSE_PERM);
+  fail_unless(pa->uncreated_ids.size() == 3);
+
+  // nothing is created past the idle slot limit
+  pa->ai_qs.idle_slot_limit = 1;
+  pa->ai_qs.num_idle = 1;
+  fail_unless(materialize_array_subjob("4[1].napali", &owner_req) == PBSE_BADSTATE);
+  fail_unless(pa->uncreated_ids.size() == 3);
+
+  // deleting drops the index without creating the subjob
+  fail_unless(delete_uncreated_subjob("4[1].napali", &owner_req) == PBSE_NONE);
+  fail_unless(pa->uncreated_ids.contains(1) == false);
+  fail_unless(pa->ai_qs.num_purged == 1);
+  fail_unless(pa->ai_qs.jobs_done == 1);
+  fail_unless(delete_uncreated_subjob("4[1].napali", &owner_req) == PBSE_UNKJOBID);
+  fail_unless(materialize_array_subjob("4[1].napali", &owner_req) == PBSE_UNKJOBID);
+  }
+END_TEST
+
+
+START_TEST(uncreated_holds_test)
+  {
+  job_array                          *pa = new job_array();
+  std::vector<int>                    range_vec;
+  std::vector<std::pair<int, int> >   runs;
+  char                                range[] = "range=2-4";
+  pbs_attribute                       temphold;
+  batch_request                       preq;
+
+  range_vec.push_back(1);
+  range_vec.push_back(2);
+  range_vec.push_back(3);
+  range_vec.push_back(7);
+  get_range_runs(range_vec, runs);
+  fail_unless(runs.size() == 2);
+  fail_unless(runs[0].first == 1);
+  fail_unless(runs[0].second == 3);
+  fail_unless(runs[1].first == 7);
+  fail_unless(runs[1].second == 7);
+
+  path_arrays = (char *)"./";
+  strcpy(pa->ai_qs.fileprefix, "held");
+  strcpy(pa->ai_qs.parent_id, "4[].napali");
+  pa->ai_qs.num_jobs = 10;
+  pa->ai_qs.array_size = 10;
+  pa->job_ids = (char **)calloc(10, sizeof(char *));
+  pa->uncreated_ids.from_range_string("0-9");
+
+  memset(&temphold, 0, sizeof(temphold));
+  temphold.at_val.at_long = HOLD_u;
+  fail_unless(hold_array_range(pa, range, &temphold) == PBSE_NONE);
+  fail_unless(pa->get_uncreated_holds(1) == 0);
+  fail_unless(pa->get_uncreated_holds(2) == HOLD_u);
+  fail_unless(pa->get_uncreated_holds(4) == HOLD_u);
+  fail_unless(pa->get_uncreated_holds(5) == 0);
+
+  memset(&preq, 0, sizeof(preq));
+  fail_unless(release_uncreated_holds(pa, &preq, 0, 2) == PBSE_NONE);
+  fail_unless(pa->get_uncreated_holds(2) == 0);
+  fail_unless(pa->get_uncreated_holds(3) == HOLD_u);
+  }
+END_TEST
+
+
+START_TEST(parse_uncreated_hold_dom_test)
+  {
+  const char *sample = "<array>\n<array_size>10</array_size>\n<number_jobs>10</number_jobs>\n"
+                       "<highest_id_created>-1</highest_id_created>\n<range>0-9</range>\n"
+                       "<uncreated>0-9</uncreated>\n"
+                       "<uncreated_hold type=\"1\">3-5</uncreated_hold>\n</array>";
+  xmlDocPtr  doc = xmlReadMemory(sample, strlen(sample), "array", NULL, 0);
+  job_array *pa = new job_array();
+  char       buf[1024];
+
+  fail_unless(parse_array_dom(&pa, xmlDocGetRootElement(doc), buf, sizeof(buf)) == PBSE_NONE, buf);
+  fail_unless(pa->get_uncreated_holds(2) == 0);
+  fail_unless(pa->get_uncreated_holds(3) == HOLD_u);
+  fail_unless(pa->get_uncreated_holds(5) == HOLD_u);
+  }
+END_TEST
+
+
+START_TEST(parse_uncreated_dom_test)
+  {
+  const char *sample = "<array>\n<array_size>10</array_size>\n<number_jobs>10</number_jobs>\n"
+                       "<highest_id_created>-1</highest_id_created>\n<range>0-9</range>\n"
+                       "<uncreated>2-3,7</uncreated>\n</array>";
+  xmlDocPtr  doc = xmlReadMemory(sample, strlen(sample), "array", NULL, 0);
+  job_array *pa = new job_array();
+  char       buf[1024];
+
+  fail_unless(parse_array_dom(&pa, xmlDocGetRootElement(doc), buf, sizeof(buf)) == PBSE_NONE, buf);
+  fail_unless(pa->uncreated_ids_recovered == true);
+  fail_unless(pa->uncreated_ids.size() == 3);
+  fail_unless(pa->uncreated_ids.first() == 2);
+  fail_unless(pa->uncreated_ids.contains(7) == true);
+  fail_unless(pa->uncreated_ids.contains(8) == false);
+  }
+END_TEST
+
+
 START_TEST(set_slot_limit_test)
   {
   job_array pa;
@@ -329,6 +511,11 @@ Suite *array_func_suite(void)
   tc_core = tcase_create("first_job_index_test");
   tcase_add_test(tc_core, first_job_index_test);
   tcase_add_test(tc_core, parse_array_dom_test);
+  tcase_add_test(tc_core, parse_uncreated_dom_test);
+  tcase_add_test(tc_core, delete_uncreated_range_test);
+  tcase_add_test(tc_core, batch_delete_range_test);
+  tcase_add_test(tc_core, uncreated_holds_test);
+  tcase_add_test(tc_core, parse_uncreated_hold_dom_test);
   suite_add_tcase(s, tc_core);
 
   tc_core = tcase_create("array_delete_test");
@@ -337,6 +524,10 @@ Suite *array_func_suite(void)
   tcase_add_test(tc_core, set_slot_hold_test);
   suite_add_tcase(s,tc_core);
 
+  tc_core = tcase_create("uncreated_subjob_request_test");
+  tcase_add_test(tc_core, uncreated_subjob_request_test);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("array_recov_binary_test");
   tcase_add_test(tc_core, array_recov_binary_test);
   tcase_add_test(tc_core, update_slot_values_test);
@@ -3,7 +3,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <sys/time.h>
 #include "attribute.h"
+#include "resource.h"
 #include "pbs_error.h"
 
 extern void im_dying();
@@ -113,6 +115,213 @@ START_TEST(test_three)
 END_TEST
 
 
+#define INDEX_TEST_DEFS 150
+
+attribute_def indexed_defs[INDEX_TEST_DEFS];
+attribute_def scanned_defs[INDEX_TEST_DEFS];
+char          def_names[INDEX_TEST_DEFS][32];
+
+
+void fill_defs()
+  {
+  for (int i = 0; i < INDEX_TEST_DEFS; i++)
+    {
+    snprintf(def_names[i], sizeof(def_names[i]), "Attribute_%d", i);
+    indexed_defs[i].at_name = def_names[i];
+    }
+
+  // a duplicate name (the first one wins, as with a scan) and an unnamed slot
+  indexed_defs[140].at_name = "ATTRIBUTE_3";
+  indexed_defs[141].at_name = NULL;
+
+  memcpy(scanned_defs, indexed_defs, sizeof(indexed_defs));
+  }
+
+
+START_TEST(test_attr_index)
+  {
+  fill_defs();
+
+  fail_unless(find_indexed_def(indexed_defs, "Attribute_1", INDEX_TEST_DEFS) == DEF_NOT_INDEXED);
+  fail_unless(index_attr_defs(indexed_defs, INDEX_TEST_DEFS) == PBSE_NONE);
+
+  for (int i = 0; i < INDEX_TEST_DEFS; i++)
+    {
+    if ((i == 140) ||
+        (i == 141))
+      continue;
+
+    fail_unless(find_attr(indexed_defs, def_names[i], INDEX_TEST_DEFS) == i);
+    }
+
+  // attribute names don't depend on case
+  fail_unless(find_attr(indexed_defs, "attribute_7", INDEX_TEST_DEFS) == 7);
+  fail_unless(find_attr(indexed_defs, "ATTRIBUTE_3", INDEX_TEST_DEFS) == 3);
+  fail_unless(find_attr(indexed_defs, "Attribute_", INDEX_TEST_DEFS) == -1);
+  fail_unless(find_attr(indexed_defs, "Attribute_1000", INDEX_TEST_DEFS) == -1);
+  fail_unless(find_attr(indexed_defs, "", INDEX_TEST_DEFS) == -1);
+
+  // a different limit isn't covered by the index
+  fail_unless(find_indexed_def(indexed_defs, "Attribute_1", 10) == DEF_NOT_INDEXED);
+  fail_unless(find_attr(indexed_defs, "Attribute_20", 10) == -1);
+  fail_unless(find_attr(indexed_defs, "Attribute_2", 10) == 2);
+  }
+END_TEST
+
+
+START_TEST(test_resc_index)
+  {
+  resource_def defs[4];
+
+  memset(defs, 0, sizeof(defs));
+  defs[0].rs_name = "walltime";
+  defs[1].rs_name = "mem";
+  defs[2].rs_name = "MEM";
+  defs[3].rs_name = "nodes";
+
+  fail_unless(index_resc_defs(defs, 4) == PBSE_NONE);
+
+  // resource names are case sensitive
+  fail_unless(find_resc_def(defs, "mem", 4) == defs + 1);
+  fail_unless(find_resc_def(defs, "MEM", 4) == defs + 2);
+  fail_unless(find_resc_def(defs, "Mem", 4) == NULL);
+  fail_unless(find_resc_def(defs, "nodes", 4) == defs + 3);
+
+  // re-registering the array replaces its index
+  defs[3].rs_name = "ncpus";
+  fail_unless(index_resc_defs(defs, 4) == PBSE_NONE);
+  fail_unless(find_resc_def(defs, "nodes", 4) == NULL);
+  fail_unless(find_resc_def(defs, "ncpus", 4) == defs + 3);
+  }
+END_TEST
+
+
+START_TEST(test_resc_index_reallocated)
+  {
+  resource_def *previous = NULL;
+  int           unindexed = 0;
+
+  // extra_resc changes reallocate svr_resc_def, each new array takes over the
+  // old one's index until no more indexes can be retired, then it is scanned.
+  // The old array is freed right away, so its address comes back.
+  for (int i = 0; i < 100; i++)
+    {
+    resource_def *defs = (resource_def *)calloc(3, sizeof(resource_def));
+    int           rc;
+
+    defs[0].rs_name = "walltime";
+    defs[1].rs_name = "mem";
+    defs[2].rs_name = "unknown";
+
+    rc = index_resc_defs(defs, 3, previous);
+
+    if (i < 40)
+      fail_unless(rc == PBSE_NONE);
+
+    if (rc == PBSE_NONE)
+      fail_unless(find_indexed_def(defs, "mem", 3) == 1);
+    else
+      {
+      fail_unless(find_indexed_def(defs, "mem", 3) == DEF_NOT_INDEXED);
+      unindexed++;
+      }
+
+    if (previous != NULL)
+      {
+      fail_unless(find_indexed_def(previous, "mem", 3) == DEF_NOT_INDEXED);
+      free(previous);
+      }
+
+    previous = defs;
+    }
+
+  fail_unless(unindexed > 0);
+  free(previous);
+  }
+END_TEST
+
+
+/*
+ * The index has to give the same answer as the scan it replaces, for hits,
+ * case variants, the duplicate and unnamed slots, and misses.
+ */
+
+START_TEST(test_attr_index_matches_scan)
+  {
+  char name[32];
+
+  fill_defs();
+  fail_unless(index_attr_defs(indexed_defs, INDEX_TEST_DEFS) == PBSE_NONE);
+
+  // the scan can't step over an unnamed slot, the index skips it
+  scanned_defs[141].at_name = "";
+  fail_unless(find_indexed_def(scanned_defs, def_names[0], INDEX_TEST_DEFS) == DEF_NOT_INDEXED);
+
+  for (int i = 0; i < INDEX_TEST_DEFS + 10; i++)
+    {
+    snprintf(name, sizeof(name), "Attribute_%d", i);
+    fail_unless(find_attr(indexed_defs, name, INDEX_TEST_DEFS) ==
+                find_attr(scanned_defs, name, INDEX_TEST_DEFS), "%s", name);
+
+    snprintf(name, sizeof(name), "ATTRIBUTE_%d", i);
+    fail_unless(find_attr(indexed_defs, name, INDEX_TEST_DEFS) ==
+                find_attr(scanned_defs, name, INDEX_TEST_DEFS), "%s", name);
+
+    snprintf(name, sizeof(name), "Attribute_%dx", i);
+    fail_unless(find_attr(indexed_defs, name, INDEX_TEST_DEFS) ==
+                find_attr(scanned_defs, name, INDEX_TEST_DEFS), "%s", name);
+    }
+  }
+END_TEST
+
+
+double elapsed_secs(
+
+  struct timeval *start)
+
+  {
+  struct timeval end;
+
+  gettimeofday(&end, NULL);
+
+  return((end.tv_sec - start->tv_sec) + (end.tv_usec - start->tv_usec) / 1000000.0);
+  }
+
+
+/*
+ * Indexed vs scanned lookups over the same definitions. Only run by
+ * make bench, see the suite below.
+ */
+
+START_TEST(test_attr_index_throughput)
+  {
+  const int       lookups = 1000000;
+  struct timeval  start;
+  double          indexed;
+  double          scanned;
+  int             found = 0;
+
+  fill_defs();
+  index_attr_defs(indexed_defs, INDEX_TEST_DEFS);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < lookups; i++)
+    found += (find_attr(scanned_defs, def_names[i % 140], INDEX_TEST_DEFS) >= 0);
+  scanned = elapsed_secs(&start);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < lookups; i++)
+    found += (find_attr(indexed_defs, def_names[i % 140], INDEX_TEST_DEFS) >= 0);
+  indexed = elapsed_secs(&start);
+
+  fail_unless(found == lookups * 2);
+
+  fprintf(stdout, "find_attr over %d definitions: scan %.0f lookups/sec, index %.0f lookups/sec\n",
+    INDEX_TEST_DEFS, lookups / scanned, lookups / indexed);
+  }
+END_TEST
+
+
 Suite *attr_func_suite(void)
   {
   Suite *s = suite_create("attr_func_suite methods");
@@ -128,6 +337,22 @@ Suite *attr_func_suite(void)
   tcase_add_test(tc_core, test_three);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_attr_index");
+  tcase_add_test(tc_core, test_attr_index);
+  tcase_add_test(tc_core, test_resc_index);
+  tcase_add_test(tc_core, test_resc_index_reallocated);
+  tcase_add_test(tc_core, test_attr_index_matches_scan);
+  suite_add_tcase(s, tc_core);
+
+  // timing runs are opt-in (make bench in src/test) so make check stays quiet
+  if (getenv("TORQUE_UT_BENCHMARKS") != NULL)
+    {
+    tc_core = tcase_create("benchmarks");
+    tcase_add_test(tc_core, test_attr_index_throughput);
+    tcase_set_timeout(tc_core, 60);
+    suite_add_tcase(s, tc_core);
+    }
+
 
   return s;
   }
@@ -2,6 +2,7 @@
 #include "lib_utils.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
 #include <check.h>
 
 
@@ -93,6 +94,156 @@ END_TEST
 
 
 
+START_TEST(test_many_addresses)
+  {
+  authorized_hosts ah;
+  std::string      list;
+
+  // enough to grow the table several times
+  for (unsigned long i = 1; i <= 5000; i++)
+    ah.add_authorized_address(i << 8, 15002, "");
+
+  for (unsigned long i = 1; i <= 5000; i++)
+    {
+    fail_unless(ah.is_authorized(i << 8));
+    fail_unless(ah.is_authorized(i << 8, 15002));
+    fail_unless(ah.is_authorized(i << 8, 15003) == false);
+    }
+
+  for (unsigned long i = 1; i <= 5000; i += 2)
+    fail_unless(ah.remove_address(i << 8, 15002) == true);
+
+  // removing and adding back again must not fill the table
+  for (int pass = 0; pass < 10; pass++)
+    {
+    for (unsigned long i = 2; i <= 5000; i += 2)
+      {
+      fail_unless(ah.remove_address(i << 8, 15002) == true);
+      ah.add_authorized_address(i << 8, 15002, "roshar");
+      }
+    }
+
+  for (unsigned long i = 1; i <= 5000; i++)
+    fail_unless(ah.is_authorized(i << 8) == ((i % 2) == 0));
+
+  fail_unless(ah.get_authorized_node(2 << 8) != NULL);
+
+  // the lowest port answers for the address
+  ah.add_authorized_address(2 << 8, 1, "scadrial");
+  fail_unless(!strcmp(ah.get_authorized_node(2 << 8)->get_name(), "scadrial"));
+  ah.remove_address(2 << 8, 1);
+  fail_unless(!strcmp(ah.get_authorized_node(2 << 8)->get_name(), "roshar"));
+
+  ah.clear();
+  ah.list_authorized_hosts(list);
+  fail_unless(list.size() == 0);
+  fail_unless(ah.is_authorized(2 << 8) == false);
+  }
+END_TEST
+
+
+/*
+ * Replaced tables and hostnames nothing points at any more are freed once
+ * no reader can be using them, so churn doesn't grow the object.
+ */
+
+START_TEST(test_reclaim)
+  {
+  authorized_hosts ah;
+  char             name[64];
+
+  for (int pass = 0; pass < 50; pass++)
+    {
+    for (unsigned long i = 1; i <= 500; i++)
+      {
+      snprintf(name, sizeof(name), "host%d-%lu", pass, i);
+      ah.add_authorized_address(i << 8, 15002, name);
+      }
+
+    fail_unless(ah.get_host_name_count() == 500);
+
+    for (unsigned long i = 1; i <= 500; i++)
+      fail_unless(ah.remove_address(i << 8, 15002) == true);
+
+    fail_unless(ah.get_host_name_count() == 0);
+    }
+
+  // with no readers about, at most what the last change retired is left
+  fail_unless(ah.get_retired_count() <= 2, "%d retired", ah.get_retired_count());
+
+  // a host renamed on the same port lets go of its old name
+  ah.add_authorized_address(1 << 8, 15002, "roshar");
+  ah.add_authorized_address(1 << 8, 15002, "scadrial");
+  fail_unless(ah.get_host_name_count() == 1);
+  fail_unless(!strcmp(ah.get_authorized_node(1 << 8, 15002)->get_name(), "scadrial"));
+
+  ah.clear();
+  fail_unless(ah.get_host_name_count() == 0);
+  }
+END_TEST
+
+
+authorized_hosts shared_hosts;
+volatile bool    readers_done;
+
+
+void *lookup_loop(
+
+  void *vp)
+
+  {
+  unsigned long *misses = (unsigned long *)vp;
+
+  while (readers_done == false)
+    {
+    // this one is never removed
+    if (shared_hosts.is_authorized(1, 15002) == false)
+      (*misses)++;
+
+    shared_hosts.is_authorized(2, 15002);
+    shared_hosts.get_authorized_node(2, 15002);
+    }
+
+  return(NULL);
+  }
+
+
+START_TEST(test_concurrent_readers)
+  {
+  pthread_t     readers[4];
+  unsigned long misses[4];
+
+  memset(misses, 0, sizeof(misses));
+  shared_hosts.add_authorized_address(1, 15002, "roshar");
+  readers_done = false;
+
+  for (int i = 0; i < 4; i++)
+    fail_unless(pthread_create(readers + i, NULL, lookup_loop, misses + i) == 0);
+
+  for (unsigned long i = 0; i < 20000; i++)
+    {
+    char name[32];
+
+    // fresh names so that retired hostnames get freed under the readers too
+    snprintf(name, sizeof(name), "scadrial%lu", i);
+    shared_hosts.add_authorized_address(2, 15002, name);
+    shared_hosts.add_authorized_address(i + 100, 15002, "");
+    shared_hosts.remove_address(2, 15002);
+    shared_hosts.remove_address(i + 100, 15002);
+    }
+
+  readers_done = true;
+
+  for (int i = 0; i < 4; i++)
+    {
+    pthread_join(readers[i], NULL);
+    fail_unless(misses[i] == 0);
+    }
+  }
+END_TEST
+
+
+
 Suite *authorized_hosts_suite(void)
   {
   Suite *s = suite_create("authorized_hosts_suite methods");
@@ -100,6 +251,12 @@ Suite *authorized_hosts_suite(void)
   tcase_add_test(tc_core, test_basics);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_many_addresses");
+  tcase_add_test(tc_core, test_many_addresses);
+  tcase_add_test(tc_core, test_reclaim);
+  tcase_add_test(tc_core, test_concurrent_readers);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include <check.h>
 
 
@@ -193,6 +194,221 @@ START_TEST(test_occupied_iterator)
 END_TEST
 
 
+START_TEST(test_word_boundaries)
+  {
+  execution_slot_tracker est(130);
+  execution_slot_tracker subset;
+  int                    iter = -1;
+
+  fail_unless(est.get_number_free() == 130);
+
+  // spans all three words
+  fail_unless(est.reserve_execution_slots(129, subset) == PBSE_NONE);
+  fail_unless(est.get_number_free() == 1);
+  fail_unless(subset.get_number_free() == 1);
+  fail_unless(est.is_occupied(128) == true);
+  fail_unless(est.is_occupied(129) == false);
+  fail_unless(est.reserve_execution_slots(2, subset) == INSUFFICIENT_FREE_EXECUTION_SLOTS);
+
+  fail_unless(est.unreserve_execution_slots(subset) == PBSE_NONE);
+  fail_unless(est.get_number_free() == 130);
+
+  est.mark_as_used(63);
+  est.mark_as_used(64);
+  est.mark_as_used(129);
+  fail_unless(est.get_next_occupied_index(iter) == 63);
+  fail_unless(est.get_next_occupied_index(iter) == 64);
+  fail_unless(est.get_next_occupied_index(iter) == 129);
+  fail_unless(est.get_next_occupied_index(iter) == -1);
+
+  // removing an occupied slot doesn't change the free count
+  fail_unless(est.remove_execution_slot() == PBSE_NONE);
+  fail_unless(est.get_number_free() == 127);
+  fail_unless(est.get_total_execution_slots() == 129);
+  fail_unless(est.remove_execution_slot() == PBSE_NONE);
+  fail_unless(est.get_number_free() == 126);
+  est.add_execution_slot();
+  fail_unless(est.is_occupied(128) == false);
+
+  execution_slot_tracker empty;
+  fail_unless(empty.remove_execution_slot() != PBSE_NONE);
+  }
+END_TEST
+
+
+#define FRAGMENTED_SLOTS 512
+
+void check_against_model(
+
+  execution_slot_tracker &node,
+  std::vector<bool>      &model)
+
+  {
+  int free_count = 0;
+
+  for (int i = 0; i < (int)model.size(); i++)
+    {
+    fail_unless(node.is_occupied(i) == model[i], "slot %d", i);
+
+    if (model[i] == false)
+      free_count++;
+    }
+
+  fail_unless(node.get_number_free() == free_count);
+  }
+
+
+/*
+ * Reserve and release on a fragmented node with many hardware threads, the
+ * way placement does, checking each step against a slot-at-a-time model:
+ * reservations take the lowest free slots and releasing everything leaves
+ * the node where it started.
+ */
+
+START_TEST(fragmented_node_test)
+  {
+  execution_slot_tracker              node(FRAGMENTED_SLOTS);
+  std::vector<bool>                   model(FRAGMENTED_SLOTS, false);
+  std::vector<bool>                   start;
+  std::vector<execution_slot_tracker> jobs;
+  unsigned int                        seed = 1;
+
+  // a third of the node is busy, in short scattered runs
+  for (int i = 0; i < FRAGMENTED_SLOTS; i++)
+    {
+    if (rand_r(&seed) % 3 == 0)
+      {
+      node.mark_as_used(i);
+      model[i] = true;
+      }
+    }
+
+  start = model;
+  check_against_model(node, model);
+
+  for (int round = 0; round < 40; round++)
+    {
+    execution_slot_tracker job;
+    int                    wanted = 1 + rand_r(&seed) % 70;
+    int                    expected = 0;
+
+    for (int i = 0; i < FRAGMENTED_SLOTS; i++)
+      expected += (model[i] == false);
+
+    if (expected < wanted)
+      {
+      fail_unless(node.reserve_execution_slots(wanted, job) == INSUFFICIENT_FREE_EXECUTION_SLOTS);
+      continue;
+      }
+
+    fail_unless(node.reserve_execution_slots(wanted, job) == PBSE_NONE);
+
+    for (int i = 0, taken = 0; taken < wanted; i++)
+      {
+      if (model[i] == false)
+        {
+        fail_unless(job.is_occupied(i), "slot %d", i);
+        model[i] = true;
+        taken++;
+        }
+      }
+
+    fail_unless(FRAGMENTED_SLOTS - job.get_number_free() == wanted);
+    check_against_model(node, model);
+    jobs.push_back(job);
+
+    // release an earlier job now and then so the free space keeps moving
+    if (round % 5 == 4)
+      {
+      execution_slot_tracker &done = jobs[rand_r(&seed) % jobs.size()];
+
+      fail_unless(node.unreserve_execution_slots(done) == PBSE_NONE);
+
+      for (int i = 0; i < FRAGMENTED_SLOTS; i++)
+        {
+        if (done.is_occupied(i))
+          {
+          model[i] = false;
+          done.mark_as_free(i);
+          }
+        }
+
+      check_against_model(node, model);
+      }
+    }
+
+  for (unsigned int i = 0; i < jobs.size(); i++)
+    fail_unless(node.unreserve_execution_slots(jobs[i]) == PBSE_NONE);
+
+  check_against_model(node, start);
+  }
+END_TEST
+
+
+#define BENCH_SLOTS      512
+#define BENCH_ITERATIONS 20000
+
+double bench_elapsed(
+
+  struct timeval *start)
+
+  {
+  struct timeval end;
+
+  gettimeofday(&end, NULL);
+
+  return((end.tv_sec - start->tv_sec) + (end.tv_usec - start->tv_usec) / 1000000.0);
+  }
+
+
+/*
+ * Reserve and release on a fragmented node with many hardware threads, the
+ * way placement does. Correctness is only that the node ends where it
+ * started; the rates are printed for comparison. Only run by make bench,
+ * see the suite below.
+ */
+
+START_TEST(fragmented_node_throughput_test)
+  {
+  execution_slot_tracker node(BENCH_SLOTS);
+  struct timeval         start;
+  unsigned int           seed = 1;
+  double                 reserve_time = 0;
+  double                 release_time = 0;
+
+  // a third of the node is busy, in short scattered runs
+  for (int i = 0; i < BENCH_SLOTS; i++)
+    {
+    if (rand_r(&seed) % 3 == 0)
+      node.mark_as_used(i);
+    }
+
+  int free_before = node.get_number_free();
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+    execution_slot_tracker job;
+
+    gettimeofday(&start, NULL);
+    fail_unless(node.reserve_execution_slots(64, job) == PBSE_NONE);
+    reserve_time += bench_elapsed(&start);
+
+    gettimeofday(&start, NULL);
+    node.unreserve_execution_slots(job);
+    release_time += bench_elapsed(&start);
+    }
+
+  fail_unless(node.get_number_free() == free_before);
+
+  printf("execution slot ops/sec on %d slots, %d free: reserve 64 %.0f, release 64 %.0f\n",
+    BENCH_SLOTS,
+    free_before,
+    BENCH_ITERATIONS / reserve_time,
+    BENCH_ITERATIONS / release_time);
+  }
+END_TEST
+
+
 Suite *execution_slot_tracker_suite(void)
   {
   Suite *s = suite_create("execution_slot_tracker test suite methods");
@@ -206,7 +422,21 @@ Suite *execution_slot_tracker_suite(void)
   tcase_add_test(tc_core, test_reserving);
   tcase_add_test(tc_core, test_occupied_iterator);
   tcase_add_test(tc_core, test_reserve_slot);
+  tcase_add_test(tc_core, test_word_boundaries);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("fragmented_node_test");
+  tcase_add_test(tc_core, fragmented_node_test);
   suite_add_tcase(s, tc_core);
+
+  // timing runs are opt-in (make bench in src/test) so make check stays quiet
+  if (getenv("TORQUE_UT_BENCHMARKS") != NULL)
+    {
+    tc_core = tcase_create("benchmarks");
+    tcase_add_test(tc_core, fragmented_node_throughput_test);
+    tcase_set_timeout(tc_core, 60);
+    suite_add_tcase(s, tc_core);
+    }
   
   return(s);
   }
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+#include "free_node_index.hpp"
+
+
+START_TEST(test_candidates)
+  {
+  free_node_index          fni;
+  std::set<int>            candidates;
+  std::vector<std::string> none;
+  std::vector<std::string> bigmem;
+  std::vector<std::string> props;
+
+  bigmem.push_back("bigmem");
+  props.push_back("bigmem");
+  props.push_back("fast");
+
+  fail_unless(fni.is_usable() == false);
+
+  fni.update(0, true, 16, 0, none);
+  fni.update(1, true, 4, 2, bigmem);
+  fni.update(2, true, 8, 0, props);
+  fni.update(3, false, 32, 4, props);
+  fail_unless(fni.is_usable() == true);
+  fail_unless(fni.count_available() == 3);
+
+  // unavailable nodes are never offered
+  fail_unless(fni.get_candidates(1, 0, none, candidates) == 3);
+  fail_unless(candidates.count(3) == 0);
+
+  candidates.clear();
+  fail_unless(fni.get_candidates(8, 0, none, candidates) == 2);
+  fail_unless(candidates.count(0) == 1);
+  fail_unless(candidates.count(2) == 1);
+
+  candidates.clear();
+  fail_unless(fni.get_candidates(1, 1, none, candidates) == 1);
+  fail_unless(candidates.count(1) == 1);
+
+  candidates.clear();
+  fail_unless(fni.get_candidates(1, 0, bigmem, candidates) == 2);
+  fail_unless(fni.get_candidates(1, 0, props, candidates) == 0);
+  fail_unless(candidates.size() == 2);
+
+  candidates.clear();
+  fail_unless(fni.get_candidates(6, 0, props, candidates) == 1);
+  fail_unless(candidates.count(2) == 1);
+
+  candidates.clear();
+  none.push_back("nosuchprop");
+  fail_unless(fni.get_candidates(1, 0, none, candidates) == 0);
+  }
+END_TEST
+
+
+START_TEST(test_update_remove)
+  {
+  free_node_index          fni;
+  std::set<int>            candidates;
+  std::vector<std::string> none;
+
+  fni.update(0, true, 16, 0, none);
+  fni.update(1, true, 16, 0, none);
+
+  // a job takes most of node 0, then all of node 1
+  fni.update(0, true, 2, 0, none);
+  fni.update(1, false, 0, 0, none);
+  fail_unless(fni.get_candidates(4, 0, none, candidates) == 0);
+  fail_unless(fni.get_candidates(2, 0, none, candidates) == 1);
+  fail_unless(candidates.count(0) == 1);
+
+  // and frees node 1 again
+  candidates.clear();
+  fni.update(1, true, 16, 0, none);
+  fail_unless(fni.get_candidates(4, 0, none, candidates) == 1);
+  fail_unless(candidates.count(1) == 1);
+
+  fni.remove(1);
+  candidates.clear();
+  fail_unless(fni.get_candidates(1, 0, none, candidates) == 1);
+  fail_unless(fni.count_available() == 1);
+
+  // nodes with subnodes turn the index off until they are deleted
+  fni.mark_unindexable(5);
+  fail_unless(fni.is_usable() == false);
+  fni.remove(5);
+  fail_unless(fni.is_usable() == true);
+  }
+END_TEST
+
+
+Suite *free_node_index_suite(void)
+  {
+  Suite *s = suite_create("free_node_index test suite methods");
+  TCase *tc_core = tcase_create("test_candidates");
+  tcase_add_test(tc_core, test_candidates);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_update_remove");
+  tcase_add_test(tc_core, test_update_remove);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(free_node_index_suite());
+  srunner_set_log(sr, "free_node_index_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
@@ -107,12 +107,11 @@ int enqueue_threadpool_request(
   }
 
 
-int insert_timed_task(
+void insert_timed_task(
 
     work_task *wt)
 
   {
-  return(PBSE_NONE);
   }
 
 
@@ -232,6 +231,16 @@ int svr_connect(pbs_net_t hostaddr, unsigned int port, int *my_err, struct pbsno
   return(10);
   }
 
+int svr_connect_pooled(pbs_net_t hostaddr, unsigned int port, int *my_err, struct pbsnode *pnode)
+  {
+  return(svr_connect(hostaddr, port, my_err, pnode, NULL));
+  }
+
+void svr_release_connection(int handle, bool reusable)
+  {
+  return;
+  }
+
 int dispatch_task(struct work_task *ptask)
   {
   return(0);
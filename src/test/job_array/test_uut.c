@@ -122,11 +122,9 @@ START_TEST(test_parse_array_request)
 
   pa.ai_qs.idle_slot_limit = 2;
   pa.ai_qs.num_idle = 0;
-  int internal_index = -1;
 
   // It should tell us to create sub job 0 next
-  fail_unless(pa.get_next_index_to_create(internal_index) == 0);
-  fail_unless(internal_index == 0);
+  fail_unless(pa.get_next_index_to_create() == 0);
 
   // Make sure we'll create a job
   pa.create_job_if_needed();
@@ -135,6 +133,90 @@ START_TEST(test_parse_array_request)
   pa.create_job_if_needed();
   fail_unless(pa.job_ids[1] != NULL);
   fail_unless(pa.ai_qs.highest_id_created == 1);
+  fail_unless(pa.uncreated_ids.size() == 8);
+
+  // Subjobs named individually are created out of order
+  fail_unless(pa.create_subjob(7) == PBSE_NONE);
+  fail_unless(pa.job_ids[7] != NULL);
+  fail_unless(pa.ai_qs.highest_id_created == 7);
+  fail_unless(pa.uncreated_ids.contains(7) == false);
+  fail_unless(pa.create_subjob(7) == PBSE_UNKJOBID);
+  fail_unless(pa.get_next_index_to_create() == 2);
+  }
+END_TEST
+
+
+START_TEST(test_subjob_index_set)
+  {
+  subjob_index_set ids;
+  std::string      range;
+
+  fail_unless(ids.first() == -1);
+
+  for (int i = 0; i < 100000; i++)
+    ids.add(i);
+
+  fail_unless(ids.size() == 100000);
+  fail_unless(ids.first() == 0);
+
+  // Ranges that straddle words
+  fail_unless(ids.remove_range(60, 130) == 71);
+  fail_unless(ids.remove_range(60, 130) == 0);
+  fail_unless(ids.contains(59) == true);
+  fail_unless(ids.contains(60) == false);
+  fail_unless(ids.contains(130) == false);
+  fail_unless(ids.contains(131) == true);
+
+  fail_unless(ids.remove_range(0, 59) == 60);
+  fail_unless(ids.first() == 131);
+  fail_unless(ids.remove(131) == true);
+  fail_unless(ids.remove(131) == false);
+  fail_unless(ids.first() == 132);
+
+  // Removing past the end only counts what's there
+  fail_unless(ids.remove_range(99990, 200000) == 10);
+  fail_unless(ids.size() == 100000 - 71 - 60 - 1 - 10);
+
+  ids.to_range_string(range);
+  fail_unless(range == "132-99989", "range is %s", range.c_str());
+
+  ids.add(5);
+  fail_unless(ids.first() == 5);
+  ids.remove_range(50000, 50000);
+  ids.to_range_string(range);
+  fail_unless(range == "5,132-49999,50001-99989", "range is %s", range.c_str());
+
+  subjob_index_set copy;
+  fail_unless(copy.from_range_string("the Lopen") != PBSE_NONE);
+
+  ids.clear();
+  fail_unless(ids.size() == 0);
+  fail_unless(ids.first() == -1);
+  ids.to_range_string(range);
+  fail_unless(range.size() == 0);
+  }
+END_TEST
+
+
+START_TEST(test_remove_uncreated_range)
+  {
+  job_array pa;
+
+  array_size = 10000;
+  fail_unless(pa.parse_array_request("0-9") == PBSE_NONE);
+
+  fail_unless(pa.remove_uncreated_range(2, 4, 271) == 3);
+  fail_unless(pa.ai_qs.jobs_done == 3);
+  fail_unless(pa.ai_qs.num_purged == 3);
+  fail_unless(pa.ai_qs.num_failed == 3);
+  fail_unless(pa.ai_qs.num_successful == 0);
+
+  fail_unless(pa.remove_uncreated_range(0, 9, 0) == 7);
+  fail_unless(pa.ai_qs.num_purged == pa.ai_qs.num_jobs);
+  fail_unless(pa.ai_qs.num_successful == 7);
+
+  // Nothing is left to create
+  fail_unless(pa.get_next_index_to_create() == -1);
   }
 END_TEST
 
@@ -150,6 +232,15 @@ START_TEST(test_initialize_uncreated_ids)
   pa.ai_qs.highest_id_created = 4;
   pa.initialize_uncreated_ids();
   fail_unless(pa.uncreated_ids.size() == 5, "Size is %d", (int)pa.uncreated_ids.size());
+
+  // Ids read from the array file are kept as they are
+  pa.uncreated_ids.clear();
+  pa.uncreated_ids.add(1);
+  pa.uncreated_ids.add(3);
+  pa.uncreated_ids_recovered = true;
+  pa.initialize_uncreated_ids();
+  fail_unless(pa.uncreated_ids.size() == 2, "Size is %d", (int)pa.uncreated_ids.size());
+  fail_unless(pa.uncreated_ids.first() == 1);
   }
 END_TEST
 
@@ -205,6 +296,11 @@ Suite *job_array_suite(void)
   tcase_add_test(tc_core, test_initialize_uncreated_ids);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_subjob_index_set");
+  tcase_add_test(tc_core, test_subjob_index_set);
+  tcase_add_test(tc_core, test_remove_uncreated_range);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
@@ -4,6 +4,9 @@
 #include "pbs_job.h"
 #include "pbs_error.h"
 #include <check.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
 
 char *get_correct_jobname(const char *jobid);
 
@@ -258,6 +261,464 @@ START_TEST(find_job_by_array_with_removed_record_test)
   }
 END_TEST
 
+typedef container::item_container<char *> name_container;
+
+
+std::vector<std::string> container_ids(
+
+  name_container &c,
+  bool            reverse)
+
+  {
+  std::vector<std::string>        ids;
+  name_container::item_iterator  *iter;
+  char                           *name;
+
+  c.lock();
+  iter = c.get_iterator(reverse);
+  while ((name = iter->get_next_item()) != NULL)
+    ids.push_back(name);
+  delete iter;
+  c.unlock();
+
+  return(ids);
+  }
+
+
+START_TEST(container_order_test)
+  {
+  name_container           c;
+  std::vector<std::string> ids;
+  char                     a[] = "a";
+  char                     b[] = "b";
+  char                     d[] = "d";
+  char                     e[] = "e";
+
+  c.lock();
+  // an empty list's first item is also its last
+  fail_unless(c.insert_first(b, "b") == true);
+  fail_unless(c.insert(d, "d") == true);
+  fail_unless(c.insert_first(a, "a") == true);
+  fail_unless(c.insert_at(3, e, "e") == true);
+  fail_unless(c.insert_at(5, e, "f") == false);
+  fail_unless(c.insert(a, "a") == false);
+  fail_unless(c.insert_after("zz", a, "y") == false);
+
+  // a miss doesn't add anything
+  fail_unless(c.find("c") == NULL);
+  fail_unless(c.count() == 4);
+  c.unlock();
+
+  ids = container_ids(c, false);
+  fail_unless(ids.size() == 4);
+  fail_unless(ids[0] == "a" && ids[1] == "b" && ids[2] == "d" && ids[3] == "e");
+
+  ids = container_ids(c, true);
+  fail_unless(ids.size() == 4);
+  fail_unless(ids[0] == "e" && ids[1] == "d" && ids[2] == "b" && ids[3] == "a");
+
+  c.lock();
+  fail_unless(c.swap("a", "e") == true);
+  fail_unless(c.find("a") == a);
+  fail_unless(c.find("e") == e);
+  fail_unless(c.pop_back() == a);
+  fail_unless(c.pop() == e);
+  c.unlock();
+
+  ids = container_ids(c, false);
+  fail_unless(ids.size() == 2);
+  fail_unless(ids[0] == "b" && ids[1] == "d");
+  }
+END_TEST
+
+
+START_TEST(iterator_survives_removal_test)
+  {
+  name_container                 c;
+  name_container::item_iterator *iter;
+  name_container::item_iterator *back_iter;
+  char                           names[6][2] = { "0", "1", "2", "3", "4", "5" };
+
+  c.lock();
+  for (int i = 0; i < 6; i++)
+    c.insert(names[i], names[i]);
+
+  iter = c.get_iterator();
+  back_iter = c.get_iterator(true);
+  fail_unless(iter->get_next_item() == names[0]);
+  fail_unless(back_iter->get_next_item() == names[5]);
+
+  // the iterator is sitting on 1; remove it, its successor, and 4
+  fail_unless(c.remove("1") == true);
+  fail_unless(c.remove("2") == true);
+  fail_unless(c.remove("4") == true);
+  c.insert(names[1], "1a");
+
+  fail_unless(iter->get_next_item() == names[3]);
+  fail_unless(iter->get_next_item() == names[5]);
+  fail_unless(iter->get_next_item() == names[1]);
+  fail_unless(iter->get_next_item() == NULL);
+
+  fail_unless(back_iter->get_next_item() == names[3]);
+  fail_unless(back_iter->get_next_item() == names[0]);
+  fail_unless(back_iter->get_next_item() == NULL);
+
+  c.clear();
+  fail_unless(c.count() == 0);
+  c.unlock();
+
+  delete iter;
+  delete back_iter;
+  }
+END_TEST
+
+
+START_TEST(pinned_item_test)
+  {
+  name_container             c;
+  char                       names[3][16] = { "1.napali", "2.napali", "3.napali" };
+  char                      *value;
+  container::item<char *>   *pinned;
+
+  c.lock();
+  for (int i = 0; i < 3; i++)
+    c.insert(names[i], names[i]);
+  c.unlock();
+
+  fail_unless(c.pin("4.napali", value) == NULL);
+  fail_unless(value == NULL);
+
+  // a swap moves payloads between items, that isn't a removal
+  fail_unless((pinned = c.pin("1.napali", value)) != NULL);
+  fail_unless(value == names[0]);
+  c.lock();
+  fail_unless(c.swap("1.napali", "3.napali") == true);
+  c.unlock();
+  fail_unless(c.removed_while_pinned(pinned, value) == false);
+  fail_unless(c.find("1.napali") == names[0]);
+
+  // removing the other payload of the pinned item isn't ours either
+  c.lock();
+  fail_unless(c.remove("3.napali") == true);
+  c.unlock();
+  fail_unless(c.removed_while_pinned(pinned, value) == false);
+  c.unpin(pinned);
+
+  // the pinned item outlives its removal
+  fail_unless((pinned = c.pin("2.napali", value)) != NULL);
+  c.lock();
+  fail_unless(c.remove("2.napali") == true);
+  c.unlock();
+  fail_unless(c.removed_while_pinned(pinned, value) == true);
+  c.unpin(pinned);
+
+  c.lock();
+  fail_unless(c.count() == 1);
+  c.clear();
+  c.unlock();
+  }
+END_TEST
+
+
+#define STRESS_JOBS   2000
+#define STRESS_ROUNDS 20000
+
+/* the first half of the names stays in the container, the second half comes and goes */
+#define STRESS_FIXED  (STRESS_JOBS / 2)
+
+name_container  stress_container;
+char            stress_names[STRESS_JOBS][16];
+volatile bool   stress_done;
+
+
+void *stress_finder(
+
+  void *vp)
+
+  {
+  unsigned long *missed = (unsigned long *)vp;
+  unsigned int   seed = (unsigned long)vp & 0xffff;
+
+  while (stress_done == false)
+    {
+    int                      i = rand_r(&seed) % STRESS_FIXED;
+    int                      j = STRESS_FIXED + rand_r(&seed) % (STRESS_JOBS - STRESS_FIXED);
+    char                    *value;
+    container::item<char *> *pinned;
+
+    if (stress_container.find(stress_names[i]) != stress_names[i])
+      (*missed)++;
+
+    // pin one that comes and goes, the way find_job_by_array() does
+    if ((pinned = stress_container.pin(stress_names[j], value)) != NULL)
+      {
+      if (value != stress_names[j])
+        (*missed)++;
+
+      stress_container.unpin(pinned);
+      }
+    }
+
+  return(NULL);
+  }
+
+
+void *stress_toggler(
+
+  void *vp)
+
+  {
+  unsigned int seed = 1;
+
+  for (int round = 0; round < STRESS_ROUNDS; round++)
+    {
+    int i = STRESS_FIXED + rand_r(&seed) % (STRESS_JOBS - STRESS_FIXED);
+
+    stress_container.lock();
+    if (stress_container.remove(stress_names[i]) == false)
+      stress_container.insert(stress_names[i], stress_names[i]);
+    stress_container.unlock();
+    }
+
+  return(NULL);
+  }
+
+
+void *stress_iterator(
+
+  void *vp)
+
+  {
+  unsigned long                 *missed = (unsigned long *)vp;
+  name_container::item_iterator *iter;
+
+  while (stress_done == false)
+    {
+    int fixed_seen = 0;
+
+    stress_container.lock();
+    iter = stress_container.get_iterator();
+    stress_container.unlock();
+
+    // like next_job(): the lock is only held for each step
+    for (;;)
+      {
+      stress_container.lock();
+      char *name = iter->get_next_item();
+      stress_container.unlock();
+
+      if (name == NULL)
+        break;
+
+      if (name < stress_names[STRESS_FIXED])
+        fixed_seen++;
+      }
+
+    if (fixed_seen != STRESS_FIXED)
+      (*missed)++;
+
+    delete iter;
+    }
+
+  return(NULL);
+  }
+
+
+/*
+ * Finds and step-locked iteration running against inserts and removes.
+ * Names that are never removed must always be found and always be walked
+ * exactly once, and the container must end up holding what the toggler
+ * left in it.
+ */
+
+START_TEST(container_concurrency_test)
+  {
+  const int      finders = 4;
+  pthread_t      threads[finders + 2];
+  unsigned long  missed[finders + 1];
+  size_t         present = 0;
+
+  memset(missed, 0, sizeof(missed));
+
+  stress_container.lock();
+  for (int i = 0; i < STRESS_JOBS; i++)
+    {
+    snprintf(stress_names[i], sizeof(stress_names[i]), "%d.napali", i);
+    stress_container.insert(stress_names[i], stress_names[i]);
+    }
+  stress_container.unlock();
+
+  stress_done = false;
+
+  for (int i = 0; i < finders; i++)
+    fail_unless(pthread_create(threads + i, NULL, stress_finder, missed + i) == 0);
+  fail_unless(pthread_create(threads + finders, NULL, stress_iterator, missed + finders) == 0);
+  fail_unless(pthread_create(threads + finders + 1, NULL, stress_toggler, NULL) == 0);
+
+  pthread_join(threads[finders + 1], NULL);
+  stress_done = true;
+
+  for (int i = 0; i < finders + 1; i++)
+    {
+    pthread_join(threads[i], NULL);
+    fail_unless(missed[i] == 0, "thread %d missed a job that was never removed", i);
+    }
+
+  for (int i = 0; i < STRESS_JOBS; i++)
+    {
+    char *found = stress_container.find(stress_names[i]);
+
+    if (found != NULL)
+      {
+      fail_unless(found == stress_names[i]);
+      present++;
+      }
+    else
+      fail_unless(i >= STRESS_FIXED);
+    }
+
+  stress_container.lock();
+  fail_unless(stress_container.count() == present);
+  stress_container.clear();
+  stress_container.unlock();
+  }
+END_TEST
+
+#define BENCH_JOBS    2000
+#define BENCH_SECONDS 1
+
+name_container  bench_container;
+char            bench_names[BENCH_JOBS][16];
+volatile bool   bench_done;
+
+
+void *bench_finder(
+
+  void *vp)
+
+  {
+  unsigned long *ops = (unsigned long *)vp;
+  unsigned int   seed = (unsigned long)vp & 0xffff;
+
+  while (bench_done == false)
+    {
+    bench_container.find(bench_names[rand_r(&seed) % BENCH_JOBS]);
+    (*ops)++;
+    }
+
+  return(NULL);
+  }
+
+
+void *bench_inserter(
+
+  void *vp)
+
+  {
+  unsigned long *ops = (unsigned long *)vp;
+  unsigned int   seed = 1;
+
+  while (bench_done == false)
+    {
+    int i = rand_r(&seed) % BENCH_JOBS;
+
+    bench_container.lock();
+    if (bench_container.remove(bench_names[i]) == false)
+      bench_container.insert(bench_names[i], bench_names[i]);
+    bench_container.unlock();
+    (*ops)++;
+    }
+
+  return(NULL);
+  }
+
+
+void *bench_iterator(
+
+  void *vp)
+
+  {
+  unsigned long                 *ops = (unsigned long *)vp;
+  name_container::item_iterator *iter;
+
+  while (bench_done == false)
+    {
+    bench_container.lock();
+    iter = bench_container.get_iterator();
+    bench_container.unlock();
+
+    // like next_job(): the lock is only held for each step
+    for (;;)
+      {
+      bench_container.lock();
+      char *name = iter->get_next_item();
+      bench_container.unlock();
+
+      if (name == NULL)
+        break;
+
+      (*ops)++;
+      }
+
+    delete iter;
+    }
+
+  return(NULL);
+  }
+
+
+/*
+ * Mixed find/insert/iterate load on one container. Correctness is only
+ * that nothing crashes or hangs; the rates are printed for comparison.
+ * Only run by make bench, see the suite below.
+ */
+
+START_TEST(container_throughput_test)
+  {
+  const int      finders = 4;
+  pthread_t      threads[finders + 2];
+  unsigned long  ops[finders + 2];
+  unsigned long  find_ops = 0;
+
+  memset(ops, 0, sizeof(ops));
+
+  bench_container.lock();
+  for (int i = 0; i < BENCH_JOBS; i++)
+    {
+    snprintf(bench_names[i], sizeof(bench_names[i]), "%d.napali", i);
+    bench_container.insert(bench_names[i], bench_names[i]);
+    }
+  bench_container.unlock();
+
+  bench_done = false;
+
+  for (int i = 0; i < finders; i++)
+    fail_unless(pthread_create(threads + i, NULL, bench_finder, ops + i) == 0);
+  fail_unless(pthread_create(threads + finders, NULL, bench_inserter, ops + finders) == 0);
+  fail_unless(pthread_create(threads + finders + 1, NULL, bench_iterator, ops + finders + 1) == 0);
+
+  sleep(BENCH_SECONDS);
+  bench_done = true;
+
+  for (int i = 0; i < finders + 2; i++)
+    pthread_join(threads[i], NULL);
+
+  for (int i = 0; i < finders; i++)
+    find_ops += ops[i];
+
+  printf("container ops/sec with %d finders: find %lu, insert/remove %lu, iterate %lu\n",
+    finders,
+    find_ops / BENCH_SECONDS,
+    ops[finders] / BENCH_SECONDS,
+    ops[finders + 1] / BENCH_SECONDS);
+
+  bench_container.lock();
+  bench_container.clear();
+  bench_container.unlock();
+  }
+END_TEST
+
+
 Suite *job_container_suite(void)
   {
   Suite *s = suite_create("job_container test suite methods");
@@ -297,6 +758,22 @@ Suite *job_container_suite(void)
   tcase_add_test(tc_core, find_job_by_array_with_removed_record_test);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("container_test");
+  tcase_add_test(tc_core, container_order_test);
+  tcase_add_test(tc_core, iterator_survives_removal_test);
+  tcase_add_test(tc_core, pinned_item_test);
+  tcase_add_test(tc_core, container_concurrency_test);
+  suite_add_tcase(s, tc_core);
+
+  // timing runs are opt-in (make bench in src/test) so make check stays quiet
+  if (getenv("TORQUE_UT_BENCHMARKS") != NULL)
+    {
+    tc_core = tcase_create("benchmarks");
+    tcase_add_test(tc_core, container_throughput_test);
+    tcase_set_timeout(tc_core, 60);
+    suite_add_tcase(s, tc_core);
+    }
+
   return(s);
   }
 
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <check.h>
+
+#include "job_journal.hpp"
+#include "pbs_error.h"
+
+const char *journal_path = "./test_job_journal";
+
+
+void remove_journals()
+  {
+  unlink(journal_path);
+  unlink("./test_job_journal.old");
+  }
+
+
+void append_delta(
+
+  job_journal &jj,
+  const char  *jobid,
+  int          state,
+  int          substate)
+
+  {
+  job_journal_record rec;
+
+  init_journal_record(rec, JOURNAL_DELTA, jobid);
+  rec.jr_state = state;
+  rec.jr_substate = substate;
+
+  fail_unless(jj.append(rec) == PBSE_NONE);
+  }
+
+
+
+START_TEST(test_append_replay)
+  {
+  job_journal        jj;
+  job_journal        recovered;
+  job_journal_record rec;
+
+  remove_journals();
+  jj.set_path(journal_path);
+
+  // nothing can be appended until the journal is opened
+  init_journal_record(rec, JOURNAL_DELTA, "1.napali");
+  fail_unless(jj.append(rec) == -1);
+
+  fail_unless(jj.open() == PBSE_NONE);
+  fail_unless(jj.is_open() == true);
+
+  append_delta(jj, "1.napali", 1, 10);
+  append_delta(jj, "2.napali", 1, 10);
+  append_delta(jj, "1.napali", 4, 42);
+  fail_unless(jj.get_appended() == 3);
+  fail_unless(jj.has_deltas("1.napali") == true);
+  fail_unless(jj.has_deltas("3.napali") == false);
+  jj.close();
+
+  recovered.set_path(journal_path);
+  fail_unless(recovered.replay() == 3);
+
+  // the newest record for a job wins
+  fail_unless(recovered.get_replayed("1.napali", rec) == true);
+  fail_unless(rec.jr_state == 4);
+  fail_unless(rec.jr_substate == 42);
+  fail_unless(recovered.get_replayed("2.napali", rec) == true);
+  fail_unless(rec.jr_state == 1);
+  fail_unless(recovered.get_replayed("3.napali", rec) == false);
+
+  // replayed jobs need a snapshot before the journal is discarded
+  fail_unless(recovered.has_deltas("1.napali") == true);
+  fail_unless(recovered.snapshot_taken("1.napali") == PBSE_NONE);
+  fail_unless(recovered.has_deltas("1.napali") == false);
+
+  remove_journals();
+  }
+END_TEST
+
+
+START_TEST(test_snapshot)
+  {
+  job_journal        jj;
+  job_journal        recovered;
+  job_journal_record rec;
+
+  remove_journals();
+  jj.set_path(journal_path);
+  fail_unless(jj.open() == PBSE_NONE);
+
+  // no record is written for jobs without deltas
+  fail_unless(jj.snapshot_taken("1.napali") == PBSE_NONE);
+  fail_unless(jj.get_appended() == 0);
+
+  append_delta(jj, "1.napali", 1, 10);
+  append_delta(jj, "2.napali", 1, 10);
+  fail_unless(jj.snapshot_taken("1.napali") == PBSE_NONE);
+  fail_unless(jj.get_appended() == 3);
+  fail_unless(jj.has_deltas("1.napali") == false);
+  jj.close();
+
+  recovered.set_path(journal_path);
+  fail_unless(recovered.replay() == 3);
+  fail_unless(recovered.get_replayed("1.napali", rec) == false);
+  fail_unless(recovered.get_replayed("2.napali", rec) == true);
+
+  remove_journals();
+  }
+END_TEST
+
+
+START_TEST(test_torn_tail)
+  {
+  job_journal        jj;
+  job_journal        recovered;
+  job_journal_record rec;
+  int                fd;
+
+  remove_journals();
+  jj.set_path(journal_path);
+  fail_unless(jj.open() == PBSE_NONE);
+  append_delta(jj, "1.napali", 1, 10);
+  append_delta(jj, "2.napali", 1, 10);
+  jj.close();
+
+  // a partial record, as if the server died in the middle of a write
+  init_journal_record(rec, JOURNAL_DELTA, "3.napali");
+  fd = open(journal_path, O_WRONLY | O_APPEND);
+  fail_unless(fd >= 0);
+  fail_unless(write(fd, &rec, sizeof(rec) / 2) == (ssize_t)(sizeof(rec) / 2));
+  close(fd);
+
+  recovered.set_path(journal_path);
+  fail_unless(recovered.replay() == 2);
+  fail_unless(recovered.get_replayed("3.napali", rec) == false);
+
+  // a whole record with a bad checksum
+  init_journal_record(rec, JOURNAL_DELTA, "4.napali");
+  fail_unless(journal_record_is_valid(rec) == false);
+
+  remove_journals();
+  }
+END_TEST
+
+
+START_TEST(test_rotate)
+  {
+  job_journal               jj;
+  job_journal               recovered;
+  job_journal               compacted;
+  job_journal_record        rec;
+  std::vector<std::string>  to_snapshot;
+
+  remove_journals();
+  jj.set_path(journal_path);
+  fail_unless(jj.rotate(to_snapshot) == -1);
+
+  fail_unless(jj.open() == PBSE_NONE);
+  append_delta(jj, "1.napali", 1, 10);
+
+  fail_unless(jj.rotate(to_snapshot) == PBSE_NONE);
+  fail_unless(to_snapshot.size() == 1);
+  fail_unless(to_snapshot[0] == "1.napali");
+  fail_unless(access("./test_job_journal.old", F_OK) == 0);
+  fail_unless(jj.get_appended() == 0);
+
+  append_delta(jj, "2.napali", 1, 10);
+
+  // the server died before the compaction finished: both generations are replayed
+  recovered.set_path(journal_path);
+  fail_unless(recovered.replay() == 2);
+  fail_unless(recovered.get_replayed("1.napali", rec) == true);
+  fail_unless(recovered.get_replayed("2.napali", rec) == true);
+
+  fail_unless(jj.snapshot_taken("1.napali") == PBSE_NONE);
+  fail_unless(jj.finish_compaction() == PBSE_NONE);
+  fail_unless(access("./test_job_journal.old", F_OK) != 0);
+  jj.close();
+
+  compacted.set_path(journal_path);
+  fail_unless(compacted.replay() == 2);
+  fail_unless(compacted.get_replayed("1.napali", rec) == false);
+  fail_unless(compacted.get_replayed("2.napali", rec) == true);
+
+  remove_journals();
+  }
+END_TEST
+
+
+
+
+Suite *job_journal_suite(void)
+  {
+  Suite *s = suite_create("job_journal test suite methods");
+  TCase *tc_core = tcase_create("test_append_replay");
+  tcase_add_test(tc_core, test_append_replay);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_snapshot");
+  tcase_add_test(tc_core, test_snapshot);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_torn_tail");
+  tcase_add_test(tc_core, test_torn_tail);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_rotate");
+  tcase_add_test(tc_core, test_rotate);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(job_journal_suite());
+  srunner_set_log(sr, "job_journal_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <unistd.h> /* write */
 #include <pthread.h> /* pthread_mutex_t */
 
 #include "attribute.h" /* attribute_def, pbs_attribute */
@@ -93,6 +94,9 @@ int unlock_ss()
 
 int write_buffer(char *buf, int len, int fds)
   {
+  if (write(fds, buf, len) != len)
+    return(-1);
+
   return(0);
   }
 
@@ -180,8 +184,15 @@ void set_chkpt_deflt(job *pjob, pbs_queue *pque) {}
 
 int attr_to_str(std::string& ds, attribute_def *attr_def,struct pbs_attribute attr, bool XML)
   {
+  char buf[32];
+
   if (attr_def->at_type == ATR_TYPE_STR)
     ds = attr.at_val.at_str;
+  else if (attr_def->at_type == ATR_TYPE_LONG)
+    {
+    snprintf(buf, sizeof(buf), "%ld", attr.at_val.at_long);
+    ds = buf;
+    }
   return(0);
   }
 
@@ -534,3 +545,8 @@ int check_default_gpu_mode_str(pbs_attribute *pattr, void *pobj, int mode)
   {
   return(PBSE_NONE);
   }
+
+int check_accounting_format_str(pbs_attribute *pattr, void *pobj, int mode)
+  {
+  return(PBSE_NONE);
+  }
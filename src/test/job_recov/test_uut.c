@@ -15,6 +15,10 @@
 #include "completed_jobs_map.h"
 #include "server.h"
 #include "array.h"
+#include "job_journal.hpp"
+#include "job_image.h"
+#include <fcntl.h>
+#include <sys/time.h>
 
 sem_t *job_clone_semaphore;
 extern int set_nodes_attr(job *pjob);
@@ -452,6 +456,235 @@ START_TEST(test_job_recover)
   }
 END_TEST
 
+START_TEST(test_journaled_state)
+  {
+  const char *journal = "/tmp/unit_test_job_journal";
+  const char *jobid = "unit_test_job2";
+  extern job_journal server_job_journal;
+
+  unlink(journal);
+  fail_unless(replay_job_journal(journal) == 0);
+  fail_unless(open_job_journal() == PBSE_NONE);
+
+  job *pj = create_a_job(jobid);
+  pj->ji_qs.ji_state = JOB_STATE_RUNNING;
+  pj->ji_qs.ji_substate = JOB_SUBSTATE_RUNNING;
+  pj->ji_wattr[JOB_ATR_etime].at_val.at_long = 1234;
+  pj->ji_wattr[JOB_ATR_etime].at_flags |= ATR_VFLAG_SET;
+  fail_unless(journal_job_state(pj) == PBSE_NONE);
+  server_job_journal.close();
+
+  fail_unless(replay_job_journal(journal) == 1);
+
+  job *recov_pj = create_a_job(jobid);
+  recov_pj->ji_qs.ji_state = JOB_STATE_QUEUED;
+  apply_journaled_state(recov_pj);
+  fail_unless(recov_pj->ji_qs.ji_state == JOB_STATE_RUNNING);
+  fail_unless(recov_pj->ji_qs.ji_substate == JOB_SUBSTATE_RUNNING);
+  fail_unless(recov_pj->ji_wattr[JOB_ATR_substate].at_val.at_long == JOB_SUBSTATE_RUNNING);
+  fail_unless(recov_pj->ji_wattr[JOB_ATR_etime].at_val.at_long == 1234);
+
+  unlink(journal);
+  }
+END_TEST
+
+/*
+ * A hold set just before a quick save has to survive a restart, even though
+ * the quick save only journals the job's state.
+ */
+
+START_TEST(test_quick_save_keeps_modified_attributes)
+  {
+  const char *journal = "/tmp/unit_test_job_journal";
+  const char *jobid = "unit_test_job5";
+  char        jobFileName[MAXPATHLEN];
+  extern job_journal server_job_journal;
+
+  unlink(journal);
+  fail_unless(replay_job_journal(journal) == 0);
+  fail_unless(open_job_journal() == PBSE_NONE);
+
+  job *pj = create_a_job(jobid);
+  pj->ji_qs.qs_version = PBS_QS_VERSION;
+  snprintf(pj->ji_qs.ji_fileprefix, sizeof(pj->ji_qs.ji_fileprefix), "%s", jobid);
+  snprintf(jobFileName, sizeof(jobFileName), "%s%s", jobid, JOB_FILE_SUFFIX);
+  fail_unless(job_save(pj, SAVEJOB_FULL, 0) == PBSE_NONE);
+
+  // what req_holdjob() does for a checkpointed running job
+  pj->ji_modified = 0;
+  pj->ji_wattr[JOB_ATR_hold].at_val.at_long |= HOLD_s;
+  pj->ji_wattr[JOB_ATR_hold].at_flags |= ATR_VFLAG_SET;
+  pj->ji_qs.ji_svrflags |= JOB_SVFLG_CHECKPOINT_FILE;
+  pj->ji_modified = 1;
+  fail_unless(job_save(pj, SAVEJOB_QUICK, 0) == PBSE_NONE);
+
+  // restart
+  server_job_journal.close();
+  replay_job_journal(journal);
+
+  job *recov_pj = job_recov(jobFileName);
+  fail_unless(recov_pj != NULL);
+  fail_unless((recov_pj->ji_wattr[JOB_ATR_hold].at_val.at_long & HOLD_s) != 0);
+  fail_unless((recov_pj->ji_qs.ji_svrflags & JOB_SVFLG_CHECKPOINT_FILE) != 0);
+
+  unlink(jobFileName);
+  unlink(journal);
+  }
+END_TEST
+
+START_TEST(test_job_image_recover)
+  {
+  char        jobFileName[MAXPATHLEN];
+  char        log_buf[1024];
+  const char *jobid = "unit_test_job3";
+  std::string image;
+  int         fd;
+
+  job *pj = create_a_job(jobid);
+  fail_unless(pj != NULL, "unable to create a job");
+  pj->ji_qs.qs_version = PBS_QS_VERSION;
+  snprintf(jobFileName, sizeof(jobFileName), "/tmp/%s.JB", jobid);
+  fail_unless(save_job_image(pj, jobFileName) == PBSE_NONE);
+
+  job *recov_pj = job_recov(jobFileName);
+  fail_unless(recov_pj != NULL);
+  fail_unless(job_compare(pj, recov_pj) == 0, "jobs (saved & recovered) did not compare the same");
+
+  // an XML job file isn't an image
+  fail_unless(saveJobToXML(pj, jobFileName) == PBSE_NONE);
+  recov_pj = job_alloc();
+  fail_unless(job_recov_image(jobFileName, &recov_pj, log_buf, sizeof(log_buf)) == PBSE_INVALID_SYNTAX);
+
+  // a damaged image is rejected rather than partially recovered
+  fail_unless(encode_job_image(pj, image) == PBSE_NONE);
+  image[image.size() - 1] ^= 0xff;
+  fd = open(jobFileName, O_WRONLY | O_TRUNC);
+  fail_unless(fd >= 0);
+  fail_unless(write(fd, image.data(), image.size()) == (ssize_t)image.size());
+  close(fd);
+  fail_unless(job_recov_image(jobFileName, &recov_pj, log_buf, sizeof(log_buf)) == -1);
+
+  // so is a truncated one
+  fail_unless(truncate(jobFileName, image.size() / 2) == 0);
+  fail_unless(job_recov_image(jobFileName, &recov_pj, log_buf, sizeof(log_buf)) == -1);
+
+  unlink(jobFileName);
+  }
+END_TEST
+
+
+/*
+ * A job recovered from its image must be the same job the XML file gives
+ * back, including after the image has been rewritten in place.
+ */
+
+START_TEST(test_job_image_matches_xml)
+  {
+  char        jobFileName[MAXPATHLEN];
+  char        log_buf[1024];
+  const char *jobid = "unit_test_job4";
+  std::string xml_image;
+  std::string recov_image;
+  job        *xml_pj;
+  job        *image_pj;
+
+  job *pj = create_a_job(jobid);
+  fail_unless(pj != NULL, "unable to create a job");
+  pj->ji_qs.qs_version = PBS_QS_VERSION;
+  snprintf(jobFileName, sizeof(jobFileName), "/tmp/%s.JB", jobid);
+
+  fail_unless(saveJobToXML(pj, jobFileName) == PBSE_NONE);
+  xml_pj = job_alloc();
+  fail_unless(job_recov_xml(jobFileName, &xml_pj, log_buf, sizeof(log_buf)) == PBSE_NONE);
+
+  for (int i = 0; i < 3; i++)
+    fail_unless(save_job_image(pj, jobFileName) == PBSE_NONE);
+  image_pj = job_alloc();
+  fail_unless(job_recov_image(jobFileName, &image_pj, log_buf, sizeof(log_buf)) == PBSE_NONE);
+
+  fail_unless(job_compare(xml_pj, image_pj) == 0, "image and XML recovery did not compare the same");
+  fail_unless(encode_job_image(xml_pj, xml_image) == PBSE_NONE);
+  fail_unless(encode_job_image(image_pj, recov_image) == PBSE_NONE);
+  fail_unless(xml_image == recov_image);
+
+  delete xml_pj;
+  delete image_pj;
+  unlink(jobFileName);
+  }
+END_TEST
+
+double elapsed(
+
+  struct timeval &start)
+
+  {
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+
+  return((now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1000000.0);
+  }
+
+
+/*
+ * Compares save and recover throughput of the binary job image against the
+ * XML job file it replaces. Only run by make bench, see the suite below.
+ */
+
+START_TEST(test_job_image_throughput)
+  {
+  const int       iterations = 500;
+  char            jobFileName[MAXPATHLEN];
+  char            log_buf[1024];
+  const char     *jobid = "unit_test_job4";
+  struct timeval  start;
+  double          xml_save;
+  double          xml_recov;
+  double          image_save;
+  double          image_recov;
+
+  job *pj = create_a_job(jobid);
+  fail_unless(pj != NULL, "unable to create a job");
+  snprintf(jobFileName, sizeof(jobFileName), "/tmp/%s.JB", jobid);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < iterations; i++)
+    fail_unless(saveJobToXML(pj, jobFileName) == PBSE_NONE);
+  xml_save = elapsed(start);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < iterations; i++)
+    {
+    job *recov_pj = job_alloc();
+    fail_unless(job_recov_xml(jobFileName, &recov_pj, log_buf, sizeof(log_buf)) == PBSE_NONE);
+    delete recov_pj;
+    }
+  xml_recov = elapsed(start);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < iterations; i++)
+    fail_unless(save_job_image(pj, jobFileName) == PBSE_NONE);
+  image_save = elapsed(start);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < iterations; i++)
+    {
+    job *recov_pj = job_alloc();
+    fail_unless(job_recov_image(jobFileName, &recov_pj, log_buf, sizeof(log_buf)) == PBSE_NONE);
+    delete recov_pj;
+    }
+  image_recov = elapsed(start);
+
+  printf("job file throughput (jobs/sec): xml save %.0f recover %.0f, image save %.0f recover %.0f\n",
+    iterations / xml_save,
+    iterations / xml_recov,
+    iterations / image_save,
+    iterations / image_recov);
+
+  unlink(jobFileName);
+  }
+END_TEST
+
 Suite *job_recov_suite(void)
   {
   Suite *s = suite_create("job_recov_suite methods");
@@ -468,8 +701,24 @@ Suite *job_recov_suite(void)
   tc_core = tcase_create("test_moar");
   tcase_add_test(tc_core, test_set_array_jobs_ids);
   tcase_add_test(tc_core, test_decode_attribute);
+  tcase_add_test(tc_core, test_journaled_state);
+  tcase_add_test(tc_core, test_quick_save_keeps_modified_attributes);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_job_image");
+  tcase_add_test(tc_core, test_job_image_recover);
+  tcase_add_test(tc_core, test_job_image_matches_xml);
   suite_add_tcase(s, tc_core);
 
+  // timing runs are opt-in (make bench in src/test) so make check stays quiet
+  if (getenv("TORQUE_UT_BENCHMARKS") != NULL)
+    {
+    tc_core = tcase_create("benchmarks");
+    tcase_add_test(tc_core, test_job_image_throughput);
+    tcase_set_timeout(tc_core, 300);
+    suite_add_tcase(s, tc_core);
+    }
+
   return s;
   }
 
@@ -28,6 +28,7 @@ int             MOMNvidiaDriverVersion    = 0;
 int             use_nvidia_gpu = TRUE;
 #endif  /* NVIDIA_GPUS */
 
+int              MOMPipelinedRadixLaunch = 0;
 std::list<job *> alljobs_list;
 int              is_reporter_mom = FALSE;
 int              is_login_node   = FALSE;
@@ -674,5 +675,6 @@ bool authorized_hosts::is_authorized(unsigned long addr)
 void authorized_hosts::list_authorized_hosts(std::string &output) {}
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
 
@@ -157,6 +157,34 @@ END_TEST
 
 
 
+START_TEST(handle_im_join_job_radix_error_test)
+  {
+  job                *pjob = (job *)calloc(1, sizeof(job));
+  struct sockaddr_in  psock;
+
+  memset(&psock, 0, sizeof(psock));
+
+  /* only mother superior and intermediate moms send join requests on */
+  pjob->ji_nodeid = 3;
+  fail_unless(handle_im_join_job_radix_error(pjob, PBSE_BADUSER, &psock) == IM_FAILURE);
+  fail_unless(pjob->ji_radix_join_errors == 1);
+
+  /* an intermediate mom passes the first failure up the radix */
+  pjob->ji_radix_join_errors = 0;
+  pjob->ji_im_nodeid = 1;
+  pjob->ji_sisters = (hnodent *)calloc(3, sizeof(hnodent));
+  pjob->ji_sisters[0].hn_host = strdup("parent");
+  fail_unless(handle_im_join_job_radix_error(pjob, PBSE_BADUSER, &psock) == IM_DONE);
+  fail_unless(pjob->ji_radix_join_errors == 1);
+
+  /* and only counts the rest */
+  fail_unless(handle_im_join_job_radix_error(pjob, PBSE_BADUSER, &psock) == IM_DONE);
+  fail_unless(pjob->ji_radix_join_errors == 2);
+  }
+END_TEST
+
+
+
 START_TEST(handle_im_poll_job_response_test)
   {
   job             *pjob = (job *)calloc(1, sizeof(job));
@@ -611,6 +639,10 @@ Suite *mom_comm_suite(void)
   tcase_add_test(tc_core, create_contact_list_test);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("handle_im_join_job_radix_error_test");
+  tcase_add_test(tc_core, handle_im_join_job_radix_error_test);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("im_join_job_as_sister_test");
   tcase_add_test(tc_core, im_join_job_as_sister_test);
   tcase_add_test(tc_core, handle_im_poll_job_response_test);
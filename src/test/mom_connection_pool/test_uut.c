@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+#include "mom_connection_pool.hpp"
+
+
+
+START_TEST(test_checkout_checkin)
+  {
+  mom_connection_pool pool(2, 60);
+
+  fail_unless(pool.checkout(1, 15002) == -1);
+
+  fail_unless(pool.checkin(1, 15002, 5, 100) == true);
+  fail_unless(pool.checkin(1, 15002, 6, 101) == true);
+  // the cap is per mom
+  fail_unless(pool.checkin(1, 15002, 7, 102) == false);
+  fail_unless(pool.checkin(2, 15002, 8, 102) == true);
+  fail_unless(pool.checkin(1, 15003, 9, 102) == true);
+  fail_unless(pool.idle_count(1, 15002) == 2);
+
+  // most recently used first
+  fail_unless(pool.checkout(1, 15002) == 6);
+  fail_unless(pool.checkout(1, 15002) == 5);
+  fail_unless(pool.checkout(1, 15002) == -1);
+  fail_unless(pool.checkout(2, 15002) == 8);
+  fail_unless(pool.checkout(1, 15003) == 9);
+
+  fail_unless(pool.checkin(1, 15002, -1, 100) == false);
+  }
+END_TEST
+
+
+START_TEST(test_disabled)
+  {
+  mom_connection_pool pool(0, 60);
+
+  fail_unless(pool.checkin(1, 15002, 5, 100) == false);
+  fail_unless(pool.checkout(1, 15002) == -1);
+  }
+END_TEST
+
+
+START_TEST(test_evict_idle)
+  {
+  mom_connection_pool pool(4, 60);
+  std::vector<int>    evicted;
+
+  pool.checkin(1, 15002, 5, 100);
+  pool.checkin(1, 15002, 6, 150);
+  pool.checkin(2, 15002, 7, 120);
+
+  pool.evict_idle(159, evicted);
+  fail_unless(evicted.size() == 0);
+
+  pool.evict_idle(180, evicted);
+  fail_unless(evicted.size() == 2);
+  fail_unless(evicted[0] == 5);
+  fail_unless(evicted[1] == 7);
+  fail_unless(pool.idle_count(1, 15002) == 1);
+  fail_unless(pool.idle_count(2, 15002) == 0);
+  fail_unless(pool.checkout(1, 15002) == 6);
+  }
+END_TEST
+
+
+START_TEST(test_purge)
+  {
+  mom_connection_pool pool(4, 60);
+  std::vector<int>    evicted;
+
+  pool.checkin(1, 15002, 5, 100);
+  pool.checkin(1, 15002, 6, 100);
+  pool.checkin(2, 15002, 7, 100);
+
+  pool.purge(1, 15002, evicted);
+  fail_unless(evicted.size() == 2);
+  fail_unless(pool.checkout(1, 15002) == -1);
+  fail_unless(pool.checkout(2, 15002) == 7);
+
+  evicted.clear();
+  pool.purge(3, 15002, evicted);
+  fail_unless(evicted.size() == 0);
+  }
+END_TEST
+
+
+Suite *mom_connection_pool_suite(void)
+  {
+  Suite *s = suite_create("mom_connection_pool test suite methods");
+  TCase *tc_core = tcase_create("test_checkout_checkin");
+  tcase_add_test(tc_core, test_checkout_checkin);
+  suite_add_tcase(s, tc_core);
+  
+  tc_core = tcase_create("test_disabled");
+  tcase_add_test(tc_core, test_disabled);
+  suite_add_tcase(s, tc_core);
+  
+  tc_core = tcase_create("test_evict_idle");
+  tcase_add_test(tc_core, test_evict_idle);
+  suite_add_tcase(s, tc_core);
+  
+  tc_core = tcase_create("test_purge");
+  tcase_add_test(tc_core, test_purge);
+  suite_add_tcase(s, tc_core);
+  
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(mom_connection_pool_suite());
+  srunner_set_log(sr, "mom_connection_pool_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
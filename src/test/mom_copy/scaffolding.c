@@ -0,0 +1 @@
+#include "license_pbs.h" /* See here for the software license */
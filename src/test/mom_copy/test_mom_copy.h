@@ -0,0 +1,8 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _MOM_COPY_CT_H
+#define _MOM_COPY_CT_H
+#include <check.h>
+
+Suite *mom_copy_suite();
+
+#endif /* _MOM_COPY_CT_H */
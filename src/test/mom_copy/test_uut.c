@@ -0,0 +1,239 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "pbs_error.h"
+#include "mom_copy.h"
+#include "test_mom_copy.h"
+
+char test_dir[] = "./mom_copy_test";
+
+
+void write_file(
+
+  const char *path,
+  const char *contents,
+  mode_t      mode)
+
+  {
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+
+  fail_unless(fd >= 0);
+  fail_unless(write(fd, contents, strlen(contents)) == (ssize_t)strlen(contents));
+  close(fd);
+  chmod(path, mode);
+  }
+
+
+std::string read_file(
+
+  const char *path)
+
+  {
+  char        buf[1024];
+  int         fd = open(path, O_RDONLY);
+  ssize_t     amt;
+  std::string contents;
+
+  if (fd < 0)
+    return(contents);
+
+  while ((amt = read(fd, buf, sizeof(buf))) > 0)
+    contents.append(buf, amt);
+
+  close(fd);
+
+  return(contents);
+  }
+
+
+void setup_test_dir()
+
+  {
+  system("rm -rf ./mom_copy_test");
+  mkdir(test_dir, 0755);
+  mkdir("./mom_copy_test/dest", 0755);
+  }
+
+
+START_TEST(test_can_copy_in_process)
+  {
+  setup_test_dir();
+  write_file("./mom_copy_test/file", "x", 0644);
+  symlink("file", "./mom_copy_test/link");
+
+  fail_unless(can_copy_in_process("./mom_copy_test/file") == true);
+  fail_unless(can_copy_in_process("./mom_copy_test/dest") == false);
+  fail_unless(can_copy_in_process("./mom_copy_test/link") == false);
+  fail_unless(can_copy_in_process("./mom_copy_test/missing") == false);
+  }
+END_TEST
+
+
+START_TEST(test_copy_file_in_process)
+  {
+  std::string     err;
+  struct stat     src_stat;
+  struct stat     dest_stat;
+  struct timespec times[2];
+
+  setup_test_dir();
+  write_file("./mom_copy_test/out", "job output\n", 0640);
+
+  memset(times, 0, sizeof(times));
+  times[0].tv_sec = 1000000000;
+  times[1].tv_sec = 1000000000;
+  utimensat(AT_FDCWD, "./mom_copy_test/out", times, 0);
+
+  fail_unless(copy_file_in_process("./mom_copy_test/out", "./mom_copy_test/out.copy", err) == 0, err.c_str());
+  fail_unless(read_file("./mom_copy_test/out.copy") == "job output\n");
+
+  stat("./mom_copy_test/out", &src_stat);
+  stat("./mom_copy_test/out.copy", &dest_stat);
+  fail_unless((dest_stat.st_mode & 07777) == 0640);
+  fail_unless(dest_stat.st_mtime == src_stat.st_mtime);
+
+  // an existing destination is overwritten
+  write_file("./mom_copy_test/out.copy", "a much longer file that was here before\n", 0600);
+  fail_unless(copy_file_in_process("./mom_copy_test/out", "./mom_copy_test/out.copy", err) == 0, err.c_str());
+  fail_unless(read_file("./mom_copy_test/out.copy") == "job output\n");
+
+  // a directory destination gets the source's name
+  fail_unless(copy_file_in_process("./mom_copy_test/out", "./mom_copy_test/dest", err) == 0, err.c_str());
+  fail_unless(read_file("./mom_copy_test/dest/out") == "job output\n");
+
+  // an empty file
+  write_file("./mom_copy_test/empty", "", 0644);
+  fail_unless(copy_file_in_process("./mom_copy_test/empty", "./mom_copy_test/empty.copy", err) == 0, err.c_str());
+  fail_unless(stat("./mom_copy_test/empty.copy", &dest_stat) == 0);
+  fail_unless(dest_stat.st_size == 0);
+  }
+END_TEST
+
+
+START_TEST(test_copy_file_in_process_errors)
+  {
+  std::string err;
+
+  setup_test_dir();
+  write_file("./mom_copy_test/out", "job output\n", 0644);
+
+  fail_unless(copy_file_in_process("./mom_copy_test/missing", "./mom_copy_test/x", err) == ENOENT);
+  fail_unless(err.find("./mom_copy_test/missing") != std::string::npos);
+
+  err.clear();
+  fail_unless(copy_file_in_process("./mom_copy_test/out", "./mom_copy_test/nodir/x", err) == ENOENT);
+  fail_unless(err.size() > 0);
+
+  // copying a file onto itself must not truncate it
+  err.clear();
+  fail_unless(copy_file_in_process("./mom_copy_test/out", "./mom_copy_test/out", err) == EINVAL);
+  fail_unless(err.find("same file") != std::string::npos);
+  fail_unless(read_file("./mom_copy_test/out") == "job output\n");
+
+  fail_unless(copy_file_in_process("./mom_copy_test/out", "./mom_copy_test", err) == EINVAL);
+  fail_unless(read_file("./mom_copy_test/out") == "job output\n");
+  }
+END_TEST
+
+
+START_TEST(test_run_copy_tasks)
+  {
+  std::vector<copy_task>   copies(20);
+  std::vector<copy_task *> tasks;
+  char                     path[256];
+  char                     contents[256];
+
+  setup_test_dir();
+
+  for (unsigned int i = 0; i < copies.size(); i++)
+    {
+    snprintf(path, sizeof(path), "./mom_copy_test/stage.%u", i);
+    snprintf(contents, sizeof(contents), "file %u\n", i);
+
+    copies[i].src = path;
+    copies[i].dest = "./mom_copy_test/dest";
+    copies[i].rc = -1;
+    copies[i].attempts = 0;
+
+    // one file that can't be copied
+    if (i != 7)
+      write_file(path, contents, 0644);
+
+    tasks.push_back(&copies[i]);
+    }
+
+  run_copy_tasks(tasks, 4);
+
+  for (unsigned int i = 0; i < copies.size(); i++)
+    {
+    snprintf(path, sizeof(path), "./mom_copy_test/dest/stage.%u", i);
+    snprintf(contents, sizeof(contents), "file %u\n", i);
+
+    if (i == 7)
+      {
+      // missing files aren't retried
+      fail_unless(copies[i].rc == ENOENT);
+      fail_unless(copies[i].attempts == 1);
+      fail_unless(copies[i].err.size() > 0);
+      }
+    else
+      {
+      fail_unless(copies[i].rc == 0, copies[i].err.c_str());
+      fail_unless(copies[i].attempts == 1);
+      fail_unless(read_file(path) == contents);
+      }
+    }
+
+  // an empty list is fine
+  tasks.clear();
+  run_copy_tasks(tasks, 4);
+
+  system("rm -rf ./mom_copy_test");
+  }
+END_TEST
+
+
+Suite *mom_copy_suite(void)
+  {
+  Suite *s = suite_create("mom_copy_suite methods");
+  TCase *tc_core = tcase_create("test_can_copy_in_process");
+  tcase_add_test(tc_core, test_can_copy_in_process);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_copy_file_in_process");
+  tcase_add_test(tc_core, test_copy_file_in_process);
+  tcase_add_test(tc_core, test_copy_file_in_process_errors);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_run_copy_tasks");
+  tcase_add_test(tc_core, test_run_copy_tasks);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(mom_copy_suite());
+  srunner_set_log(sr, "mom_copy_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
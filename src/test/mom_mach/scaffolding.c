@@ -66,6 +66,7 @@ void *get_next_return_value = NULL;
 int      memory_pressure_threshold = 0; /* 0: off, >0: check and kill */
 short    memory_pressure_duration  = 0; /* 0: off, >0: check and kill */
 int      MOMConfigUseSMT           = 1; /* 0: off, 1: on */
+int      MOMCgroupSampling         = 1;
 #endif
 
 int trq_cg_get_task_stats(
@@ -101,6 +102,10 @@ const char *nullproc(struct rm_attribute *attrib)
 
 struct rm_attribute *momgetattr(char *str)
   {
+  /* only the "no more attributes" answer is mocked */
+  if (str == NULL)
+    return(NULL);
+
   fprintf(stderr, "The call to rm_attribute needs to be mocked!!\n");
   exit(1);
   }
@@ -348,6 +353,57 @@ int trq_cg_get_task_memory_stats(
   return(0);
   }
 
+int trq_cg_get_job_cput_stats(
+
+  const char         *job_id,
+  unsigned long long &cput_used)
+
+  {
+  return(0);
+  }
+
+int trq_cg_get_job_memory_stats(
+
+  const char         *job_id,
+  unsigned long long &mem_used)
+
+  {
+  return(0);
+  }
+
+int trq_cg_get_job_pids(
+
+  const char         *job_id,
+  bool                task_cgroups,
+  std::vector<pid_t> &pids)
+
+  {
+  return(0);
+  }
+
+int proc_connector_start(void)
+  {
+  return(-1);
+  }
+
+void proc_connector_stop(void) {}
+
+bool connector_tracking = false;
+
+int proc_connector_get_job_pids(const job_pid_set_t &job_sids, pid2jobsid_map_t &job_pids)
+  {
+  /* when tracking, no process belongs to a job */
+  if (connector_tracking == true)
+    return(PBSE_NONE);
+
+  return(-1);
+  }
+
+int proc_connector_get_session_pids(pid_t sid, std::vector<pid_t> &pids)
+  {
+  return(-1);
+  }
+
 void free_pwnam(
 
   struct passwd *pwdp,
@@ -10,6 +10,7 @@
 #include "test_mom_mach.h"
 #include "pbs_job.h"
 #include "pbs_error.h"
+#include "resmon.h" /* rm_attribute */
 
 std::string cg_memory_path;
 
@@ -32,6 +33,11 @@ extern pid2procarrayindex_map_t pid2procarrayindex_map;
 extern proc_stat_t   *proc_array;
 
 extern void *get_next_return_value;
+extern bool  connector_tracking;
+extern char *ret_string;
+
+const char *pids(struct rm_attribute *attrib);
+int mom_get_sample(void);
 
 START_TEST(test_get_job_sid_from_pid)
   { 
@@ -446,6 +452,47 @@ START_TEST(test_mem_sum)
   }
 END_TEST
 
+/*
+ * A connector (or cgroup) sample only holds job processes, so it would
+ * leave out everything else on the node. The rm queries about the node or
+ * an arbitrary session must still see every process.
+ */
+
+START_TEST(test_node_queries_after_job_sample)
+  {
+  struct rm_attribute  attrib;
+  char                 session[32];
+  char                 pid[32];
+  const char          *result;
+  static char          pid_list[65536];
+
+  ret_string = pid_list;
+  global_job_sid_set.clear();
+  connector_tracking = true;
+
+  snprintf(session, sizeof(session), "%d", (int)getsid(0));
+  snprintf(pid, sizeof(pid), "%d ", (int)getpid());
+  attrib.a_qualifier = (char *)"session";
+  attrib.a_value = session;
+
+  for (int sample = 0; sample < 2; sample++)
+    {
+    fail_unless(mom_get_sample() == PBSE_NONE);
+
+    // no jobs, so the sample itself is empty, but this process is in its session
+    fail_unless((result = pids(&attrib)) != NULL);
+    fail_unless(strstr(result, pid) != NULL, "%s not in '%s'", pid, result);
+
+    // asked again within the same sample
+    fail_unless((result = pids(&attrib)) != NULL);
+    fail_unless(strstr(result, pid) != NULL);
+    }
+
+  connector_tracking = false;
+  }
+END_TEST
+
+
 Suite *mom_mach_suite(void)
   {
   Suite *s = suite_create("mom_mach_suite methods");
@@ -484,6 +531,10 @@ Suite *mom_mach_suite(void)
   tcase_add_test(tc_core, test_mem_sum);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_node_queries_after_job_sample");
+  tcase_add_test(tc_core, test_node_queries_after_job_sample);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
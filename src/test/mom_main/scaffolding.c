@@ -586,6 +586,11 @@ void log_roll(int max_depth)
   exit(1);
   }
 
+int index_attr_defs(attribute_def *attr_def, int limit)
+  {
+  return(0);
+  }
+
 int init_resc_defs(void)
   {
   fprintf(stderr, "The call to init_resc_defs needs to be mocked!!\n");
@@ -610,6 +615,13 @@ long log_size(void)
   exit(1);
   }
 
+void log_set_roll_limits(long max_size, int roll_depth) {}
+
+int log_async_init(void)
+  {
+  return(0);
+  }
+
 int task_save(task *ptask)
   {
   fprintf(stderr, "The call to task_save needs to be mocked!!\n");
@@ -1135,4 +1147,5 @@ void authorized_hosts::list_authorized_hosts(std::string &output) {}
 void authorized_hosts::add_authorized_address(unsigned long addr, unsigned short port, const std::string &hostname) {}
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
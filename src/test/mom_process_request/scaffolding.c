@@ -287,5 +287,6 @@ bool authorized_hosts::is_authorized(unsigned long addr)
   }
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
 
@@ -142,9 +142,21 @@ const char *reqgres(struct rm_attribute *attrib)
   return NULL;
   }
 
+std::vector<int> tcp_replies;
+std::vector<int> tcp_reply_commands;
+
 int read_tcp_reply(struct tcp_chan *chan, int protocol, int version, int command, int *exit_status)
   {
   *exit_status = DIS_SUCCESS;
+
+  tcp_reply_commands.push_back(command);
+
+  if (tcp_replies.size() > 0)
+    {
+    *exit_status = tcp_replies[0];
+    tcp_replies.erase(tcp_replies.begin());
+    }
+
   return *exit_status; 
   }
 
@@ -466,4 +478,34 @@ void authorized_hosts::add_authorized_address(unsigned long addr, unsigned short
 void authorized_hosts::clear() {}
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
+
+int diswul(tcp_chan *chan, unsigned long value)
+  {
+  return DIS_SUCCESS;
+  }
+
+void get_status_delta(
+
+  const std::vector<std::string> &base,
+  const std::vector<std::string> &current,
+  std::vector<unsigned int>      &changed)
+
+  {
+  for (unsigned int i = 0; i < current.size(); i++)
+    {
+    if ((i >= base.size()) ||
+        (base[i] != current[i]))
+      changed.push_back(i);
+    }
+  }
+
+int write_status_batch(
+
+  struct tcp_chan                       *chan,
+  const std::vector<status_batch_entry> &entries)
+
+  {
+  return(DIS_SUCCESS);
+  }
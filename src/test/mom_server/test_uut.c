@@ -31,6 +31,8 @@ extern int    UpdateFailCount;
 extern time_t LastServerUpdateTime;
 extern int    is_reporter_mom;
 extern mom_server mom_servers[PBS_MAXSERVER];
+extern std::vector<int> tcp_replies;
+extern std::vector<int> tcp_reply_commands;
 
 bool is_for_this_host(std::string gpu_spec, const char *suffix);
 void get_device_indices(const char *gpu_str, std::vector<unsigned int> &gpu_indices, const char *suffix);
@@ -163,6 +165,54 @@ START_TEST(test_mom_server_update_stat_clear_force)
 END_TEST
 
 
+START_TEST(test_mom_server_update_stat_delta)
+  {
+  ServerStatUpdateInterval = 45;
+  std::vector<std::string> status(4, "Think of a status line");
+  mom_server pms;
+  strncpy(pms.pbs_servername, "test", PBS_MAXSERVERNAME);
+  is_reporter_mom = false;
+  time_now = time(NULL);
+
+  // the first update is always full
+  pms.MOMLastSendToServerTime = 0;
+  tcp_reply_commands.clear();
+  fail_unless(mom_server_update_stat(&pms, status) == PBSE_NONE);
+  fail_unless(tcp_reply_commands.size() == 1);
+  fail_unless(tcp_reply_commands[0] == IS_STATUS_DELTA);
+  fail_unless(pms.status_generation == 1);
+  fail_unless(pms.last_full_status == time_now);
+  fail_unless(pms.acked_status.size() >= status.size() + 1);
+  fail_unless(!strncmp(pms.acked_status[0].c_str(), "node=", 5));
+
+  // a server that lost our last status gets it again in full
+  pms.MOMLastSendToServerTime = 0;
+  tcp_reply_commands.clear();
+  tcp_replies.push_back(IS_STATUS_BASE_UNKNOWN);
+  fail_unless(mom_server_update_stat(&pms, status) == PBSE_NONE);
+  fail_unless(tcp_reply_commands.size() == 2);
+  fail_unless(tcp_reply_commands[1] == IS_STATUS_DELTA);
+  fail_unless(pms.status_generation == 2);
+
+  // a server that doesn't know deltas gets the old message for a while
+  pms.MOMLastSendToServerTime = 0;
+  tcp_reply_commands.clear();
+  tcp_replies.push_back(UNREAD_STATUS);
+  fail_unless(mom_server_update_stat(&pms, status) == PBSE_NONE);
+  fail_unless(tcp_reply_commands.size() == 2);
+  fail_unless(tcp_reply_commands[1] == IS_STATUS);
+  fail_unless(pms.status_generation == 0);
+  fail_unless(pms.status_delta_retry == time_now + STATUS_DELTA_RETRY_INTERVAL);
+
+  pms.MOMLastSendToServerTime = 0;
+  tcp_reply_commands.clear();
+  fail_unless(mom_server_update_stat(&pms, status) == PBSE_NONE);
+  fail_unless(tcp_reply_commands.size() == 1);
+  fail_unless(tcp_reply_commands[0] == IS_STATUS);
+  }
+END_TEST
+
+
 START_TEST(test_send_update_force_flag)
   {
   first_update_time = 0;
@@ -280,6 +330,10 @@ Suite *mom_server_suite(void)
   tcase_add_test(tc_core, test_mom_server_update_stat_clear_force);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_mom_server_update_stat_delta");
+  tcase_add_test(tc_core, test_mom_server_update_stat_delta);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_send_update_force_flag");
   tcase_add_test(tc_core, test_send_update_force_flag);
   suite_add_tcase(s, tc_core);
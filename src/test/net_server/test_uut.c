@@ -9,6 +9,7 @@
 #include <string>
 #include <errno.h>
 #include <string.h>
+#include <sys/socket.h>
 
 
 #include "server_limits.h"
@@ -20,6 +21,7 @@ extern bool  socket_connect_success;
 extern bool  socket_write_success;
 extern bool  socket_read_success;
 extern bool  socket_read_code;
+extern char *net_server_name;
 
 int add_connection(int sock, enum conn_type type, pbs_net_t addr, unsigned int port, unsigned int socktype, void *(*func)(void *), int add_wait_request);
 void *accept_conn(void *new_conn);
@@ -146,6 +148,47 @@ START_TEST(test_check_trqauthd_unix_domain_port)
 END_TEST
 
 
+int ready_sock = -1;
+
+void *record_ready_sock(void *args)
+  {
+  ready_sock = ((int *)args)[0];
+  return(NULL);
+  }
+
+START_TEST(test_wait_request)
+  {
+  int sv[2];
+
+  net_server_name = strdup("napali");
+  fail_unless(init_network(0, record_ready_sock) == PBSE_NONE);
+  fail_unless(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+  fail_unless(add_conn(sv[0], FromClientDIS, 0, 0, PBS_SOCK_UNIX, record_ready_sock) == PBSE_NONE);
+
+  // nothing to read yet
+  fail_unless(wait_request(0, NULL) == PBSE_NONE);
+  fail_unless(ready_sock == -1);
+
+  fail_unless(write(sv[1], "x", 1) == 1);
+  fail_unless(wait_request(1, NULL) == PBSE_NONE);
+  fail_unless(ready_sock == sv[0]);
+
+  // sockets taken out of the global set must not be reported
+  ready_sock = -1;
+  globalset_del_sock(sv[0]);
+  fail_unless(wait_request(0, NULL) == PBSE_NONE);
+  fail_unless(ready_sock == -1);
+
+  globalset_add_sock(sv[0], 0, 0);
+  fail_unless(wait_request(1, NULL) == PBSE_NONE);
+  fail_unless(ready_sock == sv[0]);
+
+  close_conn(sv[0], FALSE);
+  close(sv[1]);
+  }
+END_TEST
+
+
 Suite *net_server_suite(void)
   {
   Suite *s = suite_create("net_server_suite methods");
@@ -169,6 +212,10 @@ Suite *net_server_suite(void)
   tcase_add_test(tc_core, test_check_trqauthd_unix_domain_port);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_wait_request");
+  tcase_add_test(tc_core, test_wait_request);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
@@ -597,4 +597,18 @@ bool authorized_hosts::remove_address(unsigned long addr, unsigned short port)
   }
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
+
+void update_free_node_index(struct pbsnode *pnode) {}
+
+void remove_from_free_node_index(struct pbsnode *pnode) {}
+
+void record_node_state(struct pbsnode *pnode) {}
+void forget_node_state(const char *node_name) {}
+void forget_received_status(const char *node_name) {}
+
+int read_node_states(std::map<std::string, int> &states)
+  {
+  return(0);
+  }
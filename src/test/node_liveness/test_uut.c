@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+#include "node_liveness.hpp"
+
+
+START_TEST(test_pop_quiet_since)
+  {
+  node_liveness_tracker    nlt;
+  std::vector<std::string> quiet;
+
+  nlt.heard_from("napali", 100);
+  nlt.heard_from("waimea", 200);
+  nlt.heard_from("lihue", 300);
+  fail_unless(nlt.size() == 3);
+
+  fail_unless(nlt.pop_quiet_since(100, quiet) == 0);
+
+  // a fresh report moves a node to the back
+  nlt.heard_from("napali", 400);
+  fail_unless(nlt.size() == 3);
+
+  fail_unless(nlt.pop_quiet_since(301, quiet) == 2);
+  fail_unless(quiet.size() == 2);
+  fail_unless(quiet[0] == "waimea");
+  fail_unless(quiet[1] == "lihue");
+  fail_unless(nlt.size() == 1);
+
+  // popped nodes are gone until they are heard from again
+  quiet.clear();
+  fail_unless(nlt.pop_quiet_since(301, quiet) == 0);
+
+  nlt.heard_from("lihue", 250);
+  fail_unless(nlt.pop_quiet_since(500, quiet) == 2);
+  fail_unless(quiet[0] == "lihue");
+  fail_unless(quiet[1] == "napali");
+  fail_unless(nlt.size() == 0);
+  }
+END_TEST
+
+
+START_TEST(test_forget)
+  {
+  node_liveness_tracker    nlt;
+  std::vector<std::string> quiet;
+
+  nlt.heard_from("napali", 100);
+  nlt.heard_from("waimea", 100);
+  nlt.forget("napali");
+  nlt.forget("nosuchnode");
+  fail_unless(nlt.size() == 1);
+
+  fail_unless(nlt.pop_quiet_since(200, quiet) == 1);
+  fail_unless(quiet[0] == "waimea");
+  }
+END_TEST
+
+
+Suite *node_liveness_suite(void)
+  {
+  Suite *s = suite_create("node_liveness test suite methods");
+  TCase *tc_core = tcase_create("test_pop_quiet_since");
+  tcase_add_test(tc_core, test_pop_quiet_since);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_forget");
+  tcase_add_test(tc_core, test_forget);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(node_liveness_suite());
+  srunner_set_log(sr, "node_liveness_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
@@ -23,6 +23,7 @@
 #include "complete_req.hpp"
 #include "json/json.h"
 #include "authorized_hosts.hpp"
+#include "free_node_index.hpp"
 
 
 bool cray_enabled;
@@ -130,6 +131,11 @@ int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *t
   return(0);
   }
 
+int enqueue_threadpool_request_lane(void *(*func)(void *), void *arg, threadpool_t *tp, enum tp_lane lane)
+  {
+  return(0);
+  }
+
 struct pbsnode *find_nodebyname(const char *nodename)
   {
   static struct pbsnode bob;
@@ -197,6 +203,11 @@ void svr_disconnect(int handle)
   return;
   }
 
+void close_pooled_mom_connections(pbs_net_t hostaddr, unsigned int port)
+  {
+  return;
+  }
+
 struct pbsnode *next_host(all_nodes *an, all_nodes_iterator **iter, struct pbsnode *held)
   {
   fprintf(stderr, "The call to next_host needs to be mocked!!\n");
@@ -1091,4 +1102,50 @@ pbsnode *authorized_hosts::get_authorized_node(unsigned long addr, unsigned shor
   }
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
+
+const std::vector<std::string> &pbsnode::get_properties() const
+  {
+  return(this->nd_properties);
+  }
+
+free_node_index::free_node_index() {}
+free_node_index::~free_node_index() {}
+void free_node_index::update(int node_id, bool available, int free_slots, int free_gpus, const std::vector<std::string> &properties) {}
+void free_node_index::mark_unindexable(int node_id) {}
+void free_node_index::remove(int node_id) {}
+bool free_node_index::is_usable() {return(false);}
+
+int free_node_index::get_candidates(int min_slots, int min_gpus, const std::vector<std::string> &properties, std::set<int> &candidates)
+  {
+  return(0);
+  }
+
+#include "node_liveness.hpp"
+#include "node_state_file.hpp"
+
+node_liveness_tracker::node_liveness_tracker() {}
+node_liveness_tracker::~node_liveness_tracker() {}
+void node_liveness_tracker::heard_from(const char *node_name, time_t when) {}
+void node_liveness_tracker::forget(const char *node_name) {}
+
+int node_liveness_tracker::pop_quiet_since(time_t cutoff, std::vector<std::string> &quiet)
+  {
+  return(0);
+  }
+
+node_state_file::node_state_file() {}
+node_state_file::~node_state_file() {}
+void node_state_file::set_path(const char *path) {}
+void node_state_file::record(const char *node_name, int state) {}
+
+int node_state_file::load(std::map<std::string, int> &states)
+  {
+  return(0);
+  }
+
+int node_state_file::flush()
+  {
+  return(0);
+  }
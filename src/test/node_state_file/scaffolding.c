@@ -0,0 +1,4 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+void log_err(int errnum, const char *routine, const char *text) {}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "node_state_file.hpp"
+#include "pbs_error.h"
+#include "pbs_nodes.h"
+#include <check.h>
+
+const char *test_path = "./node_state_test";
+
+
+int count_lines(
+
+  const char *path)
+
+  {
+  FILE *f = fopen(path, "r");
+  char  buf[256];
+  int   lines = 0;
+
+  if (f == NULL)
+    return(-1);
+
+  while (fgets(buf, sizeof(buf), f) != NULL)
+    lines++;
+
+  fclose(f);
+
+  return(lines);
+  }
+
+
+START_TEST(test_append_and_load)
+  {
+  node_state_file            nsf;
+  node_state_file            reader;
+  std::map<std::string, int> states;
+
+  unlink(test_path);
+  nsf.set_path(test_path);
+  reader.set_path(test_path);
+
+  // no file yet
+  fail_unless(nsf.load(states) == PBSE_NONE);
+  fail_unless(states.size() == 0);
+
+  nsf.record("napali", INUSE_OFFLINE);
+  nsf.record("waimea", INUSE_OFFLINE);
+  fail_unless(nsf.flush() == PBSE_NONE);
+  fail_unless(count_lines(test_path) == 2);
+
+  // unchanged states aren't written again, a cleared one is appended
+  nsf.record("napali", INUSE_OFFLINE);
+  nsf.record("waimea", 0);
+  nsf.record("lihue", 0);
+  fail_unless(nsf.flush() == PBSE_NONE);
+  fail_unless(count_lines(test_path) == 3);
+  fail_unless(nsf.get_record_count() == 3);
+
+  // the last record for each node wins
+  fail_unless(reader.load(states) == PBSE_NONE);
+  fail_unless(states.size() == 1);
+  fail_unless(states["napali"] == INUSE_OFFLINE);
+  fail_unless(reader.get_record_count() == 3);
+
+  unlink(test_path);
+  }
+END_TEST
+
+
+START_TEST(test_compact)
+  {
+  node_state_file            nsf;
+  std::map<std::string, int> states;
+
+  unlink(test_path);
+  nsf.set_path(test_path);
+  nsf.load(states);
+
+  nsf.record("napali", INUSE_OFFLINE);
+  nsf.flush();
+
+  // toggling one node grows the file until it is compacted
+  for (int i = 0; i < NODE_STATE_COMPACT_MIN_RECORDS; i++)
+    {
+    nsf.record("waimea", INUSE_OFFLINE);
+    nsf.record("waimea", 0);
+    nsf.flush();
+    }
+
+  fail_unless(nsf.get_record_count() <= NODE_STATE_COMPACT_MIN_RECORDS + 2);
+  fail_unless(count_lines(test_path) == (int)nsf.get_record_count());
+
+  fail_unless(nsf.compact() == PBSE_NONE);
+  fail_unless(count_lines(test_path) == 1);
+
+  fail_unless(nsf.load(states) == PBSE_NONE);
+  fail_unless(states.size() == 1);
+  fail_unless(states["napali"] == INUSE_OFFLINE);
+
+  unlink(test_path);
+  }
+END_TEST
+
+
+Suite *node_state_file_suite(void)
+  {
+  Suite *s = suite_create("node_state_file test suite methods");
+  TCase *tc_core = tcase_create("test_append_and_load");
+  tcase_add_test(tc_core, test_append_and_load);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_compact");
+  tcase_add_test(tc_core, test_compact);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(node_state_file_suite());
+  srunner_set_log(sr, "node_state_file_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
@@ -224,5 +224,6 @@ char *conf_res(char *resline, struct rm_attribute *attr)
 void authorized_hosts::add_authorized_address(unsigned long addr, unsigned short port, const std::string &hostname) {}
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
 
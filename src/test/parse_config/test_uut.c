@@ -10,9 +10,15 @@
 extern int encode_used_ctr;
 extern int encode_flagged_attrs_ctr;
 extern int MOMCudaVisibleDevices;
+extern int MOMCgroupSampling;
+extern int MOMPipelinedRadixLaunch;
+extern int stage_copy_threads;
 extern struct config *config_array;
 
 u_long setcudavisibledevices(const char *value);
+u_long setcgroupsampling(const char *value);
+u_long setpipelinedradixlaunch(const char *value);
+unsigned long setstagecopythreads(const char *);
 unsigned long setjobstarterprivileged(const char *);
 
 int jobstarter_privileged = 0;
@@ -32,6 +38,53 @@ START_TEST(test_setcudavisibledevices)
   }
 END_TEST
 
+START_TEST(test_setcgroupsampling)
+  {
+  fail_unless(MOMCgroupSampling == 1, "cgroup_sampling should default to on");
+
+  fail_unless(setcgroupsampling("false") == 1);
+  fail_unless(MOMCgroupSampling == 0, "did not turn cgroup_sampling off");
+
+  fail_unless(setcgroupsampling("bogus") == 1);
+  fail_unless(MOMCgroupSampling == 0, "an invalid value changed cgroup_sampling");
+
+  fail_unless(setcgroupsampling("true") == 1);
+  fail_unless(MOMCgroupSampling == 1, "did not turn cgroup_sampling on");
+  }
+END_TEST
+
+START_TEST(test_setpipelinedradixlaunch)
+  {
+  fail_unless(MOMPipelinedRadixLaunch == 0, "pipelined_radix_launch should default to off");
+
+  fail_unless(setpipelinedradixlaunch("true") == 1);
+  fail_unless(MOMPipelinedRadixLaunch == 1, "did not turn pipelined_radix_launch on");
+
+  fail_unless(setpipelinedradixlaunch("bogus") == 1);
+  fail_unless(MOMPipelinedRadixLaunch == 1, "an invalid value changed pipelined_radix_launch");
+
+  fail_unless(setpipelinedradixlaunch("false") == 1);
+  fail_unless(MOMPipelinedRadixLaunch == 0, "did not turn pipelined_radix_launch off");
+  }
+END_TEST
+
+START_TEST(test_setstagecopythreads)
+  {
+  fail_unless(stage_copy_threads == 4, "stage_copy_threads should default to 4");
+
+  fail_unless(setstagecopythreads("8") == 1);
+  fail_unless(stage_copy_threads == 8);
+
+  fail_unless(setstagecopythreads("0") == 1);
+  fail_unless(stage_copy_threads == 0, "0 should turn in-process copies off");
+
+  fail_unless(setstagecopythreads("-1") == 0);
+  fail_unless(setstagecopythreads("two") == 0);
+  fail_unless(setstagecopythreads("1000") == 0);
+  fail_unless(stage_copy_threads == 0, "an invalid value changed stage_copy_threads");
+  }
+END_TEST
+
 START_TEST(test_setjobstarterprivileged)
   {
   fail_unless(setjobstarterprivileged("") == 1);
@@ -87,6 +140,18 @@ Suite *parse_config_suite(void)
   tcase_add_test(tc_core, test_setcudavisibledevices);
   suite_add_tcase(s, tc_core);
   
+  tc_core = tcase_create("test_setcgroupsampling");
+  tcase_add_test(tc_core, test_setcgroupsampling);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_setpipelinedradixlaunch");
+  tcase_add_test(tc_core, test_setpipelinedradixlaunch);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_setstagecopythreads");
+  tcase_add_test(tc_core, test_setstagecopythreads);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_setjobstarterprivileged");
   tcase_add_test(tc_core, test_setjobstarterprivileged);
   suite_add_tcase(s, tc_core);
@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <unistd.h>
+#include <limits.h>
 
 #include <string>
 
@@ -94,6 +96,77 @@ START_TEST(test_two)
   }
 END_TEST
 
+START_TEST(test_async_log)
+  {
+  char          dir[] = "/tmp/pbs_log_testXXXXXX";
+  char          path[PATH_MAX];
+  char          rolled[PATH_MAX];
+  char          buf[64];
+  char          line[1024];
+  FILE         *fp;
+  int           continued = 0;
+  int           last = -1;
+  bool          in_order = true;
+
+  fail_unless(mkdtemp(dir) != NULL);
+  snprintf(path, sizeof(path), "%s/log", dir);
+  snprintf(rolled, sizeof(rolled), "%s/log.1", dir);
+
+  pthread_mutex_lock(&log_mutex);
+  fail_unless(log_open(path, dir) == 0);
+  pthread_mutex_unlock(&log_mutex);
+
+  /* a tiny queue so producers have to wait on the writer */
+  fail_unless(log_async_start(4, LOG_FULL_BLOCK) == PBSE_NONE);
+
+  for (int i = 0; i < 200; i++)
+    {
+    snprintf(buf, sizeof(buf), "record %d\nsecond line", i);
+    log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, "test", buf);
+    }
+
+  log_async_stop();
+
+  fail_unless((fp = fopen(path, "r")) != NULL);
+
+  while (fgets(line, sizeof(line), fp) != NULL)
+    {
+    char *pos;
+
+    if (strstr(line, ";test;[continued]second line") != NULL)
+      continued++;
+    else if ((pos = strstr(line, ";test;record ")) != NULL)
+      {
+      int num = atoi(pos + strlen(";test;record "));
+
+      if (num != last + 1)
+        in_order = false;
+
+      last = num;
+      }
+    }
+
+  fclose(fp);
+
+  fail_unless(continued == 200, "%d continued lines", continued);
+  fail_unless(last == 199);
+  fail_unless(in_order == true);
+
+  /* without the writer thread the size check happens right away */
+  log_set_roll_limits(1, 1);
+  fail_unless(access(rolled, F_OK) == 0);
+  log_set_roll_limits(0, 1);
+
+  pthread_mutex_lock(&log_mutex);
+  log_close(1);
+  pthread_mutex_unlock(&log_mutex);
+
+  unlink(path);
+  unlink(rolled);
+  rmdir(dir);
+  }
+END_TEST
+
 Suite *pbs_log_suite(void)
   {
   Suite *s = suite_create("pbs_log_suite methods");
@@ -103,6 +176,7 @@ Suite *pbs_log_suite(void)
 
   tc_core = tcase_create("test_two");
   tcase_add_test(tc_core, test_two);
+  tcase_add_test(tc_core, test_async_log);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -42,6 +42,7 @@ char *path_jobs;
 const char *msg_err_noqueue = "Unable to requeue job, queue is not defined";
 all_nodes allnodes;
 char *path_nodestate;
+char *path_job_journal;
 char *path_priv = NULL;
 const char *msg_init_exptjobs = "Expected %d, recovered %d jobs";
 const char *msg_daemonname = "unset";
@@ -92,7 +93,7 @@ const char *msg_init_unkstate = "Unable to recover job in strange substate: %d";
 all_jobs array_summary;
 attribute_def svr_attr_def[10];
 int a_opt_init = -1;
-std::list<timed_task>  *task_list_timed;
+std::vector<timed_task> *task_list_timed;
 pthread_mutex_t task_list_timed_mutex;
 char *path_jobinfo_log;
 int LOGLEVEL = 7; /* force logging code to be exercised as tests run */
@@ -152,6 +153,16 @@ int job_save(job *pjob, int updatetype, int mom_port)
   exit(1);
   }
 
+int replay_job_journal(const char *path)
+  {
+  return(0);
+  }
+
+int open_job_journal()
+  {
+  return(0);
+  }
+
 int svr_job_purge(job *pjob, int leaveSpoolFiles)
   {
   fprintf(stderr, "The call to job_purge needs to be mocked!!\n");
@@ -395,6 +406,12 @@ pbs_queue *que_recov_xml(char *filename)
   exit(1);
   }
 
+attribute_def node_attr_def[10];
+int index_attr_defs(attribute_def *attr_def, int limit)
+  {
+  return(0);
+  }
+
 int init_resc_defs(void)
   {
   fprintf(stderr, "The call to init_resc_defs needs to be mocked!!\n");
@@ -465,6 +482,11 @@ int acct_open(char *filename, bool acct_mutex_locked)
   exit(1);
   }
 
+int acct_writer_start(void)
+  {
+  return(0);
+  }
+
 void svr_evaljobstate(job &pjob, int &newstate, int &newsub, int forceeval)
   {
   evaluated++;
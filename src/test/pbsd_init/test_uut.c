@@ -9,6 +9,7 @@
 
 #include "pbs_error.h"
 #include "queue.h"
+#include <algorithm>
 
 int mk_subdirs(char **);
 int pbsd_init_reque(job *, int);
@@ -120,6 +121,73 @@ START_TEST(test_pbsd_init_reque)
   }
 END_TEST
 
+void count_item(
+
+  void   *data,
+  size_t  item)
+
+  {
+  std::vector<int> *seen = (std::vector<int> *)data;
+
+  // each item is claimed by exactly one thread
+  seen->at(item)++;
+  }
+
+
+START_TEST(test_run_recovery_pass)
+  {
+  std::vector<int> seen(1000, 0);
+  recovery_pass    pass;
+
+  memset(&pass, 0, sizeof(pass));
+  pass.stage = "test";
+  pass.count = seen.size();
+  pass.process = count_item;
+  pass.data = &seen;
+
+  run_recovery_pass(&pass, 8);
+
+  for (size_t i = 0; i < seen.size(); i++)
+    fail_unless(seen[i] == 1);
+
+  // nothing to do
+  pass.count = 0;
+  run_recovery_pass(&pass, 8);
+  }
+END_TEST
+
+
+START_TEST(test_scan_recovery_dirs)
+  {
+  std::vector<std::string> files;
+  int                      entries = 0;
+
+  fail_unless(system("rm -rf ./scan_test && mkdir -p ./scan_test/0 ./scan_test/7 && "
+                     "touch ./scan_test/1.napali.JB ./scan_test/.hidden ./scan_test/0/10.napali.JB "
+                     "./scan_test/7/17.napali.JB ./scan_test/7/27.napali.JB") == 0);
+
+  fail_unless(scan_recovery_dirs("./does_not_exist/", true, files, entries) != PBSE_NONE);
+
+  // the buckets are entries of their own without use_jobs_subdirs
+  fail_unless(scan_recovery_dirs("./scan_test/", false, files, entries) == PBSE_NONE);
+  fail_unless(files.size() == 3);
+  fail_unless(entries == 6);
+
+  fail_unless(scan_recovery_dirs("./scan_test/", true, files, entries) == PBSE_NONE);
+  fail_unless(files.size() == 4);
+  fail_unless(entries == 13);
+
+  std::sort(files.begin(), files.end());
+  fail_unless(files[0] == "./scan_test/0/10.napali.JB");
+  fail_unless(files[1] == "./scan_test/1.napali.JB");
+  fail_unless(files[2] == "./scan_test/7/17.napali.JB");
+  fail_unless(files[3] == "./scan_test/7/27.napali.JB");
+
+  fail_unless(system("rm -rf ./scan_test") == 0);
+  }
+END_TEST
+
+
 Suite *pbsd_init_suite(void)
   {
   Suite *s = suite_create("pbsd_init_suite methods");
@@ -135,6 +203,11 @@ Suite *pbsd_init_suite(void)
   tcase_add_test(tc_core, test_check_jobs_queue);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_recovery");
+  tcase_add_test(tc_core, test_run_recovery_pass);
+  tcase_add_test(tc_core, test_scan_recovery_dirs);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
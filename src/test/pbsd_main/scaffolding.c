@@ -276,6 +276,15 @@ long log_size(void)
   exit(1);
   }
 
+void log_set_roll_limits(long max_size, int roll_depth) {}
+
+int log_async_init(void)
+  {
+  return(0);
+  }
+
+void log_async_stop(void) {}
+
 void close_conn(int sd, int has_mutex)
   {
   fprintf(stderr, "The call to close_conn needs to be mocked!!\n");
@@ -387,6 +396,10 @@ int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *t
   return(0);
   }
 
+void log_threadpool_stats(threadpool_t *tp, const char *name) {}
+
+void log_hierarchy_fanin_stats() {}
+
 int set_svr_attr(int index, void *val)
   {
   return(0);
@@ -501,6 +514,23 @@ work_task *pop_timed_task(
   return(NULL);
   }
 
+int pop_timed_tasks(
+
+  time_t                    time_now,
+  std::vector<work_task *> &expired,
+  unsigned int              max_tasks)
+
+  {
+  return(0);
+  }
+
+void insert_timed_task(
+
+  work_task *wt)
+
+  {
+  }
+
 void *remove_extra_recycle_jobs(void *)
   {
   return(NULL);
@@ -519,3 +549,8 @@ void *remove_completed_jobs(void *vp) {return(NULL);}
 acl_special::acl_special() {}
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
+
+void close_idle_mom_connections(time_t now) {}
+
+void compact_job_journal() {}
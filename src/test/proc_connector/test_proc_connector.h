@@ -0,0 +1,7 @@
+#ifndef _PROC_CONNECTOR_CT_H
+#define _PROC_CONNECTOR_CT_H
+#include <check.h>
+
+Suite *proc_connector_suite();
+
+#endif /* _PROC_CONNECTOR_CT_H */
@@ -0,0 +1,240 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+
+#include <map>
+#include <vector>
+
+#include "pbs_config.h"
+#include "pbs_job.h"
+#include "pbs_error.h"
+#include "proc_connector.h"
+#include "test_proc_connector.h"
+
+int  parse_proc_ids(const char *buf, pid_t &ppid, pid_t &session);
+void proc_connector_track(pid_t pid, pid_t ppid, pid_t session);
+void handle_proc_event(struct proc_event *ev);
+void collect_job_pids(const job_pid_set_t &job_sids, pid2jobsid_map_t &job_pids);
+void collect_session_pids(pid_t sid, std::vector<pid_t> &pids);
+
+
+void send_fork(
+
+  pid_t parent,
+  pid_t child_pid,
+  pid_t child_tgid)
+
+  {
+  struct proc_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.what = proc_event::PROC_EVENT_FORK;
+  ev.event_data.fork.parent_pid = parent;
+  ev.event_data.fork.parent_tgid = parent;
+  ev.event_data.fork.child_pid = child_pid;
+  ev.event_data.fork.child_tgid = child_tgid;
+  handle_proc_event(&ev);
+  }
+
+
+void send_simple(
+
+  enum proc_event::what  what,
+  pid_t                  pid,
+  pid_t                  tgid)
+
+  {
+  struct proc_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.what = what;
+
+  if (what == proc_event::PROC_EVENT_SID)
+    {
+    ev.event_data.sid.process_pid = pid;
+    ev.event_data.sid.process_tgid = tgid;
+    }
+  else
+    {
+    ev.event_data.exit.process_pid = pid;
+    ev.event_data.exit.process_tgid = tgid;
+    }
+
+  handle_proc_event(&ev);
+  }
+
+
+START_TEST(test_parse_proc_ids)
+  {
+  pid_t ppid = 0;
+  pid_t session = 0;
+
+  fail_unless(parse_proc_ids("1234 (a (weird) name) S 10 20 30 0 -1 4194560 ", ppid, session) == PBSE_NONE);
+  fail_unless(ppid == 10);
+  fail_unless(session == 30);
+
+  fail_unless(parse_proc_ids("1234 no command name", ppid, session) != PBSE_NONE);
+  fail_unless(parse_proc_ids("1234 (truncated) S", ppid, session) != PBSE_NONE);
+  }
+END_TEST
+
+
+START_TEST(test_fork_joins_parents_job)
+  {
+  job_pid_set_t    job_sids;
+  pid2jobsid_map_t job_pids;
+
+  proc_connector_track(100, 50, 100);
+  proc_connector_track(300, 50, 300);
+
+  job_sids.insert(100);
+  collect_job_pids(job_sids, job_pids);
+  fail_unless(job_pids.size() == 1);
+  fail_unless(job_pids[100] == 100);
+
+  /* a new process inherits the job, a new thread isn't tracked at all */
+  send_fork(100, 101, 101);
+  send_fork(101, 102, 101);
+
+  job_pids.clear();
+  collect_job_pids(job_sids, job_pids);
+  fail_unless(job_pids.size() == 2);
+  fail_unless(job_pids[101] == 100);
+  fail_unless(job_pids.find(102) == job_pids.end());
+
+  /* processes outside the job's session and lineage stay out of it */
+  send_fork(300, 301, 301);
+
+  job_pids.clear();
+  collect_job_pids(job_sids, job_pids);
+  fail_unless(job_pids.size() == 2);
+  }
+END_TEST
+
+
+START_TEST(test_setsid_and_exit)
+  {
+  job_pid_set_t      job_sids;
+  pid2jobsid_map_t   job_pids;
+  std::vector<pid_t> pids;
+
+  proc_connector_track(100, 50, 100);
+  send_fork(100, 101, 101);
+  send_fork(101, 102, 102);
+
+  job_sids.insert(100);
+  job_sids.insert(200);
+  collect_job_pids(job_sids, job_pids);
+
+  /* a job process that starts its own session is still part of the job */
+  send_simple(proc_event::PROC_EVENT_SID, 101, 101);
+
+  /* 102 was forked before the setsid() so it stays in the old session */
+  collect_session_pids(100, pids);
+  fail_unless(pids.size() == 2);
+  fail_unless(pids[0] == 100);
+  fail_unless(pids[1] == 102);
+
+  pids.clear();
+  collect_session_pids(101, pids);
+  fail_unless(pids.size() == 1);
+  fail_unless(pids[0] == 101);
+
+  /* a thread exiting isn't the process exiting */
+  send_simple(proc_event::PROC_EVENT_EXIT, 103, 100);
+  send_simple(proc_event::PROC_EVENT_EXIT, 100, 100);
+
+  /* 101's parent is gone but it stays with its job while the job is around */
+  job_sids.erase(200);
+  job_pids.clear();
+  collect_job_pids(job_sids, job_pids);
+  fail_unless(job_pids.size() == 2, "expected 2 job pids, got %d", (int)job_pids.size());
+  fail_unless(job_pids.find(100) == job_pids.end());
+  fail_unless(job_pids[101] == 100);
+  fail_unless(job_pids[102] == 100);
+
+  /* and leaves it when the job does */
+  job_sids.clear();
+  job_pids.clear();
+  collect_job_pids(job_sids, job_pids);
+  fail_unless(job_pids.size() == 0);
+  }
+END_TEST
+
+
+START_TEST(test_fork_from_unknown_parent)
+  {
+  job_pid_set_t    job_sids;
+  pid2jobsid_map_t job_pids;
+  pid_t            me = getpid();
+
+  /* a parent we haven't seen: the child's ids come from /proc */
+  send_fork(getppid(), me, me);
+
+  job_sids.insert(getsid(0));
+  collect_job_pids(job_sids, job_pids);
+  fail_unless(job_pids.size() == 1);
+  fail_unless(job_pids[me] == getsid(0));
+  }
+END_TEST
+
+
+START_TEST(test_inactive_connector)
+  {
+  job_pid_set_t      job_sids;
+  pid2jobsid_map_t   job_pids;
+  std::vector<pid_t> pids;
+
+  /* without a listener the callers must scan /proc themselves */
+  fail_unless(proc_connector_active() == false);
+  fail_unless(proc_connector_get_job_pids(job_sids, job_pids) != PBSE_NONE);
+  fail_unless(proc_connector_get_session_pids(1, pids) != PBSE_NONE);
+  }
+END_TEST
+
+
+Suite *proc_connector_suite(void)
+  {
+  Suite *s = suite_create("proc_connector_suite methods");
+  TCase *tc_core = tcase_create("test_parse_proc_ids");
+  tcase_add_test(tc_core, test_parse_proc_ids);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_fork_joins_parents_job");
+  tcase_add_test(tc_core, test_fork_joins_parents_job);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_setsid_and_exit");
+  tcase_add_test(tc_core, test_setsid_and_exit);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_fork_from_unknown_parent");
+  tcase_add_test(tc_core, test_fork_from_unknown_parent);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_inactive_connector");
+  tcase_add_test(tc_core, test_inactive_connector);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(proc_connector_suite());
+  srunner_set_log(sr, "proc_connector_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
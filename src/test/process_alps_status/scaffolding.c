@@ -1914,3 +1914,4 @@ void Machine::setMemory(long long mem)
   }
 #endif
 
+void update_node_liveness(struct pbsnode *pnode) {}
@@ -125,6 +125,17 @@ int enqueue_threadpool_request(
   return(0);
   }
 
+int enqueue_threadpool_request_lane(
+
+  void *(*func)(void *),
+  void *arg,
+  threadpool_t *tp,
+  enum tp_lane lane)
+
+  {
+  return(0);
+  }
+
 int lock_node(
     
   struct pbsnode *the_node,
@@ -688,3 +699,7 @@ Machine::Machine(
 
 #endif
 
+
+void update_free_node_index(struct pbsnode *pnode) {}
+
+void update_node_liveness(struct pbsnode *pnode) {}
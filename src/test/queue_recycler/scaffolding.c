@@ -48,4 +48,15 @@ int enqueue_threadpool_request(
   return(0);
   }
 
+int enqueue_threadpool_request_lane(
+
+  void         *(*func)(void *),
+  void         *arg,
+  threadpool_t *tp,
+  enum tp_lane  lane)
+
+  {
+  return(0);
+  }
+
 
@@ -17,12 +17,18 @@
 #include "node_manager.h"
 #include "pbs_ifl.h"
 #include "authorized_hosts.hpp"
+#include "dis.h"
+
+#undef disrui
+#undef disrsi
 
 
 id_map      job_mapper;
 int         allow_any_mom;
 AvlTree     ipaddrs = NULL;
 int         LOGLEVEL;
+std::vector<unsigned long> dis_numbers;
+std::vector<std::string>   dis_strings;
 const char *dis_emsg[] =
   {
   "No error",
@@ -99,6 +105,17 @@ int enqueue_threadpool_request(
   return(0);
   }
 
+int enqueue_threadpool_request_lane(
+
+  void *(*func)(void *),
+  void *arg,
+  threadpool_t *tp,
+  enum tp_lane lane)
+
+  {
+  return(0);
+  }
+
 int lock_node(
     
   struct pbsnode *the_node,
@@ -124,7 +141,17 @@ unsigned long disrul(
   int *retval)  /* O */
 
   {
-  return(0);
+  unsigned long value = 0;
+
+  *retval = DIS_SUCCESS;
+
+  if (dis_numbers.size() > 0)
+    {
+    value = dis_numbers[0];
+    dis_numbers.erase(dis_numbers.begin());
+    }
+
+  return(value);
   }
 
 struct pbsnode *find_nodebyname(
@@ -191,7 +218,19 @@ char *disrst(
   int *retval)
 
   {
-  return(NULL);
+  char *value = NULL;
+
+  *retval = DIS_SUCCESS;
+
+  if (dis_strings.size() > 0)
+    {
+    value = strdup(dis_strings[0].c_str());
+    dis_strings.erase(dis_strings.begin());
+    }
+  else
+    *retval = DIS_EOD;
+
+  return(value);
   }
 
 long disrsl(
@@ -285,7 +324,7 @@ int disrsi(tcp_chan *channel, int *ret)
 
 int disrui(tcp_chan *channel, int *ret)
   {
-  return(PBSE_NONE);
+  return(disrul(channel, ret));
   }
 
                                                                                                                                            
@@ -933,4 +972,38 @@ pbsnode *authorized_hosts::get_authorized_node(unsigned long addr, unsigned shor
   }
 
 authorized_hosts::authorized_hosts() {}
+authorized_hosts::~authorized_hosts() {}
 authorized_hosts auth_hosts;
+
+int apply_status_delta(
+
+  std::vector<std::string>        &status,
+  unsigned int                     count,
+  const std::vector<unsigned int> &indexes,
+  const std::vector<std::string>  &values,
+  std::vector<bool>               &changed)
+
+  {
+  status.resize(count);
+  changed.assign(count, false);
+
+  for (unsigned int i = 0; i < indexes.size(); i++)
+    {
+    status[indexes[i]] = values[i];
+    changed[indexes[i]] = true;
+    }
+
+  return(PBSE_NONE);
+  }
+
+void update_node_liveness(struct pbsnode *pnode) {}
+
+int read_status_batch(
+
+  struct tcp_chan                 *chan,
+  std::vector<status_batch_entry> &entries)
+
+  {
+  entries.clear();
+  return(DIS_SUCCESS);
+  }
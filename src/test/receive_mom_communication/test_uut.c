@@ -3,9 +3,31 @@
 #include <check.h>
 #include "mom_update.h"
 #include "pbs_ifl.h"
+#include "net_connect.h"
+#include "dis.h"
+#include "mom_hierarchy.h"
 
 char server_name[PBS_MAXSERVERNAME+1] = "pv-knielson-dt";
 
+int read_status_delta(const char *node_name, struct tcp_chan *chan, std::vector<std::string> &status, std::vector<bool> &changed);
+int process_status_batch(const char *reporter, std::vector<status_batch_entry> &entries);
+void record_fanin_latency(unsigned int level, unsigned long age);
+void log_hierarchy_fanin_stats();
+void forget_received_status(const char *node_name);
+
+struct fanin_level_stats
+  {
+  unsigned long statuses;
+  unsigned long total_age;
+  unsigned long max_age;
+  };
+
+extern std::vector<fanin_level_stats> fanin_stats;
+extern unsigned long                  fanin_batches;
+
+extern std::vector<unsigned long> dis_numbers;
+extern std::vector<std::string>   dis_strings;
+
 
 START_TEST(test_one)
   {
@@ -15,8 +37,82 @@ END_TEST
 
 
 
-START_TEST(test_two)
+START_TEST(test_fanin_stats)
   {
+  std::vector<status_batch_entry> entries(1);
+
+  record_fanin_latency(2, 4);
+  record_fanin_latency(2, 10);
+  record_fanin_latency(1, 1);
+  fail_unless(fanin_stats.size() == 3);
+  fail_unless(fanin_stats[0].statuses == 0);
+  fail_unless(fanin_stats[2].statuses == 2);
+  fail_unless(fanin_stats[2].total_age == 14);
+  fail_unless(fanin_stats[2].max_age == 10);
+
+  // statuses for nodes we don't know are skipped
+  entries[0].statuses.push_back("node=unknown");
+  fail_unless(process_status_batch("napali", entries) == 0);
+  fail_unless(fanin_batches == 1);
+
+  log_hierarchy_fanin_stats();
+  fail_unless(fanin_stats.size() == 0);
+  fail_unless(fanin_batches == 0);
+  }
+END_TEST
+
+
+
+
+START_TEST(test_read_status_delta)
+  {
+  std::vector<std::string> status;
+  std::vector<bool>        changed;
+  unsigned long            full[] = { IS_STATUS_DELTA_VER, 0, 1, 2, 2, 0, 1 };
+  unsigned long            delta[] = { IS_STATUS_DELTA_VER, 1, 2, 2, 1, 0 };
+  unsigned long            stale[] = { IS_STATUS_DELTA_VER, 1, 3, 2, 0 };
+  unsigned long            same[] = { IS_STATUS_DELTA_VER, 2, 3, 2, 0 };
+
+  // a full status is a delta against generation 0
+  dis_numbers.assign(full, full + 7);
+  dis_strings.push_back("state=free");
+  dis_strings.push_back("ncpus=4");
+  fail_unless(read_status_delta("napali", NULL, status, changed) == DIS_SUCCESS);
+  fail_unless(status.size() == 2);
+  fail_unless(status[1] == "ncpus=4");
+
+  // generation 2 only carries the changed state
+  status.clear();
+  changed.clear();
+  dis_numbers.assign(delta, delta + 6);
+  dis_strings.push_back("state=busy");
+  fail_unless(read_status_delta("napali", NULL, status, changed) == DIS_SUCCESS);
+  fail_unless(status.size() == 2);
+  fail_unless(status[0] == "state=busy");
+  fail_unless(status[1] == "ncpus=4");
+  fail_unless(changed[0] == true);
+  fail_unless(changed[1] == false);
+
+  // generation 1 is no longer what we have
+  dis_numbers.assign(stale, stale + 5);
+  fail_unless(read_status_delta("napali", NULL, status, changed) == IS_STATUS_BASE_UNKNOWN);
+
+  // and we've never heard of this node
+  dis_numbers.assign(delta, delta + 6);
+  dis_strings.push_back("state=busy");
+  fail_unless(read_status_delta("waimea", NULL, status, changed) == IS_STATUS_BASE_UNKNOWN);
+  dis_strings.clear();
+
+  // a deleted node's status is dropped, so the mom has to start over
+  dis_numbers.assign(same, same + 5);
+  fail_unless(read_status_delta("napali", NULL, status, changed) == DIS_SUCCESS);
+  forget_received_status("napali");
+  dis_numbers.assign(same, same + 5);
+  fail_unless(read_status_delta("napali", NULL, status, changed) == IS_STATUS_BASE_UNKNOWN);
+
+  dis_numbers.clear();
+  dis_numbers.push_back(IS_STATUS_DELTA_VER + 1);
+  fail_unless(read_status_delta("napali", NULL, status, changed) == DIS_PROTO);
   }
 END_TEST
 
@@ -30,8 +126,9 @@ Suite *receive_mom_communication_suite(void)
   tcase_add_test(tc_core, test_one);
   suite_add_tcase(s, tc_core);
   
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_read_status_delta");
+  tcase_add_test(tc_core, test_read_status_delta);
+  tcase_add_test(tc_core, test_fanin_stats);
   suite_add_tcase(s, tc_core);
   
   return(s);
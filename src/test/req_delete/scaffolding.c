@@ -595,4 +595,13 @@ void job_array::update_array_values(
 
 void job_array::mark_deleted() {}
 
+int delete_uncreated_subjob(const char *job_id, batch_request *preq)
+  {
+  // 3[1].napali is an uncreated subjob, 3[2].napali belongs to someone else
+  if (strcmp(job_id, "3[1].napali") == 0)
+    return(PBSE_NONE);
+  else if (strcmp(job_id, "3[2].napali") == 0)
+    return(PBSE_PERM);
 
+  return(PBSE_UNKJOBID);
+  }
@@ -85,6 +85,21 @@ START_TEST(test_handle_single_delete)
   strcpy(preq->rq_ind.rq_delete.rq_objname, "1.napali");
   fail_unless(handle_single_delete(preq, preq, NULL) == PBSE_NONE);
   fail_unless(preq->rq_noreply == TRUE);
+
+  // uncreated subjobs are dropped without being created, and the duplicate is freed
+  batch_request *preq_tmp = (batch_request *)calloc(1, sizeof(batch_request));
+  preq->rq_noreply = FALSE;
+  br_freed = false;
+  strcpy(preq->rq_ind.rq_delete.rq_objname, "3[1].napali");
+  fail_unless(handle_single_delete(preq, preq_tmp, NULL) == PBSE_NONE);
+  fail_unless(preq->rq_noreply == FALSE);
+  fail_unless(br_freed == true);
+
+  br_freed = false;
+  strcpy(preq->rq_ind.rq_delete.rq_objname, "3[2].napali");
+  fail_unless(handle_single_delete(preq, NULL, NULL) == PBSE_NONE);
+  fail_unless(preq->rq_noreply == FALSE);
+  fail_unless(br_freed == false);
   }
 END_TEST
 
@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <string.h>
 
 #include "server.h" /* server */
 #include "batch_request.h" /* batch_request */
@@ -13,12 +14,18 @@
 const char *delpurgestr = DELPURGE;
 const char *msg_permlog = "Unauthorized Request, request type: %d, Object: %s, Name: %s, request from: %s@%s";
 struct server server;
+const int DEFAULT_IDLE_SLOT_LIMIT = 300;
 int LOGLEVEL = 7; /* force logging code to be exercised as tests run */
 
+int        range_rc = PBSE_NONE;
+int        whole_rc = PBSE_NONE;
+int        arrays_deleted = 0;
+int        acks = 0;
+job_array *array_to_find = NULL;
+
 int svr_authorize_req(struct batch_request *preq, char *owner, char *submit_host)
   {
-  fprintf(stderr, "The call to svr_authorize_req needs to be mocked!!\n");
-  exit(1);
+  return(0);
   }
 
 int has_job_delete_nanny(struct job *pjob)
@@ -53,8 +60,7 @@ pbs_queue *get_jobs_queue(job **pjob)
 
 void reply_ack(struct batch_request *preq)
   {
-  fprintf(stderr, "The call to reply_ack needs to be mocked!!\n");
-  exit(1);
+  acks++;
   }
 
 struct work_task *apply_job_delete_nanny(struct job *pjob, int delay)
@@ -65,7 +71,7 @@ struct work_task *apply_job_delete_nanny(struct job *pjob, int delay)
 
 int delete_array_range(job_array *pa, char *range_str, bool purge)
   {
-  return(PBSE_NONE);
+  return(range_rc);
   }
 
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *), void *parm, int get_lock)
@@ -76,7 +82,12 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 
 job_array *get_array(const char *id)
   {
-  return(NULL);
+  job_array *pa = array_to_find;
+
+  // the array is only found once; after that it has been deleted
+  array_to_find = NULL;
+
+  return(pa);
   }
 
 void req_reject(int code, int aux, struct batch_request *preq, const char *HostName, const char *Msg)
@@ -129,13 +140,12 @@ int insert_task(all_tasks *at, work_task *wt)
 
 void get_jobowner(char *from, char *to)
   {
-  fprintf(stderr, "The call to get_jobowner needs to be mocked!!\n");
-  exit(1);
+  strcpy(to, from);
   }
 
 int delete_whole_array(job_array *pa, bool purge)
   {
-  return(PBSE_NONE);
+  return(whole_rc);
   }
 
 job *svr_find_job(const char *jobid, int get_subjob)
@@ -148,6 +158,7 @@ int array_delete(
   const char *array_id)
 
   {
+  arrays_deleted++;
   return(0);
   }
 
@@ -202,3 +213,29 @@ void setup_apply_job_delete_nanny(
 
   {
   }
+
+array_info::array_info() : struct_version(ARRAY_QS_STRUCT_VERSION), array_size(0), num_jobs(0),
+                           slot_limit(NO_SLOT_LIMIT), jobs_running(0), jobs_done(0), num_cloned(0),
+                           num_started(0), num_failed(0), num_successful(0), num_purged(0),
+                           num_idle(0), deps(),
+                           idle_slot_limit(DEFAULT_IDLE_SLOT_LIMIT), highest_id_created(-1),
+                           range_str()
+
+  {
+  }
+
+array_info::~array_info() {}
+
+job_array::job_array() : job_ids(NULL), jobs_recovered(0), ai_ghost_recovered(false), uncreated_ids(),
+                         ai_mutex(NULL), ai_qs()
+
+  {
+  this->ai_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+  pthread_mutex_init(this->ai_mutex, NULL);
+  }
+
+job_array::~job_array()
+
+  {
+  free(this->ai_mutex);
+  }
@@ -3,30 +3,96 @@
 #include "test_req_deletearray.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "pbs_error.h"
-START_TEST(test_one)
+#include "array.h"
+#include "batch_request.h"
+
+extern int        range_rc;
+extern int        whole_rc;
+extern int        arrays_deleted;
+extern int        acks;
+extern job_array *array_to_find;
+
+/*
+ * when only uncreated subjobs were left, no subjob purge will ever remove the array, so
+ * it's deleted by the request itself whether or not it's a purge
+ */
+START_TEST(test_purge_array_with_no_created_subjobs)
   {
+  batch_request preq;
+  char          purge_ext[] = DELPURGE "1";
+  job_array    *pa = new job_array();
+
+  memset(&preq, 0, sizeof(preq));
+  strcpy(preq.rq_ind.rq_delete.rq_objname, "1[].napali");
+  preq.rq_extend = purge_ext;
+
+  array_to_find = pa;
+  whole_rc = NO_JOBS_IN_ARRAY;
+  arrays_deleted = 0;
+  acks = 0;
+
+  fail_unless(req_deletearray(&preq) == PBSE_NONE);
+  fail_unless(arrays_deleted == 1);
+  fail_unless(acks == 1);
 
+  // the same without purging
+  preq.rq_extend = NULL;
+  array_to_find = pa;
+  arrays_deleted = 0;
+  acks = 0;
 
+  fail_unless(req_deletearray(&preq) == PBSE_NONE);
+  fail_unless(arrays_deleted == 1);
+  fail_unless(acks == 1);
+
+  delete pa;
   }
 END_TEST
 
-START_TEST(test_two)
+START_TEST(test_purge_range_with_no_created_subjobs)
   {
+  batch_request preq;
+  char          range_ext[] = DELPURGE "1" ARRAY_RANGE "0-9";
+  job_array    *pa = new job_array();
+
+  memset(&preq, 0, sizeof(preq));
+  strcpy(preq.rq_ind.rq_delete.rq_objname, "1[].napali");
+  preq.rq_extend = range_ext;
+
+  array_to_find = pa;
+  range_rc = NO_JOBS_IN_ARRAY;
+  arrays_deleted = 0;
+  acks = 0;
+
+  fail_unless(req_deletearray(&preq) == PBSE_NONE);
+  fail_unless(arrays_deleted == 1);
+  fail_unless(acks == 1);
+
+  // created subjobs are left, so the array stays
+  array_to_find = pa;
+  range_rc = 0;
+  arrays_deleted = 0;
+  acks = 0;
 
+  fail_unless(req_deletearray(&preq) == PBSE_NONE);
+  fail_unless(arrays_deleted == 0);
+  fail_unless(acks == 1);
 
+  delete pa;
   }
 END_TEST
 
 Suite *req_deletearray_suite(void)
   {
   Suite *s = suite_create("req_deletearray_suite methods");
-  TCase *tc_core = tcase_create("test_one");
-  tcase_add_test(tc_core, test_one);
+  TCase *tc_core = tcase_create("test_purge_array_with_no_created_subjobs");
+  tcase_add_test(tc_core, test_purge_array_with_no_created_subjobs);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_purge_range_with_no_created_subjobs");
+  tcase_add_test(tc_core, test_purge_range_with_no_created_subjobs);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -52,6 +52,23 @@ int release_array_range(job_array *pa, struct batch_request *preq, char *range_s
   exit(1);
   }
 
+int release_uncreated_holds(job_array *pa, struct batch_request *preq, int start, int end)
+  {
+  return(0);
+  }
+
+int svr_authorize_req(struct batch_request *preq, char *owner, char *submit_host)
+  {
+  fprintf(stderr, "The call to svr_authorize_req to be mocked!!\n");
+  exit(1);
+  }
+
+void get_jobowner(char *from, char *to)
+  {
+  fprintf(stderr, "The call to get_jobowner to be mocked!!\n");
+  exit(1);
+  }
+
 job_array *get_array(const char *id)
   {
   fprintf(stderr, "The call to get_array to be mocked!!\n");
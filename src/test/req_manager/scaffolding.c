@@ -512,3 +512,5 @@ acl_special::acl_special() {}
 
 acl_special limited_acls;
 
+
+void update_free_node_index(struct pbsnode *pnode) {}
@@ -8,6 +8,7 @@
 #include "attribute.h"
 
 int check_default_gpu_mode_str(pbs_attribute *pattr, void *pobj, int actmode);
+int check_accounting_format_str(pbs_attribute *pattr, void *pobj, int actmode);
 extern int default_gpu_mode;
 
 START_TEST(test_check_default_gpu_mode_str)
@@ -44,6 +45,21 @@ START_TEST(test_check_default_gpu_mode_str)
   }
 END_TEST
 
+START_TEST(test_check_accounting_format_str)
+  {
+  pbs_attribute pattr;
+  pattr.at_flags |= ATR_VFLAG_SET;
+
+  pattr.at_val.at_str = strdup("text");
+  fail_unless(check_accounting_format_str(&pattr, NULL, ATR_ACTION_ALTER) == PBSE_NONE);
+  pattr.at_val.at_str = strdup("json");
+  fail_unless(check_accounting_format_str(&pattr, NULL, ATR_ACTION_ALTER) == PBSE_NONE);
+  pattr.at_val.at_str = strdup("xml");
+  fail_unless(check_accounting_format_str(&pattr, NULL, ATR_ACTION_ALTER) == PBSE_ATTRTYPE);
+  fail_unless(check_accounting_format_str(&pattr, NULL, ATR_ACTION_RECOV) == PBSE_NONE);
+  }
+END_TEST
+
 START_TEST(test_two)
   {
 
@@ -56,6 +72,7 @@ Suite *req_manager_suite(void)
   Suite *s = suite_create("req_manager_suite methods");
   TCase *tc_core = tcase_create("test_check_default_gpu_mode_str");
   tcase_add_test(tc_core, test_check_default_gpu_mode_str);
+  tcase_add_test(tc_core, test_check_accounting_format_str);
   suite_add_tcase(s, tc_core);
 
   tc_core = tcase_create("test_two");
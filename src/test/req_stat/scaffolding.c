@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <string.h>
 #include <pthread.h> /* pthread_mutex_t */
 
 #include "pbs_nodes.h" /* all_nodes, pbsnode */
@@ -156,8 +157,22 @@ int status_job(
   int           *bad) /* RETURN: index of first bad pbs_attribute */
 
   {
-  fprintf(stderr, "The call to status_job to be mocked!!\n");
-  exit(1);
+  // report the job as held so that callers can be seen to change the state
+  struct brp_status *pstat = (struct brp_status *)calloc(1, sizeof(struct brp_status));
+  svrattrl          *pattr = (svrattrl *)calloc(1, sizeof(svrattrl));
+
+  CLEAR_LINK(pstat->brp_stlink);
+  strcpy(pstat->brp_objname, pjob->ji_qs.ji_jobid);
+  CLEAR_HEAD(pstat->brp_attr);
+  append_link(pstathd, &pstat->brp_stlink, pstat);
+
+  CLEAR_LINK(pattr->al_link);
+  pattr->al_name = strdup(ATTR_state);
+  pattr->al_value = strdup("H");
+  pattr->al_valln = 2;
+  append_link(&pstat->brp_attr, &pattr->al_link, pattr);
+
+  return(PBSE_NONE);
   }
 
 int job_abt(struct job **pjobp, const char *text, bool b=false)
@@ -168,8 +183,12 @@ int job_abt(struct job **pjobp, const char *text, bool b=false)
 
 void *get_next(list_link pl, char *file, int line)
   {
-  fprintf(stderr, "The call to get_next to be mocked!!\n");
-  exit(1);
+  return(pl.ll_next->ll_struct);
+  }
+
+void *get_prior(list_link pl, char *file, int line)
+  {
+  return(pl.ll_prior->ll_struct);
   }
 
 int issue_Drequest(int conn, struct batch_request *request, bool close_handle)
@@ -204,8 +223,11 @@ void release_req(struct work_task *pwt)
 
 void append_link(tlist_head *head, list_link *new_link, void *pobj)
   {
-  fprintf(stderr, "The call to append_link to be mocked!!\n");
-  exit(1);
+  new_link->ll_struct = pobj;
+  new_link->ll_prior = head->ll_prior;
+  new_link->ll_next = head;
+  head->ll_prior->ll_next = new_link;
+  head->ll_prior = new_link;
   }
 
 pbs_queue *next_queue(all_queues *aq, all_queues_iterator *iter)
@@ -220,6 +242,12 @@ int svr_connect(pbs_net_t hostaddr, unsigned int port, int *err, struct pbsnode
   exit(1);
   }
 
+int svr_connect_pooled(pbs_net_t hostaddr, unsigned int port, int *err, struct pbsnode *pnode)
+  {
+  fprintf(stderr, "The call to svr_connect_pooled to be mocked!!\n");
+  exit(1);
+  }
+
 int is_array(char *id)
   {
   fprintf(stderr, "The call to is_array to be mocked!!\n");
@@ -368,3 +396,22 @@ bool pbsnode::hasprop(std::vector<prop> *needed) const
   {
   preply->brp_choice = type;
   }
+
+job_array *uncreated_array = NULL;
+long       uncreated_hold_mask = 0;
+
+job_array *get_uncreated_subjob_array(const char *job_id, int &index)
+  {
+  if ((uncreated_array == NULL) ||
+      (strchr(job_id, '[') == NULL))
+    return(NULL);
+
+  index = atoi(strchr(job_id, '[') + 1);
+
+  return(uncreated_array);
+  }
+
+long job_array::get_uncreated_holds(int index) const
+  {
+  return(uncreated_hold_mask);
+  }
@@ -3,12 +3,15 @@
 #include "test_req_stat.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "pbs_error.h"
 #include "array.h"
 
 bool in_execution_queue(job *pjob, job_array *pa);
 job *get_next_status_job(struct stat_cntl *cntl, int &job_array_index, job_array *pa, all_jobs_iterator *iter);
 extern int abort_called;
+extern job_array *uncreated_array;
+extern long       uncreated_hold_mask;
 
 enum TJobStatTypeEnum
   {
@@ -107,6 +110,45 @@ START_TEST(test_get_next_status_job)
 END_TEST
 
 
+START_TEST(test_status_uncreated_subjob)
+  {
+  job_array         *pa = (job_array *)calloc(1, sizeof(job_array));
+  batch_request      preq;
+  tlist_head         stathd;
+  struct brp_status *pstat;
+  svrattrl          *pattr;
+  int                bad = 0;
+
+  memset(&preq, 0, sizeof(preq));
+  strcpy(pa->ai_qs.parent_id, "1[].napali");
+  CLEAR_HEAD(stathd);
+
+  uncreated_array = NULL;
+  fail_unless(status_uncreated_subjob("1[5].napali", &preq, NULL, &stathd, false, &bad) == PBSE_UNKJOBID);
+  fail_unless(GET_NEXT(stathd) == NULL);
+
+  // reported from the template under the subjob's id, queued
+  uncreated_array = pa;
+  uncreated_hold_mask = 0;
+  fail_unless(status_uncreated_subjob("1[5].napali", &preq, NULL, &stathd, false, &bad) == PBSE_NONE);
+  pstat = (struct brp_status *)GET_PRIOR(stathd);
+  fail_unless(!strcmp(pstat->brp_objname, "1[5].napali"));
+  pattr = (svrattrl *)GET_NEXT(pstat->brp_attr);
+  fail_unless(!strcmp(pattr->al_value, "Q"));
+
+  // holds placed before the subjob was created show
+  uncreated_hold_mask = HOLD_u;
+  fail_unless(status_uncreated_subjob("1[6].napali", &preq, NULL, &stathd, false, &bad) == PBSE_NONE);
+  pstat = (struct brp_status *)GET_PRIOR(stathd);
+  fail_unless(!strcmp(pstat->brp_objname, "1[6].napali"));
+  pattr = (svrattrl *)GET_NEXT(pstat->brp_attr);
+  fail_unless(!strcmp(pattr->al_value, "H"));
+
+  uncreated_array = NULL;
+  }
+END_TEST
+
+
 Suite *req_stat_suite(void)
   {
   Suite *s = suite_create("req_stat_suite methods");
@@ -119,6 +161,10 @@ Suite *req_stat_suite(void)
   tcase_add_test(tc_core, test_get_next_status_job);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_status_uncreated_subjob");
+  tcase_add_test(tc_core, test_status_uncreated_subjob);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
@@ -24,6 +24,7 @@
 #include "power_state.hpp"
 #include "sys_file.hpp"
 #include "log.h"
+#include "mom_copy.h"
 
 char *apbasil_protocol;
 char *apbasil_path;
@@ -42,6 +43,7 @@ int cphosts_num = 0;
 struct var_table vtable; 
 char mom_host[PBS_MAXHOSTNAME + 1];
 int spoolasfinalname = 0;
+int stage_copy_threads = 0;
 char *path_spool = strdup("/var/spool/torque/spool/");
 unsigned int pbs_rm_port = 0;
 unsigned int alarm_time = 10;
@@ -536,3 +538,10 @@ int send_job_obit(job *pjob, int exit_status)
   {
   return(PBSE_NONE);
   }
+
+bool can_copy_in_process(const char *src)
+  {
+  return(false);
+  }
+
+void run_copy_tasks(std::vector<copy_task *> &tasks, int max_threads) {}
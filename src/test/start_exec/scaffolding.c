@@ -2,6 +2,7 @@
 #include <pbs_config.h>
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <string.h>
 #include <time.h> /* time_t */
 #include <pwd.h> /* struct passwd, gid_t, uid_t */
 #include <signal.h> /* sigset_t */
@@ -16,6 +17,7 @@
 #include "resource.h" /* resource_def */
 #include "pbs_ifl.h" /* PBS_MAXHOSTNAME, MAXPATHLEN */
 #include "list_link.h" /* tlist_head, list_link */
+#include "tcp.h" /* tcp_chan, tcpdisbuf */
 #include "resmon.h" /* TMAX_NSDCOUNT */
 #include "log.h" /* LOG_BUF_SIZE */
 #include "pbs_job.h" /* job, hnodent, pjobexec_t */
@@ -125,7 +127,36 @@ int create_job_cpuset(job * pj) { return 0; }
 int DIS_tcp_wflush (struct tcp_chan *chan) { return 0; }
 int move_to_job_cpuset(pid_t, job *) { return 0; }
 int diswsi(tcp_chan *chan, int i) { return 0; }
-int encode_DIS_svrattrl(tcp_chan *chan, svrattrl *s) { return 0; }
+int encode_svrattrl_calls = 0;
+
+int encode_DIS_svrattrl(tcp_chan *chan, svrattrl *s)
+  {
+  encode_svrattrl_calls++;
+
+  for (; s != NULL; s = (svrattrl *)GET_NEXT(s->al_link))
+    tcp_puts(chan, s->al_name, strlen(s->al_name));
+
+  return 0;
+  }
+
+int tcp_puts(struct tcp_chan *chan, const char *str, size_t ct)
+  {
+  struct tcpdisbuf *tp = &chan->writebuf;
+
+  if ((size_t)(tp->tdis_thebuf + tp->tdis_bufsize - tp->tdis_leadp) < ct)
+    return(-1);
+
+  memcpy(tp->tdis_leadp, str, ct);
+  tp->tdis_leadp += ct;
+
+  return(ct);
+  }
+
+int tcp_wcommit(struct tcp_chan *chan, int commit_flag)
+  {
+  chan->writebuf.tdis_trailp = chan->writebuf.tdis_leadp;
+  return(0);
+  }
 int im_compose(tcp_chan *chan, char *arg2, const char *a3, int a4, int a5, unsigned int a6) { return 0; }
 int create_alps_reservation(char *a1, char *a2, char *a3, char *a4, char *a5, long long a6, int a7, int a8, int a9, char **a10,const char *a11, std::string& cray_frequency) { return 0; }
 int mom_close_poll(void)
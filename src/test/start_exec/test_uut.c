@@ -12,6 +12,8 @@
 
 #include "pbs_error.h"
 #include "pbs_nodes.h"
+#include "tcp.h"
+#include "dis.h"
 #include "test_uut.h"
 
 int job_nodes(job &pjob);
@@ -40,6 +42,7 @@ extern bool fail_init_groups;
 extern bool fail_site_grp_check;
 extern bool am_ms;
 extern bool addr_fail;
+extern int  encode_svrattrl_calls;
 
 void create_command(std::string &cmd, char **argv);
 void no_hang(int sig);
@@ -375,6 +378,54 @@ int check_content(
   return PBSE_NONE;
   }
 
+START_TEST(test_write_join_job_attrs)
+  {
+  struct tcp_chan chan;
+  char            buf[256];
+  tlist_head      phead;
+  svrattrl        attr;
+  std::string     encoded;
+
+  memset(&chan, 0, sizeof(chan));
+  chan.writebuf.tdis_thebuf = buf;
+  chan.writebuf.tdis_leadp = buf;
+  chan.writebuf.tdis_trailp = buf;
+  chan.writebuf.tdis_bufsize = sizeof(buf);
+
+  memset(&attr, 0, sizeof(attr));
+  attr.al_name = (char *)"Job_Name";
+  CLEAR_HEAD(phead);
+  attr.al_link.ll_struct = &attr;
+  attr.al_link.ll_next = &phead;
+  attr.al_link.ll_prior = &phead;
+  phead.ll_next = &attr.al_link;
+  phead.ll_prior = &attr.al_link;
+
+  encode_svrattrl_calls = 0;
+
+  /* the first sister gets the attributes encoded */
+  fail_unless(write_join_job_attrs(&chan, &phead, encoded) == DIS_SUCCESS);
+  fail_unless(encode_svrattrl_calls == 1);
+  fail_unless(encoded == "Job_Name");
+
+  /* every other sister gets the same bytes without encoding them again */
+  strcpy(buf, "im_compose");
+  chan.writebuf.tdis_leadp = buf + strlen("im_compose");
+  chan.writebuf.tdis_trailp = chan.writebuf.tdis_leadp;
+
+  fail_unless(write_join_job_attrs(&chan, &phead, encoded) == DIS_SUCCESS);
+  fail_unless(encode_svrattrl_calls == 1);
+  fail_unless(chan.writebuf.tdis_leadp - buf == (int)strlen("im_composeJob_Name"));
+  fail_unless(chan.writebuf.tdis_trailp == chan.writebuf.tdis_leadp);
+  fail_unless(memcmp(buf, "im_composeJob_Name", strlen("im_composeJob_Name")) == 0);
+
+  /* not enough room for the attributes */
+  chan.writebuf.tdis_bufsize = strlen("im_compose") + 4;
+  chan.writebuf.tdis_leadp = buf + strlen("im_compose");
+  fail_unless(write_join_job_attrs(&chan, &phead, encoded) != DIS_SUCCESS);
+  }
+END_TEST
+
 START_TEST(test_bld_env_variables_no_realloc)
   {
   struct var_table vtable;
@@ -615,6 +666,10 @@ Suite *start_exec_suite(void)
   tcase_add_test(tc_core, test_bld_env_variables_realloc_all);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_write_join_job_attrs");
+  tcase_add_test(tc_core, test_write_join_job_attrs);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_get_indices_from_exec_str");
   tcase_add_test(tc_core, test_get_indices_from_exec_str);
   suite_add_tcase(s, tc_core);
@@ -129,12 +129,6 @@ resource_def svr_resc_def_const[] =
 resource_def *svr_resc_def = svr_resc_def_const;
 int svr_resc_size = sizeof(svr_resc_def_const) / sizeof(resource_def);
 
-svrattrl *attrlist_create(const char *aname, const char *rname, int vsize)
-  {
-  fprintf(stderr, "The call to attrlist_create to be mocked!!\n");
-  exit(1);
-  }
-
 int svr_authorize_jobreq(struct batch_request *preq, job *pjob)
   {
   fprintf(stderr, "The call to svr_authorize_jobreq to be mocked!!\n");
@@ -147,18 +141,6 @@ int find_attr(struct attribute_def *attr_def, const char *name, int limit)
   exit(1);
   }
 
-void *get_next(list_link pl, char *file, int line)
-  {
-  fprintf(stderr, "The call to get_next to be mocked!!\n");
-  exit(1);
-  }
-
-void append_link(tlist_head *head, list_link *new_link, void *pobj)
-  {
-  fprintf(stderr, "The call to append_link to be mocked!!\n");
-  exit(1);
-  }
-
 int get_svr_attr_l(int index, long *l)
   {
   return(0);
@@ -179,6 +161,9 @@ int remove_procct(
   return(0);
   }
 
+job::job() {}
+job::~job() {}
+
 void job::encode_plugin_resource_usage(
     
   tlist_head *phead) const
@@ -1,12 +1,46 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "pbs_error.h"
 #include "pbs_job.h"
 #include "test_stat_job.h"
 
 bool include_in_status(int index);
+job_status_cache *find_status_cache(job *pjob, int priv, int owner, bool condensed, time_t time_now);
+void save_status_cache(job *pjob, tlist_head *phead, int priv, int owner, bool condensed, time_t time_now);
+int copy_status_cache(job *pjob, job_status_cache *jsc, tlist_head *phead);
+
+
+void add_status_attr(
+
+  tlist_head *phead,
+  const char *name,
+  const char *resc,
+  const char *value)
+
+  {
+  svrattrl *pal = attrlist_create(name, resc, strlen(value) + 1);
+
+  strcpy(pal->al_value, value);
+  append_link(phead, &pal->al_link, pal);
+  }
+
+
+void free_status_attrs(
+
+  tlist_head *phead)
+
+  {
+  svrattrl *pal;
+
+  while ((pal = (svrattrl *)GET_NEXT(*phead)) != NULL)
+    {
+    delete_link(&pal->al_link);
+    free(pal);
+    }
+  }
 
 
 START_TEST(test_include_in_status)
@@ -37,10 +71,64 @@ START_TEST(test_include_in_status)
   }
 END_TEST
 
-START_TEST(test_two)
+START_TEST(test_status_cache)
   {
-
-
+  job         pjob;
+  tlist_head  encoded;
+  tlist_head  copied;
+  svrattrl   *pal;
+  time_t      time_now = time(NULL);
+
+  CLEAR_HEAD(encoded);
+  CLEAR_HEAD(copied);
+  memset(pjob.ji_wattr, 0, sizeof(pjob.ji_wattr));
+  pjob.ji_wattr[JOB_ATR_state].at_val.at_char = 'Q';
+
+  add_status_attr(&encoded, "Job_Name", NULL, "STDIN");
+  add_status_attr(&encoded, "Resource_List", "nodes", "2:ppn=4");
+  add_status_attr(&encoded, "Walltime", "Remaining", "100");
+
+  fail_unless(find_status_cache(&pjob, 1, 0, false, time_now) == NULL);
+  save_status_cache(&pjob, &encoded, 1, 0, false, time_now);
+  free_status_attrs(&encoded);
+
+  // other kinds of requests don't share the encoding
+  fail_unless(find_status_cache(&pjob, 1, 1, false, time_now) == NULL);
+  fail_unless(find_status_cache(&pjob, 1, 0, true, time_now) == NULL);
+  fail_unless(find_status_cache(&pjob, 1, 0, false, time_now) != NULL);
+
+  fail_unless(copy_status_cache(&pjob, find_status_cache(&pjob, 1, 0, false, time_now), &copied) == PBSE_NONE);
+  pal = (svrattrl *)GET_NEXT(copied);
+  fail_unless(pal != NULL);
+  fail_unless(!strcmp(pal->al_name, "Job_Name"));
+  fail_unless(pal->al_resc == NULL);
+  fail_unless(!strcmp(pal->al_value, "STDIN"));
+  pal = (svrattrl *)GET_NEXT(pal->al_link);
+  fail_unless(pal != NULL);
+  fail_unless(!strcmp(pal->al_name, "Resource_List"));
+  fail_unless(!strcmp(pal->al_resc, "nodes"));
+  fail_unless(!strcmp(pal->al_value, "2:ppn=4"));
+
+  // walltime remaining is recomputed, and the job isn't running
+  fail_unless(GET_NEXT(pal->al_link) == NULL);
+  free_status_attrs(&copied);
+
+  // expired entries are dropped
+  fail_unless(find_status_cache(&pjob, 1, 0, false, time_now + JOB_STATUS_CACHE_TTL) == NULL);
+  fail_unless(pjob.ji_status_cache.size() == 0);
+
+  // the oldest variant makes room for a new one
+  add_status_attr(&encoded, "Job_Name", NULL, "STDIN");
+  for (int i = 0; i <= JOB_STATUS_CACHE_VARIANTS; i++)
+    save_status_cache(&pjob, &encoded, i, 0, false, time_now);
+  free_status_attrs(&encoded);
+
+  fail_unless(pjob.ji_status_cache.size() == JOB_STATUS_CACHE_VARIANTS);
+  fail_unless(find_status_cache(&pjob, 0, 0, false, time_now) == NULL);
+  fail_unless(find_status_cache(&pjob, JOB_STATUS_CACHE_VARIANTS, 0, false, time_now) != NULL);
+
+  pjob.invalidate_status_cache();
+  fail_unless(find_status_cache(&pjob, JOB_STATUS_CACHE_VARIANTS, 0, false, time_now) == NULL);
   }
 END_TEST
 
@@ -51,8 +139,8 @@ Suite *stat_job_suite(void)
   tcase_add_test(tc_core, test_include_in_status);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_status_cache");
+  tcase_add_test(tc_core, test_status_cache);
   suite_add_tcase(s, tc_core);
 
   return s;
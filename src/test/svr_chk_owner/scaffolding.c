@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <string.h>
 
 #include "pbs_job.h" /* job */
 #include "attribute.h" /* pbs_attribute */
@@ -28,22 +29,22 @@ char *get_variable(job *pjob, const char *variable)
   exit(1);
   }
 
+int materialize_rc = PBSE_UNKJOBID;
+int reject_code = 0;
+
 void req_reject(int code, int aux, struct batch_request *preq, const char *HostName, const char *Msg)
   {
-  fprintf(stderr, "The call to req_reject to be mocked!!\n");
-  exit(1);
+  reject_code = code;
   }
 
 char *pbse_to_txt(int err)
   {
-  fprintf(stderr, "The call to pbse_to_txt to be mocked!!\n");
-  exit(1);
+  return(strdup("error"));
   }
 
 job *svr_find_job(const char *jobid, int get_subjob)
   {
-  fprintf(stderr, "The call to find_job to be mocked!!\n");
-  exit(1);
+  return(NULL);
   }
 
 int acl_check(pbs_attribute *pattr, char *name, int type)
@@ -147,3 +148,8 @@ char *get_cached_fullhostname(const char *hostname,const struct sockaddr_in *sai
   {
   return(NULL);
   }
+
+int materialize_array_subjob(const char *job_id, batch_request *preq)
+  {
+  return(materialize_rc);
+  }
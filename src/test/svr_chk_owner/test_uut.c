@@ -1,12 +1,37 @@
 #include "license_pbs.h" /* See here for the software license */
+#include "pbs_job.h"
+#include "batch_request.h"
 #include "test_svr_chk_owner.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "pbs_error.h"
+
+job *chk_job_request(char *jobid, struct batch_request *preq);
+
+extern int materialize_rc;
+extern int reject_code;
+
 START_TEST(test_one)
   {
+  batch_request preq;
+  char          jobid[] = "1[5].napali";
+
+  memset(&preq, 0, sizeof(preq));
+
+  // uncreated subjobs of another user's array are rejected without being created
+  materialize_rc = PBSE_PERM;
+  fail_unless(chk_job_request(jobid, &preq) == NULL);
+  fail_unless(reject_code == PBSE_PERM);
 
+  // as are ones past the array's idle slot limit
+  materialize_rc = PBSE_BADSTATE;
+  fail_unless(chk_job_request(jobid, &preq) == NULL);
+  fail_unless(reject_code == PBSE_BADSTATE);
 
+  materialize_rc = PBSE_UNKJOBID;
+  fail_unless(chk_job_request(jobid, &preq) == NULL);
+  fail_unless(reject_code == PBSE_UNKJOBID);
   }
 END_TEST
 
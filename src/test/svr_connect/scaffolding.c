@@ -149,3 +149,16 @@ int pbsnode::unlock_node(const char *id, const char *msg, int level)
   }
 
 pbsnode::pbsnode() {}
+
+int last_added_sock = -1;
+int last_deleted_sock = -1;
+
+void globalset_add_sock(int sock, u_long addr, u_long port)
+  {
+  last_added_sock = sock;
+  }
+
+void globalset_del_sock(int sock)
+  {
+  last_deleted_sock = sock;
+  }
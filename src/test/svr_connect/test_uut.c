@@ -3,12 +3,21 @@
 #include "test_svr_connect.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
 #include "pbs_error.h"
+#include "libpbs.h"
+#include "net_connect.h"
 
 
 extern bool free_node_on_unlock;
 extern int  node_unlocked;
 extern int  find_node_called;
+extern int  last_added_sock;
+extern int  last_deleted_sock;
+
+extern struct connect_handle connection[];
+extern struct connection     svr_conn[];
 
 int connect_while_handling_mutex(pbs_net_t hostaddr, unsigned int port, char *EMsg, struct pbsnode **pnode);
 
@@ -32,10 +41,38 @@ START_TEST(test_connect_while_handling_mutex)
   }
 END_TEST
 
-START_TEST(test_two)
+START_TEST(test_pooled_connections_leave_read_set)
   {
-
-
+  int       fds[2];
+  pbs_net_t addr = 0x7f000001;
+  int       port = 15003;
+  int       err = 0;
+
+  fail_unless(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  connection[1].ch_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+  pthread_mutex_init(connection[1].ch_mutex, NULL);
+  connection[1].ch_socket = fds[0];
+  connection[1].ch_inuse = TRUE;
+
+  svr_conn[fds[0]].cn_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+  pthread_mutex_init(svr_conn[fds[0]].cn_mutex, NULL);
+  svr_conn[fds[0]].cn_active = ToServerDIS;
+  svr_conn[fds[0]].cn_addr = addr;
+  svr_conn[fds[0]].cn_port = port;
+
+  // a pooled socket isn't waited on, nothing would read it
+  last_deleted_sock = -1;
+  svr_release_connection(1, true);
+  fail_unless(last_deleted_sock == fds[0]);
+
+  // and it's waited on again once it's handed out
+  last_added_sock = -1;
+  fail_unless(svr_connect_pooled(addr, port, &err, NULL) == 1);
+  fail_unless(last_added_sock == fds[0]);
+
+  close(fds[0]);
+  close(fds[1]);
   }
 END_TEST
 
@@ -46,8 +83,8 @@ Suite *svr_connect_suite(void)
   tcase_add_test(tc_core, test_connect_while_handling_mutex);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_pooled_connections_leave_read_set");
+  tcase_add_test(tc_core, test_pooled_connections_leave_read_set);
   suite_add_tcase(s, tc_core);
 
   return s;
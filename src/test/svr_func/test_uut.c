@@ -6,6 +6,7 @@
 #include "pbs_error.h"
 
 int keep_completed_val_check(pbs_attribute *pattr,void *pobj,int actmode);
+int ck_checkpoint(pbs_attribute *pattr, void *pobject, int mode);
 
 START_TEST(test_keep_comleted_val_check)
   {
@@ -17,6 +18,20 @@ START_TEST(test_keep_comleted_val_check)
   }
 END_TEST
 
+START_TEST(test_ck_checkpoint_recov)
+  {
+  pbs_attribute ckpt;
+  char          val[] = "bogus";
+
+  /* recovery must not reach csv_nth(), the scaffolding version exits */
+  ckpt.at_val.at_str = val;
+  fail_unless(ck_checkpoint(&ckpt, NULL, ATR_ACTION_RECOV) == 0);
+
+  ckpt.at_val.at_str = NULL;
+  fail_unless(ck_checkpoint(&ckpt, NULL, ATR_ACTION_NEW) == 0);
+  }
+END_TEST
+
 START_TEST(test_two)
   {
 
@@ -31,6 +46,10 @@ Suite *svr_func_suite(void)
   tcase_add_test(tc_core, test_keep_comleted_val_check);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_ck_checkpoint_recov");
+  tcase_add_test(tc_core, test_ck_checkpoint_recov);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_two");
   tcase_add_test(tc_core, test_two);
   suite_add_tcase(s, tc_core);
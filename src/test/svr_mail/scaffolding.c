@@ -47,6 +47,11 @@ int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *t
   return 0;
   }
 
+int enqueue_threadpool_request_lane(void *(*func)(void *), void *arg, threadpool_t *tp, enum tp_lane lane)
+  {
+  return(enqueue_threadpool_request(func, arg, tp));
+  }
+
 resource *find_resc_entry(pbs_attribute *pattr, resource_def *rscdf) 
   { 
   fprintf(stderr, "The call to find_ersc_entry need to be mocked!!\n");
@@ -28,6 +28,11 @@ int enqueue_threadpool_request(void *(*func)(void *),void *arg, threadpool_t *tp
   return 5;
   }
 
+int enqueue_threadpool_request_lane(void *(*func)(void *),void *arg, threadpool_t *tp, enum tp_lane lane)
+  {
+  return 5;
+  }
+
 void check_nodes(struct work_task *ptask)
   {
   fprintf(stderr, "The call to check_nodes to be mocked!!\n");
@@ -8,8 +8,6 @@
 #include "threadpool.h"
 
 extern void  check_nodes(struct work_task *ptask);
-void         insert_timed_task(work_task *wt);
-work_task   *pop_timed_task(time_t  time_now);
 bool         can_dispatch_task();
 int          dispatch_timed_task(work_task *ptask);
 
@@ -17,7 +15,7 @@ int          dispatch_timed_task(work_task *ptask);
 extern all_tasks      task_list_event;
 extern task_recycler  tr;
 extern threadpool_t  *request_pool;
-extern std::list<timed_task> *task_list_timed;
+extern std::vector<timed_task> *task_list_timed;
 
 START_TEST(dispatch_timed_task_test)
   {
@@ -28,7 +26,7 @@ START_TEST(dispatch_timed_task_test)
   wt.wt_event = 200;
 
   if (task_list_timed == NULL)
-    task_list_timed = new std::list<timed_task>();
+    task_list_timed = new std::vector<timed_task>();
 
   if (request_pool == NULL)
     initialize_threadpool(&request_pool,10,50,50);
@@ -82,7 +80,7 @@ START_TEST(manage_timed_task_test)
   pthread_mutex_init(ptask3.wt_mutex, NULL);
 
   if (task_list_timed == NULL)
-    task_list_timed = new std::list<timed_task>();
+    task_list_timed = new std::vector<timed_task>();
 
   ptask1.wt_event = 100;
   ptask2.wt_event = 200;
@@ -117,6 +115,97 @@ START_TEST(manage_timed_task_test)
   }
 END_TEST
 
+work_task *new_timed_task(
+
+  long event)
+
+  {
+  work_task *wt = (work_task *)calloc(1, sizeof(work_task));
+
+  wt->wt_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+  pthread_mutex_init(wt->wt_mutex, NULL);
+  wt->wt_event = event;
+
+  return(wt);
+  }
+
+
+START_TEST(timed_task_heap_test)
+  {
+  std::vector<work_task *> tasks;
+  std::vector<work_task *> expired;
+  work_task               *wt;
+  long                     last = 0;
+  unsigned int             seed = 7;
+  int                      count = 0;
+
+  if (task_list_timed == NULL)
+    task_list_timed = new std::vector<timed_task>();
+  task_list_timed->clear();
+
+  for (int i = 0; i < 1000; i++)
+    {
+    tasks.push_back(new_timed_task(1 + rand_r(&seed) % 500));
+    insert_timed_task(tasks.back());
+    }
+
+  // cancel every third task by its handle
+  for (int i = 0; i < 1000; i += 3)
+    {
+    pthread_mutex_lock(tasks[i]->wt_mutex);
+    fail_unless(remove_timed_task(tasks[i]) == true);
+    fail_unless(tasks[i]->wt_heap_slot == 0);
+    fail_unless(remove_timed_task(tasks[i]) == false);
+    pthread_mutex_unlock(tasks[i]->wt_mutex);
+    }
+
+  fail_unless(task_list_timed->size() == 666);
+
+  // nothing expires before its time
+  fail_unless(pop_timed_tasks(0, expired, TIMED_TASK_BATCH) == 0);
+
+  while (pop_timed_tasks(250, expired, TIMED_TASK_BATCH) > 0)
+    {
+    fail_unless(expired.size() <= TIMED_TASK_BATCH);
+
+    for (unsigned int i = 0; i < expired.size(); i++)
+      {
+      fail_unless(expired[i]->wt_event >= last);
+      fail_unless(expired[i]->wt_event <= 250);
+      fail_unless(pthread_mutex_trylock(expired[i]->wt_mutex) == EBUSY);
+      last = expired[i]->wt_event;
+      pthread_mutex_unlock(expired[i]->wt_mutex);
+      count++;
+      }
+
+    expired.clear();
+    }
+
+  while ((wt = pop_timed_task(500)) != NULL)
+    {
+    fail_unless(wt->wt_event >= last);
+    last = wt->wt_event;
+    pthread_mutex_unlock(wt->wt_mutex);
+    count++;
+    }
+
+  fail_unless(count == 666);
+  fail_unless(task_list_timed->empty());
+
+  // tasks due at the same time come out in the order they were set
+  for (int i = 0; i < 3; i++)
+    {
+    tasks[i]->wt_event = 10;
+    insert_timed_task(tasks[i]);
+    }
+
+  fail_unless(pop_timed_tasks(10, expired, TIMED_TASK_BATCH) == 3);
+  fail_unless(expired[0] == tasks[0]);
+  fail_unless(expired[1] == tasks[1]);
+  fail_unless(expired[2] == tasks[2]);
+  }
+END_TEST
+
 START_TEST(test_one)
   {
   int rc;
@@ -124,7 +213,7 @@ START_TEST(test_one)
   initialize_task_recycler();
 
   if (task_list_timed == NULL)
-    task_list_timed = new std::list<timed_task>();
+    task_list_timed = new std::vector<timed_task>();
 
   rc = initialize_threadpool(&request_pool, 5, 50, 60);
   fail_unless(rc == PBSE_NONE, "initalize_threadpool failed", rc);
@@ -158,6 +247,7 @@ Suite *svr_task_suite(void)
   tc_core = tcase_create("can_dispatch_task_test");
   tcase_add_test(tc_core, can_dispatch_task_test);
   tcase_add_test(tc_core, manage_timed_task_test);
+  tcase_add_test(tc_core, timed_task_heap_test);
   tcase_add_test(tc_core, dispatch_timed_task_test);
   suite_add_tcase(s, tc_core);
 
@@ -33,10 +33,100 @@ START_TEST(test_one)
   }
 END_TEST
 
-START_TEST(test_two)
+START_TEST(test_status_delta)
   {
+  std::vector<std::string>  base;
+  std::vector<std::string>  current;
+  std::vector<std::string>  received;
+  std::vector<std::string>  values;
+  std::vector<unsigned int> indexes;
+  std::vector<bool>         changed;
+
+  base.push_back("node=napali");
+  base.push_back("state=free");
+  base.push_back("ncpus=16");
+
+  current = base;
+  current[1] = "state=busy";
+  current.push_back("message=ERROR");
+
+  get_status_delta(base, current, indexes);
+  fail_unless(indexes.size() == 2);
+  fail_unless(indexes[0] == 1);
+  fail_unless(indexes[1] == 3);
+
+  get_status_delta(current, current, indexes);
+  fail_unless(indexes.size() == 0);
+
+  // apply the delta to what the server had
+  get_status_delta(base, current, indexes);
+  for (unsigned int i = 0; i < indexes.size(); i++)
+    values.push_back(current[indexes[i]]);
+
+  received = base;
+  fail_unless(apply_status_delta(received, current.size(), indexes, values, changed) == PBSE_NONE);
+  fail_unless(received == current);
+  fail_unless(changed[0] == false);
+  fail_unless(changed[1] == true);
+  fail_unless(changed[2] == false);
+  fail_unless(changed[3] == true);
+
+  // shrinking drops the tail
+  indexes.clear();
+  values.clear();
+  fail_unless(apply_status_delta(received, 2, indexes, values, changed) == PBSE_NONE);
+  fail_unless(received.size() == 2);
+
+  // a delta that doesn't fill new positions or points past the end is rejected
+  fail_unless(apply_status_delta(received, 3, indexes, values, changed) == PBSE_PROTOCOL);
+  indexes.push_back(5);
+  values.push_back("ncpus=16");
+  fail_unless(apply_status_delta(received, 3, indexes, values, changed) == PBSE_PROTOCOL);
+  values.push_back("ncpus=16");
+  fail_unless(apply_status_delta(received, 6, indexes, values, changed) == PBSE_PROTOCOL);
+  }
+END_TEST
 
 
+START_TEST(test_status_batch)
+  {
+  std::vector<status_batch_entry> entries;
+  std::vector<status_batch_entry> unpacked;
+  std::string                     packed;
+  unsigned int                    raw_len = 0;
+
+  entries.resize(2);
+  entries[0].age = 3;
+  entries[0].statuses.push_back("node=napali");
+  entries[0].statuses.push_back("state=free");
+  entries[0].statuses.push_back("");
+  entries[0].statuses.push_back("ncpus=16");
+  entries[1].age = 0;
+  entries[1].statuses.push_back("node=waimea");
+  entries[1].statuses.push_back("state=down");
+
+  fail_unless(pack_status_batch(entries, packed, raw_len) == PBSE_NONE);
+  fail_unless(raw_len > 0);
+
+  fail_unless(unpack_status_batch(packed.data(), packed.size(), raw_len, unpacked) == PBSE_NONE);
+  fail_unless(unpacked.size() == 2);
+  fail_unless(unpacked[0].age == 3);
+  // empty strings aren't sent
+  fail_unless(unpacked[0].statuses.size() == 3);
+  fail_unless(unpacked[0].statuses[2] == "ncpus=16");
+  fail_unless(unpacked[1].age == 0);
+  fail_unless(unpacked[1].statuses == entries[1].statuses);
+
+  // a wrong length or a truncated batch is rejected
+  fail_unless(unpack_status_batch(packed.data(), packed.size(), raw_len + 1, unpacked) == PBSE_PROTOCOL);
+  fail_unless(unpack_status_batch(packed.data(), packed.size() / 2, raw_len, unpacked) == PBSE_PROTOCOL);
+  fail_unless(unpack_status_batch(packed.data(), packed.size(), 0, unpacked) == PBSE_PROTOCOL);
+
+  // entries that don't name a node are dropped
+  entries[1].statuses[0] = "state=free";
+  fail_unless(pack_status_batch(entries, packed, raw_len) == PBSE_NONE);
+  fail_unless(unpack_status_batch(packed.data(), packed.size(), raw_len, unpacked) == PBSE_NONE);
+  fail_unless(unpacked.size() == 1);
   }
 END_TEST
 
@@ -47,8 +137,12 @@ Suite *u_mom_hierarchy_suite(void)
   tcase_add_test(tc_core, test_one);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_status_delta");
+  tcase_add_test(tc_core, test_status_delta);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_status_batch");
+  tcase_add_test(tc_core, test_status_batch);
   suite_add_tcase(s, tc_core);
 
   return s;
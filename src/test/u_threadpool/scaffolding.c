@@ -10,8 +10,9 @@ void log_err(int errnum, const char *routine, const char *text)
   exit(1);
   }
 
+char last_event[4096];
+
 void log_event(int eventtype, int objclass, const char *objname, const char *text)
   { 
-  fprintf(stderr, "The call to log_err needs to be mocked!!\n");
-  exit(1);
+  snprintf(last_event, sizeof(last_event), "%s", text);
   }
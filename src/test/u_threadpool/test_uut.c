@@ -3,33 +3,153 @@
 #include "test_u_threadpool.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
-
+#include "threadpool.h"
 #include "pbs_error.h"
 
-START_TEST(test_one)
+extern char last_event[];
+
+int  work_done = 0;
+char lane_tags[] = "HNL";
+
+
+void *count_work(
+
+  void *vp)
+
   {
+  __sync_fetch_and_add(&work_done, 1);
+  return(NULL);
+  }
+
+
+START_TEST(test_lanes)
+  {
+  threadpool_t *tp = NULL;
+  tp_work_t    *work;
+  tp_stats_t    stats;
+
+  // the pool isn't started, so nothing is taken off the queue behind our back
+  fail_unless(initialize_threadpool(&tp, 1, 1, 10) == PBSE_NONE);
+
+  fail_unless(enqueue_threadpool_request_lane(count_work, lane_tags + 2, tp, TP_LANE_LOW) == 0);
+  fail_unless(enqueue_threadpool_request(count_work, lane_tags + 1, tp) == 0);
+  fail_unless(enqueue_threadpool_request_lane(count_work, lane_tags, tp, TP_LANE_HIGH) == 0);
+
+  get_threadpool_stats(tp, &stats);
+  fail_unless(stats.queued == 3);
+  fail_unless(stats.lane_queued[TP_LANE_HIGH] == 1);
+  fail_unless(stats.lane_queued[TP_LANE_NORMAL] == 1);
+  fail_unless(stats.lane_queued[TP_LANE_LOW] == 1);
+  fail_unless(stats.enqueued == 3);
+
+  pthread_mutex_lock(&tp->tp_mutex);
+
+  // the highest lane goes first
+  work = next_work_item(tp);
+  fail_unless(work->work_arg == lane_tags);
+  free(work);
+  work = next_work_item(tp);
+  fail_unless(work->work_arg == lane_tags + 1);
+  free(work);
+  work = next_work_item(tp);
+  fail_unless(work->work_arg == lane_tags + 2);
+  free(work);
+  fail_unless(next_work_item(tp) == NULL);
 
+  pthread_mutex_unlock(&tp->tp_mutex);
 
+  // a waiting lower lane gets a turn after TP_LANE_STARVE_LIMIT higher items
+  enqueue_threadpool_request_lane(count_work, lane_tags + 2, tp, TP_LANE_LOW);
+  usleep(10);
+  for (int i = 0; i < TP_LANE_STARVE_LIMIT * 2; i++)
+    enqueue_threadpool_request_lane(count_work, lane_tags, tp, TP_LANE_HIGH);
+
+  pthread_mutex_lock(&tp->tp_mutex);
+
+  for (int i = 0; i < TP_LANE_STARVE_LIMIT; i++)
+    {
+    work = next_work_item(tp);
+    fail_unless(work->work_arg == lane_tags);
+    free(work);
+    }
+
+  work = next_work_item(tp);
+  fail_unless(work->work_arg == lane_tags + 2);
+  free(work);
+
+  while ((work = next_work_item(tp)) != NULL)
+    {
+    fail_unless(work->work_arg == lane_tags);
+    free(work);
+    }
+
+  fail_unless(tp->tp_queued == 0);
+  fail_unless(tp->tp_stats.max_queued == TP_LANE_STARVE_LIMIT * 2 + 1);
+
+  pthread_mutex_unlock(&tp->tp_mutex);
   }
 END_TEST
 
-START_TEST(test_two)
+
+START_TEST(test_work_runs)
   {
+  threadpool_t *tp = NULL;
+  tp_stats_t    stats;
+  int           i;
+
+  work_done = 0;
+  fail_unless(initialize_threadpool(&tp, 2, 4, -1) == PBSE_NONE);
+  start_request_pool(tp);
+
+  for (i = 0; i < 1000; i++)
+    fail_unless(enqueue_threadpool_request_lane(count_work, NULL, tp, (enum tp_lane)(i % TP_LANES)) == 0);
+
+  for (i = 0; (i < 1000) && (work_done < 1000); i++)
+    usleep(10000);
+
+  fail_unless(work_done == 1000);
+
+  // completed is counted just after the work function returns
+  for (i = 0; i < 100; i++)
+    {
+    get_threadpool_stats(tp, &stats);
+    if (stats.completed == 1000)
+      break;
+
+    usleep(10000);
+    }
+
+  fail_unless(stats.completed == 1000);
+  fail_unless(stats.enqueued == 1000);
+  fail_unless(stats.queued == 0);
+
+  // finished items are kept for re-use
+  pthread_mutex_lock(&tp->tp_mutex);
+  fail_unless(tp->tp_nfree > 0);
+  fail_unless(tp->tp_nfree <= TP_MAX_FREE_WORK);
+  pthread_mutex_unlock(&tp->tp_mutex);
 
+  log_threadpool_stats(tp, "test_pool");
+  fail_unless(strstr(last_event, "test_pool: threads") != NULL);
+  fail_unless(strstr(last_event, "completed 1000") != NULL);
 
+  destroy_request_pool(tp);
   }
 END_TEST
 
 Suite *u_threadpool_suite(void)
   {
   Suite *s = suite_create("u_threadpool_suite methods");
-  TCase *tc_core = tcase_create("test_one");
-  tcase_add_test(tc_core, test_one);
+  TCase *tc_core = tcase_create("test_lanes");
+  tcase_add_test(tc_core, test_lanes);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_work_runs");
+  tcase_add_test(tc_core, test_work_runs);
+  tcase_set_timeout(tc_core, 30);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -79,10 +79,13 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include "portability.h"
 #include "list_link.h"
@@ -91,6 +94,8 @@
 #include "pbs_job.h"
 #include "tm.h"
 #include "lib_ifl.h"
+#include "job_image.h"
+#include "job_recovery.h"
 
 
 void prt_job_struct(
@@ -330,6 +335,294 @@ int read_tm_info(
 
 
 
+/*
+ * print_xml_value() - print str with the XML reserved characters escaped
+ */
+
+void print_xml_value(
+
+  const char *str)
+
+  {
+  for (; *str != '\0'; str++)
+    {
+    switch (*str)
+      {
+      case '<':  printf("&lt;");   break;
+      case '>':  printf("&gt;");   break;
+      case '&':  printf("&amp;");  break;
+      case '"':  printf("&quot;"); break;
+      case '\'': printf("&apos;"); break;
+      default:   putchar(*str);    break;
+      }
+    }
+  }  /* END print_xml_value() */
+
+
+
+
+/*
+ * prt_job_xml_fields() - print ji_qs using the tags of the server's XML job file
+ */
+
+void prt_job_xml_fields(
+
+  job *pjob)
+
+  {
+  printf("<?xml version=\"1.0\"?>\n<%s>\n", JOB_TAG);
+  printf("  <%s>%d</%s>\n", VERSION_TAG, pjob->ji_qs.qs_version, VERSION_TAG);
+  printf("  <%s>%d</%s>\n", STATE_TAG, pjob->ji_qs.ji_state, STATE_TAG);
+  printf("  <%s>%d</%s>\n", SUBSTATE_TAG, pjob->ji_qs.ji_substate, SUBSTATE_TAG);
+  printf("  <%s>%d</%s>\n", SRV_FLAGS_TAG, pjob->ji_qs.ji_svrflags, SRV_FLAGS_TAG);
+  printf("  <%s>%ld</%s>\n", STIME_TAG, (long)pjob->ji_qs.ji_stime, STIME_TAG);
+  printf("  <%s>", JOBID_TAG);
+  print_xml_value(pjob->ji_qs.ji_jobid);
+  printf("</%s>\n  <%s>", JOBID_TAG, FPREFIX_TAG);
+  print_xml_value(pjob->ji_qs.ji_fileprefix);
+  printf("</%s>\n  <%s>", FPREFIX_TAG, QUEUE_TAG);
+  print_xml_value(pjob->ji_qs.ji_queue);
+  printf("</%s>\n  <%s>", QUEUE_TAG, DST_QUEUE);
+  print_xml_value(pjob->ji_qs.ji_destin);
+  printf("</%s>\n", DST_QUEUE);
+
+  printf("  <%s>%d</%s>\n", REC_TYPE_TAG, pjob->ji_qs.ji_un_type, REC_TYPE_TAG);
+
+  switch (pjob->ji_qs.ji_un_type)
+    {
+
+    case JOB_UNION_TYPE_NEW:
+
+      printf("  <%s>%lu</%s>\n", FROM_HOST_TAG, pjob->ji_qs.ji_un.ji_newt.ji_fromaddr, FROM_HOST_TAG);
+      printf("  <%s>%d</%s>\n", FROM_SOCK_TAG, pjob->ji_qs.ji_un.ji_newt.ji_fromsock, FROM_SOCK_TAG);
+      printf("  <%s>%d</%s>\n", SCRT_SIZE_TAG, pjob->ji_qs.ji_un.ji_newt.ji_scriptsz, SCRT_SIZE_TAG);
+
+      break;
+
+    case JOB_UNION_TYPE_EXEC:
+
+      printf("  <%s>%lu</%s>\n", MOM_ADDR_TAG, pjob->ji_qs.ji_un.ji_exect.ji_momaddr, MOM_ADDR_TAG);
+      printf("  <%s>%d</%s>\n", MOM_PORT_TAG, pjob->ji_qs.ji_un.ji_exect.ji_momport, MOM_PORT_TAG);
+      printf("  <%s>%d</%s>\n", MOM_RPORT_TAG, pjob->ji_qs.ji_un.ji_exect.ji_mom_rmport, MOM_RPORT_TAG);
+
+      break;
+
+    case JOB_UNION_TYPE_ROUTE:
+
+      printf("  <%s>%ld</%s>\n", QUE_TIME_TAG, (long)pjob->ji_qs.ji_un.ji_routet.ji_quetime, QUE_TIME_TAG);
+      printf("  <%s>%ld</%s>\n", RQUE_TIME_TAG, (long)pjob->ji_qs.ji_un.ji_routet.ji_rteretry, RQUE_TIME_TAG);
+
+      break;
+
+    case JOB_UNION_TYPE_MOM:
+
+      printf("  <%s>%lu</%s>\n", SVR_ADDR_TAG, pjob->ji_qs.ji_un.ji_momt.ji_svraddr, SVR_ADDR_TAG);
+      printf("  <%s>%d</%s>\n", EXIT_STAT_TAG, pjob->ji_qs.ji_un.ji_momt.ji_exitstat, EXIT_STAT_TAG);
+      printf("  <%s>%u</%s>\n", EXEC_UID_TAG, (unsigned int)pjob->ji_qs.ji_un.ji_momt.ji_exuid, EXEC_UID_TAG);
+      printf("  <%s>%u</%s>\n", EXEC_GID_TAG, (unsigned int)pjob->ji_qs.ji_un.ji_momt.ji_exgid, EXEC_GID_TAG);
+
+      break;
+    }
+
+  return;
+  }  /* END prt_job_xml_fields() */
+
+
+
+
+/*
+ * print_job_image() - print a binary job image (see job_image.h)
+ *
+ * With xml set the job is printed as the XML job file the server reads, so
+ * that an image can be converted back for an older pbs_server.
+ *
+ * @return 0 if the file was printed, 1 if it isn't a job image, -1 if it is damaged
+ */
+
+int print_job_image(
+
+  int         fd,
+  const char *filename,
+  int         no_attributes,
+  int         xml)
+
+  {
+  struct stat             sb;
+  char                   *map;
+  const job_image_header *hdr;
+  const char             *pos;
+  const char             *end;
+  const char             *open_list = NULL;
+  job                     xjob;
+  int                     rc = 0;
+
+  if ((fstat(fd, &sb) != 0) ||
+      (sb.st_size < (off_t)sizeof(job_image_header)))
+    return(1);
+
+  map = (char *)mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (map == MAP_FAILED)
+    {
+    perror("mmap failed");
+
+    return(-1);
+    }
+
+  hdr = (const job_image_header *)map;
+
+  if (hdr->jih_magic != JOB_IMAGE_MAGIC)
+    {
+    munmap(map, sb.st_size);
+
+    return(1);
+    }
+
+  if ((hdr->jih_version != JOB_IMAGE_VERSION) ||
+      (hdr->jih_qs_size != sizeof(xjob.ji_qs)) ||
+      ((size_t)hdr->jih_qs_offset + hdr->jih_qs_size > (size_t)sb.st_size) ||
+      ((size_t)hdr->jih_attr_offset + hdr->jih_attr_size > (size_t)sb.st_size) ||
+      ((size_t)hdr->jih_mom_offset + hdr->jih_mom_size > (size_t)sb.st_size))
+    {
+    fprintf(stderr, "%s is a job image this printjob can't read (image version %u, ji_qs version %#010x)\n",
+      filename,
+      hdr->jih_version,
+      hdr->jih_qs_version);
+
+    munmap(map, sb.st_size);
+
+    return(-1);
+    }
+
+  if (job_image_checksum(map + hdr->jih_qs_offset, sb.st_size - hdr->jih_qs_offset) != hdr->jih_checksum)
+    fprintf(stderr, "warning: %s fails its checksum, pbs_server will not recover it\n", filename);
+
+  memcpy(&xjob.ji_qs, map + hdr->jih_qs_offset, sizeof(xjob.ji_qs));
+  xjob.ji_qs.ji_jobid[sizeof(xjob.ji_qs.ji_jobid) - 1] = '\0';
+  xjob.ji_qs.ji_fileprefix[sizeof(xjob.ji_qs.ji_fileprefix) - 1] = '\0';
+  xjob.ji_qs.ji_queue[sizeof(xjob.ji_qs.ji_queue) - 1] = '\0';
+  xjob.ji_qs.ji_destin[sizeof(xjob.ji_qs.ji_destin) - 1] = '\0';
+
+  if (xml)
+    {
+    prt_job_xml_fields(&xjob);
+    printf("  <%s>\n", ATTRIB_TAG);
+    }
+  else
+    {
+    prt_job_struct(&xjob);
+
+    if (no_attributes == 0)
+      printf("--attributes--\n");
+    }
+
+  pos = map + hdr->jih_attr_offset;
+  end = pos + hdr->jih_attr_size;
+
+  for (unsigned int i = 0; (i < hdr->jih_attr_count) && ((no_attributes == 0) || (xml)); i++)
+    {
+    const job_image_attr *rec = (const job_image_attr *)pos;
+    const char           *name = pos + sizeof(*rec);
+    const char           *resc;
+    const char           *value;
+
+    if ((end - pos < (long)sizeof(*rec)) ||
+        (rec->jia_size < sizeof(*rec)) ||
+        (rec->jia_size > (size_t)(end - pos)) ||
+        (sizeof(*rec) + rec->jia_name_len + rec->jia_resc_len + rec->jia_value_len > rec->jia_size) ||
+        (rec->jia_name_len == 0) ||
+        (rec->jia_value_len == 0) ||
+        (name[rec->jia_name_len - 1] != '\0') ||
+        ((rec->jia_resc_len != 0) && (name[rec->jia_name_len + rec->jia_resc_len - 1] != '\0')) ||
+        (name[rec->jia_name_len + rec->jia_resc_len + rec->jia_value_len - 1] != '\0'))
+      {
+      fprintf(stderr, "bad attribute record %u in %s\n", i, filename);
+
+      rc = -1;
+
+      break;
+      }
+
+    resc = (rec->jia_resc_len != 0) ? name + rec->jia_name_len : NULL;
+    value = name + rec->jia_name_len + rec->jia_resc_len;
+
+    if (xml)
+      {
+      /* the resources of a list are consecutive records nested under the list's tag */
+      if ((open_list != NULL) &&
+          ((resc == NULL) || (strcmp(open_list, name) != 0)))
+        {
+        printf("    </%s>\n", open_list);
+        open_list = NULL;
+        }
+
+      if (resc != NULL)
+        {
+        if (open_list == NULL)
+          {
+          printf("    <%s>\n", name);
+          open_list = name;
+          }
+
+        printf("      <%s %s=\"%u\">", resc, AL_FLAGS_ATTR, rec->jia_flags);
+        print_xml_value(value);
+        printf("</%s>\n", resc);
+        }
+      else
+        {
+        printf("    <%s %s=\"%u\">", name, AL_FLAGS_ATTR, rec->jia_flags);
+        print_xml_value(value);
+        printf("</%s>\n", name);
+        }
+      }
+    else if (resc != NULL)
+      printf("%s.%s = %s\n", name, resc, value);
+    else
+      printf("%s = %s\n", name, value);
+
+    pos += rec->jia_size;
+    }
+
+  if (xml)
+    {
+    if (open_list != NULL)
+      printf("    </%s>\n", open_list);
+
+    printf("  </%s>\n", ATTRIB_TAG);
+    }
+
+  if (hdr->jih_mom_size >= sizeof(job_image_mom))
+    {
+    const job_image_mom *mom = (const job_image_mom *)(map + hdr->jih_mom_offset);
+
+    if (xml)
+      {
+      printf("  <%s>%d</%s>\n", STDOUT_TAG, mom->jim_stdout, STDOUT_TAG);
+      printf("  <%s>%d</%s>\n", STDERR_TAG, mom->jim_stderr, STDERR_TAG);
+      printf("  <%s>%d</%s>\n", TASKID_TAG, mom->jim_taskid, TASKID_TAG);
+      printf("  <%s>%d</%s>\n", NODEID_TAG, mom->jim_nodeid, NODEID_TAG);
+      }
+    else
+      {
+      printf("--TM info--\n");
+      printf("stdout port = %d\nstderr port = %d\ntaskid = %d\nnodeid = %d\n",
+        mom->jim_stdout,
+        mom->jim_stderr,
+        mom->jim_taskid,
+        mom->jim_nodeid);
+      }
+    }
+
+  if (xml)
+    printf("</%s>\n", JOB_TAG);
+
+  munmap(map, sb.st_size);
+
+  return(rc);
+  }  /* END print_job_image() */
+
+
+
 int main(
 
   int argc,
@@ -341,11 +634,13 @@ int main(
   int f;
   int fp;
   int no_attributes = 0;
+  int xml = 0;
+  int rc;
   job xjob;
 
   extern int optind;
 
-  while ((f = getopt(argc, argv, "a")) != EOF)
+  while ((f = getopt(argc, argv, "ax")) != EOF)
     {
     switch (f)
       {
@@ -356,6 +651,12 @@ int main(
 
         break;
 
+      case 'x':
+
+        xml = 1;
+
+        break;
+
       default:
 
         err = 1;
@@ -366,7 +667,7 @@ int main(
 
   if (err || (argc - optind < 1))
     {
-    fprintf(stderr, "usage: %s [-a] file[ file]...}\n",
+    fprintf(stderr, "usage: %s [-a] [-x] file[ file]...}\n",
             argv[0]);
 
     return(1);
@@ -386,6 +687,24 @@ int main(
       exit(1);
       }
 
+    /* job images are printed on their own, anything else is the old binary format */
+    if ((rc = print_job_image(fp, argv[f], no_attributes, xml)) != 1)
+      {
+      close(fp);
+
+      if (rc != 0)
+        err = 1;
+
+      printf("\n");
+
+      continue;
+      }
+
+    if (xml)
+      {
+      fprintf(stderr, "%s is not a job image, -x ignored\n", argv[f]);
+      }
+
     amt = read_ac_socket(fp, &xjob.ji_qs, sizeof(xjob.ji_qs));
 
     if (amt != sizeof(xjob.ji_qs))
@@ -432,7 +751,7 @@ int main(
     printf("\n");
     }  /* END for (f) */
 
-  return(0);
+  return(err);
   }    /* END main() */
 
 